@@ -51,6 +51,7 @@
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
 #include <core/Sampler/Interpolation.h>
+#include <core/Sampler/SampleRegistry.h>
 #include <core/Version.h>
 
 using namespace H2Core;
@@ -191,6 +192,13 @@ int main(int argc, char *argv[])
 			QStringList() << "x" << "extract",
 			"Extracts the content of a drumkit (.h2drumkit). If no target is specified using the -t option, this command behaves like --install.",
 			"File" );
+		QCommandLineOption prewarmCacheOption(
+			QStringList() << "prewarm-cache",
+			"Decodes all samples of a drumkit into the sample cache. The provided file can be either an absolute path to a folder containing a drumkit or an absolute path to a drumkit file (drumkit.xml) itself. Requires 'sampleCacheSize' to be set in the preferences.",
+			"File" );
+		QCommandLineOption sampleMemoryOption(
+			QStringList() << "sample-memory",
+			"Lists the memory occupied by the samples of the loaded song (-s) and drumkit (-k). Samples shared by several instruments or drumkits are listed once." );
 		QCommandLineOption targetOption(
 			QStringList() << "t" << "target",
 			"Target folder the extracted (-x) or upgraded (-u) drumkit will be stored in. The folder is created if it does not exists yet.",
@@ -206,6 +214,12 @@ int main(int argc, char *argv[])
 			"double", "0.0" );
 		QCommandLineOption outputFileOption(
 			QStringList() << "o" << "outfile", "Output to file (export)", "File" );
+		QCommandLineOption stemsOption(
+			QStringList() << "stems",
+			"Export every instrument into a separate file alongside the one (-o) holding the mix. The song is rendered just once." );
+		QCommandLineOption stemComponentsOption(
+			QStringList() << "stem-components",
+			"Like --stems but using a separate file for every component of an instrument." );
 		QCommandLineOption interpolationOption(
 			QStringList() << "I" << "interpolation",
 			"Interpolation:\n   - 0 (linear) [default]\n   - 1 (cosine)\n   - 2 (third)\n   - 3 (cubic)\n   - 4 (hermite)",
@@ -249,6 +263,8 @@ int main(int argc, char *argv[])
 		parser.addOption( rateOption );
 		parser.addOption( bitsOption );
 		parser.addOption( compressionLevelOption );
+		parser.addOption( stemsOption );
+		parser.addOption( stemComponentsOption );
 		parser.addOption( kitOption );
 		parser.addOption( kitToDrumkitMapOption );
 		parser.addOption( interpolationOption );
@@ -257,6 +273,8 @@ int main(int argc, char *argv[])
 		parser.addOption( legacyCheckDrumkitOption );
 		parser.addOption( upgradeDrumkitOption );
 		parser.addOption( extractDrumkitOption );
+		parser.addOption( prewarmCacheOption );
+		parser.addOption( sampleMemoryOption );
 		parser.addOption( targetOption );
 #ifdef H2CORE_HAVE_OSC
 		parser.addOption( oscPortOption );
@@ -285,8 +303,13 @@ int main(int argc, char *argv[])
 		const QString sLogFile = parser.value( logFileOption );
 		const QString sDrumkitToUpgrade = parser.value( upgradeDrumkitOption );
 		const QString sDrumkitToExtract = parser.value( extractDrumkitOption );
+		const QString sDrumkitToPrewarm = parser.value( prewarmCacheOption );
+		const bool bShowSampleMemory = parser.isSet( sampleMemoryOption );
 		const bool bLogTimestamps = parser.isSet( logTimestampsOption );
 		const QString sTarget = parser.value( targetOption );
+		const bool bExportStemComponents = parser.isSet( stemComponentsOption );
+		const bool bExportStems = parser.isSet( stemsOption ) ||
+			bExportStemComponents;
 
 		bool bOk;
 		const short bits = parser.value( bitsOption ).toShort( &bOk );
@@ -475,8 +498,13 @@ int main(int argc, char *argv[])
 			for (auto i = 0; i < pInstrumentList->size(); i++) {
 				pInstrumentList->get(i)->setCurrentlyExported( true );
 			}
+			std::vector<ExportStem> stems;
+			if ( bExportStems ) {
+				stems = pHydrogen->getExportStems(
+					sOutFilename, bExportStemComponents );
+			}
 			pHydrogen->startExportSession(nRate, bits, fCompressionLevel);
-			pHydrogen->startExportSong( sOutFilename );
+			pHydrogen->startExportSong( sOutFilename, stems );
 			std::cout << "Export Progress ... ";
 			bExportMode = true;
 		}
@@ -564,6 +592,33 @@ int main(int argc, char *argv[])
 			}
 		}
 
+		if ( ! sDrumkitToPrewarm.isEmpty() ) {
+			if ( ! H2Core::CoreActionController::prewarmSampleCache(
+					 sDrumkitToPrewarm ) ) {
+				nReturnCode = 1;
+				std::cout << "Unable to cache samples of drumkit [" <<
+					sDrumkitToPrewarm.toLocal8Bit().data() << "]" << std::endl;
+			}
+			else {
+				nReturnCode = 0;
+				std::cout << "Samples of drumkit [" <<
+					sDrumkitToPrewarm.toLocal8Bit().data() << "] cached" <<
+					std::endl;
+			}
+		}
+
+		if ( bShowSampleMemory ) {
+			nReturnCode = 0;
+			long long nTotalBytes = 0;
+			for ( const auto& info : SampleRegistry::getInfos() ) {
+				std::cout << info.nBytes << " bytes\t" << info.nUsers <<
+					" users\t" << ( info.bMapped ? "mapped\t" : "\t" ) <<
+					info.sPath.toLocal8Bit().data() << std::endl;
+				nTotalBytes += info.nBytes;
+			}
+			std::cout << "Total: " << nTotalBytes << " bytes" << std::endl;
+		}
+
 		if ( ! sKitToDrumkitMap.isEmpty() ) {
 			if ( ! convertKitToDrumkitMap( sKitToDrumkitMap, sOutFilename ) ) {
 				nReturnCode = 1;
@@ -29,9 +29,13 @@
 #    include <sys/time.h>
 #endif
 
+#include <algorithm>
 #include <limits>
 #include <sstream>
 
+#include <core/AudioEngine/ColumnMap.h>
+#include <core/AudioEngine/NotePool.h>
+#include <core/AudioEngine/TempoMap.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/Basics/AutomationPath.h>
 #include <core/Basics/Drumkit.h>
@@ -65,6 +69,7 @@
 #include <core/IO/PortMidiDriver.h>
 #include <core/IO/PulseAudioDriver.h>
 #include <core/Preferences/Preferences.h>
+#include <core/Sampler/ResampleCache.h>
 #include <core/Sampler/Sampler.h>
 
 #define AUDIO_ENGINE_DEBUG 0
@@ -100,6 +105,7 @@ AudioEngine::AudioEngine()
 		, m_pMetronomeInstrument( nullptr )
 		, m_fSongSizeInTicks( 4 * H2Core::nTicksPerQuarter )
 		, m_nRealtimeFrame( 0 )
+		, m_nPreviousCycleTimestamp( 0 )
 		, m_fMasterPeak_L( 0.0f )
 		, m_fMasterPeak_R( 0.0f )
 		, m_nextState( State::Ready )
@@ -111,11 +117,16 @@ AudioEngine::AudioEngine()
 		, m_fLastTickEnd( 0 )
 		, m_bLookaheadApplied( false )
 		, m_nLoopsDone( 0 )
+		, m_nNextTempoMapSlot( 0 )
+		, m_bSkipQueuingTicks( true )
 {
 	m_pTransportPosition = std::make_shared<TransportPosition>( "Transport" );
 	m_pQueuingPosition = std::make_shared<TransportPosition>( "Queuing" );
 	
 	m_pSampler = new Sampler;
+	m_pNotePool = new NotePool;
+	m_pResampleCache = new ResampleCache( this );
+	m_dueNotes.reserve( NoteTimingWheel::nDefaultCapacity );
 
 	srand( time( nullptr ) );
 
@@ -143,6 +154,11 @@ AudioEngine::AudioEngine()
 
 AudioEngine::~AudioEngine()
 {
+	// Has to be done before locking the engine since the worker of
+	// the cache might be waiting for the lock.
+	delete m_pResampleCache;
+	m_pResampleCache = nullptr;
+
 	stopAudioDrivers();
 	if ( getState() != State::Initialized ) {
 		AE_ERRORLOG( "Error the audio engine is not in State::Initialized" );
@@ -167,10 +183,14 @@ AudioEngine::~AudioEngine()
 	this->unlock();
 	
 #ifdef H2CORE_HAVE_LADSPA
-	delete Effects::get_instance();
+	// Instances of an engine context are owned by the context itself.
+	if ( EngineContext::getCurrent() == nullptr ) {
+		delete Effects::get_instance();
+	}
 #endif
 
 	delete m_pSampler;
+	delete m_pNotePool;
 }
 
 Sampler* AudioEngine::getSampler() const
@@ -179,6 +199,12 @@ Sampler* AudioEngine::getSampler() const
 	return m_pSampler;
 }
 
+NotePool* AudioEngine::getNotePool() const
+{
+	assert(m_pNotePool);
+	return m_pNotePool;
+}
+
 void AudioEngine::lock( const char* file, unsigned int line, const char* function )
 {
 #ifdef H2CORE_HAVE_DEBUG
@@ -304,7 +330,7 @@ void AudioEngine::unlock()
 #endif
 }
 
-void AudioEngine::startPlayback()
+void AudioEngine::startPlayback( Event::Trigger trigger )
 {
 	AE_INFOLOG( "" );
 
@@ -313,9 +339,13 @@ void AudioEngine::startPlayback()
 		return;
 	}
 
-	setState( State::Playing );
+	setState( State::Playing, trigger );
 	
-	handleSelectedPattern();
+	if ( trigger == Event::Trigger::Suppress ) {
+		handleSelectedPattern( trigger );
+	} else {
+		handleSelectedPattern();
+	}
 }
 
 void AudioEngine::stopPlayback( Event::Trigger trigger )
@@ -496,7 +526,8 @@ void AudioEngine::resetOffsets() {
 	m_pQueuingPosition->setLastLeadLagFactor( 0 );
 }
 
-void AudioEngine::incrementTransportPosition( uint32_t nFrames ) {
+void AudioEngine::incrementTransportPosition( uint32_t nFrames,
+												Event::Trigger trigger ) {
 	const long long nNewFrame = m_pTransportPosition->getFrame() + nFrames;
 	const double fNewTick = TransportPosition::computeTickFromFrame( nNewFrame );
 	m_pTransportPosition->m_fTickMismatch = 0;
@@ -511,7 +542,7 @@ void AudioEngine::incrementTransportPosition( uint32_t nFrames ) {
 			  .arg( m_pTransportPosition->getTickSize(), 0, 'f' ) );
 #endif
 
-	updateTransportPosition( fNewTick, nNewFrame, m_pTransportPosition );
+	updateTransportPosition( fNewTick, nNewFrame, m_pTransportPosition, trigger );
 
 	// We are not updating the queuing position in here. This will be
 	// done in updateNoteQueue().
@@ -733,9 +764,8 @@ void AudioEngine::updateBpmAndTickSize( std::shared_ptr<TransportPosition> pPos,
 	if ( pHydrogen->getJackTimebaseState() !=
 		 JackAudioDriver::Timebase::Listener &&
 		 ( ( pSong != nullptr && ! pSong->getIsTimelineActivated() ) ||
-				pHydrogen->getMode() != Song::Mode::Song ) &&
-		 fNewBpm != m_fNextBpm ) {
-		fNewBpm = m_fNextBpm;
+				pHydrogen->getMode() != Song::Mode::Song ) ) {
+		fNewBpm = m_fNextBpm.load();
 	}
 
 	if ( fNewBpm != fOldBpm ) {
@@ -952,6 +982,9 @@ AudioOutput* AudioEngine::createAudioDriver( const Preferences::AudioDriver& dri
 		return nullptr;
 	}
 
+	// Locks the engine itself.
+	m_pSampler->setBufferSize( pAudioDriver->getBufferSize() );
+
 	this->lock( RIGHT_HERE );
 	m_MutexOutputPointer.lock();
 
@@ -1153,6 +1186,8 @@ void AudioEngine::handleDriverChange() {
 	}
 	
 	handleTimelineChange();
+
+	updateResampleCache( Hydrogen::get_instance()->getSong()->getDrumkit() );
 }
 
 float AudioEngine::getBpmAtColumn( int nColumn ) {
@@ -1285,6 +1320,7 @@ void AudioEngine::handleSongModeChanged( Event::Trigger trigger ) {
 	}
 
 	m_fSongSizeInTicks = pSong->lengthInTicks();
+	rebuildColumnMap();
 	reset( true, trigger );
 	setNextBpm( pSong->getBpm() );
 }
@@ -1311,15 +1347,16 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 		nFrame = getRealtimeFrame();
 	}
 
-	while ( !m_songNoteQueue.empty() ) {
-		auto pNote = m_songNoteQueue.top();
+	// Retrieve all notes due within this cycle at once.
+	m_dueNotes.clear();
+	m_songNoteQueue.popDue( nFrame + static_cast<long long>(nframes),
+							m_dueNotes );
+
+	for ( const auto& pNote : m_dueNotes ) {
 		if ( pNote == nullptr || pNote->getInstrument() == nullptr ) {
-			m_songNoteQueue.pop();
 			continue;
 		}
 
-		const long long nNoteStartInFrames = pNote->getNoteStart();
-
 #if AUDIO_ENGINE_DEBUG
 		AE_DEBUGLOG( QString( "m_pTransportPosition->getDoubleTick(): %1, m_pTransportPosition->getFrame(): %2, nframes: %3, " )
 				  .arg( m_pTransportPosition->getDoubleTick() )
@@ -1328,99 +1365,67 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 				  .append( pNote->toQString( "", true ) ) );
 #endif
 
-		if ( nNoteStartInFrames < nFrame + static_cast<long long>(nframes) ) {
-
-			float fNoteProbability = pNote->getProbability();
-			if ( fNoteProbability != 1. ) {
-				// Current note is skipped with a certain probability.
-				if ( fNoteProbability < (float) rand() / (float) RAND_MAX ) {
-					m_songNoteQueue.pop();
-					pNote->getInstrument()->dequeue( pNote );
-					continue;
-				}
-			}
-
-			/*
-			 * Check if the current instrument has the property "Stop-Note" set.
-			 * If yes, a NoteOff note is generated automatically after each note.
-			 */
-			auto pNoteInstrument = pNote->getInstrument();
-			if ( pNoteInstrument->isStopNotes() ){
-				auto pOffNote = std::make_shared<Note>( pNoteInstrument );
-				pOffNote->setNoteOff( true );
-				m_pSampler->noteOn( pOffNote );
-			}
-
-			if ( ! pNote->getInstrument()->hasSamples() ) {
-				m_songNoteQueue.pop();
+		float fNoteProbability = pNote->getProbability();
+		if ( fNoteProbability != 1. ) {
+			// Current note is skipped with a certain probability.
+			if ( fNoteProbability < (float) rand() / (float) RAND_MAX ) {
 				pNote->getInstrument()->dequeue( pNote );
 				continue;
 			}
+		}
 
-			if ( pNoteInstrument == m_pMetronomeInstrument ) {
-				EventQueue::get_instance()->pushEvent(
-					Event::Type::Metronome, pNote->getPitch() == 0 ? 1 : 0 );
-			}
+		/*
+		 * Check if the current instrument has the property "Stop-Note" set.
+		 * If yes, a NoteOff note is generated automatically after each note.
+		 */
+		auto pNoteInstrument = pNote->getInstrument();
+		if ( pNoteInstrument->isStopNotes() ){
+			auto pOffNote = m_pNotePool->acquire( pNoteInstrument );
+			pOffNote->setNoteOff( true );
+			m_pSampler->noteOn( pOffNote );
+		}
 
-			m_pSampler->noteOn( pNote );
-			m_songNoteQueue.pop();
+		if ( ! pNote->getInstrument()->hasSamples() ) {
 			pNote->getInstrument()->dequeue( pNote );
-			
-			const int nInstrument = pSong->getDrumkit()->getInstruments()->index( pNote->getInstrument() );
-
-			// Check whether the instrument could be found.
-			if ( nInstrument != -1 ) {
-				EventQueue::get_instance()->pushEvent(
-					Event::Type::NoteOn, nInstrument );
-			}
-			
 			continue;
-		} else {
-			// this note will not be played
-			break;
+		}
+
+		if ( pNoteInstrument == m_pMetronomeInstrument ) {
+			EventQueue::get_instance()->pushEvent(
+				Event::Type::Metronome, pNote->getPitch() == 0 ? 1 : 0 );
+		}
+
+		m_pSampler->noteOn( pNote );
+		pNote->getInstrument()->dequeue( pNote );
+
+		const int nInstrument = pSong->getDrumkit()->getInstruments()->index( pNote->getInstrument() );
+
+		// Check whether the instrument could be found.
+		if ( nInstrument != -1 ) {
+			EventQueue::get_instance()->pushEvent(
+				Event::Type::NoteOn, nInstrument );
 		}
 	}
+
+	// Drop our references right away to allow pooled notes to be recycled.
+	m_dueNotes.clear();
 }
 
 void AudioEngine::clearNoteQueues( std::shared_ptr<Instrument> pInstrument )
 {
 	// notes in the song queue. Attention: their instruments are enqueued.
-	if ( pInstrument == nullptr ) {
-		// delete all copied notes in the note queues
-		while ( !m_songNoteQueue.empty() ) {
-			auto pNote = m_songNoteQueue.top();
-			if ( pNote != nullptr ) {
-				if ( pNote->getInstrument() != nullptr ) {
-					pNote->getInstrument()->dequeue( pNote );
-				}
-			}
-			m_songNoteQueue.pop();
-		}
-	}
-	else {
-		// delete just notes of a particular instrument
-		//
-		// AFAICS we can not erase from m_songNoteQueue since it is a priority
-		// queue. Instead, we construct it anew.
-		std::vector<std::shared_ptr<Note>> notes;
-		for ( ; ! m_songNoteQueue.empty(); m_songNoteQueue.pop() ) {
-			auto ppNote = m_songNoteQueue.top();
-			if ( ppNote == nullptr || ppNote->getInstrument() == nullptr ||
-				 ppNote->getInstrument() == pInstrument ) {
-				if ( ppNote->getInstrument() != nullptr ) {
-					ppNote->getInstrument()->dequeue( ppNote );
-				}
-			}
-			else {
-				// We keep this one
-				notes.push_back( ppNote );
-			}
+	m_songNoteQueue.eraseIf( [&]( std::shared_ptr<Note> ppNote ) {
+		if ( ppNote == nullptr || ppNote->getInstrument() == nullptr ) {
+			return true;
 		}
-		for ( auto& ppNote : notes ) {
-			m_songNoteQueue.push( ppNote );
+		if ( pInstrument == nullptr || ppNote->getInstrument() == pInstrument ) {
+			ppNote->getInstrument()->dequeue( ppNote );
+			return true;
 		}
 
-	}
+		// We keep this one
+		return false;
+	} );
 
 	// Notes of MIDI note queue (no instrument enqueued in here).
 	for ( auto it = m_midiNoteQueue.begin(); it != m_midiNoteQueue.end(); ) {
@@ -1434,6 +1439,14 @@ void AudioEngine::clearNoteQueues( std::shared_ptr<Instrument> pInstrument )
 			++it;
 		}
 	}
+
+	// Pending time stamped notes are at most one period old. Dropping
+	// all of them is fine.
+	m_midiIngressQueue.clear();
+
+	// Pooled notes no longer in use must not keep the instrument (and
+	// its samples) alive.
+	m_pNotePool->releaseIdleNotes( pInstrument );
 }
 
 int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
@@ -1449,10 +1462,15 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		return 0;
 	}
 	timeval startTimeval = currentTime2();
-	const auto sDrivers = pAudioEngine->getDriverNames();
+	const long long nCycleTimestamp = MidiMessage::currentTimestamp();
 
 	pAudioEngine->clearAudioBuffers( nframes );
 
+	// Apply all changes posted by control threads since the last cycle
+	// not requiring the lock. This way they do not pile up in case
+	// locking fails.
+	pAudioEngine->m_commandQueue.processAll( false );
+
 	// Calculate maximum time to wait for audio engine lock. Using the
 	// last calculated processing time as an estimate of the expected
 	// processing time for this frame.
@@ -1475,15 +1493,8 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	 */
 	if ( !pAudioEngine->tryLockFor( std::chrono::microseconds( (int)(1000.0*fSlackTime) ),
 							  RIGHT_HERE ) ) {
-		___ERRORLOG( QString( "[%1] Failed to lock audioEngine in allowed %2 ms, missed buffer" )
-					 .arg( sDrivers ).arg( fSlackTime ) );
-
-		if ( dynamic_cast<DiskWriterDriver*>(pAudioEngine->m_pAudioDriver) != nullptr ) {
-			// Returning the special return value "2" enables the disk 
-			// writer driver - which does not require running in
-			// realtime - to repeat the processing of the current data.
-			return 2;
-		}
+		ERRORLOG_RT( "Failed to lock audioEngine in allowed %1 ms, missed buffer",
+					 fSlackTime );
 
 		return 0;
 	}
@@ -1495,6 +1506,9 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		return 0;
 	}
 
+	// Apply the remaining changes posted by control threads.
+	pAudioEngine->m_commandQueue.processAll( true );
+
 	Hydrogen* pHydrogen = Hydrogen::get_instance();
 
 	// Sync transport with server (in case the current audio driver is
@@ -1503,8 +1517,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	if ( Hydrogen::get_instance()->hasJackTransport() ) {
 		auto pAudioDriver = pHydrogen->getAudioOutput();
 		if ( pAudioDriver == nullptr ) {
-			___ERRORLOG( QString( "[%1] AudioDriver is not ready!" )
-						 .arg( sDrivers ) );
+			ERRORLOG_RT( "AudioDriver is not ready!" );
 			assert( pAudioDriver );
 			return 1;
 		}
@@ -1535,6 +1548,8 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 										 static_cast<long long>(nframes) );
 	}
 
+	pAudioEngine->processMidiIngress( nframes, nCycleTimestamp );
+
 	// always update note queue.. could come from pattern or realtime input
 	// (midi, keyboard)
 	pAudioEngine->updateNoteQueue( nframes );
@@ -1547,7 +1562,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		if ( pAudioEngine->isEndOfSongReached(
 				 pAudioEngine->m_pTransportPosition ) ) {
 
-			___INFOLOG( QString( "[%1] End of song received" ).arg( sDrivers ) );
+			INFOLOG_RT( "End of song received" );
 
 			if ( pHydrogen->getMidiOutput() != nullptr ) {
 				pHydrogen->getMidiOutput()->handleQueueAllNoteOff();
@@ -1564,7 +1579,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 			if ( dynamic_cast<FakeDriver*>(pAudioEngine->m_pAudioDriver) !=
 				 nullptr ) {
-				___INFOLOG( QString( "[%1] End of song." ).arg( sDrivers ) );
+				INFOLOG_RT( "End of song." );
 
 				// TODO This part of the code might not be reached
 				// anymore.
@@ -1585,16 +1600,11 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	
 #ifdef CONFIG_DEBUG
 	if ( pAudioEngine->m_fProcessTime > pAudioEngine->m_fMaxProcessTime ) {
-		___WARNINGLOG( "" );
-		___WARNINGLOG( "----XRUN----" );
-		___WARNINGLOG( QString( "[%1] XRUN of %2 msec (%3 > %4)" )
-					   .arg( sDrivers )
-					   .arg( ( pAudioEngine->m_fProcessTime - pAudioEngine->m_fMaxProcessTime ) )
-					   .arg( pAudioEngine->m_fProcessTime )
-					   .arg( pAudioEngine->m_fMaxProcessTime ) );
-		___WARNINGLOG( QString( "Ladspa process time = %1" ).arg( fLadspaTime ) );
-		___WARNINGLOG( "------------" );
-		___WARNINGLOG( "" );
+		WARNINGLOG_RT( "XRUN of %1 msec (%2 > %3). Ladspa process time = %4",
+					   pAudioEngine->m_fProcessTime - pAudioEngine->m_fMaxProcessTime,
+					   pAudioEngine->m_fProcessTime,
+					   pAudioEngine->m_fMaxProcessTime,
+					   pAudioEngine->m_fLadspaTime );
 		
 		EventQueue::get_instance()->pushEvent( Event::Type::Xrun, -1 );
 	}
@@ -1605,6 +1615,68 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	return 0;
 }
 
+int AudioEngine::renderOffline( uint32_t nFrames )
+{
+	if ( m_pAudioDriver == nullptr || nFrames > MAX_BUFFER_SIZE ) {
+		return 1;
+	}
+
+	clearAudioBuffers( nFrames );
+
+	// The export owns the engine. Other threads are only able to
+	// acquire the lock in between two blocks.
+	lock( RIGHT_HERE );
+
+	if ( ! ( getState() == State::Ready || getState() == State::Playing ) ) {
+		unlock();
+		return 1;
+	}
+
+	m_commandQueue.processAll();
+
+	updateBpmAndTickSize( m_pTransportPosition, Event::Trigger::Suppress );
+	updateBpmAndTickSize( m_pQueuingPosition, Event::Trigger::Suppress );
+
+	if ( m_nextState == State::Playing ) {
+		if ( getState() == State::Ready ) {
+			// Same start-up path as audioEngine_process().
+			startPlayback( Event::Trigger::Suppress );
+		}
+		setRealtimeFrame( m_pTransportPosition->getFrame() );
+	}
+	else {
+		if ( getState() == State::Playing ) {
+			stopPlayback( Event::Trigger::Suppress );
+		}
+		setRealtimeFrame( getRealtimeFrame() + static_cast<long long>(nFrames) );
+	}
+
+	updateNoteQueue( nFrames );
+
+	processAudio( nFrames );
+
+	if ( getState() == State::Playing ) {
+		if ( isEndOfSongReached( m_pTransportPosition ) ) {
+			auto pMidiOutput = Hydrogen::get_instance()->getMidiOutput();
+			if ( pMidiOutput != nullptr ) {
+				pMidiOutput->handleQueueAllNoteOff();
+			}
+
+			// Notes still being rendered are allowed to ring out.
+			stop();
+			stopPlayback( Event::Trigger::Suppress );
+			locate( 0, false, Event::Trigger::Suppress );
+		}
+		else {
+			incrementTransportPosition( nFrames, Event::Trigger::Suppress );
+		}
+	}
+
+	unlock();
+
+	return 0;
+}
+
 void AudioEngine::processAudio( uint32_t nFrames ) {
 
 	auto pSong = Hydrogen::get_instance()->getSong();
@@ -1732,6 +1804,7 @@ void AudioEngine::setSong( std::shared_ptr<Song> pNewSong )
 		fNextBpm = MIN_BPM;
 		m_fSongSizeInTicks = 4 * H2Core::nTicksPerQuarter;
 	}
+	rebuildColumnMap();
 	// Reset (among other things) the transport position. This causes
 	// the locate() call below to update the playing patterns.
 	reset( false, Event::Trigger::Suppress );
@@ -1752,6 +1825,114 @@ void AudioEngine::setSong( std::shared_ptr<Song> pNewSong )
 	}
 
 	updateSongSize( Event::Trigger::Suppress );
+
+	if ( pNewSong != nullptr ) {
+		m_pNotePool->reserveLayerInfos( pNewSong->getDrumkit() );
+	}
+	updateResampleCache( pNewSong != nullptr ? pNewSong->getDrumkit() : nullptr );
+}
+
+void AudioEngine::updateResampleCache( std::shared_ptr<Drumkit> pDrumkit ) {
+	if ( m_pResampleCache == nullptr ) {
+		return;
+	}
+
+	// Exporting is done offline. Its result should neither depend on
+	// the progress of the background conversion nor should the
+	// caches of the realtime driver be discarded.
+	if ( m_pAudioDriver == nullptr ||
+		 dynamic_cast<DiskWriterDriver*>(m_pAudioDriver) != nullptr ) {
+		return;
+	}
+
+	m_pResampleCache->rebuild( pDrumkit,
+							   static_cast<int>(m_pAudioDriver->getSampleRate()) );
+}
+
+std::shared_ptr<const TempoMap> AudioEngine::getTempoMap( int nSampleRate ) {
+	auto pHydrogen = Hydrogen::get_instance();
+	const auto pSong = pHydrogen->getSong();
+	const auto pTimeline = pHydrogen->getTimeline();
+	const int nColumns = pSong != nullptr ?
+		pSong->getPatternGroupVector()->size() : 0;
+	const int nRevision = pTimeline != nullptr ? pTimeline->getRevision() : 0;
+	const double fSongSizeInTicks = m_fSongSizeInTicks;
+
+	int nSlot = -1;
+	for ( int ii = 0; ii < nTempoMapSlots; ++ii ) {
+		const auto pTempoMap = std::atomic_load( &m_tempoMaps[ ii ] );
+		if ( pTempoMap == nullptr ) {
+			nSlot = ii;
+		}
+		else if ( pTempoMap->getSampleRate() == nSampleRate ) {
+			if ( pTempoMap->isValidFor( pSong, pTimeline.get(), nRevision,
+										fSongSizeInTicks, nColumns,
+										nSampleRate ) ) {
+				return pTempoMap;
+			}
+			// Outdated
+			nSlot = ii;
+		}
+	}
+	if ( nSlot == -1 ) {
+		nSlot = m_nNextTempoMapSlot.fetch_add( 1 ) % nTempoMapSlots;
+	}
+
+	auto pTempoMap = std::make_shared<const TempoMap>(
+		pSong, pTimeline, fSongSizeInTicks, nSampleRate );
+	std::atomic_store( &m_tempoMaps[ nSlot ], pTempoMap );
+
+	return pTempoMap;
+}
+
+void AudioEngine::rebuildTempoMaps() {
+	auto pHydrogen = Hydrogen::get_instance();
+	const auto pSong = pHydrogen->getSong();
+	const auto pTimeline = pHydrogen->getTimeline();
+	const double fSongSizeInTicks = m_fSongSizeInTicks;
+	const int nDriverSampleRate = m_pAudioDriver != nullptr ?
+		static_cast<int>(m_pAudioDriver->getSampleRate()) : 0;
+
+	bool bDriverSampleRateCached = false;
+	for ( auto& ppTempoMap : m_tempoMaps ) {
+		const auto pOldTempoMap = std::atomic_load( &ppTempoMap );
+		if ( pOldTempoMap == nullptr ) {
+			continue;
+		}
+		const int nSampleRate = pOldTempoMap->getSampleRate();
+		if ( nSampleRate == nDriverSampleRate ) {
+			bDriverSampleRateCached = true;
+		}
+		std::atomic_store( &ppTempoMap, std::make_shared<const TempoMap>(
+							   pSong, pTimeline, fSongSizeInTicks, nSampleRate ) );
+	}
+
+	if ( nDriverSampleRate > 0 && ! bDriverSampleRateCached ) {
+		getTempoMap( nDriverSampleRate );
+	}
+}
+
+std::shared_ptr<const ColumnMap> AudioEngine::getColumnMap() {
+	const auto pSong = Hydrogen::get_instance()->getSong();
+	const int nColumns = pSong != nullptr ?
+		pSong->getPatternGroupVector()->size() : 0;
+	const double fSongSizeInTicks = m_fSongSizeInTicks;
+
+	auto pColumnMap = std::atomic_load( &m_pColumnMap );
+	if ( pColumnMap == nullptr ||
+		 ! pColumnMap->isValidFor( pSong, fSongSizeInTicks, nColumns ) ) {
+		// Change was not announced.
+		pColumnMap = std::make_shared<const ColumnMap>( pSong, fSongSizeInTicks );
+		std::atomic_store( &m_pColumnMap, pColumnMap );
+	}
+
+	return pColumnMap;
+}
+
+void AudioEngine::rebuildColumnMap() {
+	std::atomic_store( &m_pColumnMap, std::make_shared<const ColumnMap>(
+						   Hydrogen::get_instance()->getSong(),
+						   m_fSongSizeInTicks ) );
 }
 
 void AudioEngine::prepare( Event::Trigger trigger ) {
@@ -1774,12 +1955,18 @@ void AudioEngine::prepare( Event::Trigger trigger ) {
 }
 
 void AudioEngine::updateSongSize( Event::Trigger trigger ) {
+
+	// Layout of the columns changed while the song size is still the
+	// old one.
+	rebuildColumnMap();
 	
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
 
 	if ( pSong == nullptr ) {
 		AE_ERRORLOG( "No song set yet" );
+		rebuildColumnMap();
+		rebuildTempoMaps();
 		return;
 	}
 
@@ -1799,6 +1986,8 @@ void AudioEngine::updateSongSize( Event::Trigger trigger ) {
 					.arg( m_fSongSizeInTicks )
 					.arg( static_cast<double>( pSong->lengthInTicks() ) ) );
 		m_fSongSizeInTicks = static_cast<double>( pSong->lengthInTicks() );
+		rebuildColumnMap();
+		rebuildTempoMaps();
 
 		if ( trigger != Event::Trigger::Suppress ) {
 			EventQueue::get_instance()->pushEvent( Event::Type::SongSizeChanged, 0 );
@@ -1854,6 +2043,9 @@ void AudioEngine::updateSongSize( Event::Trigger trigger ) {
 				.arg( m_fSongSizeInTicks ).arg( fNewSongSizeInTicks ) );
 
 	m_fSongSizeInTicks = fNewSongSizeInTicks;
+	// Rebuilt right away so the audio thread does not have to.
+	rebuildColumnMap();
+	rebuildTempoMaps();
 
 	auto endOfSongReached = [&](){
 		if ( getState() == State::Playing ) {
@@ -2188,12 +2380,16 @@ void AudioEngine::toggleNextPattern( int nPatternNumber ) {
 	if ( pSong == nullptr ) {
 		return;
 	}
-	auto pPatternList = pSong->getPatternList();
-	auto pPattern = pPatternList->get( nPatternNumber );
-	if ( pPattern == nullptr ) {
+	toggleNextPattern( pSong->getPatternList()->get( nPatternNumber ) );
+}
+
+void AudioEngine::toggleNextPattern( std::shared_ptr<Pattern> pPattern ) {
+	auto pSong = Hydrogen::get_instance()->getSong();
+	if ( pSong == nullptr || pPattern == nullptr ||
+		 pSong->getPatternList()->index( pPattern ) == -1 ) {
 		return;
 	}
-	
+
 	if ( m_pTransportPosition->getNextPatterns()->del( pPattern ) == nullptr ) {
 		m_pTransportPosition->getNextPatterns()->add( pPattern );
 	}
@@ -2213,14 +2409,27 @@ void AudioEngine::flushAndAddNextPattern( int nPatternNumber ) {
 	if ( pSong == nullptr ) {
 		return;
 	}
-	auto pPatternList = pSong->getPatternList();
 
-	bool bAlreadyPlaying = false;
-	
 	// Note: we will not perform a bound check on the provided pattern
 	// number. This way the user can use the SELECT_ONLY_NEXT_PATTERN
 	// MIDI or OSC command to flush all playing patterns.
-	auto pRequestedPattern = pPatternList->get( nPatternNumber );
+	flushAndAddNextPattern( pSong->getPatternList()->get( nPatternNumber ) );
+}
+
+void AudioEngine::flushAndAddNextPattern( std::shared_ptr<Pattern> pPattern ) {
+	auto pSong = Hydrogen::get_instance()->getSong();
+	if ( pSong == nullptr ) {
+		return;
+	}
+
+	bool bAlreadyPlaying = false;
+
+	// Patterns removed from the song in the meantime are not queued.
+	auto pRequestedPattern = pPattern;
+	if ( pRequestedPattern != nullptr &&
+		 pSong->getPatternList()->index( pRequestedPattern ) == -1 ) {
+		pRequestedPattern = nullptr;
+	}
 
 	auto flushAndAddNext = [&]( std::shared_ptr<TransportPosition> pPos ) {
 
@@ -2267,12 +2476,16 @@ void AudioEngine::updateVirtualPatterns() {
 	m_pTransportPosition->getPlayingPatterns()->clear();
 	m_pQueuingPosition->getPlayingPatterns()->clear();
 
+	// Virtual patterns contribute to the length of a column.
+	rebuildColumnMap();
 	updatePlayingPatterns( Event::Trigger::Default );
 	updateSongSize();
 }
 
 void AudioEngine::handleTimelineChange() {
 
+	rebuildTempoMaps();
+
 #if AUDIO_ENGINE_DEBUG
 	AE_DEBUGLOG( QString( "before:\n%1\n%2" )
 			 .arg( m_pTransportPosition->toQString() )
@@ -2578,9 +2791,16 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 				.arg( m_pQueuingPosition->toQString() ) );
 #endif
 
+	// In song mode ticks not holding any event are skipped.
+	const auto pColumnMap = pHydrogen->getMode() == Song::Mode::Song &&
+		m_bSkipQueuingTicks ? getColumnMap() : nullptr;
+
 	// We loop over integer ticks to ensure that all notes encountered
 	// between two iterations belong to the same pattern.
-	for ( long nnTick = nTickStart; nnTick < nTickEnd; ++nnTick ) {
+	for ( long nnTick = nTickStart; nnTick < nTickEnd;
+		  nnTick = pColumnMap != nullptr ?
+			  computeNextQueuingTick( nnTick, nTickEnd, pColumnMap.get() ) :
+			  nnTick + 1 ) {
 
 		//////////////////////////////////////////////////////////////
 		// Update queuing position and playing patterns.
@@ -2637,7 +2857,7 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 			// Only trigger the sounds if the user enabled the
 			// metronome. 
 			if ( Preferences::get_instance()->m_bUseMetronome ) {
-				auto pMetronomeNote = std::make_shared<Note>(
+				auto pMetronomeNote = m_pNotePool->acquire(
 					m_pMetronomeInstrument,
 					nnTick,
 					fVelocity,
@@ -2664,8 +2884,8 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 		// Update the notes queue.
 		//
 		// Supporting ticks with float precision:
-		// - make FOREACH_NOTE_CST_IT_BOUND loop over all notes
-		// `(_it)->first >= (_bound) && (_it)->first < (_bound + 1)`
+		// - make the loop over the note snapshot cover all notes
+		// `position >= nPatternTickPosition && position < nPatternTickPosition + 1`
 		// - add remainder of pNote->getPosition() % 1 when setting
 		// nnTick as new position.
 		//
@@ -2674,18 +2894,23 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 			for ( auto nPat = 0; nPat < pPlayingPatterns->size(); ++nPat ) {
 				auto pPattern = pPlayingPatterns->get( nPat );
 				assert( pPattern != nullptr );
-				Pattern::notes_t* notes = (Pattern::notes_t*)pPattern->getNotes();
+				// The snapshot is never modified. Editing the pattern
+				// publishes a new one instead.
+				const auto pNotes = pPattern->getNoteSnapshot();
+				const int nPatternTickPosition = static_cast<int>(
+					m_pQueuingPosition->getPatternTickPosition());
 
 				// Loop over all notes at tick nPatternTickPosition
 				// (associated tick is determined by Note::__position
 				// at the time of insertion into the Pattern).
-				FOREACH_NOTE_CST_IT_BOUND_LENGTH(notes, it,
-												 m_pQueuingPosition->getPatternTickPosition(),
-												 pPattern ) {
-					auto pNote = it->second;
+				for ( int nn = pNotes->lowerBound( nPatternTickPosition );
+					  nn < pNotes->size() &&
+						  pNotes->getPosition( nn ) == nPatternTickPosition &&
+						  nPatternTickPosition < pPattern->getLength(); ++nn ) {
+					const auto& pNote = pNotes->getNote( nn );
 					if ( pNote != nullptr &&
 						 pNote->getInstrument() != nullptr ) {
-						auto pCopiedNote = std::make_shared<Note>( pNote );
+						auto pCopiedNote = m_pNotePool->acquire( pNote );
 
 						// Lead or Lag.
 						// This property is set within the
@@ -2723,7 +2948,8 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 							const float fPos = static_cast<float>( m_pQueuingPosition->getColumn() ) +
 								pCopiedNote->getPosition() % 192 / 192.f;
 							pCopiedNote->setVelocity( pCopiedNote->getVelocity() *
-													   pAutomationPath->get_value( fPos ) );
+													   pAutomationPath->get_value(
+														   fPos, m_velocityAutomationCursor ) );
 						}
 
 						// Ensure the custom length of the note does not exceed
@@ -2753,6 +2979,64 @@ void AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 	return;
 }
 
+long AudioEngine::computeNextQueuingTick( long nTick, long nTickEnd,
+										 const ColumnMap* pColumnMap ) const {
+	const int nColumn = m_pQueuingPosition->getColumn();
+	if ( nTick + 1 >= nTickEnd - 1 || nColumn < 0 ||
+		 nColumn >= pColumnMap->getNumberOfColumns() ) {
+		return nTick + 1;
+	}
+
+	// All positions in here are relative to the start of the current
+	// column. Its end is the upper bound as the playing patterns
+	// change in the next one.
+	const long nPatternTickPosition =
+		m_pQueuingPosition->getPatternTickPosition();
+	long nNextPosition = pColumnMap->getColumnLength( nColumn );
+
+	if ( Preferences::get_instance()->m_bUseMetronome ) {
+		nNextPosition = std::min(
+			nNextPosition, ( nPatternTickPosition / H2Core::nTicksPerQuarter + 1 ) *
+			H2Core::nTicksPerQuarter );
+	}
+
+	for ( const auto& ppPattern : *m_pQueuingPosition->getPlayingPatterns() ) {
+		const auto pNotes = ppPattern->getNoteSnapshot();
+		const int nNext = pNotes->lowerBound(
+			static_cast<int>(nPatternTickPosition) + 1 );
+		if ( nNext < pNotes->size() &&
+			 pNotes->getPosition( nNext ) < ppPattern->getLength() ) {
+			nNextPosition = std::min(
+				nNextPosition, static_cast<long>(pNotes->getPosition( nNext )) );
+		}
+	}
+
+	return std::max( nTick + 1,
+					 std::min( nTick + nNextPosition - nPatternTickPosition,
+							   nTickEnd - 1 ) );
+}
+
+void AudioEngine::pushCommand( CommandQueue::Command command,
+								bool bNeedsLock ) {
+	const auto state = getState();
+	if ( m_pAudioDriver != nullptr &&
+		 ( state == State::Ready || state == State::Playing ) ) {
+		if ( m_commandQueue.push( command, bNeedsLock ) ) {
+			return;
+		}
+		AE_WARNINGLOG( "Command queue is full. Executing command directly." );
+	}
+
+	lock( RIGHT_HERE );
+	// Ensure commands are still applied in order. The audio thread might
+	// be busy processing the ones not requiring the lock.
+	while ( m_commandQueue.processAll( true ) < 0 ) {
+		std::this_thread::yield();
+	}
+	command();
+	unlock();
+}
+
 void AudioEngine::noteOn( std::shared_ptr<Note> pNote )
 {
 	if ( ! ( getState() == State::Playing ||
@@ -2766,9 +3050,115 @@ void AudioEngine::noteOn( std::shared_ptr<Note> pNote )
 	m_midiNoteQueue.push_back( pNote );
 }
 
-bool AudioEngine::compare_pNotes::operator()( std::shared_ptr<Note> pNote1,
-											  std::shared_ptr<Note> pNote2 ) {
-	return Note::compareStart( pNote1, pNote2 );
+bool AudioEngine::pushMidiIngress( const MidiIngressQueue::Entry& entry ) {
+	const auto state = getState();
+	if ( m_pAudioDriver == nullptr ||
+		 ! ( state == State::Ready || state == State::Playing ) ) {
+		return false;
+	}
+
+	if ( ! m_midiIngressQueue.push( entry ) ) {
+		WARNINGLOG_RT( "MIDI ingress queue is full" );
+		return false;
+	}
+
+	return true;
+}
+
+void AudioEngine::processMidiIngress( uint32_t nFrames, long long nCycleTimestamp ) {
+	if ( m_midiIngressQueue.size() == 0 || m_pAudioDriver == nullptr ) {
+		m_nPreviousCycleTimestamp = nCycleTimestamp;
+		return;
+	}
+
+	// Same reference frame used in processPlayNotes().
+	long long nFrame;
+	if ( getState() == State::Playing || getState() == State::Testing ) {
+		nFrame = m_pTransportPosition->getFrame();
+	} else {
+		nFrame = getRealtimeFrame();
+	}
+
+	const double fFramesPerMicrosecond =
+		static_cast<double>(m_pAudioDriver->getSampleRate()) / 1000000.0;
+
+	auto pHydrogen = Hydrogen::get_instance();
+	std::shared_ptr<InstrumentList> pInstrumentList = nullptr;
+	if ( pHydrogen->getSong() != nullptr &&
+		 pHydrogen->getSong()->getDrumkit() != nullptr ) {
+		pInstrumentList = pHydrogen->getSong()->getDrumkit()->getInstruments();
+	}
+
+	MidiIngressQueue::Entry entry;
+	const MidiIngressQueue::Entry* pFront;
+	while ( ( pFront = m_midiIngressQueue.front() ) != nullptr ) {
+		if ( pFront->nTimestamp >= nCycleTimestamp ) {
+			// Received after the current cycle started. Will be handled
+			// within the next one.
+			break;
+		}
+		m_midiIngressQueue.pop( &entry );
+
+		// Resolved here instead of in the MIDI thread since it does not
+		// hold the lock.
+		const int nInstrument = entry.bPlaySelectedInstrument ?
+			pHydrogen->getSelectedInstrumentNumber() : entry.nInstrument;
+		if ( pInstrumentList == nullptr ||
+			 ! pInstrumentList->isValidIndex( nInstrument ) ) {
+			continue;
+		}
+		auto pInstrument = pInstrumentList->get( nInstrument );
+		if ( pInstrument == nullptr || ! pInstrument->hasSamples() ) {
+			continue;
+		}
+
+		long long nOffset = 0;
+		if ( entry.nFrameOffset >= 0 ) {
+			// Drivers in sync with the audio engine know the exact
+			// frame. Their period might still differ from ours.
+			nOffset = std::min( static_cast<long long>(entry.nFrameOffset),
+								static_cast<long long>(nFrames) - 1 );
+		}
+		else if ( m_nPreviousCycleTimestamp != 0 ) {
+			nOffset = static_cast<long long>( std::round(
+				static_cast<double>(entry.nTimestamp - m_nPreviousCycleTimestamp) *
+				fFramesPerMicrosecond ) );
+			nOffset = std::clamp( nOffset, static_cast<long long>(0),
+								  static_cast<long long>(nFrames) - 1 );
+		}
+
+		std::shared_ptr<Note> pNote;
+		if ( entry.bNoteOff ) {
+			if ( ! m_pSampler->isInstrumentPlaying( pInstrument ) ) {
+				continue;
+			}
+			if ( entry.bPlaySelectedInstrument ) {
+				m_pSampler->midiKeyboardNoteOff( entry.nNote );
+				continue;
+			}
+			pNote = m_pNotePool->acquire( pInstrument );
+			pNote->setNoteOff( true );
+		}
+		else {
+			pNote = m_pNotePool->acquire(
+				pInstrument, 0, entry.fVelocity, entry.fPan );
+			if ( entry.bPlaySelectedInstrument ) {
+				const int nDivider = entry.nNote / 12;
+				pNote->setMidiInfo(
+					static_cast<Note::Key>(entry.nNote - 12 * nDivider),
+					static_cast<Note::Octave>(nDivider - 3), entry.nNote );
+			}
+		}
+
+		pInstrument->enqueue( pNote );
+		pNote->humanize();
+		// Realtime notes are never delayed by humanization (same as for
+		// notes passed via noteOn()).
+		pNote->setNoteStart( nFrame + nOffset );
+		m_songNoteQueue.push( pNote );
+	}
+
+	m_nPreviousCycleTimestamp = nCycleTimestamp;
 }
 
 void AudioEngine::play() {
@@ -2941,7 +3331,7 @@ QString AudioEngine::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_pMetronomeInstrument == nullptr ? "nullptr" :
 						   m_pMetronomeInstrument->toQString( sPrefix + s, bShort ) ) )
 			.append( QString( "%1%2m_fNextBpm: %3\n" ).arg( sPrefix ).arg( s )
-					 .arg( m_fNextBpm, 0, 'f' ) )
+					 .arg( m_fNextBpm.load(), 0, 'f' ) )
 			.append( QString( "%1%2m_fLastTickEnd: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_fLastTickEnd, 0, 'f' ) )
 			.append( QString( "%1%2m_bLookaheadApplied: %3\n" ).arg( sPrefix ).arg( s )
@@ -3042,7 +3432,7 @@ QString AudioEngine::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_pMetronomeInstrument == nullptr ? "nullptr" :
 						   m_pMetronomeInstrument->toQString( sPrefix + s, bShort ) ) )
 			.append( QString( ", m_fNextBpm: %1" )
-					 .arg( m_fNextBpm, 0, 'f' ) )
+					 .arg( m_fNextBpm.load(), 0, 'f' ) )
 			.append( QString( ", m_fLastTickEnd: %1" )
 					 .arg( m_fLastTickEnd, 0, 'f' ) )
 			.append( QString( ", m_bLookaheadApplied: %1" )
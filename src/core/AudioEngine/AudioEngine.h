@@ -24,6 +24,10 @@
 #define AUDIO_ENGINE_H
 
 #include <core/AudioEngine/AudioEngineTests.h>
+#include <core/AudioEngine/CommandQueue.h>
+#include <core/AudioEngine/MidiIngressQueue.h>
+#include <core/AudioEngine/NoteTimingWheel.h>
+#include <core/Basics/AutomationPath.h>
 #include <core/Basics/Event.h>
 #include <core/config.h>
 #include <core/CoreActionController.h>
@@ -37,6 +41,7 @@
 #include <core/Sampler/Sampler.h>
 
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <cassert>
@@ -44,7 +49,6 @@
 #include <thread>
 #include <chrono>
 #include <deque>
-#include <queue>
 #include <QString>
 
 /** \def RIGHT_HERE
@@ -68,8 +72,12 @@ namespace H2Core
 	class MidiInput;
 	class MidiOutput;
 	class Note;
+	class NotePool;
 	class PatternList;
+	class ResampleCache;
 	class Song;
+	class ColumnMap;
+	class TempoMap;
 	class TransportPosition;
 	
 /**
@@ -251,7 +259,44 @@ public:
 	 */
 	void			assertLocked( const QString& sClass, const char* sFunction,
 								  const QString& sMsg );
+
+	/**
+	 * Hands @a command over to the audio thread which will execute it
+	 * at the beginning of its next process cycle. The calling thread
+	 * does not block.
+	 *
+	 * Commands with @a bNeedsLock set to `false` are applied before
+	 * the audio thread tries to acquire the engine lock and, thus,
+	 * even in cycles it fails to do so. They must only alter state
+	 * safe to be accessed without the lock. All others are applied
+	 * once the lock was obtained.
+	 *
+	 * In case the audio thread is not processing (e.g. no driver is
+	 * running or transport is being set up) or the queue is full, the
+	 * engine is locked and the command executed right away instead.
+	 * Therefore, this function must not be called while holding the
+	 * lock.
+	 *
+	 * Commands are not executed immediately. They are only suitable for
+	 * mutations whose caller does not rely on their effect right after
+	 * posting them.
+	 */
+	void			pushCommand( CommandQueue::Command command,
+								 bool bNeedsLock = true );
 	void			noteOn( std::shared_ptr<Note> pNote );
+	/**
+	 * Hands a time stamped note over to the audio thread without
+	 * locking the audio engine. It will be started at the frame within
+	 * the upcoming buffer corresponding to its time stamp (see
+	 * processMidiIngress()).
+	 *
+	 * Must only be called by the thread of the active MIDI input
+	 * driver.
+	 *
+	 * @return `false` in case the audio thread is not processing or the
+	 *   queue is full. The caller has to fall back to noteOn() instead.
+	 */
+	bool			pushMidiIngress( const MidiIngressQueue::Entry& entry );
 
 	/**
 	 * Main audio processing function called by the audio drivers whenever
@@ -260,11 +305,25 @@ public:
 	 * \param nframes Buffersize.
 	 * \param arg Unused.
 	 * \return
-	 * - __2__ : Failed to acquire the audio engine lock, no processing took place.
 	 * - __1__ : kill the audio driver thread.
 	 * - __0__ : else
 	 */
 	static int                      audioEngine_process( uint32_t nframes, void *arg );
+	/**
+	 * Offline counterpart of audioEngine_process() used by the
+	 * #DiskWriterDriver during export.
+	 *
+	 * As there is no deadline to meet, the engine lock is acquired
+	 * without a timeout and neither processing time nor XRUNs are
+	 * tracked. MIDI input is ignored and no events are pushed to the
+	 * GUI, which only follows the export via Event::Type::Progress.
+	 * @a nFrames may be as large as MAX_BUFFER_SIZE.
+	 *
+	 * \return
+	 * - __1__ : the engine is not ready to render.
+	 * - __0__ : else
+	 */
+	int				renderOffline( uint32_t nFrames );
 
 	/**
 	 * Calculates the number of frames that make up a tick.
@@ -273,6 +332,10 @@ public:
 	static double computeDoubleTickSize(const int nSampleRate, const float fBpm );
 
 	Sampler*		getSampler() const;
+	/** Pre-allocated notes used to avoid heap allocations while
+	 * scheduling notes. Must only be accessed while holding the lock
+	 * of the audio engine. */
+	NotePool*		getNotePool() const;
 
 	/** \return Time passed since the beginning of the song*/
 	float			getElapsedTime() const;	
@@ -305,6 +368,44 @@ public:
 	void			restartAudioDrivers();
 					
 	void			setupLadspaFX();
+
+	/**
+	 * Triggers the background conversion of all samples in
+	 * @a pDrumkit to the sample rate of the current audio driver (see
+	 * #ResampleCache).
+	 *
+	 * Does not block and can be called while holding the lock.
+	 */
+	void			updateResampleCache( std::shared_ptr<Drumkit> pDrumkit );
+
+	/**
+	 * Provides the conversion between ticks and frames of the current
+	 * #Song with active #Timeline at @a nSampleRate.
+	 *
+	 * Maps are built on demand and cached for a couple of sample rates
+	 * since the #Sampler converts positions using the rates of the
+	 * individual samples. Whenever the #Timeline or the song size
+	 * changes, all cached maps are rebuilt right away in
+	 * handleTimelineChange() and updateSongSize() by the thread
+	 * altering them. The audio thread only builds a map itself for a
+	 * sample rate not encountered before or in case a change was not
+	 * announced and TempoMap::isValidFor() does not hold anymore.
+	 *
+	 * Can be called without holding the lock.
+	 */
+	std::shared_ptr<const TempoMap> getTempoMap( int nSampleRate );
+	/**
+	 * Provides the column layout of the current #Song.
+	 *
+	 * Just like the tempo maps, the map is rebuilt right away by the
+	 * thread altering the song, e.g. in updateSongSize() and
+	 * updateVirtualPatterns(). The audio thread only builds one itself
+	 * in case a change was not announced and ColumnMap::isValidFor()
+	 * does not hold anymore.
+	 *
+	 * Can be called without holding the lock.
+	 */
+	std::shared_ptr<const ColumnMap> getColumnMap();
 	
 	MidiInput*		getMidiDriver() const;
 	MidiOutput*		getMidiOutDriver() const;
@@ -412,6 +513,9 @@ public:
 	 * in case it is already present.
 	 */
 	void toggleNextPattern( int nPatternNumber );
+	/** Same as toggleNextPattern( int ) but operates on @a pPattern
+	 * directly. Patterns not part of the current song are ignored. */
+	void toggleNextPattern( std::shared_ptr<Pattern> pPattern );
 	/**
 	 * Add pattern @a nPatternNumber to #m_pNextPatterns as well as
 	 * the whole content of #m_pPlayingPatterns. After the next call
@@ -419,6 +523,10 @@ public:
 	 * playing.
 	 */
 	void flushAndAddNextPattern( int nPatternNumber );
+	/** Same as flushAndAddNextPattern( int ) but operates on @a
+	 * pPattern directly. Passing nullptr or a pattern not part of
+	 * the current song just flushes the next patterns. */
+	void flushAndAddNextPattern( std::shared_ptr<Pattern> pPattern );
 
 	void updateVirtualPatterns();
 
@@ -516,7 +624,39 @@ private:
 	 * MIDI queue #m_midiNoteQueue, and those triggered by the
 	 * metronome and pushes them onto #m_songNoteQueue for playback.
 	 */
+	/**
+	 * Moves all notes received via pushMidiIngress() prior to
+	 * @a nCycleTimestamp into #m_songNoteQueue.
+	 *
+	 * Notes received during the previous cycle, between
+	 * #m_nPreviousCycleTimestamp and @a nCycleTimestamp, are mapped
+	 * onto the frames of the current buffer. This adds a constant
+	 * latency of one period but no jitter. Entries carrying a frame
+	 * offset, e.g. those of the JACK MIDI driver, are placed at this
+	 * offset instead.
+	 *
+	 * The instruments of the entries are resolved against the current
+	 * drumkit here. Entries of invalid instruments or ones without
+	 * samples are dropped.
+	 *
+	 * \param nFrames Size of the current buffer.
+	 * \param nCycleTimestamp Beginning of the current process cycle as
+	 *   returned by MidiMessage::currentTimestamp().
+	 */
+	void			processMidiIngress( uint32_t nFrames, long long nCycleTimestamp );
 	void			updateNoteQueue( unsigned nIntervalLengthInFrames );
+	/**
+	 * Determines the next tick updateNoteQueue() has to visit in
+	 * Song::Mode::Song after #m_pQueuingPosition was moved to @a nTick.
+	 *
+	 * Ticks in between neither start a new column nor hold a note of
+	 * one of the playing patterns or a metronome beat. Skipping them
+	 * leaves the queue untouched. The last tick of the interval, @a
+	 * nTickEnd - 1, is always visited so the queuing position ends up
+	 * in the same state as when visiting all ticks.
+	 */
+	long			computeNextQueuingTick( long nTick, long nTickEnd,
+											const ColumnMap* pColumnMap ) const;
 	void 			processAudio( uint32_t nFrames );
 	long long 		computeTickInterval( double* fTickStart, double* fTickEnd, unsigned nIntervalLengthInFrames );
 	void			updateBpmAndTickSize( std::shared_ptr<TransportPosition> pTransportPosition,
@@ -532,7 +672,13 @@ private:
 							  Event::Trigger trigger = Event::Trigger::Default );
 	void 			setNextState( const State& state );
 
-	void				startPlayback();
+	/**
+	 * Starts transport and selects the pattern it is located in.
+	 *
+	 * \param trigger #Event::Trigger::Suppress silences both the state
+	 *   change and the pattern selection, e.g. during export.
+	 */
+	void				startPlayback( Event::Trigger trigger = Event::Trigger::Default );
 	
 	void			stopPlayback( Event::Trigger trigger = Event::Trigger::Default );
 	
@@ -547,7 +693,8 @@ private:
 	 * computeTickFromFrame() will wrap it.
 	 */
 	void			locateToFrame( const long long nFrame );
-	void			incrementTransportPosition( uint32_t nFrames );
+	void			incrementTransportPosition( uint32_t nFrames,
+												Event::Trigger trigger = Event::Trigger::Default );
 	void			updateTransportPosition( double fTick, long long nFrame,
 											 std::shared_ptr<TransportPosition> pPos,
 											 Event::Trigger trigger = Event::Trigger::Default );
@@ -605,6 +752,27 @@ private:
 	QString getDriverNames() const;
 
 	Sampler* 			m_pSampler;
+	NotePool* 			m_pNotePool;
+	ResampleCache*		m_pResampleCache;
+
+	static constexpr int nTempoMapSlots = 4;
+	/** Accessed via std::atomic_load() and std::atomic_store() only
+	 * since ticks and frames are converted by the GUI as well. */
+	std::shared_ptr<const TempoMap> m_tempoMaps[ nTempoMapSlots ];
+	std::atomic<unsigned> m_nNextTempoMapSlot;
+	/** Replaces all cached tempo maps by ones matching the current
+	 * #Song and #Timeline and ensures there is one for the sample rate
+	 * of the audio driver. */
+	void rebuildTempoMaps();
+	/** Accessed via std::atomic_load() and std::atomic_store() only. */
+	std::shared_ptr<const ColumnMap> m_pColumnMap;
+	/** Replaces the cached column map by one matching the current
+	 * #Song and #m_fSongSizeInTicks. */
+	void rebuildColumnMap();
+	/** Whether updateNoteQueue() skips ticks without any event in
+	 * Song::Mode::Song (see computeNextQueuingTick()). Only disabled by
+	 * the #AudioEngineTests to compare against visiting every tick. */
+	bool m_bSkipQueuingTicks;
 	AudioOutput *		m_pAudioDriver;
 	MidiInput *			m_pMidiDriver;
 	MidiOutput *		m_pMidiDriverOut;
@@ -689,23 +857,33 @@ private:
 	
 	audioProcessCallback m_AudioProcessCallback;
 	
-	/// Song Note FIFO
-	// overload the > operator of Note objects for priority_queue
-	struct compare_pNotes {
-		bool operator() ( std::shared_ptr<Note> pNote1,
-						  std::shared_ptr<Note> pNote2 );
-	};
-
-	std::priority_queue<std::shared_ptr<Note>,
-		std::deque<std::shared_ptr<Note>>, compare_pNotes > m_songNoteQueue;
+	/** Mutations posted by control threads via pushCommand(). */
+	CommandQueue		m_commandQueue;
+
+	/// Song Note FIFO ordered by note start (see Note::compareStart()).
+	NoteTimingWheel		m_songNoteQueue;
+	/** Notes due in the current process cycle. Reused in order to avoid
+	 * allocations in processPlayNotes(). */
+	std::vector<std::shared_ptr<Note>>	m_dueNotes;
 	std::deque<std::shared_ptr<Note>>	m_midiNoteQueue;	///< Midi Note FIFO
+	/** Time stamped notes handed over by the MIDI input driver. */
+	MidiIngressQueue	m_midiIngressQueue;
+	/** Beginning of the previous process cycle (see
+	 * processMidiIngress()). */
+	long long			m_nPreviousCycleTimestamp;
 	
 	/**
 	 * Pointer to the metronome.
 	 */
 	std::shared_ptr<Instrument>		m_pMetronomeInstrument;
 
-	float 			m_fNextBpm;
+	/** Used by updateNoteQueue() to evaluate the velocity automation
+	 * path of the current song at the position of each note. */
+	AutomationPath::Cursor	m_velocityAutomationCursor;
+
+	/** Set by control threads without holding the lock (see
+	 * CoreActionController::setBpm()). */
+	std::atomic<float>	m_fNextBpm;
 	double m_fLastTickEnd;
 	bool m_bLookaheadApplied;
 
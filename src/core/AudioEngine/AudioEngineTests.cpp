@@ -19,6 +19,7 @@
  * along with this program. If not, see https://www.gnu.org/licenses
  *
  */
+#include <algorithm>
 #include <random>
 #include <stdexcept>
 
@@ -37,6 +38,7 @@
 #include <core/Basics/Song.h>
 #include <core/Sampler/Sampler.h>
 #include <core/Hydrogen.h>
+#include <core/IO/MidiCommon.h>
 #include <core/CoreActionController.h>
 #include <core/Preferences/Preferences.h>
 #include <core/config.h>
@@ -1103,6 +1105,116 @@ void AudioEngineTests::testNoteEnqueuing() {
 	pAE->unlock();
 }
 
+void AudioEngineTests::testQueuingTickSkipping() {
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = pHydrogen->getSong();
+	auto pPref = Preferences::get_instance();
+	auto pAE = pHydrogen->getAudioEngine();
+	auto pQueuingPos = pAE->m_pQueuingPosition;
+
+	CoreActionController::activateTimeline( false );
+	CoreActionController::activateLoopMode( false );
+	CoreActionController::activateSongMode( true );
+
+	// Humanization would render both queues incomparable. Metronome
+	// beats are one of the events the skipping has to stop at.
+	const float fHumanizeTime = pSong->getHumanizeTimeValue();
+	const float fHumanizeVelocity = pSong->getHumanizeVelocityValue();
+	const bool bUseMetronome = pPref->m_bUseMetronome;
+	pSong->setHumanizeTimeValue( 0 );
+	pSong->setHumanizeVelocityValue( 0 );
+	pPref->m_bUseMetronome = true;
+
+	pAE->lock( RIGHT_HERE );
+	pAE->setState( AudioEngine::State::Testing );
+
+	struct QueuedNote {
+		QString sInstrument;
+		int nPosition;
+		long long nNoteStart;
+		int nHumanizeDelay;
+		float fVelocity;
+	};
+
+	const int nMaxCycles = 100000;
+	auto queueSong = [&]( bool bSkipTicks ) {
+		pAE->m_bSkipQueuingTicks = bSkipTicks;
+		pAE->reset( false );
+
+		// Same irregular buffer sizes in both runs.
+		std::default_random_engine randomEngine( 1234 );
+		std::uniform_int_distribution<int> frameDist(
+			pPref->m_nBufferSize / 2, pPref->m_nBufferSize );
+
+		std::vector<QueuedNote> queuedNotes;
+		std::vector<double> queuingTicks;
+		int nn = 0;
+		while ( pQueuingPos->getDoubleTick() < pAE->m_fSongSizeInTicks ) {
+			const uint32_t nFrames = frameDist( randomEngine );
+			pAE->updateNoteQueue( nFrames );
+
+			for ( const auto& ppNote : AudioEngineTests::copySongNoteQueue() ) {
+				queuedNotes.push_back(
+					{ ppNote->getInstrument() != nullptr ?
+					  ppNote->getInstrument()->getName() : "nullptr",
+					  ppNote->getPosition(), ppNote->getNoteStart(),
+					  ppNote->getHumanizeDelay(), ppNote->getVelocity() } );
+			}
+			pAE->clearNoteQueues();
+			queuingTicks.push_back( pQueuingPos->getDoubleTick() );
+
+			pAE->incrementTransportPosition( nFrames );
+
+			if ( ++nn > nMaxCycles ) {
+				AudioEngineTests::throwException(
+					"[testQueuingTickSkipping] end of the song wasn't reached in time" );
+			}
+		}
+
+		return std::make_pair( queuedNotes, queuingTicks );
+	};
+
+	const auto skipped = queueSong( true );
+	const auto visited = queueSong( false );
+	pAE->m_bSkipQueuingTicks = true;
+
+	if ( skipped.first.size() == 0 ) {
+		AudioEngineTests::throwException(
+			"[testQueuingTickSkipping] no notes were enqueued" );
+	}
+	if ( skipped.first.size() != visited.first.size() ||
+		 skipped.second != visited.second ) {
+		AudioEngineTests::throwException(
+			QString( "[testQueuingTickSkipping] mismatch: [%1] notes in [%2] cycles while skipping ticks, [%3] notes in [%4] cycles while visiting all ticks" )
+			.arg( skipped.first.size() ).arg( skipped.second.size() )
+			.arg( visited.first.size() ).arg( visited.second.size() ) );
+	}
+	for ( int ii = 0; ii < skipped.first.size(); ++ii ) {
+		const auto& skippedNote = skipped.first[ ii ];
+		const auto& visitedNote = visited.first[ ii ];
+		if ( skippedNote.sInstrument != visitedNote.sInstrument ||
+			 skippedNote.nPosition != visitedNote.nPosition ||
+			 skippedNote.nNoteStart != visitedNote.nNoteStart ||
+			 skippedNote.nHumanizeDelay != visitedNote.nHumanizeDelay ||
+			 skippedNote.fVelocity != visitedNote.fVelocity ) {
+			AudioEngineTests::throwException(
+				QString( "[testQueuingTickSkipping] note [%1] differs. skipped: [%2, %3, %4], visited: [%5, %6, %7]" )
+				.arg( ii ).arg( skippedNote.sInstrument )
+				.arg( skippedNote.nPosition ).arg( skippedNote.nNoteStart )
+				.arg( visitedNote.sInstrument ).arg( visitedNote.nPosition )
+				.arg( visitedNote.nNoteStart ) );
+		}
+	}
+
+	pAE->reset( false );
+	pAE->setState( AudioEngine::State::Ready );
+	pAE->unlock();
+
+	pSong->setHumanizeTimeValue( fHumanizeTime );
+	pSong->setHumanizeVelocityValue( fHumanizeVelocity );
+	pPref->m_bUseMetronome = bUseMetronome;
+}
+
 void AudioEngineTests::testNoteEnqueuingTimeline() {
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
@@ -1697,6 +1809,155 @@ void AudioEngineTests::testNoteOff() {
 	pAE->unlock();
 }
 	
+void AudioEngineTests::testMidiIngressJitter() {
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = pHydrogen->getSong();
+	auto pAE = pHydrogen->getAudioEngine();
+	auto pPref = Preferences::get_instance();
+
+	auto pInstrument = pSong->getDrumkit()->getInstruments()->get( 0 );
+	if ( pInstrument == nullptr ) {
+		AudioEngineTests::throwException(
+			"[testMidiIngressJitter] no instrument found" );
+	}
+
+	CoreActionController::activateLoopMode( false );
+	CoreActionController::activateSongMode( true );
+
+	// Notes have to be handed over without locking the engine.
+	const bool bOldRecordEvents = pPref->getRecordEvents();
+	const bool bOldPlaySelectedInstrument = pPref->m_bPlaySelectedInstrument;
+	pPref->setRecordEvents( false );
+	pPref->m_bPlaySelectedInstrument = false;
+
+	pAE->lock( RIGHT_HERE );
+	pAE->setState( AudioEngine::State::Testing );
+	pAE->reset( false );
+	AudioEngineTests::resetSampler( "testMidiIngressJitter" );
+	// addRealtimeNote() only uses the queue while the engine is ready
+	// and falls back to the lock otherwise.
+	pAE->setState( AudioEngine::State::Ready );
+
+	std::random_device randomSeed;
+	std::default_random_engine randomEngine( randomSeed() );
+	std::uniform_real_distribution<double> timeDist( 0, 1 );
+	std::uniform_int_distribution<int> eventDist( 0, 8 );
+
+	const uint32_t nFrames = pPref->m_nBufferSize;
+	const double fSampleRate =
+		static_cast<double>(pAE->getAudioDriver()->getSampleRate());
+	// Length of a single period in microseconds.
+	const double fPeriod = static_cast<double>(nFrames) / fSampleRate * 1000000;
+	std::uniform_int_distribution<int> frameDist( 0, nFrames - 1 );
+
+	// Time stamps are chosen arbitrarily as the FakeDriver does not
+	// run in realtime.
+	const long long nStartTimestamp = 1000000;
+	long long nCycleTimestamp = nStartTimestamp;
+	pAE->processMidiIngress( nFrames, nCycleTimestamp );
+	pAE->unlock();
+
+	auto addNote = [&]( long long nTimestamp, int nFrameOffset ) {
+		if ( ! pHydrogen->addRealtimeNote(
+				 0, 0.8, false, MidiMessage::instrumentOffset, nTimestamp,
+				 nFrameOffset ) ) {
+			pAE->lock( RIGHT_HERE );
+			AudioEngineTests::throwException(
+				"[testMidiIngressJitter] unable to add note" );
+		}
+	};
+
+	double fMaxJitter = 0;
+	double fMaxJitterBufferBoundary = 0;
+	int nEvents = 0;
+	const int nCycles = 100;
+	for ( int nn = 0; nn < nCycles; ++nn ) {
+		const long long nPreviousCycleTimestamp = nCycleTimestamp;
+		nCycleTimestamp = nStartTimestamp +
+			static_cast<long long>(std::round( ( nn + 1 ) * fPeriod ));
+
+		// Events received by the MIDI driver during the last cycle. Every
+		// other one carries a frame offset like those of the JACK MIDI
+		// driver.
+		std::vector<std::pair<long long, int>> events;
+		const int nNewEvents = eventDist( randomEngine );
+		for ( int ii = 0; ii < nNewEvents; ++ii ) {
+			const long long nTimestamp = nPreviousCycleTimestamp +
+				static_cast<long long>( std::floor(
+					timeDist( randomEngine ) *
+					static_cast<double>(nCycleTimestamp - nPreviousCycleTimestamp) ) );
+			events.push_back( { nTimestamp,
+								ii % 2 == 0 ? -1 : frameDist( randomEngine ) } );
+		}
+		std::sort( events.begin(), events.end() );
+
+		std::vector<double> expectedOffsets;
+		for ( const auto& [ nnTimestamp, nnFrameOffset ] : events ) {
+			addNote( nnTimestamp, nnFrameOffset );
+			if ( nnFrameOffset >= 0 ) {
+				expectedOffsets.push_back( nnFrameOffset );
+			} else {
+				expectedOffsets.push_back(
+					static_cast<double>(nnTimestamp - nPreviousCycleTimestamp) *
+					fSampleRate / 1000000 );
+			}
+		}
+		// Received after the start of the cycle and must be kept for
+		// the next one.
+		addNote( nCycleTimestamp, -1 );
+
+		pAE->lock( RIGHT_HERE );
+		const long long nFrame = pAE->getRealtimeFrame();
+		pAE->processMidiIngress( nFrames, nCycleTimestamp );
+
+		auto notes = AudioEngineTests::copySongNoteQueue();
+		if ( notes.size() != events.size() ||
+			 pAE->m_midiIngressQueue.size() != 1 ) {
+			AudioEngineTests::throwException(
+				QString( "[testMidiIngressJitter] [%1] mismatching number of notes. Pushed: %2, enqueued: %3, pending: %4" )
+				.arg( nn ).arg( events.size() ).arg( notes.size() )
+				.arg( pAE->m_midiIngressQueue.size() ) );
+		}
+
+		// The note queue is ordered by start frame, not by reception.
+		std::sort( expectedOffsets.begin(), expectedOffsets.end() );
+		std::sort( notes.begin(), notes.end(),
+				   []( const std::shared_ptr<Note>& pA,
+					   const std::shared_ptr<Note>& pB ) {
+					   return pA->getNoteStart() < pB->getNoteStart(); } );
+		for ( int ii = 0; ii < notes.size(); ++ii ) {
+			const double fExpectedOffset = expectedOffsets[ ii ];
+			const double fJitter = std::abs(
+				static_cast<double>(notes[ ii ]->getNoteStart() - nFrame) -
+				fExpectedOffset );
+			if ( fJitter > 1.0 ) {
+				AudioEngineTests::throwException(
+					QString( "[testMidiIngressJitter] [%1] note not started at the right frame. expected offset: %2, note start: %3, buffer start: %4, jitter: %5" )
+					.arg( nn ).arg( fExpectedOffset, 0, 'f' )
+					.arg( notes[ ii ]->getNoteStart() ).arg( nFrame )
+					.arg( fJitter, 0, 'f' ) );
+			}
+			fMaxJitter = std::max( fMaxJitter, fJitter );
+			// Notes passed via AudioEngine::noteOn() are all started at
+			// the beginning of the buffer.
+			fMaxJitterBufferBoundary =
+				std::max( fMaxJitterBufferBoundary, fExpectedOffset );
+		}
+		nEvents += notes.size();
+
+		// Drops the late entry as well.
+		pAE->clearNoteQueues();
+		pAE->unlock();
+	}
+
+	INFOLOG( QString( "[testMidiIngressJitter] events: %1, max jitter: %2 frames (%3 frames when starting at buffer boundaries)" )
+			 .arg( nEvents ).arg( fMaxJitter, 0, 'f' )
+			 .arg( fMaxJitterBufferBoundary, 0, 'f' ) );
+
+	pPref->setRecordEvents( bOldRecordEvents );
+	pPref->m_bPlaySelectedInstrument = bOldPlaySelectedInstrument;
+}
+
 void AudioEngineTests::mergeQueues( std::vector<std::shared_ptr<Note>>* noteList, std::vector<std::shared_ptr<Note>> newNotes ) {
 	bool bNoteFound;
 	for ( const auto& newNote : newNotes ) {
@@ -91,6 +91,13 @@ public:
 	 */
 	static void testNoteEnqueuingTimeline();
 
+	/**
+	 * Checks that skipping ticks without events in song mode (see
+	 * AudioEngine::computeNextQueuingTick()) enqueues the very same
+	 * notes as visiting every single tick.
+	 */
+	static void testQueuingTickSkipping();
+
 	/**
 	 * Unit test checking that custom note properties take effect and
 	 * that humanization works as expected.
@@ -105,6 +112,12 @@ public:
 	 * properly in the Sampler. */
 	static void testNoteOff();
 
+	/** Unit test checking that time stamped notes passed to
+	 * Hydrogen::addRealtimeNote() are handed over via the
+	 * #MidiIngressQueue and started at the right frame within the
+	 * buffer, both for time stamps and frame offsets. */
+	static void testMidiIngressJitter();
+
 		/**
 		 * Checks is reproducible and works even without any song set.
 		 */
@@ -162,7 +175,7 @@ private:
 	 */
 	static void checkTransportPosition( std::shared_ptr<TransportPosition> pPos, const QString& sContext );
 	/**
-	 * Takes two instances of Sampler::m_playingNotesQueue and checks
+	 * Takes two instances of Sampler::getPlayingNotesQueue() and checks
 	 * whether matching notes have exactly @a nPassedFrames difference
 	 * in their SelectedLayerInfo::SamplePosition.
 	 */
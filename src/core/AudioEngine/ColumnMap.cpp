@@ -0,0 +1,122 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/ColumnMap.h>
+
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+
+#include <algorithm>
+
+namespace H2Core
+{
+
+ColumnMap::ColumnMap( std::shared_ptr<Song> pSong, double fSongSizeInTicks )
+	: m_columnTicks( 1, 0 )
+	, m_pSong( pSong )
+	, m_fSongSizeInTicks( fSongSizeInTicks )
+{
+	if ( pSong == nullptr ) {
+		return;
+	}
+
+	const auto pColumns = pSong->getPatternGroupVector();
+	m_columnTicks.reserve( pColumns->size() + 1 );
+	long nTick = 0;
+	for ( const auto& ppColumn : *pColumns ) {
+		if ( ppColumn->size() != 0 ) {
+			nTick += ppColumn->longestPatternLength();
+		} else {
+			nTick += 4 * H2Core::nTicksPerQuarter;
+		}
+		m_columnTicks.push_back( nTick );
+	}
+}
+
+bool ColumnMap::isValidFor( const std::shared_ptr<Song>& pSong,
+							double fSongSizeInTicks, int nColumns ) const {
+	// Neither locks the song nor compares addresses.
+	return ! m_pSong.owner_before( pSong ) && ! pSong.owner_before( m_pSong ) &&
+		m_fSongSizeInTicks == fSongSizeInTicks &&
+		getNumberOfColumns() == nColumns;
+}
+
+int ColumnMap::findColumn( long nTick, bool bLoopMode,
+						   long* pPatternStartTick ) const {
+	const int nColumns = getNumberOfColumns();
+	if ( nColumns == 0 ) {
+		// There are no patterns in the current song.
+		*pPatternStartTick = 0;
+		return 0;
+	}
+
+	// If the song is played in loop mode, the tick numbers of the
+	// second turn are added on top of maximum tick number of the
+	// song. Therefore, we will introduced periodic boundary
+	// conditions.
+	if ( bLoopMode && nTick >= getLengthInTicks() &&
+		 getLengthInTicks() != 0 ) {
+		nTick = nTick % getLengthInTicks();
+	}
+
+	if ( nTick >= 0 && nTick < getLengthInTicks() ) {
+		// Last column starting at or before nTick. Columns of zero
+		// length share their start with the following one and are
+		// skipped this way.
+		const auto it = std::upper_bound( m_columnTicks.begin(),
+										  m_columnTicks.end(), nTick );
+		const int nColumn =
+			static_cast<int>( std::distance( m_columnTicks.begin(), it ) ) - 1;
+		*pPatternStartTick = m_columnTicks[ nColumn ];
+		return nColumn;
+	}
+
+	*pPatternStartTick = 0;
+	return -1;
+}
+
+QString ColumnMap::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[ColumnMap]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_fSongSizeInTicks: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_fSongSizeInTicks ) )
+			.append( QString( "%1%2m_columnTicks: [" ).arg( sPrefix ).arg( s ) );
+		for ( int ii = 0; ii < m_columnTicks.size(); ++ii ) {
+			if ( ii > 0 ) {
+				sOutput.append( ", " );
+			}
+			sOutput.append( QString::number( m_columnTicks[ ii ] ) );
+		}
+		sOutput.append( "]\n" );
+	}
+	else {
+		sOutput = QString( "[ColumnMap] m_fSongSizeInTicks: %1" )
+			.arg( m_fSongSizeInTicks )
+			.append( QString( ", columns: %1" ).arg( getNumberOfColumns() ) )
+			.append( QString( ", length: %1" ).arg( getLengthInTicks() ) );
+	}
+
+	return sOutput;
+}
+
+};
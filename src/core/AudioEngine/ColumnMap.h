@@ -0,0 +1,107 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_COLUMN_MAP_H
+#define H2C_COLUMN_MAP_H
+
+#include <memory>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class Song;
+
+/**
+ * Precomputed layout of the columns - pattern groups - of a #Song.
+ *
+ * Start ticks of all columns are accumulated once so looking up the
+ * column containing a tick only requires a binary search instead of
+ * summing up the lengths of all prior columns. Just like in
+ * Hydrogen::getColumnForTick() a column is as long as its longest
+ * pattern (including virtual ones) or four quarters if it is empty.
+ *
+ * The map only holds the layout and no patterns or notes. These are
+ * still accessed directly by the #AudioEngine so notes can be added
+ * while transport is rolling.
+ *
+ * A map is immutable and only valid for the song, song size, and
+ * number of columns it was built with (see isValidFor()). The
+ * #AudioEngine caches the one currently in use (see
+ * AudioEngine::getColumnMap()).
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class ColumnMap : public H2Core::Object<ColumnMap>
+{
+	H2_OBJECT(ColumnMap)
+public:
+	ColumnMap( std::shared_ptr<Song> pSong, double fSongSizeInTicks );
+
+	/** Whether the map was built using the provided parameters. */
+	bool isValidFor( const std::shared_ptr<Song>& pSong,
+					 double fSongSizeInTicks, int nColumns ) const;
+
+	/** See Hydrogen::getColumnForTick() */
+	int findColumn( long nTick, bool bLoopMode, long* pPatternStartTick ) const;
+
+	/** \return Start tick of @a nColumn. @a nColumn must be within
+	 *   [0, getNumberOfColumns()). */
+	long getColumnStartTick( int nColumn ) const;
+	/** \return Length of @a nColumn in ticks. @a nColumn must be
+	 *   within [0, getNumberOfColumns()). */
+	long getColumnLength( int nColumn ) const;
+
+	int getNumberOfColumns() const;
+	/** Sum of the length of all columns. */
+	long getLengthInTicks() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	/** Start ticks of all columns followed by the end of the last
+	 * one. */
+	std::vector<long> m_columnTicks;
+
+	/** Compared by ownership. In contrast to the address, it can not be
+	 * reused by a song loaded after the original one was deleted. */
+	std::weak_ptr<const Song> m_pSong;
+	double m_fSongSizeInTicks;
+};
+
+inline long ColumnMap::getColumnStartTick( int nColumn ) const {
+	return m_columnTicks[ nColumn ];
+}
+inline long ColumnMap::getColumnLength( int nColumn ) const {
+	return m_columnTicks[ nColumn + 1 ] - m_columnTicks[ nColumn ];
+}
+inline int ColumnMap::getNumberOfColumns() const {
+	return static_cast<int>(m_columnTicks.size()) - 1;
+}
+inline long ColumnMap::getLengthInTicks() const {
+	return m_columnTicks.back();
+}
+
+};
+
+#endif // H2C_COLUMN_MAP_H
@@ -0,0 +1,146 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/CommandQueue.h>
+
+namespace H2Core
+{
+
+static_assert( ( CommandQueue::nCapacity & ( CommandQueue::nCapacity - 1 ) ) == 0,
+			   "Capacity must be a power of two" );
+
+CommandQueue::CommandQueue()
+	: m_slots( new Slot[ nCapacity ] )
+	, m_nEnqueuePos( 0 )
+	, m_nDequeuePos( 0 )
+	, m_bConsuming( false )
+{
+	for ( size_t ii = 0; ii < nCapacity; ++ii ) {
+		m_slots[ ii ].nSequence.store( ii, std::memory_order_relaxed );
+		m_slots[ ii ].bNeedsLock = true;
+	}
+}
+
+CommandQueue::~CommandQueue() {
+}
+
+bool CommandQueue::push( Command command, bool bNeedsLock ) {
+	Slot* pSlot;
+	size_t nPos = m_nEnqueuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		pSlot = &m_slots[ nPos & ( nCapacity - 1 ) ];
+		const size_t nSequence = pSlot->nSequence.load( std::memory_order_acquire );
+		const auto nDiff = static_cast<std::ptrdiff_t>(nSequence) -
+			static_cast<std::ptrdiff_t>(nPos);
+		if ( nDiff == 0 ) {
+			if ( m_nEnqueuePos.compare_exchange_weak(
+					 nPos, nPos + 1, std::memory_order_relaxed ) ) {
+				break;
+			}
+		}
+		else if ( nDiff < 0 ) {
+			// Queue is full.
+			return false;
+		}
+		else {
+			nPos = m_nEnqueuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	// This destroys the command previously executed in this slot.
+	pSlot->command = std::move( command );
+	pSlot->bNeedsLock = bNeedsLock;
+	pSlot->nSequence.store( nPos + 1, std::memory_order_release );
+
+	return true;
+}
+
+int CommandQueue::processAll( bool bLocked ) {
+	if ( m_bConsuming.exchange( true, std::memory_order_acquire ) ) {
+		return -1;
+	}
+
+	int nProcessed = 0;
+	size_t nPos = m_nDequeuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		auto pSlot = &m_slots[ nPos & ( nCapacity - 1 ) ];
+		const size_t nSequence = pSlot->nSequence.load( std::memory_order_acquire );
+		const auto nDiff = static_cast<std::ptrdiff_t>(nSequence) -
+			static_cast<std::ptrdiff_t>(nPos + 1);
+		if ( nDiff < 0 ) {
+			// Queue is empty.
+			break;
+		}
+		else if ( nDiff > 0 ) {
+			nPos = m_nDequeuePos.load( std::memory_order_relaxed );
+			continue;
+		}
+
+		if ( ! bLocked && pSlot->bNeedsLock ) {
+			// Has to wait for a consumer holding the lock.
+			break;
+		}
+
+		if ( ! m_nDequeuePos.compare_exchange_weak(
+				 nPos, nPos + 1, std::memory_order_relaxed ) ) {
+			continue;
+		}
+
+		if ( pSlot->command ) {
+			pSlot->command();
+		}
+		pSlot->nSequence.store( nPos + nCapacity, std::memory_order_release );
+		++nProcessed;
+		++nPos;
+	}
+
+	m_bConsuming.store( false, std::memory_order_release );
+
+	return nProcessed;
+}
+
+int CommandQueue::size() const {
+	const size_t nEnqueuePos = m_nEnqueuePos.load( std::memory_order_relaxed );
+	const size_t nDequeuePos = m_nDequeuePos.load( std::memory_order_relaxed );
+	if ( nEnqueuePos <= nDequeuePos ) {
+		return 0;
+	}
+
+	return static_cast<int>( nEnqueuePos - nDequeuePos );
+}
+
+QString CommandQueue::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[CommandQueue]\n" ).arg( sPrefix )
+			.append( QString( "%1%2size: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( size() ) );
+	}
+	else {
+		sOutput = QString( "[CommandQueue] " )
+			.append( QString( "size: %1" ).arg( size() ) );
+	}
+
+	return sOutput;
+}
+
+};
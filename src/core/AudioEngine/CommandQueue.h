@@ -0,0 +1,119 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_COMMAND_QUEUE_H
+#define H2C_COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+/**
+ * Bounded lock-free FIFO used by control threads (GUI, OSC, MIDI, and
+ * #CoreActionController) to hand mutations of the #AudioEngine over to
+ * the audio thread.
+ *
+ * The implementation follows the bounded multi-producer queue by Dmitry
+ * Vyukov. Each slot carries a sequence number indicating whether it is
+ * ready to be written or read and neither pushing nor processing
+ * commands blocks.
+ *
+ * Commands either require the #AudioEngine lock or only touch state
+ * safe to be altered without it. The latter can be processed even if
+ * the audio thread fails to acquire the lock in time.
+ *
+ * Commands are executed in place and only destroyed once a producer
+ * reuses their slot. This way all memory management associated with
+ * the commands and their captures happens in the control threads.
+ * Capturing shared pointers, e.g. to a #Pattern, is therefore safe as
+ * their last reference is never dropped on the audio thread.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class CommandQueue : public H2Core::Object<CommandQueue>
+{
+	H2_OBJECT(CommandQueue)
+public:
+	typedef std::function<void()> Command;
+
+	/** Maximum number of pending commands. Must be a power of two. */
+	static constexpr int nCapacity = 1024;
+
+	CommandQueue();
+	~CommandQueue();
+
+	/**
+	 * Appends @a command to the queue. Can be called from multiple
+	 * threads at once.
+	 *
+	 * \param bNeedsLock Whether @a command must only be executed while
+	 *   holding the #AudioEngine lock.
+	 *
+	 * @return `false` in case the queue is full.
+	 */
+	bool push( Command command, bool bNeedsLock = true );
+
+	/**
+	 * Executes pending commands in the order they were pushed.
+	 *
+	 * Only one consumer is processing commands at a time. If another
+	 * one is already doing so, the function returns right away.
+	 *
+	 * \param bLocked Whether the caller holds the #AudioEngine lock. If
+	 *   not, processing stops at the first command requiring it in
+	 *   order to preserve the order of execution.
+	 *
+	 * @return Number of executed commands or -1 in case another
+	 *   consumer is busy.
+	 */
+	int processAll( bool bLocked = true );
+
+	/** @return Approximate number of pending commands. */
+	int size() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	struct Slot {
+		std::atomic<size_t> nSequence;
+		Command command;
+		bool bNeedsLock;
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+
+	/** Producer and consumer positions are placed on different cache
+	 * lines to avoid false sharing. */
+	alignas(64) std::atomic<size_t> m_nEnqueuePos;
+	alignas(64) std::atomic<size_t> m_nDequeuePos;
+	/** Set while a consumer is processing commands. */
+	std::atomic<bool> m_bConsuming;
+};
+
+};
+
+#endif // H2C_COMMAND_QUEUE_H
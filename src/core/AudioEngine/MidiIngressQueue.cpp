@@ -0,0 +1,109 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/MidiIngressQueue.h>
+#include <core/Basics/Instrument.h>
+
+namespace H2Core
+{
+
+static_assert( ( MidiIngressQueue::nCapacity & ( MidiIngressQueue::nCapacity - 1 ) ) == 0,
+			   "Capacity must be a power of two" );
+
+MidiIngressQueue::MidiIngressQueue()
+	: m_entries( new Entry[ nCapacity ] )
+	, m_nWritePos( 0 )
+	, m_nReadPos( 0 )
+{
+}
+
+MidiIngressQueue::~MidiIngressQueue() {
+}
+
+bool MidiIngressQueue::push( const Entry& entry ) {
+	const size_t nWritePos = m_nWritePos.load( std::memory_order_relaxed );
+	if ( nWritePos - m_nReadPos.load( std::memory_order_acquire ) >= nCapacity ) {
+		// Queue is full.
+		return false;
+	}
+
+	m_entries[ nWritePos & ( nCapacity - 1 ) ] = entry;
+	m_nWritePos.store( nWritePos + 1, std::memory_order_release );
+
+	return true;
+}
+
+const MidiIngressQueue::Entry* MidiIngressQueue::front() const {
+	const size_t nReadPos = m_nReadPos.load( std::memory_order_relaxed );
+	if ( nReadPos == m_nWritePos.load( std::memory_order_acquire ) ) {
+		return nullptr;
+	}
+
+	return &m_entries[ nReadPos & ( nCapacity - 1 ) ];
+}
+
+bool MidiIngressQueue::pop( Entry* pEntry ) {
+	const size_t nReadPos = m_nReadPos.load( std::memory_order_relaxed );
+	if ( nReadPos == m_nWritePos.load( std::memory_order_acquire ) ) {
+		return false;
+	}
+
+	auto& entry = m_entries[ nReadPos & ( nCapacity - 1 ) ];
+	if ( pEntry != nullptr ) {
+		*pEntry = entry;
+	}
+	m_nReadPos.store( nReadPos + 1, std::memory_order_release );
+
+	return true;
+}
+
+void MidiIngressQueue::clear() {
+	while ( pop() ) {
+	}
+}
+
+int MidiIngressQueue::size() const {
+	const size_t nWritePos = m_nWritePos.load( std::memory_order_relaxed );
+	const size_t nReadPos = m_nReadPos.load( std::memory_order_relaxed );
+	if ( nWritePos <= nReadPos ) {
+		return 0;
+	}
+
+	return static_cast<int>( nWritePos - nReadPos );
+}
+
+QString MidiIngressQueue::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[MidiIngressQueue]\n" ).arg( sPrefix )
+			.append( QString( "%1%2size: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( size() ) );
+	}
+	else {
+		sOutput = QString( "[MidiIngressQueue] " )
+			.append( QString( "size: %1" ).arg( size() ) );
+	}
+
+	return sOutput;
+}
+
+};
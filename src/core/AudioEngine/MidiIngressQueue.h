@@ -0,0 +1,124 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_MIDI_INGRESS_QUEUE_H
+#define H2C_MIDI_INGRESS_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+/**
+ * Bounded lock-free single-producer single-consumer FIFO handing
+ * incoming MIDI notes over from the thread of the active MIDI input
+ * driver to the audio thread.
+ *
+ * In contrast to #AudioEngine::noteOn() no lock is required and each
+ * entry carries the time the corresponding MIDI event was received by
+ * the driver. Entries hold the raw event data only. The instrument is
+ * resolved by the audio thread while holding the lock. This allows the audio engine to start the note at the
+ * right frame within the current buffer instead of at its beginning.
+ *
+ * \ingroup docCore docAudioEngine docMIDI
+ */
+class MidiIngressQueue : public H2Core::Object<MidiIngressQueue>
+{
+	H2_OBJECT(MidiIngressQueue)
+public:
+	struct Entry {
+		/** Position of the instrument in the instrument list of the
+		 * current drumkit. Not used in case of
+		 * #bPlaySelectedInstrument. */
+		int nInstrument = 0;
+		float fVelocity = 0;
+		float fPan = 0;
+		bool bNoteOff = false;
+		/** MIDI pitch of the incoming event. */
+		int nNote = 0;
+		/** Whether the note was played using
+		 * Preferences::m_bPlaySelectedInstrument. */
+		bool bPlaySelectedInstrument = false;
+		/** Time of reception in microseconds (see
+		 * MidiMessage::currentTimestamp()). */
+		long long nTimestamp = 0;
+		/** Offset in frames within the process cycle the event was
+		 * received in (see MidiMessage::m_nFrameOffset). Used instead
+		 * of #nTimestamp to place the note if it is not -1. */
+		int nFrameOffset = -1;
+	};
+
+	/** Maximum number of pending entries. Must be a power of two. */
+	static constexpr int nCapacity = 512;
+
+	MidiIngressQueue();
+	~MidiIngressQueue();
+
+	/**
+	 * Appends @a entry to the queue. Must only be called by a single
+	 * thread at a time.
+	 *
+	 * @return `false` in case the queue is full.
+	 */
+	bool push( const Entry& entry );
+
+	/**
+	 * Retrieves the oldest entry without removing it.
+	 *
+	 * @return `nullptr` in case the queue is empty.
+	 */
+	const Entry* front() const;
+
+	/**
+	 * Removes the oldest entry and moves it into @a pEntry (in case it
+	 * is not `nullptr`).
+	 *
+	 * Consumers have to be serialized. Within Hydrogen this is done by
+	 * only calling it while holding the #AudioEngine lock.
+	 *
+	 * @return `false` in case the queue is empty.
+	 */
+	bool pop( Entry* pEntry = nullptr );
+
+	/** Discards all pending entries. Same constraints as for pop(). */
+	void clear();
+
+	/** @return Approximate number of pending entries. */
+	int size() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	std::unique_ptr<Entry[]> m_entries;
+
+	/** Producer and consumer positions are placed on different cache
+	 * lines to avoid false sharing. */
+	alignas(64) std::atomic<size_t> m_nWritePos;
+	alignas(64) std::atomic<size_t> m_nReadPos;
+};
+
+};
+
+#endif // H2C_MIDI_INGRESS_QUEUE_H
@@ -0,0 +1,266 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/NotePool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+
+namespace H2Core
+{
+
+struct NotePool::Slot {
+	/** Size of the storage reserved for the control block. Checked at
+	 * compile time in SlotAllocator::allocate(). */
+	static constexpr std::size_t nControlBlockSize = 64;
+
+	std::unique_ptr<Note> pNote;
+	/** Set when handing out #pNote and cleared once no shared or weak
+	 * pointer refers to it anymore. */
+	std::atomic<bool> bInUse{ false };
+	alignas( std::max_align_t ) unsigned char controlBlock[ nControlBlockSize ];
+};
+
+/** Places the control block of a shared pointer into the storage of
+ * its #Slot instead of allocating it and flags the slot as idle once
+ * it is released. */
+template <typename T>
+class NotePool::SlotAllocator {
+public:
+	using value_type = T;
+
+	explicit SlotAllocator( Slot* pSlot ) : m_pSlot( pSlot ) {}
+	template <typename U>
+	SlotAllocator( const SlotAllocator<U>& other ) : m_pSlot( other.m_pSlot ) {}
+
+	T* allocate( std::size_t n ) {
+		static_assert( sizeof( T ) <= Slot::nControlBlockSize,
+					   "Control block does not fit into note slot" );
+		static_assert( alignof( T ) <= alignof( std::max_align_t ),
+					   "Control block alignment not supported" );
+		assert( n == 1 );
+		return reinterpret_cast<T*>( m_pSlot->controlBlock );
+	}
+	void deallocate( T* /*p*/, std::size_t /*n*/ ) {
+		// The release synchronizes all accesses of the former owners
+		// with the next acquire().
+		m_pSlot->bInUse.store( false, std::memory_order_release );
+	}
+
+	template <typename U>
+	bool operator==( const SlotAllocator<U>& other ) const {
+		return m_pSlot == other.m_pSlot;
+	}
+	template <typename U>
+	bool operator!=( const SlotAllocator<U>& other ) const {
+		return m_pSlot != other.m_pSlot;
+	}
+
+	Slot* m_pSlot;
+};
+
+/** Pooled notes are owned by their #NotePool::Slot. */
+struct NoteSlotDeleter {
+	void operator()( Note* /*pNote*/ ) const {}
+};
+
+NotePool::NotePool( int nCapacity )
+	: m_nLayerInfos( nLayerInfosPerNote )
+	, m_nCursor( 0 )
+	, m_nMisses( 0 )
+{
+	if ( nCapacity < 1 ) {
+		ERRORLOG( QString( "Invalid capacity [%1]. Using [%2] instead." )
+				  .arg( nCapacity ).arg( nDefaultCapacity ) );
+		nCapacity = nDefaultCapacity;
+	}
+
+	m_slots.reserve( nCapacity );
+	for ( int ii = 0; ii < nCapacity; ++ii ) {
+		auto pSlot = std::make_unique<Slot>();
+		pSlot->pNote = std::make_unique<Note>( nullptr );
+		// Each pooled note owns an envelope right from the start. It will
+		// be reused by Note::copyFrom() and Note::reset().
+		pSlot->pNote->m_pAdsr = std::make_shared<ADSR>();
+		// Same for the layer selection.
+		addLayerInfos( pSlot->pNote.get(), m_nLayerInfos );
+		m_slots.push_back( std::move( pSlot ) );
+	}
+}
+
+NotePool::~NotePool() {
+	for ( auto& pSlot : m_slots ) {
+		if ( pSlot->bInUse.load( std::memory_order_acquire ) ) {
+			// The control block of the remaining references resides
+			// within the slot. Better leak it than having them dangle.
+			WARNINGLOG( "Note still in use while destroying pool" );
+			pSlot.release();
+		}
+	}
+}
+
+void NotePool::addLayerInfos( Note* pNote, int nLayerInfos ) {
+	// Recycling must not require the vector to grow either.
+	pNote->m_spareLayerInfoNodes.reserve(
+		pNote->m_spareLayerInfoNodes.size() +
+		pNote->m_selectedLayerInfoMap.size() + nLayerInfos );
+	for ( int nn = 0; nn < nLayerInfos; ++nn ) {
+		Note::SelectedLayerInfoMap selectedLayerInfoMap;
+		selectedLayerInfoMap.emplace(
+			nullptr, std::make_shared<SelectedLayerInfo>() );
+		pNote->m_spareLayerInfoNodes.push_back(
+			selectedLayerInfoMap.extract( selectedLayerInfoMap.begin() ) );
+	}
+}
+
+std::shared_ptr<Note> NotePool::nextIdle() {
+	const int nCapacity = getCapacity();
+	for ( int ii = 0; ii < nCapacity; ++ii ) {
+		auto& pSlot = m_slots[ ( m_nCursor + ii ) % nCapacity ];
+		if ( ! pSlot->bInUse.load( std::memory_order_acquire ) ) {
+			m_nCursor = ( m_nCursor + ii + 1 ) % nCapacity;
+			pSlot->bInUse.store( true, std::memory_order_relaxed );
+			return std::shared_ptr<Note>( pSlot->pNote.get(), NoteSlotDeleter(),
+										  SlotAllocator<Note>( pSlot.get() ) );
+		}
+	}
+
+	++m_nMisses;
+	return nullptr;
+}
+
+std::shared_ptr<Note> NotePool::acquire( std::shared_ptr<Note> pOther ) {
+	auto pNote = nextIdle();
+	if ( pNote == nullptr ) {
+		return std::make_shared<Note>( pOther );
+	}
+
+	pNote->copyFrom( pOther );
+	return pNote;
+}
+
+std::shared_ptr<Note> NotePool::acquire( std::shared_ptr<Instrument> pInstrument,
+										 int nPosition, float fVelocity,
+										 float fPan, int nLength,
+										 float fPitch ) {
+	auto pNote = nextIdle();
+	if ( pNote == nullptr ) {
+		return std::make_shared<Note>( pInstrument, nPosition, fVelocity, fPan,
+									   nLength, fPitch );
+	}
+
+	pNote->reset( pInstrument, nPosition, fVelocity, fPan, nLength, fPitch );
+	return pNote;
+}
+
+void NotePool::releaseIdleNotes( std::shared_ptr<Instrument> pInstrument ) {
+	for ( auto& pSlot : m_slots ) {
+		if ( pSlot->bInUse.load( std::memory_order_acquire ) ) {
+			continue;
+		}
+
+		// Notes without instrument might still hold spare layer infos
+		// of a former one.
+		auto pNote = pSlot->pNote.get();
+		if ( pInstrument == nullptr || pNote->m_pInstrument == nullptr ||
+			 pNote->m_pInstrument == pInstrument ) {
+			pNote->m_pInstrument = nullptr;
+			// Keep the map nodes and infos but drop the components and
+			// layers they refer to.
+			pNote->recycleSelectedLayerInfos();
+			for ( auto& node : pNote->m_spareLayerInfoNodes ) {
+				node.key() = nullptr;
+				if ( node.mapped() != nullptr ) {
+					node.mapped()->pLayer = nullptr;
+				}
+			}
+		}
+	}
+}
+
+void NotePool::reserveLayerInfos( std::shared_ptr<Drumkit> pDrumkit ) {
+	if ( pDrumkit == nullptr ) {
+		return;
+	}
+
+	int nComponents = 0;
+	for ( const auto& ppInstrument : *pDrumkit->getInstruments() ) {
+		if ( ppInstrument != nullptr ) {
+			nComponents = std::max(
+				nComponents,
+				static_cast<int>(ppInstrument->getComponents()->size()) );
+		}
+	}
+	if ( nComponents <= m_nLayerInfos ) {
+		return;
+	}
+
+	INFOLOG( QString( "Increasing number of layer infos per note from [%1] to [%2]" )
+			 .arg( m_nLayerInfos ).arg( nComponents ) );
+	for ( auto& pSlot : m_slots ) {
+		addLayerInfos( pSlot->pNote.get(), nComponents - m_nLayerInfos );
+	}
+	m_nLayerInfos = nComponents;
+}
+
+int NotePool::getAvailable() const {
+	int nAvailable = 0;
+	for ( const auto& pSlot : m_slots ) {
+		if ( ! pSlot->bInUse.load( std::memory_order_acquire ) ) {
+			++nAvailable;
+		}
+	}
+
+	return nAvailable;
+}
+
+QString NotePool::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[NotePool]\n" ).arg( sPrefix )
+			.append( QString( "%1%2capacity: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getCapacity() ) )
+			.append( QString( "%1%2available: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getAvailable() ) )
+			.append( QString( "%1%2m_nCursor: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nCursor ) )
+			.append( QString( "%1%2m_nMisses: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nMisses ) );
+	}
+	else {
+		sOutput = QString( "[NotePool] " )
+			.append( QString( "capacity: %1" ).arg( getCapacity() ) )
+			.append( QString( ", available: %1" ).arg( getAvailable() ) )
+			.append( QString( ", m_nCursor: %1" ).arg( m_nCursor ) )
+			.append( QString( ", m_nMisses: %1" ).arg( m_nMisses ) );
+	}
+
+	return sOutput;
+}
+
+};
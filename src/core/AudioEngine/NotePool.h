@@ -0,0 +1,146 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_NOTE_POOL_H
+#define H2C_NOTE_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <core/Object.h>
+#include <core/Basics/Note.h>
+
+namespace H2Core
+{
+
+class Drumkit;
+class Instrument;
+
+/**
+ * Fixed-capacity pool of #Note instances used by the #AudioEngine and
+ * #Sampler to avoid heap allocations in the audio thread.
+ *
+ * All notes (including their #ADSR and #SelectedLayerInfo) are created once in the
+ * constructor. Each note handed out is wrapped into a shared pointer
+ * whose control block resides in preallocated storage of its slot.
+ * Once the last reference to it is dropped - by whatever thread - the
+ * slot is flagged as idle. Therefore, no explicit release is required:
+ * whenever the #AudioEngine or #Sampler drop a note from their queues
+ * it will be recycled automatically.
+ *
+ * In case the pool is exhausted, a regular heap-allocated note will be
+ * handed out instead and #m_nMisses incremented.
+ *
+ * Apart from releasing notes, the pool is not thread-safe on its own.
+ * It must only be accessed by the audio thread or by a thread holding
+ * the #AudioEngine lock.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class NotePool : public H2Core::Object<NotePool>
+{
+	H2_OBJECT(NotePool)
+public:
+	/** Number of notes created by default. */
+	static constexpr int nDefaultCapacity = 2048;
+	/** Number of #SelectedLayerInfo created for each note by default.
+	 * See reserveLayerInfos(). */
+	static constexpr int nLayerInfosPerNote = 4;
+
+	NotePool( int nCapacity = nDefaultCapacity );
+	~NotePool();
+
+	/** Retrieves a note from the pool and turns it into a copy of @a
+	 * pOther (see Note::Note( std::shared_ptr<Note> )). */
+	std::shared_ptr<Note> acquire( std::shared_ptr<Note> pOther );
+	/** Retrieves a note from the pool and initializes it like
+	 * Note::Note( std::shared_ptr<Instrument>, int, float, float, int,
+	 * float ) would. */
+	std::shared_ptr<Note> acquire( std::shared_ptr<Instrument> pInstrument,
+								   int nPosition = 0,
+								   float fVelocity = VELOCITY_DEFAULT,
+								   float fPan = PAN_DEFAULT,
+								   int nLength = LENGTH_ENTIRE_SAMPLE,
+								   float fPitch = PITCH_DEFAULT );
+
+	/**
+	 * Drops all references idle notes still hold to instruments and
+	 * layers. Without it, a recycled note would keep the instrument and
+	 * samples of the last note it represented alive.
+	 *
+	 * \param pInstrument If not `nullptr`, only idle notes associated
+	 *   with this particular instrument will be cleaned.
+	 */
+	void releaseIdleNotes( std::shared_ptr<Instrument> pInstrument = nullptr );
+
+	/**
+	 * Ensures each note holds enough #SelectedLayerInfo to render
+	 * notes of all instruments of @a pDrumkit without allocating. Has
+	 * to be called whenever a kit is loaded.
+	 *
+	 * Allocates if the kit contains instruments with more components
+	 * than all kits before. Must be called while holding the
+	 * #AudioEngine lock.
+	 */
+	void reserveLayerInfos( std::shared_ptr<Drumkit> pDrumkit );
+
+	int getCapacity() const;
+	/** @return Number of notes currently not in use. Iterates the whole
+	 * pool and is intended for debugging and tests. */
+	int getAvailable() const;
+	/** @return Number of notes which had to be allocated on the heap
+	 * because the pool was exhausted. */
+	long getMisses() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	/** Pooled note along with the storage of the control block of the
+	 * shared pointer handing it out. */
+	struct Slot;
+	template <typename T> class SlotAllocator;
+
+	/** @return An idle note or `nullptr` in case the pool is exhausted. */
+	std::shared_ptr<Note> nextIdle();
+	/** Adds @a nLayerInfos spare #SelectedLayerInfo to @a pNote. */
+	static void addLayerInfos( Note* pNote, int nLayerInfos );
+
+	std::vector<std::unique_ptr<Slot>> m_slots;
+	/** Number of #SelectedLayerInfo held by each note. */
+	int m_nLayerInfos;
+	/** Index at which the search for the next idle note starts. Since
+	 * notes are usually released in the order they were acquired, this
+	 * renders nextIdle() amortized O(1). */
+	int m_nCursor;
+	long m_nMisses;
+};
+
+inline int NotePool::getCapacity() const {
+	return static_cast<int>(m_slots.size());
+}
+inline long NotePool::getMisses() const {
+	return m_nMisses;
+}
+
+};
+
+#endif // H2C_NOTE_POOL_H
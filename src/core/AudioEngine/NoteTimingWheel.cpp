@@ -0,0 +1,299 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/NoteTimingWheel.h>
+
+#include <core/Basics/Note.h>
+
+#include <algorithm>
+
+namespace H2Core
+{
+
+static_assert( ( NoteTimingWheel::nSlots & ( NoteTimingWheel::nSlots - 1 ) ) == 0,
+			   "Number of slots must be a power of two" );
+
+NoteTimingWheel::NoteTimingWheel( int nCapacity )
+	: m_nFreeNode( -1 )
+	, m_heads( nSlots, -1 )
+	, m_tails( nSlots, -1 )
+	, m_nCursor( 0 )
+	, m_nOverflowHead( -1 )
+	, m_nOverflowTail( -1 )
+	, m_nSize( 0 )
+	, m_nSizeRing( 0 )
+{
+	if ( nCapacity < 1 ) {
+		ERRORLOG( QString( "Invalid capacity [%1]. Using [%2] instead." )
+				  .arg( nCapacity ).arg( nDefaultCapacity ) );
+		nCapacity = nDefaultCapacity;
+	}
+
+	m_nodes.resize( nCapacity );
+	for ( int ii = nCapacity - 1; ii >= 0; --ii ) {
+		m_nodes[ ii ].nNext = m_nFreeNode;
+		m_nFreeNode = ii;
+	}
+}
+
+NoteTimingWheel::~NoteTimingWheel() {
+}
+
+void NoteTimingWheel::grow() {
+	const int nOldCapacity = static_cast<int>(m_nodes.size());
+	const int nNewCapacity = 2 * nOldCapacity;
+	WARNINGLOG( QString( "Note queue exhausted. Increasing capacity [%1] -> [%2]" )
+				.arg( nOldCapacity ).arg( nNewCapacity ) );
+
+	m_nodes.resize( nNewCapacity );
+	for ( int ii = nNewCapacity - 1; ii >= nOldCapacity; --ii ) {
+		m_nodes[ ii ].nNext = m_nFreeNode;
+		m_nFreeNode = ii;
+	}
+}
+
+int NoteTimingWheel::allocateNode() {
+	if ( m_nFreeNode == -1 ) {
+		grow();
+	}
+
+	const int nNode = m_nFreeNode;
+	m_nFreeNode = m_nodes[ nNode ].nNext;
+	m_nodes[ nNode ].nNext = -1;
+
+	return nNode;
+}
+
+void NoteTimingWheel::releaseNode( int nNode ) {
+	// Dropping the reference allows pooled notes to be recycled.
+	m_nodes[ nNode ].pNote = nullptr;
+	m_nodes[ nNode ].nNext = m_nFreeNode;
+	m_nFreeNode = nNode;
+}
+
+bool NoteTimingWheel::before( int nNode, int nOther ) const {
+	const auto& node = m_nodes[ nNode ];
+	const auto& other = m_nodes[ nOther ];
+	if ( node.nStart != other.nStart ) {
+		return node.nStart < other.nStart;
+	}
+
+	// Note-off notes are handled after all other notes starting at the
+	// same frame.
+	return ! node.bNoteOff && other.bNoteOff;
+}
+
+void NoteTimingWheel::insertSorted( int nNode, int* pHead, int* pTail ) {
+	// Most notes are pushed in order. Check the end of the list first.
+	if ( *pTail == -1 ) {
+		*pHead = nNode;
+		*pTail = nNode;
+		return;
+	}
+	if ( ! before( nNode, *pTail ) ) {
+		m_nodes[ *pTail ].nNext = nNode;
+		*pTail = nNode;
+		return;
+	}
+
+	int nPrev = -1;
+	int nCurrent = *pHead;
+	while ( nCurrent != -1 && ! before( nNode, nCurrent ) ) {
+		nPrev = nCurrent;
+		nCurrent = m_nodes[ nCurrent ].nNext;
+	}
+
+	m_nodes[ nNode ].nNext = nCurrent;
+	if ( nPrev == -1 ) {
+		*pHead = nNode;
+	} else {
+		m_nodes[ nPrev ].nNext = nNode;
+	}
+}
+
+void NoteTimingWheel::insert( int nNode ) {
+	if ( m_nSizeRing == 0 && m_nOverflowHead == -1 ) {
+		// Queue is empty. We can move the ring to the position of the
+		// note. This is the case after relocations too.
+		m_nCursor = slotOf( m_nodes[ nNode ].nStart );
+	}
+
+	// Late notes are sorted into the current bucket.
+	const long long nSlot =
+		std::max( slotOf( m_nodes[ nNode ].nStart ), m_nCursor );
+
+	if ( nSlot - m_nCursor >= nSlots ) {
+		insertSorted( nNode, &m_nOverflowHead, &m_nOverflowTail );
+		return;
+	}
+
+	const int nIndex = static_cast<int>(nSlot & ( nSlots - 1 ));
+	insertSorted( nNode, &m_heads[ nIndex ], &m_tails[ nIndex ] );
+	++m_nSizeRing;
+}
+
+void NoteTimingWheel::migrateOverflow() {
+	if ( m_nOverflowHead == -1 ) {
+		return;
+	}
+
+	if ( m_nSizeRing == 0 ) {
+		m_nCursor = std::max(
+			m_nCursor, slotOf( m_nodes[ m_nOverflowHead ].nStart ) );
+	}
+
+	while ( m_nOverflowHead != -1 &&
+			slotOf( m_nodes[ m_nOverflowHead ].nStart ) - m_nCursor < nSlots ) {
+		const int nNode = m_nOverflowHead;
+		m_nOverflowHead = m_nodes[ nNode ].nNext;
+		if ( m_nOverflowHead == -1 ) {
+			m_nOverflowTail = -1;
+		}
+		m_nodes[ nNode ].nNext = -1;
+
+		const long long nSlot =
+			std::max( slotOf( m_nodes[ nNode ].nStart ), m_nCursor );
+		const int nIndex = static_cast<int>(nSlot & ( nSlots - 1 ));
+		insertSorted( nNode, &m_heads[ nIndex ], &m_tails[ nIndex ] );
+		++m_nSizeRing;
+	}
+}
+
+void NoteTimingWheel::advance() {
+	if ( m_nSize == 0 ) {
+		return;
+	}
+
+	if ( m_nSizeRing == 0 ) {
+		migrateOverflow();
+	}
+
+	while ( m_heads[ m_nCursor & ( nSlots - 1 ) ] == -1 ) {
+		++m_nCursor;
+
+		// The horizon of the ring moved by one bucket.
+		if ( m_nOverflowHead != -1 &&
+			 slotOf( m_nodes[ m_nOverflowHead ].nStart ) - m_nCursor < nSlots ) {
+			migrateOverflow();
+		}
+	}
+}
+
+void NoteTimingWheel::push( std::shared_ptr<Note> pNote ) {
+	const int nNode = allocateNode();
+	auto& node = m_nodes[ nNode ];
+	node.nStart = pNote != nullptr ? pNote->getNoteStart() : 0;
+	node.bNoteOff = pNote != nullptr ? pNote->getNoteOff() : false;
+	node.pNote = pNote;
+
+	insert( nNode );
+	++m_nSize;
+}
+
+std::shared_ptr<Note> NoteTimingWheel::top() {
+	if ( m_nSize == 0 ) {
+		return nullptr;
+	}
+
+	advance();
+	return m_nodes[ m_heads[ m_nCursor & ( nSlots - 1 ) ] ].pNote;
+}
+
+void NoteTimingWheel::pop() {
+	if ( m_nSize == 0 ) {
+		return;
+	}
+
+	advance();
+	const int nIndex = static_cast<int>(m_nCursor & ( nSlots - 1 ));
+	const int nNode = m_heads[ nIndex ];
+	m_heads[ nIndex ] = m_nodes[ nNode ].nNext;
+	if ( m_heads[ nIndex ] == -1 ) {
+		m_tails[ nIndex ] = -1;
+	}
+	releaseNode( nNode );
+
+	--m_nSizeRing;
+	--m_nSize;
+}
+
+int NoteTimingWheel::popDue( long long nFrameEnd,
+							 std::vector<std::shared_ptr<Note>>& notes ) {
+	int nPopped = 0;
+	while ( m_nSize > 0 ) {
+		advance();
+
+		const int nIndex = static_cast<int>(m_nCursor & ( nSlots - 1 ));
+		const int nNode = m_heads[ nIndex ];
+		if ( m_nodes[ nNode ].nStart >= nFrameEnd ) {
+			break;
+		}
+
+		notes.push_back( m_nodes[ nNode ].pNote );
+		m_heads[ nIndex ] = m_nodes[ nNode ].nNext;
+		if ( m_heads[ nIndex ] == -1 ) {
+			m_tails[ nIndex ] = -1;
+		}
+		releaseNode( nNode );
+
+		--m_nSizeRing;
+		--m_nSize;
+		++nPopped;
+	}
+
+	return nPopped;
+}
+
+void NoteTimingWheel::clear() {
+	if ( m_nSize == 0 ) {
+		return;
+	}
+
+	eraseIf( []( std::shared_ptr<Note> ) { return true; } );
+	m_nCursor = 0;
+}
+
+QString NoteTimingWheel::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[NoteTimingWheel]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_nSize: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nSize ) )
+			.append( QString( "%1%2m_nSizeRing: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nSizeRing ) )
+			.append( QString( "%1%2m_nCursor: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nCursor ) )
+			.append( QString( "%1%2capacity: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getCapacity() ) );
+	}
+	else {
+		sOutput = QString( "[NoteTimingWheel] " )
+			.append( QString( "m_nSize: %1" ).arg( m_nSize ) )
+			.append( QString( ", m_nSizeRing: %1" ).arg( m_nSizeRing ) )
+			.append( QString( ", m_nCursor: %1" ).arg( m_nCursor ) )
+			.append( QString( ", capacity: %1" ).arg( getCapacity() ) );
+	}
+
+	return sOutput;
+}
+
+};
@@ -0,0 +1,221 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_NOTE_TIMING_WHEEL_H
+#define H2C_NOTE_TIMING_WHEEL_H
+
+#include <memory>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class Note;
+
+/**
+ * Queue of #Note ordered by their start in frames (see
+ * Note::getNoteStart()) used as song note queue of the #AudioEngine.
+ *
+ * Notes are sorted into a ring of #nSlots buckets each covering
+ * 2^#nFramesPerSlotExponent frames. Only the bucket a note falls into
+ * has to be searched on insertion and the engine drains the notes due in
+ * the current process cycle by walking the buckets covered by it. Notes
+ * scheduled beyond the horizon of the ring are kept in an overflow list
+ * and moved into the ring as soon as it reaches them.
+ *
+ * All entries are taken from a pre-allocated node storage. Only in case
+ * it is exhausted, more memory will be allocated.
+ *
+ * The order of the notes is the same as the one established by
+ * Note::compareStart(): notes starting earlier are returned first and
+ * note-off notes come after all other notes starting at the same frame.
+ * Notes sharing both start and type are returned in the order they were
+ * pushed.
+ *
+ * Just like the #AudioEngine it is part of, the queue is not thread-safe
+ * and must only be accessed while holding the engine's lock.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class NoteTimingWheel : public H2Core::Object<NoteTimingWheel>
+{
+	H2_OBJECT(NoteTimingWheel)
+public:
+	/** Number of buckets. Must be a power of two. */
+	static constexpr int nSlots = 2048;
+	/** Each bucket covers 2^nFramesPerSlotExponent frames. */
+	static constexpr int nFramesPerSlotExponent = 4;
+	/** Number of notes the queue can hold without allocating memory. */
+	static constexpr int nDefaultCapacity = 4096;
+
+	NoteTimingWheel( int nCapacity = nDefaultCapacity );
+	~NoteTimingWheel();
+
+	/** Adds @a pNote to the queue. Its start has to be computed (see
+	 * Note::computeNoteStart()) beforehand and must not be altered while
+	 * the note is enqueued. */
+	void push( std::shared_ptr<Note> pNote );
+	/** @return Note starting first or `nullptr` in case the queue is
+	 * empty. */
+	std::shared_ptr<Note> top();
+	/** Removes the note returned by top(). */
+	void pop();
+
+	/**
+	 * Removes all notes starting prior to @a nFrameEnd from the queue and
+	 * appends them - in order - to @a notes.
+	 *
+	 * @return Number of notes appended.
+	 */
+	int popDue( long long nFrameEnd, std::vector<std::shared_ptr<Note>>& notes );
+
+	/**
+	 * Removes all notes for which @a predicate returns `true`. The
+	 * remaining ones keep their order.
+	 *
+	 * @param predicate Callable taking a `std::shared_ptr<Note>` and
+	 *   returning a `bool`.
+	 */
+	template<typename Predicate>
+	void eraseIf( Predicate predicate );
+
+	/** Removes all notes and resets the queue. */
+	void clear();
+
+	bool empty() const;
+	int size() const;
+	int getCapacity() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	struct Node {
+		std::shared_ptr<Note> pNote;
+		long long nStart;
+		bool bNoteOff;
+		int nNext;
+	};
+
+	/** Bucket index of the ring the frame @a nStart does fall into. */
+	long long slotOf( long long nStart ) const;
+
+	int allocateNode();
+	void releaseNode( int nNode );
+	/** Doubles #m_nodes in case the free list is exhausted. */
+	void grow();
+
+	/** Whether node @a nNode has to be placed in front of a node @a
+	 * nOther according to Note::compareStart(). */
+	bool before( int nNode, int nOther ) const;
+	/** Sorts node @a nNode into either a bucket of the ring or into the
+	 * overflow list. */
+	void insert( int nNode );
+	/** Inserts @a nNode into the singly linked list starting at @a
+	 * nHead and ending at @a nTail while keeping it sorted. */
+	void insertSorted( int nNode, int* pHead, int* pTail );
+
+	/** Moves #m_nCursor forward till it points to a non-empty bucket. */
+	void advance();
+	/** Moves all notes of the overflow list within reach of the ring
+	 * into their buckets. In case the ring is empty, it is moved to the
+	 * first note of the overflow list beforehand. */
+	void migrateOverflow();
+
+	std::vector<Node> m_nodes;
+	int m_nFreeNode;
+
+	/** Heads and tails of the singly linked lists of all buckets. `-1`
+	 * indicates an empty one. */
+	std::vector<int> m_heads;
+	std::vector<int> m_tails;
+
+	/** Absolute index of the bucket holding the next note due. All notes
+	 * in the ring start at or after the beginning of this bucket except
+	 * for late notes, which are sorted into the current bucket too. */
+	long long m_nCursor;
+
+	/** Sorted list of notes beyond the horizon of the ring. */
+	int m_nOverflowHead;
+	int m_nOverflowTail;
+
+	int m_nSize;
+	int m_nSizeRing;
+};
+
+inline long long NoteTimingWheel::slotOf( long long nStart ) const {
+	return nStart >> nFramesPerSlotExponent;
+}
+inline bool NoteTimingWheel::empty() const {
+	return m_nSize == 0;
+}
+inline int NoteTimingWheel::size() const {
+	return m_nSize;
+}
+inline int NoteTimingWheel::getCapacity() const {
+	return static_cast<int>(m_nodes.size());
+}
+
+template<typename Predicate>
+void NoteTimingWheel::eraseIf( Predicate predicate ) {
+	auto eraseFromList = [&]( int* pHead, int* pTail ) {
+		int nPrev = -1;
+		int nNode = *pHead;
+		int nErased = 0;
+		while ( nNode != -1 ) {
+			const int nNext = m_nodes[ nNode ].nNext;
+			if ( predicate( m_nodes[ nNode ].pNote ) ) {
+				if ( nPrev == -1 ) {
+					*pHead = nNext;
+				} else {
+					m_nodes[ nPrev ].nNext = nNext;
+				}
+				if ( *pTail == nNode ) {
+					*pTail = nPrev;
+				}
+				releaseNode( nNode );
+				++nErased;
+			}
+			else {
+				nPrev = nNode;
+			}
+			nNode = nNext;
+		}
+		return nErased;
+	};
+
+	if ( m_nSizeRing > 0 ) {
+		for ( int ii = 0; ii < nSlots; ++ii ) {
+			const int nErased = eraseFromList( &m_heads[ ii ], &m_tails[ ii ] );
+			m_nSizeRing -= nErased;
+			m_nSize -= nErased;
+		}
+	}
+
+	if ( m_nOverflowHead != -1 ) {
+		m_nSize -= eraseFromList( &m_nOverflowHead, &m_nOverflowTail );
+	}
+}
+
+};
+
+#endif // H2C_NOTE_TIMING_WHEEL_H
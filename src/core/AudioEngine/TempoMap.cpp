@@ -0,0 +1,328 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/TempoMap.h>
+
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/Hydrogen.h>
+#include <core/Timeline.h>
+
+#include <cmath>
+#include <limits>
+
+namespace H2Core
+{
+
+TempoMap::TempoMap( std::shared_ptr<Song> pSong,
+					std::shared_ptr<Timeline> pTimeline,
+					double fSongSizeInTicks, int nSampleRate )
+	: m_fSongSizeInTicks( fSongSizeInTicks )
+	, m_fSongSizeInFrames( 0 )
+	, m_fFirstMarkerTick( 0 )
+	, m_pTimeline( pTimeline )
+	, m_pSong( pSong )
+	, m_nTimelineRevision( pTimeline != nullptr ? pTimeline->getRevision() : 0 )
+	, m_nColumns( 0 )
+	, m_nSampleRate( nSampleRate )
+{
+	if ( pSong == nullptr || pTimeline == nullptr ) {
+		return;
+	}
+
+	// Start ticks of all columns in a single pass. Equivalent to
+	// Hydrogen::getTickForColumn().
+	const auto pColumns = pSong->getPatternGroupVector();
+	m_nColumns = pColumns->size();
+	std::vector<long> columnTicks( m_nColumns );
+	long nTick = 0;
+	for ( int ii = 0; ii < m_nColumns; ++ii ) {
+		columnTicks[ ii ] = nTick;
+		const auto pColumn = ( *pColumns )[ ii ];
+		if ( pColumn->size() > 0 ) {
+			nTick += pColumn->longestPatternLength();
+		} else {
+			nTick += 4 * H2Core::nTicksPerQuarter;
+		}
+	}
+
+	const auto& tempoMarkers = pTimeline->getAllTempoMarkers();
+	if ( tempoMarkers.size() == 0 ) {
+		return;
+	}
+	m_fFirstMarkerTick = static_cast<double>(
+		Hydrogen::get_instance()->getTickForColumn( tempoMarkers[ 0 ]->nColumn ) );
+
+	m_segments.resize( tempoMarkers.size() );
+	double fPassedTicks = 0;
+	double fPassedFrames = 0;
+	for ( int ii = 1; ii <= tempoMarkers.size(); ++ii ) {
+		auto& segment = m_segments[ ii - 1 ];
+
+		double fNextTick;
+		if ( ii == tempoMarkers.size() ||
+			 tempoMarkers[ ii ]->nColumn >= m_nColumns ) {
+			fNextTick = fSongSizeInTicks;
+		} else {
+			fNextTick = static_cast<double>(
+				columnTicks[ tempoMarkers[ ii ]->nColumn ] );
+		}
+
+		segment.fStartTick = fPassedTicks;
+		segment.fEndTick = fNextTick;
+		segment.fTickSize = AudioEngine::computeDoubleTickSize(
+			nSampleRate, tempoMarkers[ ii - 1 ]->fBpm );
+		segment.fStartFrame = fPassedFrames;
+		segment.fFrames = ( fNextTick - fPassedTicks ) * segment.fTickSize;
+
+		fPassedFrames += segment.fFrames;
+		fPassedTicks = fNextTick;
+	}
+	m_fSongSizeInFrames = fPassedFrames;
+}
+
+bool TempoMap::isValidFor( const std::shared_ptr<Song>& pSong,
+						   const Timeline* pTimeline, int nTimelineRevision,
+						   double fSongSizeInTicks, int nColumns,
+						   int nSampleRate ) const {
+	return ! m_pSong.owner_before( pSong ) && ! pSong.owner_before( m_pSong ) &&
+		m_pTimeline.get() == pTimeline &&
+		m_nTimelineRevision == nTimelineRevision &&
+		m_fSongSizeInTicks == fSongSizeInTicks &&
+		m_nColumns == nColumns &&
+		m_nSampleRate == nSampleRate;
+}
+
+int TempoMap::findSegmentByTick( const double fTick ) const {
+	// All segment boundaries are integer ticks. Comparing them with
+	// the provided tick is thus exact and yields the same segment as
+	// subtracting the segment lengths one by one would.
+	int nLow = 0;
+	int nHigh = static_cast<int>(m_segments.size());
+	while ( nLow < nHigh ) {
+		const int nMid = nLow + ( nHigh - nLow ) / 2;
+		if ( fTick > m_segments[ nMid ].fEndTick ) {
+			nLow = nMid + 1;
+		} else {
+			nHigh = nMid;
+		}
+	}
+
+	return nLow < m_segments.size() ? nLow : -1;
+}
+
+int TempoMap::findSegmentByFrame( const double fFrame,
+								  const double fOffset ) const {
+	int nLow = 0;
+	int nHigh = static_cast<int>(m_segments.size());
+	while ( nLow < nHigh ) {
+		const int nMid = nLow + ( nHigh - nLow ) / 2;
+		const auto& segment = m_segments[ nMid ];
+		// Same comparison TransportPosition did use while walking the
+		// segments.
+		if ( segment.fFrames <
+			 fFrame - ( fOffset + segment.fStartFrame ) ) {
+			nLow = nMid + 1;
+		} else {
+			nHigh = nMid;
+		}
+	}
+
+	return nLow < m_segments.size() ? nLow : -1;
+}
+
+long long TempoMap::computeFrameFromTick( const double fTick,
+										  double* fTickMismatch ) const {
+	*fTickMismatch = 0;
+	if ( fTick <= 0 || m_segments.size() == 0 ) {
+		return 0;
+	}
+
+	double fNewFrame = 0;
+	double fTickInSong = fTick;
+	int nSegment = findSegmentByTick( fTick );
+	if ( nSegment == -1 ) {
+		// The provided fTick is larger than the song.
+		const int nRepetitions = std::floor( fTick / m_fSongSizeInTicks );
+		fNewFrame = m_fSongSizeInFrames * static_cast<double>(nRepetitions);
+		fTickInSong = std::fmod( fTick, m_fSongSizeInTicks );
+
+		if ( std::isinf( fNewFrame ) ||
+			 static_cast<long long>(fNewFrame) >
+			 std::numeric_limits<long long>::max() ) {
+			ERRORLOG( QString( "Provided ticks [%1] are too large." ).arg( fTick ) );
+			return 0;
+		}
+
+		if ( fTickInSong == 0 ) {
+			// The target tick matches a multiple of the song size. We
+			// need to reproduce the context within the last tempo
+			// marker in order to get the mismatch right.
+			return finishFrame( fNewFrame, 0, 0, m_fFirstMarkerTick,
+								m_segments.back().fTickSize,
+								m_segments.size(), fTickMismatch );
+		}
+
+		nSegment = findSegmentByTick( fTickInSong );
+		if ( nSegment == -1 ) {
+			nSegment = m_segments.size() - 1;
+		}
+		fNewFrame += m_segments[ nSegment ].fStartFrame;
+	}
+	else {
+		fNewFrame = m_segments[ nSegment ].fStartFrame;
+	}
+
+	const auto& segment = m_segments[ nSegment ];
+	return finishFrame( fNewFrame, segment.fStartTick,
+						fTickInSong - segment.fStartTick, segment.fEndTick,
+						segment.fTickSize, nSegment + 1, fTickMismatch );
+}
+
+long long TempoMap::finishFrame( double fNewFrame, const double fPassedTicks,
+								 const double fRemainingTicks,
+								 const double fNextTick,
+								 const double fNextTickSize,
+								 const int nNextSegment,
+								 double* fTickMismatch ) const {
+	// The next frame is within this segment.
+	fNewFrame += fRemainingTicks * fNextTickSize;
+
+	const long long nNewFrame = static_cast<long long>( std::round( fNewFrame ) );
+
+	// Keep track of the rounding error to be able to switch between
+	// fTick and its frame counterpart later on. In case fTick is
+	// located close to a tempo marker we will only cover the part up
+	// to the tempo marker in here as only this region is governed by
+	// fNextTickSize.
+	const double fRoundingErrorInTicks =
+		( fNewFrame - static_cast<double>( nNewFrame ) ) / fNextTickSize;
+
+	// Compares the negative distance between current position
+	// (fNewFrame) and the one resulting from rounding -
+	// fRoundingErrorInTicks - with the negative distance between
+	// current position (fNewFrame) and location of next tempo marker.
+	if ( fRoundingErrorInTicks >
+		 fPassedTicks + fRemainingTicks - fNextTick ) {
+		// Whole mismatch located within the current tempo interval.
+		*fTickMismatch = fRoundingErrorInTicks;
+	}
+	else {
+		// Mismatch at this side of the tempo marker.
+		*fTickMismatch = fPassedTicks + fRemainingTicks - fNextTick;
+
+		const double fFinalFrame = fNewFrame +
+			( fNextTick - fPassedTicks - fRemainingTicks ) * fNextTickSize;
+
+		// Mismatch located beyond the tempo marker.
+		const double fFinalTickSize = nNextSegment < m_segments.size() ?
+			m_segments[ nNextSegment ].fTickSize : m_segments[ 0 ].fTickSize;
+
+		*fTickMismatch += ( fFinalFrame - static_cast<double>(nNewFrame) ) /
+			fFinalTickSize;
+	}
+
+	return nNewFrame;
+}
+
+double TempoMap::computeTickFromFrame( const long long nFrame ) const {
+	if ( nFrame <= 0 || m_segments.size() == 0 ) {
+		return 0;
+	}
+
+	// We are using double precision in here to avoid rounding errors.
+	const double fTargetFrame = static_cast<double>(nFrame);
+	double fTick = 0;
+	double fPassedFrames = 0;
+
+	int nSegment = findSegmentByFrame( fTargetFrame, 0 );
+	if ( nSegment == -1 ) {
+		// The provided nFrame is larger than the song.
+		const int nRepetitions =
+			std::floor( fTargetFrame / m_fSongSizeInFrames );
+		if ( m_fSongSizeInTicks * nRepetitions >
+			 std::numeric_limits<double>::max() ) {
+			ERRORLOG( QString( "Provided frames [%1] are too large." ).arg( nFrame ) );
+			return 0;
+		}
+		fTick = m_fSongSizeInTicks * nRepetitions;
+		fPassedFrames = static_cast<double>(nRepetitions) * m_fSongSizeInFrames;
+
+		if ( fPassedFrames == fTargetFrame ) {
+			return fTick;
+		}
+
+		nSegment = findSegmentByFrame( fTargetFrame, fPassedFrames );
+		if ( nSegment == -1 ) {
+			nSegment = m_segments.size() - 1;
+		}
+		fPassedFrames += m_segments[ nSegment ].fStartFrame;
+	}
+	else {
+		fPassedFrames = m_segments[ nSegment ].fStartFrame;
+	}
+
+	const auto& segment = m_segments[ nSegment ];
+	fTick += segment.fStartTick;
+	fTick += ( fTargetFrame - fPassedFrames ) / segment.fTickSize;
+
+	return fTick;
+}
+
+QString TempoMap::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[TempoMap]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_fSongSizeInTicks: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_fSongSizeInTicks ) )
+			.append( QString( "%1%2m_fSongSizeInFrames: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_fSongSizeInFrames, 0, 'f' ) )
+			.append( QString( "%1%2m_nTimelineRevision: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nTimelineRevision ) )
+			.append( QString( "%1%2m_nColumns: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nColumns ) )
+			.append( QString( "%1%2m_nSampleRate: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nSampleRate ) )
+			.append( QString( "%1%2m_segments:\n" ).arg( sPrefix ).arg( s ) );
+		for ( const auto& segment : m_segments ) {
+			sOutput.append( QString( "%1%2%2[%3, %4] tick size: %5, start frame: %6\n" )
+							.arg( sPrefix ).arg( s ).arg( segment.fStartTick )
+							.arg( segment.fEndTick ).arg( segment.fTickSize, 0, 'f' )
+							.arg( segment.fStartFrame, 0, 'f' ) );
+		}
+	}
+	else {
+		sOutput = QString( "[TempoMap] m_fSongSizeInTicks: %1" )
+			.arg( m_fSongSizeInTicks )
+			.append( QString( ", m_fSongSizeInFrames: %1" )
+					 .arg( m_fSongSizeInFrames, 0, 'f' ) )
+			.append( QString( ", m_nTimelineRevision: %1" ).arg( m_nTimelineRevision ) )
+			.append( QString( ", m_nColumns: %1" ).arg( m_nColumns ) )
+			.append( QString( ", m_nSampleRate: %1" ).arg( m_nSampleRate ) )
+			.append( QString( ", segments: %1" ).arg( m_segments.size() ) );
+	}
+
+	return sOutput;
+}
+
+};
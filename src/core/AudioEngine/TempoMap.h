@@ -0,0 +1,131 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_TEMPO_MAP_H
+#define H2C_TEMPO_MAP_H
+
+#include <memory>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class Song;
+class Timeline;
+
+/**
+ * Precomputed conversion between ticks and frames of a #Song with an
+ * active #Timeline.
+ *
+ * Each tempo marker spans a segment of the song. Their start ticks
+ * and frames are accumulated once - in the very same order
+ * TransportPosition used to do on every call - so a conversion only
+ * requires a binary search over the segments instead of walking all
+ * tempo markers and summing up all columns prior to each of them.
+ *
+ * A map is immutable and only valid for the song, Timeline revision,
+ * song size, and sample rate it was built with (see isValidFor()). The
+ * #AudioEngine caches the maps currently in use (see
+ * AudioEngine::getTempoMap()).
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class TempoMap : public H2Core::Object<TempoMap>
+{
+	H2_OBJECT(TempoMap)
+public:
+	TempoMap( std::shared_ptr<Song> pSong, std::shared_ptr<Timeline> pTimeline,
+			  double fSongSizeInTicks, int nSampleRate );
+
+	/** Whether the map was built using the provided parameters. */
+	bool isValidFor( const std::shared_ptr<Song>& pSong,
+					 const Timeline* pTimeline, int nTimelineRevision,
+					 double fSongSizeInTicks, int nColumns,
+					 int nSampleRate ) const;
+
+	/** See TransportPosition::computeFrameFromTick() */
+	long long computeFrameFromTick( double fTick, double* fTickMismatch ) const;
+	/** See TransportPosition::computeTickFromFrame() */
+	double computeTickFromFrame( long long nFrame ) const;
+
+	int getSampleRate() const;
+	int getNumberOfSegments() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	/** Part of the song governed by a single tempo marker. */
+	struct Segment {
+		double fStartTick;
+		double fEndTick;
+		double fTickSize;
+		double fStartFrame;
+		/** Length of the segment in frames. */
+		double fFrames;
+	};
+
+	/** \return First segment not ending before @a fTick or -1 if
+	 *   @a fTick is located beyond the end of the song. */
+	int findSegmentByTick( double fTick ) const;
+	/** \return First segment containing @a fFrame when starting at
+	 *   @a fOffset or -1 if @a fFrame is located beyond the end of
+	 *   the song. */
+	int findSegmentByFrame( double fFrame, double fOffset ) const;
+
+	/** Rounds @a fNewFrame and computes the resulting tick mismatch
+	 * given that the position is located @a fRemainingTicks after
+	 * @a fPassedTicks within a segment ending at @a fNextTick. */
+	long long finishFrame( double fNewFrame, double fPassedTicks,
+						   double fRemainingTicks, double fNextTick,
+						   double fNextTickSize, int nNextSegment,
+						   double* fTickMismatch ) const;
+
+	std::vector<Segment> m_segments;
+	double m_fSongSizeInTicks;
+	double m_fSongSizeInFrames;
+	/** Tick of the column of the first tempo marker. */
+	double m_fFirstMarkerTick;
+
+	/** Owning the #Timeline ensures its address is not reused by
+	 * another one while the map is still around. Else, a map of a
+	 * deleted #Timeline with the same revision would be considered
+	 * valid. */
+	std::shared_ptr<const Timeline> m_pTimeline;
+	/** Compared by ownership so a song loaded at the address of a
+	 * deleted one is not mistaken for it. */
+	std::weak_ptr<const Song> m_pSong;
+	int m_nTimelineRevision;
+	int m_nColumns;
+	int m_nSampleRate;
+};
+
+inline int TempoMap::getSampleRate() const {
+	return m_nSampleRate;
+}
+inline int TempoMap::getNumberOfSegments() const {
+	return static_cast<int>(m_segments.size());
+}
+
+};
+
+#endif // H2C_TEMPO_MAP_H
@@ -88,6 +88,8 @@ public:
 	 * passed tempo markers into account in order to determine the
 	 * number of ticks passed when letting the #AudioEngine roll for
 	 * @a nFrame frames.
+	 * The segments between the markers are precomputed in a
+	 * #TempoMap (see AudioEngine::getTempoMap()).
 	 *
 	 * It depends on the sample rate @a nSampleRate and assumes that
 	 * it as well as the resolution to be constant over the whole
@@ -107,6 +109,8 @@ public:
 	 * passed tempo markers into account in order to determine the
 	 * number of frames passed when letting the #AudioEngine roll for
 	 * @a fTick ticks.
+	 * The segments between the markers are precomputed in a
+	 * #TempoMap (see AudioEngine::getTempoMap()).
 	 *
 	 * It depends on the sample rate @a nSampleRate and assumes that
 	 * it as well as the resolution to be constant over the whole
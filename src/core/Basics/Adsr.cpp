@@ -62,6 +62,24 @@ ADSR::ADSR( const std::shared_ptr<ADSR> other ) :
 
 ADSR::~ADSR() { }
 
+void ADSR::copyFrom( const std::shared_ptr<ADSR> other )
+{
+	if ( other == nullptr ) {
+		return;
+	}
+
+	m_nAttack = other->m_nAttack;
+	m_nDecay = other->m_nDecay;
+	m_fSustain = other->m_fSustain;
+	m_nRelease = other->m_nRelease;
+	m_state = other->m_state;
+	m_fFramesInState = other->m_fFramesInState;
+	m_fValue = other->m_fValue;
+	m_fReleaseValue = other->m_fReleaseValue;
+	m_fQ = other->m_fQ;
+	normalise();
+}
+
 void ADSR::normalise()
 {
 	if (m_nAttack < 0.0) {
@@ -51,6 +51,11 @@ class ADSR : public Object<ADSR>
 		/** copy constructor */
 		ADSR( const std::shared_ptr<ADSR> other );
 
+		/** Assigns all parameters and the processing state of @a other to
+		 * this instance without allocating a new one. Used when recycling
+		 * pooled #H2Core::Note. */
+		void copyFrom( const std::shared_ptr<ADSR> other );
+
 		/** destructor */
 		~ADSR();
 
@@ -117,6 +122,8 @@ class ADSR : public Object<ADSR>
 	static QString StateToQString( const State& state );
 
 		const State& getState() const;
+		/** \return #m_fValue */
+		float getValue() const;
 
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
@@ -199,6 +206,10 @@ inline const ADSR::State& ADSR::getState() const {
 	return m_state;
 }
 
+inline float ADSR::getValue() const {
+	return m_fValue;
+}
+
 };
 
 #endif // H2C_ADRS_H
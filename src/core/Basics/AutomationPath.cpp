@@ -24,15 +24,50 @@
 #include <core/Basics/Song.h>
 #include <core/Hydrogen.h>
 
+#include <atomic>
+#include <limits>
+
 namespace H2Core
 {
 
+static unsigned next_revision()
+{
+	static std::atomic<unsigned> revisions( 0 );
+	unsigned revision = ++revisions;
+	if ( revision == 0 ) {
+		// Reserved for unset cursors.
+		revision = ++revisions;
+	}
+	return revision;
+}
+
 AutomationPath::AutomationPath(float min, float max, float def)
 	: Object(),
 	  _min(min),
 	  _max(max),
-	  _def(def)
+	  _def(def),
+	  _revision(next_revision())
+{
+}
+
+AutomationPath::Cursor::Cursor()
+	: _revision(0),
+	  _lo(0),
+	  _hi(0),
+	  _lo_inclusive(false),
+	  _hi_inclusive(false),
+	  _flat(true),
+	  _x0(0),
+	  _y0(0),
+	  _x1(0),
+	  _y1(0)
+{
+}
+
+bool AutomationPath::Cursor::contains(float x) const noexcept
 {
+	return ( _lo_inclusive ? x >= _lo : x > _lo ) &&
+		( _hi_inclusive ? x <= _hi : x < _hi );
 }
 
 
@@ -71,6 +106,79 @@ float AutomationPath::get_value(float x) const noexcept
 	return y1 + (y2-y1)*d;
 }
 
+float AutomationPath::get_value(float x, Cursor &cursor) const noexcept
+{
+	if ( cursor._revision != _revision || ! cursor.contains(x) ) {
+		seek(x, cursor);
+	}
+
+	if ( cursor._flat ) {
+		return cursor._y0;
+	}
+
+	float d = (x-cursor._x0)/(cursor._x1 - cursor._x0);
+
+	return cursor._y0 + (cursor._y1-cursor._y0)*d;
+}
+
+/**
+ * \brief Store the segment containing a location in a cursor
+ *
+ * Segments are chosen such that get_value( float, Cursor& ) yields
+ * the very same results as get_value( float ).
+ **/
+void AutomationPath::seek(float x, Cursor &cursor) const noexcept
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	cursor._revision = _revision;
+
+	if (_points.empty()) {
+		cursor._lo = -inf;
+		cursor._hi = inf;
+		cursor._lo_inclusive = true;
+		cursor._hi_inclusive = true;
+		cursor._flat = true;
+		cursor._y0 = _def;
+		return;
+	}
+
+	auto f = _points.begin();
+	if(x <= f->first) {
+		cursor._lo = -inf;
+		cursor._hi = f->first;
+		cursor._lo_inclusive = true;
+		cursor._hi_inclusive = true;
+		cursor._flat = true;
+		cursor._y0 = f->second;
+		return;
+	}
+
+	auto l = _points.rbegin();
+	if(x >= l->first) {
+		cursor._lo = l->first;
+		cursor._hi = inf;
+		cursor._lo_inclusive = true;
+		cursor._hi_inclusive = true;
+		cursor._flat = true;
+		cursor._y0 = l->second;
+		return;
+	}
+
+	auto i = _points.lower_bound(x);
+	auto p1 = *i;
+	auto p0 = *(--i);
+	cursor._lo = p0.first;
+	cursor._hi = p1.first;
+	cursor._lo_inclusive = false;
+	// The last point itself belongs to the flat segment after it.
+	cursor._hi_inclusive = p1.first != l->first;
+	cursor._flat = false;
+	cursor._x0 = p0.first;
+	cursor._y0 = p0.second;
+	cursor._x1 = p1.first;
+	cursor._y1 = p1.second;
+}
+
 
 /**
  * \brief Add a point to path
@@ -80,6 +188,7 @@ float AutomationPath::get_value(float x) const noexcept
 void AutomationPath::add_point(float x, float y)
 {
 	_points[x] = y;
+	_revision = next_revision();
 	Hydrogen::get_instance()->setIsModified( true );
 }
 
@@ -177,6 +286,7 @@ AutomationPath::iterator AutomationPath::move(iterator &in, float x, float y)
 {
 	_points.erase(in);
 	auto rv = _points.insert(std::make_pair(x,y));
+	_revision = next_revision();
 	Hydrogen::get_instance()->setIsModified( true );
 	return rv.first;
 }
@@ -191,6 +301,7 @@ void AutomationPath::remove_point(float x)
 	auto it = find(x);
 	if (it != _points.end()) {
 		_points.erase(it);
+		_revision = next_revision();
 	}
 	Hydrogen::get_instance()->setIsModified( true );
 }
@@ -42,6 +42,39 @@ class AutomationPath : public Object<AutomationPath>
 	typedef std::map<float,float>::iterator iterator;
 	typedef std::map<float,float>::const_iterator const_iterator;
 
+	/**
+	 * Remembers the segment of a path the last value was taken from.
+	 *
+	 * Evaluating a path at increasing locations - like the audio
+	 * engine does while queuing notes - only requires a search once
+	 * a new segment is entered. Every caller should use a cursor of
+	 * its own. It can be shared between different paths but then
+	 * loses its benefit.
+	 */
+	class Cursor {
+		public:
+		Cursor();
+
+		private:
+		friend class AutomationPath;
+
+		bool contains(float x) const noexcept;
+
+		/** Revision of the path the segment belongs to. 0 if unset. */
+		unsigned _revision;
+		float _lo;
+		float _hi;
+		bool _lo_inclusive;
+		bool _hi_inclusive;
+		/** Constant value of #_y0 before the first and after the last
+		 * point. */
+		bool _flat;
+		float _x0;
+		float _y0;
+		float _x1;
+		float _y1;
+	};
+
 	private:
 	
 	float _min;
@@ -49,6 +82,11 @@ class AutomationPath : public Object<AutomationPath>
 	float _def;
 
 	std::map<float,float> _points;
+	/** Unique across all paths and updated on each modification in
+	 * order to invalidate Cursors. */
+	unsigned _revision;
+
+	void seek(float x, Cursor &cursor) const noexcept;
 
 	public:
 	
@@ -60,6 +98,9 @@ class AutomationPath : public Object<AutomationPath>
 	float get_default() const noexcept { return _def; }
 
 	float get_value(float x) const noexcept;
+	/** Same as get_value( float ) but starts searching from the
+	 * segment stored in @a cursor. */
+	float get_value(float x, Cursor &cursor) const noexcept;
 
 	void add_point(float x, float y);
 	void remove_point(float x);
@@ -87,6 +87,8 @@ QString Event::TypeToQString( Event::Type type ) {
 		return "Relocation";
 	case Event::Type::SelectedInstrumentChanged:
 		return "SelectedInstrumentChanged";
+	case Event::Type::SampleLoadingProgress:
+		return "SampleLoadingProgress";
 	case Event::Type::SelectedPatternChanged:
 		return "SelectedPatternChanged";
 	case Event::Type::SongModeActivation:
@@ -101,6 +103,8 @@ QString Event::TypeToQString( Event::Type type ) {
 		return "StackedModeActivation";
 	case Event::Type::State:
 		return "State";
+	case Event::Type::StreamUnderrun:
+		return "StreamUnderrun";
 	case Event::Type::TempoChanged:
 		return "TempoChanged";
 	case Event::Type::TimelineActivation:
@@ -164,6 +164,10 @@ public:
 			 * the very end of the song in song mode.
 			 */
 			Relocation,
+			/** Progress of InstrumentList::loadSamples(). Pushed
+			 * whenever all samples of an instrument were loaded. The
+			 * value holds the percentage of instruments done. */
+			SampleLoadingProgress,
 			/** Another pattern was selected via MIDI or the GUI without
 			 * affecting the audio transport. While the selection in the former
 			 * case already happens in the GUI, this event will be used to tell
@@ -181,6 +185,10 @@ public:
 				(1) was activated */
 			StackedModeActivation,
 			State,
+			/** The #SampleStreamer was not able to prefetch the frames
+			 * of streamed samples in time. The value holds the number
+			 * of underruns since the last event. */
+			StreamUnderrun,
 			TempoChanged,
 			/** Enables/disables the usage of the Timeline.*/
 			TimelineActivation,
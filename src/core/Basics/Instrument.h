@@ -349,7 +349,7 @@ class Instrument : public H2Core::Object<Instrument>
 		bool					m_bSoloed;				///< is the instrument in solo mode?
 		bool					m_bMuted;				///< is the instrument muted?
 		int						m_nMuteGroup;			///< mute group of the instrument
-		int						m_nQueued;				///< count the number of notes queued within Sampler::m_playingNotesQueue or std::priority_queue m_songNoteQueue
+		int						m_nQueued;				///< count the number of notes queued within the voices of Sampler or AudioEngine::m_songNoteQueue
 		/** List of short string representations of notes for which this
 		 * instrument was enqueued. */
 		QStringList				m_enqueuedBy;
@@ -91,7 +91,11 @@ void InstrumentLayer::setPitch( float fValue )
 void InstrumentLayer::loadSample( float fBpm )
 {
 	if ( m_pSample != nullptr ) {
-		m_pSample->load( fBpm );
+		const auto pPref = Preferences::get_instance();
+		m_pSample->load( fBpm, pPref != nullptr ?
+						 pPref->m_nSampleStreamingHead : 0, true,
+						 pPref != nullptr ? pPref->m_sampleStorage :
+						 ResampleKernels::Format::Float );
 	}
 }
 
@@ -99,7 +99,9 @@ namespace H2Core
 
 		/**
 		 * Calls the #H2Core::Sample::load()
-		 * member function of #m_pSample.
+		 * member function of #m_pSample. Large samples are streamed
+		 * in case Preferences::m_nSampleStreamingHead is set. Decoded
+		 * data is shared via the #SampleCache.
 		 */
 		void loadSample( float fBpm = 120 );
 		/*
@@ -27,15 +27,26 @@
 #include <core/Basics/Note.h>
 #include <core/Basics/Sample.h>
 
+#include <core/EventQueue.h>
+#include <core/Helpers/Parallel.h>
 #include <core/Helpers/Xml.h>
 #include <core/IO/MidiCommon.h>
 #include <core/License.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <set>
 
+#include <QFileInfo>
+
 namespace H2Core
 {
 
+/** Upper bound of the memory estimated to be in use by samples
+ * decoded concurrently in InstrumentList::loadSamples(). */
+static constexpr long long nMaxLoadingBytes = 512LL * 1024 * 1024;
+
 InstrumentList::InstrumentList()
 {
 }
@@ -55,9 +66,83 @@ InstrumentList::~InstrumentList()
 
 void InstrumentList::loadSamples( float fBpm )
 {
-	for( int i=0; i<m_pInstruments.size(); i++ ) {
-		m_pInstruments[i]->loadSamples( fBpm );
+	struct Task {
+		std::shared_ptr<InstrumentLayer> pLayer;
+		int nInstrument;
+		/** Rough estimate of the memory required while decoding. */
+		long long nBytes;
+	};
+
+	// Samples shared by several layers are loaded just once.
+	std::vector<Task> tasks;
+	std::vector<int> remainingTasks( m_pInstruments.size(), 0 );
+	std::set<Sample*> samples;
+	for ( int ii = 0; ii < m_pInstruments.size(); ++ii ) {
+		for ( const auto& ppComponent : *m_pInstruments[ ii ]->getComponents() ) {
+			for ( int nnLayer = 0; nnLayer < InstrumentComponent::getMaxLayers();
+				  ++nnLayer ) {
+				auto pLayer = ppComponent->getLayer( nnLayer );
+				if ( pLayer == nullptr || pLayer->getSample() == nullptr ||
+					 ! samples.insert( pLayer->getSample().get() ).second ) {
+					continue;
+				}
+				// Interleaved float buffer plus the resulting channels.
+				const long long nBytes = 4 *
+					QFileInfo( pLayer->getSample()->getFilepath() ).size();
+				tasks.push_back( { pLayer, ii, nBytes } );
+				++remainingTasks[ ii ];
+			}
+		}
+	}
+	if ( tasks.size() == 0 ) {
+		return;
 	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	int nNextTask = 0;
+	long long nBytesInFlight = 0;
+	int nLoadedInstruments = std::count(
+		remainingTasks.begin(), remainingTasks.end(), 0 );
+
+	auto work = [&]() {
+		while ( true ) {
+			std::unique_lock<std::mutex> lock( mutex );
+			if ( nNextTask >= tasks.size() ) {
+				return;
+			}
+			const auto& task = tasks[ nNextTask ];
+			++nNextTask;
+
+			// Bound the memory used for decoding. Samples exceeding
+			// the limit on their own are loaded one at a time.
+			condition.wait( lock, [&]() {
+				return nBytesInFlight == 0 ||
+					nBytesInFlight + task.nBytes <= nMaxLoadingBytes; } );
+			nBytesInFlight += task.nBytes;
+			lock.unlock();
+
+			task.pLayer->loadSample( fBpm );
+
+			lock.lock();
+			nBytesInFlight -= task.nBytes;
+			int nProgress = -1;
+			if ( --remainingTasks[ task.nInstrument ] == 0 ) {
+				++nLoadedInstruments;
+				nProgress = 100 * nLoadedInstruments / m_pInstruments.size();
+			}
+			lock.unlock();
+			condition.notify_all();
+
+			auto pEventQueue = EventQueue::get_instance();
+			if ( nProgress != -1 && pEventQueue != nullptr ) {
+				pEventQueue->pushEvent( Event::Type::SampleLoadingProgress,
+										nProgress );
+			}
+		}
+	};
+
+	Parallel::run( Parallel::getThreadCount( tasks.size() ), work );
 }
 
 void InstrumentList::unloadSamples()
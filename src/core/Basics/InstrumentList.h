@@ -149,8 +149,12 @@ class InstrumentList : public H2Core::Object<InstrumentList>
 		 */
 		void move( int idx_a, int idx_b );
 
-		/** Calls the Instrument::loadSamples() member
-		 * function of all Instruments in #m_pInstruments.
+		/** Loads the samples of all layers of all Instruments in
+		 * #m_pInstruments using Preferences::m_nSampleLoadingThreads
+		 * threads.
+		 *
+		 * Pushes an #Event::Type::SampleLoadingProgress whenever all
+		 * samples of an instrument were loaded.
 		 */
 		void loadSamples( float fBpm = 120 );
 		/** Calls the Instrument::unloadSamples() member
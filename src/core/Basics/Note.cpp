@@ -22,6 +22,7 @@
 
 #include <core/Basics/Note.h>
 
+#include <algorithm>
 #include <cassert>
 
 #include <core/AudioEngine/AudioEngine.h>
@@ -47,7 +48,8 @@ const char* Note::m_keyStr[] = { "C", "Cs", "D", "Ef", "E", "F", "Fs", "G", "Af"
 
 SelectedLayerInfo::SelectedLayerInfo() : pLayer( nullptr )
 									   , fSamplePosition( 0.0 )
-									   , nNoteLength( LENGTH_ENTIRE_SAMPLE ) {
+									   , nNoteLength( LENGTH_ENTIRE_SAMPLE )
+									   , nStream( -1 ) {
 }
 SelectedLayerInfo::~SelectedLayerInfo() {}
 
@@ -61,7 +63,9 @@ QString SelectedLayerInfo::toQString( const QString& sPrefix, bool bShort ) cons
 			.append( QString( "%1%2fSamplePosition: %3\n" ).arg( sPrefix )
 					 .arg( s ).arg( fSamplePosition ) )
 			.append( QString( "%1%2nNoteLength: %3\n" ).arg( sPrefix )
-					 .arg( s ).arg( nNoteLength ) );
+					 .arg( s ).arg( nNoteLength ) )
+			.append( QString( "%1%2nStream: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( nStream ) );
 	}
 	else {
 		sOutput = QString( "[SelectedLayerInfo] " )
@@ -70,7 +74,8 @@ QString SelectedLayerInfo::toQString( const QString& sPrefix, bool bShort ) cons
 			.append( QString( ", fSamplePosition: %1" )
 					 .arg( fSamplePosition ) )
 			.append( QString( ", nNoteLength: %1" )
-					 .arg( nNoteLength ) );
+					 .arg( nNoteLength ) )
+			.append( QString( ", nStream: %1" ).arg( nStream ) );
 	}
 
 	return sOutput;
@@ -94,6 +99,8 @@ Note::Note( std::shared_ptr<Instrument> pInstrument, int nPosition,
 	  m_fBpfbR( 0.0 ),
 	  m_fLpfbL( 0.0 ),
 	  m_fLpfbR( 0.0 ),
+	  m_fFilterCutoff( -1.0 ),
+	  m_fFilterResonance( -1.0 ),
 	  m_nMidiMsg( -1 ),
 	  m_bNoteOff( false ),
 	  m_fProbability( PROBABILITY_DEFAULT ),
@@ -127,6 +134,8 @@ Note::Note( std::shared_ptr<Note> pOther )
 	  m_fBpfbR( pOther->m_fBpfbR ),
 	  m_fLpfbL( pOther->m_fLpfbL ),
 	  m_fLpfbR( pOther->m_fLpfbR ),
+	  m_fFilterCutoff( pOther->m_fFilterCutoff ),
+	  m_fFilterResonance( pOther->m_fFilterResonance ),
 	  m_nMidiMsg( pOther->getMidiMsg() ),
 	  m_bNoteOff( pOther->getNoteOff() ),
 	  m_fProbability( pOther->getProbability() ),
@@ -138,31 +147,167 @@ Note::Note( std::shared_ptr<Note> pOther )
 		m_pAdsr = m_pInstrument->copyAdsr();
 		m_nInstrumentId = m_pInstrument->getId();
 
-		for ( const auto& [ ppOtherComponent, ppOtherSelectedLayerInfo ] :
-				  pOther->m_selectedLayerInfoMap ) {
-			if ( ppOtherComponent != nullptr &&
-				 ppOtherSelectedLayerInfo != nullptr ) {
-				// We took a deep copy of the instrument and have to ensure we
-				// point to the right component.
-				auto pComponent = m_pInstrument->getComponent(
-					pOther->m_pInstrument->index( ppOtherComponent ) );
-				if ( pComponent == nullptr ) {
-					continue;
-				}
+		copySelectedLayerInfos( pOther );
+	}
+}
+
+Note::~Note() {
+}
 
-				auto pSelectedLayerInfo = std::make_shared<SelectedLayerInfo>();
-				pSelectedLayerInfo->pLayer = ppOtherSelectedLayerInfo->pLayer;
-				pSelectedLayerInfo->fSamplePosition =
-					ppOtherSelectedLayerInfo->fSamplePosition;
-				pSelectedLayerInfo->nNoteLength = ppOtherSelectedLayerInfo->nNoteLength;
-		
-				setSelectedLayerInfo( pSelectedLayerInfo, pComponent );
+void Note::copyFrom( std::shared_ptr<Note> pOther ) {
+	if ( pOther == nullptr ) {
+		ERRORLOG( "Invalid note" );
+		return;
+	}
+
+	m_nInstrumentId = pOther->getInstrumentId();
+	m_sType = pOther->getType();
+	m_nPosition = pOther->getPosition();
+	m_fVelocity = pOther->getVelocity();
+	m_fPan = pOther->getPan();
+	m_nLength = pOther->getLength();
+	m_fPitch = pOther->getPitch();
+	m_key = pOther->getKey();
+	m_octave = pOther->getOctave();
+	m_fLeadLag = pOther->getLeadLag();
+	m_nHumanizeDelay = pOther->getHumanizeDelay();
+	m_fBpfbL = pOther->m_fBpfbL;
+	m_fBpfbR = pOther->m_fBpfbR;
+	m_fLpfbL = pOther->m_fLpfbL;
+	m_fLpfbR = pOther->m_fLpfbR;
+	m_fFilterCutoff = pOther->m_fFilterCutoff;
+	m_fFilterResonance = pOther->m_fFilterResonance;
+	m_nMidiMsg = pOther->getMidiMsg();
+	m_bNoteOff = pOther->getNoteOff();
+	m_fProbability = pOther->getProbability();
+	m_nNoteStart = pOther->getNoteStart();
+	m_fUsedTickSize = pOther->getUsedTickSize();
+	m_pInstrument = pOther->getInstrument();
+	recycleSelectedLayerInfos();
+
+	if ( m_pInstrument != nullptr ) {
+		if ( m_pAdsr != nullptr ) {
+			m_pAdsr->copyFrom( m_pInstrument->getAdsr() );
+		} else {
+			m_pAdsr = m_pInstrument->copyAdsr();
+		}
+		m_nInstrumentId = m_pInstrument->getId();
+
+		copySelectedLayerInfos( pOther );
+	}
+	else {
+		m_pAdsr = nullptr;
+	}
+}
+
+void Note::reset( std::shared_ptr<Instrument> pInstrument, int nPosition,
+				  float fVelocity, float fPan, int nLength, float fPitch ) {
+	m_nInstrumentId = EMPTY_INSTR_ID;
+	m_sType = "";
+	m_nPosition = nPosition;
+	m_fVelocity = fVelocity;
+	m_nLength = nLength;
+	m_fPitch = fPitch;
+	m_key = static_cast<Note::Key>(KEY_MIN);
+	m_octave = static_cast<Note::Octave>(OCTAVE_DEFAULT);
+	m_fLeadLag = LEAD_LAG_DEFAULT;
+	m_nHumanizeDelay = 0;
+	m_fBpfbL = 0.0;
+	m_fBpfbR = 0.0;
+	m_fLpfbL = 0.0;
+	m_fLpfbR = 0.0;
+	m_fFilterCutoff = -1.0;
+	m_fFilterResonance = -1.0;
+	m_nMidiMsg = -1;
+	m_bNoteOff = false;
+	m_fProbability = PROBABILITY_DEFAULT;
+	m_nNoteStart = 0;
+	m_fUsedTickSize = std::nan("");
+	m_pInstrument = pInstrument;
+	recycleSelectedLayerInfos();
+
+	if ( pInstrument != nullptr ) {
+		if ( m_pAdsr != nullptr ) {
+			m_pAdsr->copyFrom( pInstrument->getAdsr() );
+		} else {
+			m_pAdsr = pInstrument->copyAdsr();
+		}
+		m_nInstrumentId = pInstrument->getId();
+		m_sType = pInstrument->getType();
+	}
+	else {
+		m_pAdsr = nullptr;
+	}
+
+	setPan( fPan ); // this checks the boundaries
+}
+
+void Note::copySelectedLayerInfos( std::shared_ptr<Note> pOther ) {
+	if ( pOther == nullptr || pOther->m_pInstrument == nullptr ||
+		 m_pInstrument == nullptr ) {
+		return;
+	}
+
+	for ( const auto& [ ppOtherComponent, ppOtherSelectedLayerInfo ] :
+			  pOther->m_selectedLayerInfoMap ) {
+		if ( ppOtherComponent != nullptr &&
+			 ppOtherSelectedLayerInfo != nullptr ) {
+			// We took a deep copy of the instrument and have to ensure we
+			// point to the right component.
+			auto pComponent = m_pInstrument->getComponent(
+				pOther->m_pInstrument->index( ppOtherComponent ) );
+			if ( pComponent == nullptr ) {
+				continue;
 			}
+
+			auto pSelectedLayerInfo = obtainSelectedLayerInfo( pComponent );
+			pSelectedLayerInfo->pLayer = ppOtherSelectedLayerInfo->pLayer;
+			pSelectedLayerInfo->fSamplePosition =
+				ppOtherSelectedLayerInfo->fSamplePosition;
+			pSelectedLayerInfo->nNoteLength = ppOtherSelectedLayerInfo->nNoteLength;
 		}
 	}
 }
 
-Note::~Note() {
+void Note::recycleSelectedLayerInfos() {
+	while ( ! m_selectedLayerInfoMap.empty() ) {
+		m_spareLayerInfoNodes.push_back(
+			m_selectedLayerInfoMap.extract( m_selectedLayerInfoMap.begin() ) );
+	}
+}
+
+std::shared_ptr<SelectedLayerInfo> Note::obtainSelectedLayerInfo(
+	std::shared_ptr<InstrumentComponent> pComponent )
+{
+	// Infos still referenced elsewhere, e.g. ones provided via
+	// setSelectedLayerInfo(), must not be altered.
+	auto reuse = []( std::shared_ptr<SelectedLayerInfo>& ppInfo ) {
+		if ( ppInfo == nullptr || ppInfo.use_count() > 1 ) {
+			ppInfo = std::make_shared<SelectedLayerInfo>();
+		}
+		else {
+			*ppInfo = SelectedLayerInfo();
+		}
+	};
+
+	auto it = m_selectedLayerInfoMap.find( pComponent );
+	if ( it != m_selectedLayerInfoMap.end() ) {
+		reuse( it->second );
+		return it->second;
+	}
+
+	if ( m_spareLayerInfoNodes.empty() ) {
+		auto pInfo = std::make_shared<SelectedLayerInfo>();
+		m_selectedLayerInfoMap[ pComponent ] = pInfo;
+		return pInfo;
+	}
+
+	auto node = std::move( m_spareLayerInfoNodes.back() );
+	m_spareLayerInfoNodes.pop_back();
+	node.key() = pComponent;
+	reuse( node.mapped() );
+
+	return m_selectedLayerInfoMap.insert( std::move( node ) ).position->second;
 }
 
 static inline float check_boundary( float fValue, float fMin, float fMax )
@@ -202,18 +347,50 @@ void Note::mapTo( std::shared_ptr<Drumkit> pDrumkit,
 		ERRORLOG( "Invalid drumkit" );
 		return;
 	}
-	const auto pDrumkitMap = pDrumkit->toDrumkitMap();
+
+	mapTo( pDrumkit, pDrumkit->toDrumkitMap(), pOldDrumkit, nullptr );
+}
+
+void Note::mapTo( std::shared_ptr<Drumkit> pDrumkit,
+				  std::shared_ptr<DrumkitMap> pDrumkitMap,
+				  std::shared_ptr<Drumkit> pOldDrumkit,
+				  std::shared_ptr<DrumkitMap> pOldDrumkitMap )
+{
+	if ( pDrumkit == nullptr || pDrumkitMap == nullptr ) {
+		ERRORLOG( "Invalid drumkit" );
+		return;
+	}
+
+	QString sType = m_sType;
+	const auto pInstrument = findMappedInstrument(
+		&sType, m_nInstrumentId, pDrumkit, pDrumkitMap, pOldDrumkit,
+		pOldDrumkitMap );
+
+	assignInstrument( pInstrument,
+					  pInstrument != nullptr ? pInstrument->copyAdsr() : nullptr,
+					  sType );
+}
+
+std::shared_ptr<Instrument> Note::findMappedInstrument(
+	QString* psType, int nInstrumentId, std::shared_ptr<Drumkit> pDrumkit,
+	std::shared_ptr<DrumkitMap> pDrumkitMap, std::shared_ptr<Drumkit> pOldDrumkit,
+	std::shared_ptr<DrumkitMap> pOldDrumkitMap )
+{
+	if ( pDrumkit == nullptr || pDrumkitMap == nullptr || psType == nullptr ) {
+		ERRORLOG( "Invalid input" );
+		return nullptr;
+	}
 
 	std::shared_ptr<Instrument> pInstrument = nullptr;
 
-	if ( ! m_sType.isEmpty() ) {
+	if ( ! psType->isEmpty() ) {
 		// In case the note features a type string, it can only be mapped to an
 		// instrument bearing the exact same type string. (At least
 		// automatically/in here. The user has various options to assign this
 		// note to arbitrary instruments in the pattern editor.)
 		if ( pDrumkitMap->getAllTypes().size() > 0 ) {
 			bool bFound;
-			const int nId = pDrumkitMap->getId( m_sType, &bFound );
+			const int nId = pDrumkitMap->getId( *psType, &bFound );
 			if ( bFound ) {
 				pInstrument = pDrumkit->getInstruments()->find( nId );
 			}
@@ -226,15 +403,17 @@ void Note::mapTo( std::shared_ptr<Drumkit> pDrumkit,
 				// Note that this is not supposed to work for an empty type.
 				// Initial type adding and type removal has to be done
 				// explicitly.
-				const auto pOldDrumkitMap = pOldDrumkit->toDrumkitMap();
-				const int nOldId = pOldDrumkitMap->getId( m_sType, &bFound );
+				if ( pOldDrumkitMap == nullptr ) {
+					pOldDrumkitMap = pOldDrumkit->toDrumkitMap();
+				}
+				const int nOldId = pOldDrumkitMap->getId( *psType, &bFound );
 				if ( pDrumkit->getPath() == pOldDrumkit->getPath() &&
 					 pDrumkit->getName() == pOldDrumkit->getName() &&
 					 bFound && nId != nOldId ) {
 					pInstrument = pDrumkit->getInstruments()->find( nOldId );
 					if ( pInstrument != nullptr &&
 						 ! pInstrument->getType().isEmpty() ) {
-						m_sType = pInstrument->getType();
+						*psType = pInstrument->getType();
 					}
 				}
 			}
@@ -254,13 +433,13 @@ void Note::mapTo( std::shared_ptr<Drumkit> pDrumkit,
 		// as is, the IDs of the instruments were overwritten in such a way it
 		// matched the order of the previous kit.
 		if ( pOldDrumkit != nullptr &&
-			 pOldDrumkit->getInstruments()->find( m_nInstrumentId ) != nullptr ) {
+			 pOldDrumkit->getInstruments()->find( nInstrumentId ) != nullptr ) {
 			pInstrument = pDrumkit->getInstruments()->get(
 				pOldDrumkit->getInstruments()->index(
-					pOldDrumkit->getInstruments()->find( m_nInstrumentId ) ) );
+					pOldDrumkit->getInstruments()->find( nInstrumentId ) ) );
 		}
 		else {
-			pInstrument = pDrumkit->getInstruments()->find( m_nInstrumentId );
+			pInstrument = pDrumkit->getInstruments()->find( nInstrumentId );
 		}
 
 		// For a clean and easy to grasp concept of the automated mapping,
@@ -271,14 +450,25 @@ void Note::mapTo( std::shared_ptr<Drumkit> pDrumkit,
 		}
 	}
 
+	if ( pInstrument == nullptr ) {
+		INFOLOG( QString( "No instrument was found for type [%1] and ID [%2]." )
+				 .arg( *psType ).arg( nInstrumentId ) );
+	}
+
+	return pInstrument;
+}
+
+void Note::assignInstrument( std::shared_ptr<Instrument> pInstrument,
+							 std::shared_ptr<ADSR> pAdsr,
+							 const QString& sType )
+{
 	if ( pInstrument != nullptr ) {
 		m_pInstrument = pInstrument;
-		m_pAdsr = pInstrument->copyAdsr();
+		m_pAdsr = pAdsr;
 		m_nInstrumentId = pInstrument->getId();
+		m_sType = sType;
 	}
 	else {
-		INFOLOG( QString( "No instrument was found for type [%1] and ID [%2]." )
-				 .arg( m_sType ).arg( m_nInstrumentId ) );
 		m_pInstrument = nullptr;
 		m_pAdsr = nullptr;
 	}
@@ -316,6 +506,70 @@ bool Note::isPartiallyRendered() const {
 	return false;
 }
 
+void Note::applyFilter( float* pBuffer_L, float* pBuffer_R, int nFrames ) {
+	if ( m_pInstrument == nullptr ) {
+		std::fill_n( pBuffer_L, nFrames, 0.0f );
+		std::fill_n( pBuffer_R, nFrames, 0.0f );
+		return;
+	}
+	if ( nFrames <= 0 ) {
+		return;
+	}
+
+	const float fTargetCutoff = m_pInstrument->getFilterCutoff();
+	const float fTargetResonance = m_pInstrument->getFilterResonance();
+	if ( m_fFilterCutoff < 0 ) {
+		m_fFilterCutoff = fTargetCutoff;
+		m_fFilterResonance = fTargetResonance;
+	}
+
+	// The filter states are kept in local variables in order to allow
+	// the compiler to hold them in registers throughout the loop.
+	float fBpfbL = m_fBpfbL;
+	float fBpfbR = m_fBpfbR;
+	float fLpfbL = m_fLpfbL;
+	float fLpfbR = m_fLpfbR;
+
+	if ( m_fFilterCutoff == fTargetCutoff &&
+		 m_fFilterResonance == fTargetResonance ) {
+		const float fCutoff = fTargetCutoff;
+		const float fResonance = fTargetResonance;
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			fBpfbL = fResonance * fBpfbL + fCutoff * ( pBuffer_L[ ii ] - fLpfbL );
+			fLpfbL += fCutoff * fBpfbL;
+			fBpfbR = fResonance * fBpfbR + fCutoff * ( pBuffer_R[ ii ] - fLpfbR );
+			fLpfbR += fCutoff * fBpfbR;
+			pBuffer_L[ ii ] = fLpfbL;
+			pBuffer_R[ ii ] = fLpfbR;
+		}
+	}
+	else {
+		const float fCutoffStep =
+			( fTargetCutoff - m_fFilterCutoff ) / nFrames;
+		const float fResonanceStep =
+			( fTargetResonance - m_fFilterResonance ) / nFrames;
+		float fCutoff = m_fFilterCutoff;
+		float fResonance = m_fFilterResonance;
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			fCutoff += fCutoffStep;
+			fResonance += fResonanceStep;
+			fBpfbL = fResonance * fBpfbL + fCutoff * ( pBuffer_L[ ii ] - fLpfbL );
+			fLpfbL += fCutoff * fBpfbL;
+			fBpfbR = fResonance * fBpfbR + fCutoff * ( pBuffer_R[ ii ] - fLpfbR );
+			fLpfbR += fCutoff * fBpfbR;
+			pBuffer_L[ ii ] = fLpfbL;
+			pBuffer_R[ ii ] = fLpfbR;
+		}
+		m_fFilterCutoff = fTargetCutoff;
+		m_fFilterResonance = fTargetResonance;
+	}
+
+	m_fBpfbL = fBpfbL;
+	m_fBpfbR = fBpfbR;
+	m_fLpfbL = fLpfbL;
+	m_fLpfbR = fLpfbR;
+}
+
 void Note::computeNoteStart() {
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pAudioEngine = pHydrogen->getAudioEngine();
@@ -515,18 +769,16 @@ void Note::selectLayers( const std::map< std::shared_ptr<InstrumentComponent>,
 
 			if ( ppSelectedLayerInfo == nullptr ||
 				 ppSelectedLayerInfo->pLayer == nullptr ) {
-				auto pNewSelectedLayerInfo = std::make_shared<SelectedLayerInfo>();
-				pNewSelectedLayerInfo->pLayer = selectLayer( ppComponent );
-				m_selectedLayerInfoMap[ ppComponent ] = pNewSelectedLayerInfo;
+				obtainSelectedLayerInfo( ppComponent )->pLayer =
+					selectLayer( ppComponent );
 			}
 		}
 	}
 	else {
 		// Select layers for all components
 		for ( const auto& ppComponent : *m_pInstrument->getComponents() ) {
-			auto pNewSelectedLayerInfo = std::make_shared<SelectedLayerInfo>();
-			pNewSelectedLayerInfo->pLayer = selectLayer( ppComponent );
-			m_selectedLayerInfoMap[ ppComponent ] = pNewSelectedLayerInfo;
+			obtainSelectedLayerInfo( ppComponent )->pLayer =
+				selectLayer( ppComponent );
 		}
 	}
 }
@@ -713,6 +965,10 @@ QString Note::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_fLpfbL ) )
 			.append( QString( "%1%2m_fLpfbR: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_fLpfbR ) )
+			.append( QString( "%1%2m_fFilterCutoff: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_fFilterCutoff ) )
+			.append( QString( "%1%2m_fFilterResonance: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_fFilterResonance ) )
 			.append( QString( "%1%2m_nMidiMsg: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_nMidiMsg ) )
 			.append( QString( "%1%2m_bNoteOff: %3\n" ).arg( sPrefix ).arg( s )
@@ -771,6 +1027,8 @@ QString Note::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", m_fBpfbR: %1" ).arg( m_fBpfbR ) )
 			.append( QString( ", m_fLlpfbL: %1" ).arg( m_fLpfbL ) )
 			.append( QString( ", m_fLpfbR: %1" ).arg( m_fLpfbR ) )
+			.append( QString( ", m_fFilterCutoff: %1" ).arg( m_fFilterCutoff ) )
+			.append( QString( ", m_fFilterResonance: %1" ).arg( m_fFilterResonance ) )
 			.append( QString( ", m_nMidiMsg: %1" ).arg( m_nMidiMsg ) )
 			.append( QString( ", m_bNoteOff: %1" ).arg( m_bNoteOff ) )
 			.append( QString( ", m_fProbability: %1" ).arg( m_fProbability ) )
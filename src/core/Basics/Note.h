@@ -25,6 +25,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <core/Object.h>
 #include <core/Basics/DrumkitMap.h>
@@ -100,6 +101,11 @@ struct SelectedLayerInfo {
 	 * fraction between #fSamplePosition and the former #nNoteLength.*/
 	int nNoteLength;
 
+	/** Stream of the #H2Core::SampleStreamer prefetching the sample
+	 * of #pLayer in case it is not fully held in memory. -1 if none
+	 * was acquired (yet). */
+	int nStream;
+
 	QString toQString( const QString& sPrefix = "", bool bShort = true ) const;
 };
 
@@ -143,6 +149,24 @@ class Note : public H2Core::Object<Note>
 		Note( std::shared_ptr<Note> pOther );
 		~Note();
 
+		/**
+		 * In-place counterpart of the copy constructor. All members of
+		 * @a pOther are assigned to this note while the #ADSR already owned
+		 * by this instance is reused.
+		 *
+		 * Used by #NotePool to hand out copies of pattern notes without
+		 * allocating memory in the audio thread.
+		 */
+		void copyFrom( std::shared_ptr<Note> pOther );
+		/**
+		 * In-place counterpart of the regular constructor. Used by
+		 * #NotePool to hand out fresh notes.
+		 */
+		void reset( std::shared_ptr<Instrument> pInstrument, int nPosition = 0,
+					float fVelocity = VELOCITY_DEFAULT, float fPan = PAN_DEFAULT,
+					int nLength = LENGTH_ENTIRE_SAMPLE,
+					float fPitch = PITCH_DEFAULT );
+
 		/*
 		 * save the note within the given XMLNode
 		 * \param node the XMLNode to feed
@@ -166,6 +190,45 @@ class Note : public H2Core::Object<Note>
 		 */
 		void mapTo( std::shared_ptr<Drumkit> pDrumkit,
 					std::shared_ptr<Drumkit> pOldDrumkit = nullptr );
+		/**
+		 * Same as mapTo() but uses the already computed drumkit maps
+		 * (see Drumkit::toDrumkitMap()) of @a pDrumkit and @a pOldDrumkit.
+		 * Allows to share the maps among all notes of a pattern.
+		 *
+		 * \param pOldDrumkitMap If nullptr, it will be computed on
+		 *   demand. */
+		void mapTo( std::shared_ptr<Drumkit> pDrumkit,
+					std::shared_ptr<DrumkitMap> pDrumkitMap,
+					std::shared_ptr<Drumkit> pOldDrumkit,
+					std::shared_ptr<DrumkitMap> pOldDrumkitMap );
+		/**
+		 * Determines the instrument of @a pDrumkit a note with type
+		 * @a psType and instrument ID @a nInstrumentId would be mapped to
+		 * by mapTo().
+		 *
+		 * Does not alter any note. Together with assignInstrument() this
+		 * allows to prepare a drumkit switch without locking the
+		 * #AudioEngine.
+		 *
+		 * \param psType Type of the note. Will be updated in case the
+		 *   type of the instrument the note is mapped to changed.
+		 *
+		 * \return nullptr in case no instrument matches. */
+		static std::shared_ptr<Instrument> findMappedInstrument(
+			QString* psType, int nInstrumentId,
+			std::shared_ptr<Drumkit> pDrumkit,
+			std::shared_ptr<DrumkitMap> pDrumkitMap,
+			std::shared_ptr<Drumkit> pOldDrumkit,
+			std::shared_ptr<DrumkitMap> pOldDrumkitMap );
+		/**
+		 * Assigns the result of findMappedInstrument() to the note.
+		 *
+		 * \param pAdsr Copy of the ADSR of @a pInstrument. Passed in to
+		 *   not allocate while the #AudioEngine is locked.
+		 * \param sType Type as returned by findMappedInstrument(). */
+		void assignInstrument( std::shared_ptr<Instrument> pInstrument,
+							   std::shared_ptr<ADSR> pAdsr,
+							   const QString& sType );
 		/** #m_pInstrument accessor */
 		std::shared_ptr<Instrument> getInstrument() const;
 		/**
@@ -245,8 +308,8 @@ class Note : public H2Core::Object<Note>
 		void selectLayers( const std::map< std::shared_ptr<InstrumentComponent>,
 						     std::shared_ptr<InstrumentLayer> >& lastUsedLayers );
 
-		std::map< std::shared_ptr<InstrumentComponent>,
-				  std::shared_ptr<SelectedLayerInfo> > getAllSelectedLayerInfos() const;
+		const std::map< std::shared_ptr<InstrumentComponent>,
+				  std::shared_ptr<SelectedLayerInfo> >& getAllSelectedLayerInfos() const;
 		/** Returns the #H2Core::InstrumentLayer and some additional rendering
 		 * meta data for a given component. If no selection took place yet,
 		 * `nullptr` will be returned. */
@@ -360,13 +423,26 @@ class Note : public H2Core::Object<Note>
 								  const std::shared_ptr<Note> pNote2 );
 
 		/**
-		 * compute left and right output based on filters
-		 * \param val_l the left channel value
-		 * \param val_r the right channel value
+		 * Applies the resonant low pass filter of the instrument to a
+		 * block of rendered frames in place.
+		 *
+		 * Cutoff and resonance are read once per call. In case they
+		 * changed since the previous block, they are ramped linearly
+		 * across @a nFrames to avoid zipper noise.
+		 *
+		 * \param pBuffer_L left channel
+		 * \param pBuffer_R right channel
+		 * \param nFrames number of frames to filter
 		 */
-		void computeLrValues( float* val_l, float* val_r );
+		void applyFilter( float* pBuffer_L, float* pBuffer_R, int nFrames );
 
 	long long getNoteStart() const;
+	/**
+	 * Sets #m_nNoteStart directly instead of deriving it from
+	 * #m_nPosition (see computeNoteStart()). Used for notes triggered
+	 * in realtime which have to start at a particular frame.
+	 */
+	void setNoteStart( long long nNoteStart );
 	float getUsedTickSize() const;
 
 	/** 
@@ -445,7 +521,23 @@ class Note : public H2Core::Object<Note>
 			return KEYS_PER_OCTAVE * ( OCTAVE_MIN + OCTAVE_NUMBER ) - 1 - nPitch;
 		}
 
+	friend class NotePool;
+
 	private:
+		/** Deep copies the selected layer infos of @a pOther and maps them
+		 * onto the components of #m_pInstrument. */
+		void copySelectedLayerInfos( std::shared_ptr<Note> pOther );
+		/** Moves all entries of #m_selectedLayerInfoMap to
+		 * #m_spareLayerInfoNodes. Contrary to clearing the map, this
+		 * neither frees memory nor - as long as the spare nodes
+		 * reserved suffice - allocates it. */
+		void recycleSelectedLayerInfos();
+		/** \return A pristine layer info of @a pComponent stored in
+		 * #m_selectedLayerInfoMap. Spare map nodes and infos are reused
+		 * whenever possible. */
+		std::shared_ptr<SelectedLayerInfo> obtainSelectedLayerInfo(
+			std::shared_ptr<InstrumentComponent> pComponent );
+
         /** The ID of the instrument the note will be mapped to in case a
 		 * drumkit with no or incomplete types is used (e.g. a new or legacy
 		 * kit).
@@ -492,6 +584,11 @@ class Note : public H2Core::Object<Note>
 		float			m_fBpfbR;             ///< right band pass filter buffer
 		float			m_fLpfbL;             ///< left low pass filter buffer
 		float			m_fLpfbR;             ///< right low pass filter buffer
+		/** Filter cutoff used at the end of the previous block. Negative
+		 * in case the filter was not applied yet. */
+		float			m_fFilterCutoff;
+		/** Filter resonance used at the end of the previous block. */
+		float			m_fFilterResonance;
 		int				m_nMidiMsg;             ///< TODO
 		bool			m_bNoteOff;            ///< note type on|off
 		float			m_fProbability;        ///< note probability
@@ -519,8 +616,16 @@ class Note : public H2Core::Object<Note>
 	 */
 	float m_fUsedTickSize;
 
-		std::map< std::shared_ptr<InstrumentComponent>,
-				  std::shared_ptr<SelectedLayerInfo> > m_selectedLayerInfoMap;
+		using SelectedLayerInfoMap =
+			std::map< std::shared_ptr<InstrumentComponent>,
+					  std::shared_ptr<SelectedLayerInfo> >;
+
+		SelectedLayerInfoMap m_selectedLayerInfoMap;
+		/** Nodes of #m_selectedLayerInfoMap (including their
+		 * #SelectedLayerInfo) of former selections kept for reuse. Only
+		 * notes of the #NotePool hold spare nodes. This way, recycling
+		 * them in the audio thread does not involve the heap. */
+		std::vector<SelectedLayerInfoMap::node_type> m_spareLayerInfoNodes;
 
 		/** The instrument (of the current drumkit) the note is associated with.
 		 * It will be used to render the note and, if not `nullptr`, to indicate
@@ -612,8 +717,8 @@ inline int Note::getMidiMsg() const
 	return m_nMidiMsg;
 }
 
-inline std::map< std::shared_ptr<InstrumentComponent>,
-				 std::shared_ptr<SelectedLayerInfo> > Note::getAllSelectedLayerInfos() const {
+inline const std::map< std::shared_ptr<InstrumentComponent>,
+				 std::shared_ptr<SelectedLayerInfo> >& Note::getAllSelectedLayerInfos() const {
 	return m_selectedLayerInfoMap;
 }
 
@@ -760,28 +865,12 @@ inline bool Note::compareAscending( const std::shared_ptr<Note> pNote1,
 	}
 }
 
-inline void Note::computeLrValues( float* val_l, float* val_r )
-{
-	if ( m_pInstrument == nullptr ) {
-		*val_l = 0.0f;
-		*val_r = 0.0f;
-		return;
-	}
-	else {
-		const float fCutOff = m_pInstrument->getFilterCutoff();
-		const float fResonance = m_pInstrument->getFilterResonance();
-		m_fBpfbL  =  fResonance * m_fBpfbL  + fCutOff * ( *val_l - m_fLpfbL );
-		m_fLpfbL +=  fCutOff   * m_fBpfbL;
-		m_fBpfbR  =  fResonance * m_fBpfbR  + fCutOff * ( *val_r - m_fLpfbR );
-		m_fLpfbR +=  fCutOff   * m_fBpfbR;
-		*val_l = m_fLpfbL;
-		*val_r = m_fLpfbR;
-	}
-}
-
 inline long long Note::getNoteStart() const {
 	return m_nNoteStart;
 }
+inline void Note::setNoteStart( long long nNoteStart ) {
+	m_nNoteStart = nNoteStart;
+}
 inline float Note::getUsedTickSize() const {
 	return m_fUsedTickSize;
 }
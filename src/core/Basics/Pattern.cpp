@@ -22,6 +22,7 @@
 
 #include <core/Basics/Pattern.h>
 
+#include <algorithm>
 #include <cassert>
 
 #include <core/AudioEngine/AudioEngine.h>
@@ -47,6 +48,7 @@ Pattern::Pattern( const QString& sName, const QString& sInfo,
 	, m_sName( sName )
 	, m_sCategory( sCategory )
 	, m_sInfo( sInfo )
+	, m_pNoteSnapshot( std::make_shared<const NoteSnapshot>( notes_t() ) )
 {
 	if ( sCategory.isEmpty() ) {
 		m_sCategory = SoundLibraryDatabase::m_sPatternBaseCategory;
@@ -68,6 +70,7 @@ Pattern::Pattern( std::shared_ptr<Pattern> pOther )
 		m_notes.insert( std::make_pair( it->first,
 										std::make_shared<Note>( it->second ) ) );
 	}
+	updateNoteSnapshot();
 
 	for ( const auto& ppPattern : pOther->m_virtualPatterns ) {
 		m_virtualPatterns.insert( std::make_shared<Pattern>( ppPattern ) );
@@ -170,10 +173,13 @@ std::shared_ptr<Pattern> Pattern::loadFrom( const XMLNode& node,
 			if ( pNote != nullptr &&
 				 ( pNote->getInstrumentId() != EMPTY_INSTR_ID ||
 				   ! pNote->getType().isEmpty() ) ) {
-				pPattern->insertNote( pNote );
+				// Publish the snapshot only once all notes are loaded.
+				pPattern->m_notes.insert(
+					std::make_pair( pNote->getPosition(), pNote ) );
 			}
 			note_node = note_node.nextSiblingElement( "note" );
 		}
+		pPattern->updateNoteSnapshot();
 	}
 
 	pPattern->applyMissingTypes( pDrumkit, bSilent );
@@ -288,16 +294,25 @@ std::vector< std::shared_ptr<Note>> Pattern::findNotes(
 	return notes;
 }
 
-void Pattern::removeNote( std::shared_ptr<Note> pNote )
+void Pattern::removeNote( std::shared_ptr<Note> pNote,
+						  bool bUpdateNoteSnapshot )
 {
 	int nPos = pNote->getPosition();
-	for ( notes_it_t it = m_notes.lower_bound( nPos );
-		  it != m_notes.end() && it->first == nPos; ++it ) {
-		if ( it->second == pNote ) {
-			m_notes.erase( it );
-			break;
+	bool bErased = false;
+	{
+		std::lock_guard<std::mutex> guard( m_notesMutex );
+		for ( notes_it_t it = m_notes.lower_bound( nPos );
+			  it != m_notes.end() && it->first == nPos; ++it ) {
+			if ( it->second == pNote ) {
+				m_notes.erase( it );
+				bErased = true;
+				break;
+			}
 		}
 	}
+	if ( bErased && bUpdateNoteSnapshot ) {
+		updateNoteSnapshot();
+	}
 }
 
 bool Pattern::references( std::shared_ptr<Instrument> pInstrument ) const
@@ -322,19 +337,27 @@ void Pattern::purgeInstrument( std::shared_ptr<Instrument> pInstrument,
 	}
 
 	bool bLocked = false;
-	for ( notes_it_t it = m_notes.begin(); it != m_notes.end(); ) {
-		auto pNote = it->second;
-		assert( pNote );
-		if ( pNote != nullptr && pNote->getInstrument() == pInstrument ) {
-			if ( ! bLocked && bRequiresLock ) {
-				Hydrogen::get_instance()->getAudioEngine()->lock( RIGHT_HERE );
-				bLocked = true;
+	bool bErased = false;
+	{
+		std::lock_guard<std::mutex> guard( m_notesMutex );
+		for ( notes_it_t it = m_notes.begin(); it != m_notes.end(); ) {
+			auto pNote = it->second;
+			assert( pNote );
+			if ( pNote != nullptr && pNote->getInstrument() == pInstrument ) {
+				if ( ! bLocked && bRequiresLock ) {
+					Hydrogen::get_instance()->getAudioEngine()->lock( RIGHT_HERE );
+					bLocked = true;
+				}
+				m_notes.erase( it++ );
+				bErased = true;
+			} else {
+				++it;
 			}
-			m_notes.erase( it++ );
-		} else {
-			++it;
 		}
 	}
+	if ( bErased ) {
+		updateNoteSnapshot();
+	}
 	if ( bLocked ) {
 		Hydrogen::get_instance()->getAudioEngine()->unlock();
 	}
@@ -347,13 +370,66 @@ void Pattern::clear( bool bRequiresLock )
 		pAudioEngine->lock( RIGHT_HERE );
 	}
 
-	m_notes.clear();
+	{
+		std::lock_guard<std::mutex> guard( m_notesMutex );
+		m_notes.clear();
+	}
+	updateNoteSnapshot();
 
 	if ( bRequiresLock ) {
 		pAudioEngine->unlock();
 	}
 }
 
+void Pattern::updateNoteSnapshot()
+{
+	std::lock_guard<std::mutex> guard( m_notesMutex );
+	auto pOldSnapshot = std::atomic_exchange(
+		&m_pNoteSnapshot, std::shared_ptr<const NoteSnapshot>(
+			std::make_shared<NoteSnapshot>( m_notes ) ) );
+	if ( pOldSnapshot != nullptr ) {
+		m_retiredNoteSnapshots.push_back( std::move( pOldSnapshot ) );
+	}
+
+	pruneRetiredNoteSnapshots();
+}
+
+void Pattern::releaseRetiredNoteSnapshots()
+{
+	std::lock_guard<std::mutex> guard( m_notesMutex );
+	pruneRetiredNoteSnapshots();
+}
+
+void Pattern::pruneRetiredNoteSnapshots()
+{
+	// Retired snapshots can not be obtained via getNoteSnapshot()
+	// anymore. Once we hold the only reference left, they are safe to
+	// be freed.
+	m_retiredNoteSnapshots.erase(
+		std::remove_if( m_retiredNoteSnapshots.begin(),
+						m_retiredNoteSnapshots.end(),
+						[]( const std::shared_ptr<const NoteSnapshot>& pSnapshot ) {
+							return pSnapshot.use_count() == 1; } ),
+		m_retiredNoteSnapshots.end() );
+}
+
+Pattern::NoteSnapshot::NoteSnapshot( const notes_t& notes )
+{
+	m_positions.reserve( notes.size() );
+	m_notes.reserve( notes.size() );
+	for ( const auto& [ nPosition, ppNote ] : notes ) {
+		m_positions.push_back( nPosition );
+		m_notes.push_back( ppNote );
+	}
+}
+
+int Pattern::NoteSnapshot::lowerBound( int nPosition ) const
+{
+	return static_cast<int>(
+		std::lower_bound( m_positions.begin(), m_positions.end(), nPosition ) -
+		m_positions.begin() );
+}
+
 void Pattern::flattenedVirtualPatternsCompute()
 {
 	// m_flattenedVirtualPatterns must have been cleared before
@@ -441,24 +517,25 @@ void Pattern::applyMissingTypes( std::shared_ptr<Drumkit> pDrumkit,
 			// different priority. In each context, we just take the first
 			// match.
 			const auto pDB = Hydrogen::get_instance()->getSoundLibraryDatabase();
+			const auto pDrumkitEntries = pDB->getDrumkitEntries();
 
 			// Kits explicitly loaded by user via our API have highest priority.
-			for ( const auto& [ _, ppDrumkit ] : pDB->getDrumkitDatabase() ) {
-				if ( ppDrumkit != nullptr &&
-					 ( ppDrumkit->getContext() == Drumkit::Context::SessionReadOnly ||
-					   ppDrumkit->getContext() == Drumkit::Context::SessionReadWrite ) &&
-					 ppDrumkit->getName() == m_sDrumkitName ) {
-					pDrumkitMap = ppDrumkit->toDrumkitMap();
+			for ( const auto& [ _, ppEntry ] : *pDrumkitEntries ) {
+				if ( ppEntry != nullptr &&
+					 ( ppEntry->context == Drumkit::Context::SessionReadOnly ||
+					   ppEntry->context == Drumkit::Context::SessionReadWrite ) &&
+					 ppEntry->sName == m_sDrumkitName ) {
+					pDrumkitMap = ppEntry->toDrumkitMap();
 					break;
 				}
 			}
 			if ( pDrumkitMap == nullptr ) {
 				// Kits in the user's drumkit folder are next.
-				for ( const auto& [ _, ppDrumkit ] : pDB->getDrumkitDatabase() ) {
-					if ( ppDrumkit != nullptr &&
-						 ppDrumkit->getContext() == Drumkit::Context::User &&
-						 ppDrumkit->getName() == m_sDrumkitName ) {
-						pDrumkitMap = ppDrumkit->toDrumkitMap();
+				for ( const auto& [ _, ppEntry ] : *pDrumkitEntries ) {
+					if ( ppEntry != nullptr &&
+						 ppEntry->context == Drumkit::Context::User &&
+						 ppEntry->sName == m_sDrumkitName ) {
+						pDrumkitMap = ppEntry->toDrumkitMap();
 						break;
 					}
 				}
@@ -466,11 +543,11 @@ void Pattern::applyMissingTypes( std::shared_ptr<Drumkit> pDrumkit,
 			if ( pDrumkitMap == nullptr ) {
 				// Kits in the system's drumkit folder, which were shipped as
 				// part of Hydrogen, have the lower priority.
-				for ( const auto& [ _, ppDrumkit ] : pDB->getDrumkitDatabase() ) {
-					if ( ppDrumkit != nullptr &&
-						 ppDrumkit->getContext() == Drumkit::Context::System &&
-						 ppDrumkit->getName() == m_sDrumkitName ) {
-						pDrumkitMap = ppDrumkit->toDrumkitMap();
+				for ( const auto& [ _, ppEntry ] : *pDrumkitEntries ) {
+					if ( ppEntry != nullptr &&
+						 ppEntry->context == Drumkit::Context::System &&
+						 ppEntry->sName == m_sDrumkitName ) {
+						pDrumkitMap = ppEntry->toDrumkitMap();
 						break;
 					}
 				}
@@ -525,9 +602,15 @@ void Pattern::mapTo( std::shared_ptr<Drumkit> pDrumkit,
 
 	m_sDrumkitName = pDrumkit->getName();
 
+	// The maps are shared by all notes instead of being created for
+	// each of them.
+	const auto pDrumkitMap = pDrumkit->toDrumkitMap();
+	const auto pOldDrumkitMap = pOldDrumkit != nullptr ?
+		pOldDrumkit->toDrumkitMap() : nullptr;
+
 	for ( auto& [ _, ppNote ] : m_notes ) {
 		if ( ppNote != nullptr ) {
-			ppNote->mapTo( pDrumkit, pOldDrumkit );
+			ppNote->mapTo( pDrumkit, pDrumkitMap, pOldDrumkit, pOldDrumkitMap );
 		}
 	}
 }
@@ -25,6 +25,8 @@
 
 #include <set>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <core/License.h>
 #include <core/Object.h>
 #include <core/Basics/DrumkitMap.h>
@@ -61,6 +63,32 @@ class Pattern : public H2Core::Object<Pattern>
 		///< note set const iterator type;
 		typedef virtual_patterns_t::const_iterator virtual_patterns_cst_it_t;
 
+	/**
+	 * Immutable copy of all notes of a pattern sorted by position.
+	 *
+	 * Positions and notes are stored in two separate contiguous
+	 * arrays. The #AudioEngine looks up the notes at a tick using a
+	 * binary search over plain integers instead of walking the nodes
+	 * of #notes_t. A new snapshot is published each time notes are
+	 * added or removed. Snapshots already handed out stay valid (and
+	 * keep their notes alive) till they are released.
+	 */
+	class NoteSnapshot {
+	public:
+		NoteSnapshot( const notes_t& notes );
+
+		/** \return Index of the first note located at or after
+		 *   @a nPosition. size() if there is none. */
+		int lowerBound( int nPosition ) const;
+		int size() const;
+		int getPosition( int nIndex ) const;
+		const std::shared_ptr<Note>& getNote( int nIndex ) const;
+
+	private:
+		std::vector<int> m_positions;
+		std::vector<std::shared_ptr<Note>> m_notes;
+	};
+
 	/** allow iteration of all contained virtual patterns.*/
 	std::set<std::shared_ptr<Pattern>>::iterator begin();
 	std::set<std::shared_ptr<Pattern>>::iterator end();
@@ -156,6 +184,16 @@ class Pattern : public H2Core::Object<Pattern>
 		int getDenominator() const;
 		///< get the note multimap
 		const notes_t* getNotes() const;
+		/** Guards #m_notes. It is locked by insertNote(), removeNote(),
+		 * purgeInstrument(), and clear() and has to be held by threads
+		 * iterating the notes while others might alter them. The
+		 * #AudioEngine does not use it since it only reads the
+		 * #NoteSnapshot. */
+		std::mutex& getNotesMutex() const;
+		/** Snapshot of #m_notes intended to be used by the audio
+		 * thread. Can be called without holding the lock of the
+		 * #AudioEngine. */
+		std::shared_ptr<const NoteSnapshot> getNoteSnapshot() const;
 		///< get the virtual pattern set
 		const virtual_patterns_t* getVirtualPatterns() const;
 		///< get the flattened virtual pattern set
@@ -169,8 +207,13 @@ class Pattern : public H2Core::Object<Pattern>
 		/**
 		 * insert a new note within m_notes
 		 * \param pNote the note to be inserted
+		 * \param bUpdateNoteSnapshot Whether to publish a new
+		 *   #NoteSnapshot right away. When inserting several notes at
+		 *   once, pass false and call updateNoteSnapshot() after the
+		 *   last one instead.
 		 */
-		void insertNote( std::shared_ptr<Note> pNote );
+		void insertNote( std::shared_ptr<Note> pNote,
+						 bool bUpdateNoteSnapshot = true );
 		/**
 		 * Search for all notes at a given index within #m_notes which correspond
 		 * to the given arguments.
@@ -206,8 +249,18 @@ class Pattern : public H2Core::Object<Pattern>
 		/**
 		 * removes a given note from m_notes, it's not deleted
 		 * \param pNote the note to be removed
+		 * \param bUpdateNoteSnapshot See insertNote().
 		 */
-		void removeNote( std::shared_ptr<Note> pNote );
+		void removeNote( std::shared_ptr<Note> pNote,
+						 bool bUpdateNoteSnapshot = true );
+		/** Publishes a new #m_pNoteSnapshot based on #m_notes. Has to
+		 * be called after each change of #m_notes. */
+		void updateNoteSnapshot();
+		/** Frees all retired snapshots no longer used by the audio
+		 * thread. Intended to be called periodically by the editing
+		 * thread so snapshots of patterns not edited anymore do not
+		 * linger. Must not be called from the audio thread. */
+		void releaseRetiredNoteSnapshots();
 
 		/**
 		 * check if this pattern contains a note referencing the given instrument
@@ -287,6 +340,11 @@ class Pattern : public H2Core::Object<Pattern>
 		QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
 
 	private:
+		/** Drops all retired snapshots only referenced by
+		 * #m_retiredNoteSnapshots itself. #m_notesMutex must be
+		 * held. */
+		void pruneRetiredNoteSnapshots();
+
 		int m_nVersion;
 		/** Name of the kit using which the pattern was written. This is mainly
 		 * used for backward compatibility. */
@@ -316,6 +374,16 @@ class Pattern : public H2Core::Object<Pattern>
 		QString m_sInfo;
 		/** multimap (hash with possible multiple values for one key) of note */
 		notes_t m_notes;
+		/** Only accessed via std::atomic_load() and
+		 * std::atomic_store(). Never nullptr. */
+		std::shared_ptr<const NoteSnapshot> m_pNoteSnapshot;
+		/** Snapshots replaced by updateNoteSnapshot() which might still
+		 * be in use by the audio thread. They are kept alive in here
+		 * till no one else references them, so the audio thread never
+		 * releases the last reference and frees them. */
+		std::vector<std::shared_ptr<const NoteSnapshot>> m_retiredNoteSnapshots;
+		/** See getNotesMutex(). Also guards #m_retiredNoteSnapshots. */
+		mutable std::mutex m_notesMutex;
 		/** list of patterns directly referenced by this one */
 		virtual_patterns_t m_virtualPatterns;
 		/** complete list of virtual patterns */
@@ -459,13 +527,45 @@ inline const Pattern::virtual_patterns_t* Pattern::getFlattenedVirtualPatterns()
 	return &m_flattenedVirtualPatterns;
 }
 
-inline void Pattern::insertNote( std::shared_ptr<Note> pNote )
+inline void Pattern::insertNote( std::shared_ptr<Note> pNote,
+								 bool bUpdateNoteSnapshot )
 {
 	if ( pNote != nullptr ) {
-		m_notes.insert( std::make_pair( pNote->getPosition(), pNote ) );
+		{
+			std::lock_guard<std::mutex> guard( m_notesMutex );
+			m_notes.insert( std::make_pair( pNote->getPosition(), pNote ) );
+		}
+		if ( bUpdateNoteSnapshot ) {
+			updateNoteSnapshot();
+		}
 	}
 }
 
+inline std::mutex& Pattern::getNotesMutex() const
+{
+	return m_notesMutex;
+}
+
+inline std::shared_ptr<const Pattern::NoteSnapshot> Pattern::getNoteSnapshot() const
+{
+	return std::atomic_load( &m_pNoteSnapshot );
+}
+
+inline int Pattern::NoteSnapshot::size() const
+{
+	return static_cast<int>(m_positions.size());
+}
+
+inline int Pattern::NoteSnapshot::getPosition( int nIndex ) const
+{
+	return m_positions[ nIndex ];
+}
+
+inline const std::shared_ptr<Note>& Pattern::NoteSnapshot::getNote( int nIndex ) const
+{
+	return m_notes[ nIndex ];
+}
+
 inline bool Pattern::virtualPatternsEmpty() const
 {
 	return m_virtualPatterns.empty();
@@ -22,9 +22,15 @@
 
 
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
 #include <core/Helpers/Filesystem.h>
@@ -67,6 +73,7 @@ Sample::Sample( const QString& filepath, const License& license, int frames, int
   : m_bIsLoaded( false ),
 	m_sFilepath( filepath ),
 	m_nFrames( frames ),
+	m_nHeadFrames( frames ),
 	m_nSampleRate( sample_rate ),
 	m_data_L( data_l ),
 	m_data_R( data_r ),
@@ -83,6 +90,7 @@ Sample::Sample( std::shared_ptr<Sample> pOther ) :
 	m_bIsLoaded( pOther->m_bIsLoaded ),
 	m_sFilepath( pOther->getFilepath() ),
 	m_nFrames( pOther->getFrames() ),
+	m_nHeadFrames( pOther->getHeadFrames() ),
 	m_nSampleRate( pOther->getSampleRate() ),
 	m_data_L( nullptr ),
 	m_data_R( nullptr ),
@@ -91,16 +99,25 @@ Sample::Sample( std::shared_ptr<Sample> pOther ) :
 	m_rubberband( pOther->m_rubberband ),
 	m_license( pOther->m_license )
 {
-
-	m_data_L = new float[m_nFrames];
-	m_data_R = new float[m_nFrames];
-	
-	// Since the third argument of memcpy takes the number of bytes,
-	// which are about to be copied, and the data is given in float,
-	// which are  four bytes each, the number of copied frames
-	// `m_nFrames` has to be multiplied by four.
-	memcpy( m_data_L, pOther->getData_L(), m_nFrames * 4 );
-	memcpy( m_data_R, pOther->getData_R(), m_nFrames * 4 );
+	if ( pOther->m_pBuffer != nullptr ) {
+		// Shared data is never altered.
+		setBuffer( pOther->m_pBuffer );
+	}
+	else {
+		m_data_L = new float[m_nHeadFrames];
+
+		// Since the third argument of memcpy takes the number of bytes,
+		// which are about to be copied, and the data is given in float,
+		// which are  four bytes each, the number of copied frames
+		// `m_nHeadFrames` has to be multiplied by four.
+		memcpy( m_data_L, pOther->getData_L(), m_nHeadFrames * 4 );
+		if ( pOther->isMono() ) {
+			m_data_R = m_data_L;
+		} else {
+			m_data_R = new float[m_nHeadFrames];
+			memcpy( m_data_R, pOther->getData_R(), m_nHeadFrames * 4 );
+		}
+	}
 	
 	auto pPan = pOther->getPanEnvelope();
 	for( int i=0; i<pPan.size(); i++ ) {
@@ -115,12 +132,7 @@ Sample::Sample( std::shared_ptr<Sample> pOther ) :
 
 Sample::~Sample()
 {
-	if ( m_data_L != nullptr ) {
-		delete[] m_data_L;
-	}
-	if ( m_data_R != nullptr ) {
-		delete[] m_data_R;
-	}
+	freeData();
 }
 
 void Sample::setFilename( const QString& filename )
@@ -156,30 +168,195 @@ std::shared_ptr<Sample> Sample::load( const QString& sFilepath, const License& l
 	return pSample;
 }
 
-bool Sample::load( float fBpm )
+SNDFILE* Sample::openSndfile( const QString& sPath, SF_INFO* pInfo )
 {
-	// Will contain a bunch of metadata about the loaded sample.
-	SF_INFO sound_info = {0};
-
 	// Opens file in read-only mode.
 #ifdef WIN32
 	// On Windows we use a special version of sf_open to ensure we get all
 	// characters of the filename entered in the GUI right. No matter which
 	// encoding was used locally.
 	// We have to terminate the string using a null character ourselves.
-	QString sPath( getFilepath() );
-	const QString sPaddedPath = sPath.append( '\0' );
+	QString sPaddedPath( sPath );
+	sPaddedPath.append( '\0' );
 	wchar_t* encodedFilename = new wchar_t[ sPaddedPath.size() ];
 
 	sPaddedPath.toWCharArray( encodedFilename );
 
-	SNDFILE* file = sf_wchar_open( encodedFilename, SFM_READ,
-								   &sound_info );
-	delete encodedFilename;
+	SNDFILE* file = sf_wchar_open( encodedFilename, SFM_READ, pInfo );
+	delete[] encodedFilename;
+#else
+	SNDFILE* file = sf_open( sPath.toLocal8Bit(), SFM_READ, pInfo );
+#endif
+	return file;
+}
+
+bool Sample::load( float fBpm, int nStreamingHead, bool bUseCache,
+				   ResampleKernels::Format format )
+{
+	// Modified samples have to be processed as a whole.
+	const bool bIsUnmodified = m_loops == Loops() &&
+		m_velocityEnvelope.size() == 0 && m_panEnvelope.size() == 0 &&
+		! m_rubberband.use;
+	if ( ! bIsUnmodified ) {
+		nStreamingHead = 0;
+	}
+
+	// Use the data of other samples loaded from the same file with
+	// the same modifiers.
+	const QString sKey = getRegistryKey( fBpm, nStreamingHead, format );
+	auto pBuffer = SampleRegistry::lookup( sKey );
+	if ( pBuffer != nullptr ) {
+		unload();
+		setBuffer( pBuffer );
+		m_bIsLoaded = true;
+		return true;
+	}
+
+	const bool bCacheEnabled = bUseCache && SampleCache::isEnabled();
+	std::shared_ptr<SampleCache::Entry> pCacheEntry = nullptr;
+	if ( bCacheEnabled ) {
+		pCacheEntry = SampleCache::lookup( getFilepath() );
+		// Samples to be streamed are read from their original file.
+		if ( pCacheEntry != nullptr && nStreamingHead > 0 &&
+			 pCacheEntry->getFrames() >
+			 2 * static_cast<long long>(nStreamingHead) ) {
+			pCacheEntry = nullptr;
+		}
+	}
+
+	if ( pCacheEntry != nullptr ) {
+		unload();
+		m_nFrames = pCacheEntry->getFrames();
+		m_nHeadFrames = m_nFrames;
+		m_nSampleRate = pCacheEntry->getSampleRate();
+
+		if ( bIsUnmodified ) {
+			// Data is used in place.
+			m_pBuffer = std::make_shared<SampleRegistry::Buffer>( pCacheEntry );
+			pack( format );
+			share( sKey );
+			m_bIsLoaded = true;
+			return true;
+		}
+
+		// Modifiers are applied to a copy.
+		m_data_L = new float[ m_nFrames ];
+		m_data_R = new float[ m_nFrames ];
+		memcpy( m_data_L, pCacheEntry->getData_L(), m_nFrames * sizeof( float ) );
+		memcpy( m_data_R, pCacheEntry->getData_R(), m_nFrames * sizeof( float ) );
+	}
+	else {
+		if ( ! decode( nStreamingHead, bCacheEnabled ) ) {
+			return false;
+		}
+		if ( isStreamed() ) {
+			share( sKey );
+			return true;
+		}
+	}
+
+	// Apply modifiers (if present/altered).
+	if ( ! applyLoops() ) {
+		WARNINGLOG( "Unable to apply loops" );
+	}
+	applyVelocity();
+	applyPan();
+#ifdef H2CORE_HAVE_RUBBERBAND
+	applyRubberband( fBpm );
 #else
-	SNDFILE* file = sf_open( getFilepath().toLocal8Bit(), SFM_READ,
-							 &sound_info );
+	if ( ! execRubberbandCli( fBpm ) ) {
+		WARNINGLOG( "Unable to apply rubberband" );
+	}
 #endif
+
+	pack( format );
+	share( sKey );
+	m_bIsLoaded = true;
+
+	return true;
+}
+
+QString Sample::getRegistryKey( float fBpm, int nStreamingHead,
+								ResampleKernels::Format format ) const
+{
+	const QFileInfo info( getFilepath() );
+	if ( ! info.exists() ) {
+		return "";
+	}
+
+	QString sKey = QString( "%1\n%2\n%3\n%4\n%5\n" )
+		.arg( info.absoluteFilePath() ).arg( info.size() )
+		.arg( info.lastModified().toMSecsSinceEpoch() ).arg( nStreamingHead )
+		.arg( static_cast<int>(format) );
+	sKey.append( QString( "%1 %2 %3 %4 %5\n" )
+				 .arg( m_loops.start_frame ).arg( m_loops.loop_frame )
+				 .arg( m_loops.end_frame ).arg( m_loops.count )
+				 .arg( m_loops.mode ) );
+	if ( m_rubberband.use ) {
+		sKey.append( QString( "%1 %2 %3 %4\n" )
+					 .arg( m_rubberband.divider, 0, 'g', 9 )
+					 .arg( m_rubberband.pitch, 0, 'g', 9 )
+					 .arg( m_rubberband.c_settings )
+					 .arg( fBpm, 0, 'g', 9 ) );
+	}
+	for ( const auto* pEnvelope : { &m_panEnvelope, &m_velocityEnvelope } ) {
+		for ( const auto& point : *pEnvelope ) {
+			sKey.append( QString( "%1:%2 " ).arg( point.frame )
+						 .arg( point.value ) );
+		}
+		sKey.append( "\n" );
+	}
+
+	return QString::fromLatin1(
+		QCryptographicHash::hash( sKey.toUtf8(),
+								  QCryptographicHash::Sha1 ).toHex() );
+}
+
+void Sample::setBuffer( std::shared_ptr<SampleRegistry::Buffer> pBuffer )
+{
+	m_pBuffer = pBuffer;
+	if ( pBuffer->getFormat() == ResampleKernels::Format::Float ) {
+		m_data_L = pBuffer->getData_L();
+		m_data_R = pBuffer->getData_R();
+	}
+	else {
+		// Converted to float only on demand by getData_L().
+		m_data_L = m_data_R = nullptr;
+	}
+	m_nFrames = pBuffer->getFrames();
+	m_nHeadFrames = pBuffer->getHeadFrames();
+	m_nSampleRate = pBuffer->getSampleRate();
+}
+
+void Sample::share( const QString& sKey )
+{
+	if ( m_pBuffer == nullptr ) {
+		// Hand the data over.
+		m_pBuffer = std::make_shared<SampleRegistry::Buffer>(
+			m_data_L, m_data_R, m_nFrames, m_nHeadFrames, m_nSampleRate );
+	}
+	setBuffer( SampleRegistry::insert( sKey, getFilepath(), m_pBuffer ) );
+}
+
+void Sample::pack( ResampleKernels::Format format )
+{
+	if ( format == ResampleKernels::Format::Float || isStreamed() ||
+		 getFormat() == format ) {
+		return;
+	}
+
+	auto pPacked = std::make_shared<SampleRegistry::Buffer>(
+		format, getData_L(), getData_R(), m_nFrames, m_nSampleRate );
+	freeData();
+	m_pBuffer = pPacked;
+}
+
+bool Sample::decode( int nStreamingHead, bool bStore )
+{
+	// Will contain a bunch of metadata about the loaded sample.
+	SF_INFO sound_info = {0};
+
+	SNDFILE* file = openSndfile( getFilepath(), &sound_info );
 	if ( file == nullptr ) {
 		ERRORLOG( QString( "Error loading file [%1] with format [%2]: %3" )
 				  .arg( getFilepath() )
@@ -188,6 +365,12 @@ bool Sample::load( float fBpm )
 		return false;
 	}
 	
+	if ( nStreamingHead > 0 &&
+		 sound_info.frames > 2 * static_cast<sf_count_t>(nStreamingHead) &&
+		 sound_info.frames <= std::numeric_limits<int>::max() ) {
+		return loadHead( file, sound_info, nStreamingHead );
+	}
+
 	// Sanity check. SAMPLE_CHANNELS is defined in
 	// core/include/hydrogen/globals.h and set to 2.
 	if ( sound_info.channels > SAMPLE_CHANNELS ) {
@@ -226,17 +409,18 @@ bool Sample::load( float fBpm )
 	// Save the metadata of the loaded file into private members
 	// of the Sample class.
 	m_nFrames = sound_info.frames;
+	m_nHeadFrames = m_nFrames;
 	m_nSampleRate = sound_info.samplerate;
 
 	// Split the loaded frames into left and right channel. 
-	// If only one channels was present in the underlying data,
-	// duplicate its content.
+	// If only one channels was present in the underlying data, both
+	// channels share its content.
 	m_data_L = new float[ sound_info.frames ];
-	m_data_R = new float[ sound_info.frames ];
 	if ( sound_info.channels == 1 ) {
 		memcpy( m_data_L, buffer, m_nFrames * sizeof( float ) );
-		memcpy( m_data_R, buffer, m_nFrames * sizeof( float ) );
+		m_data_R = m_data_L;
 	} else if ( sound_info.channels == SAMPLE_CHANNELS ) {
+		m_data_R = new float[ sound_info.frames ];
 		for ( int i = 0; i < m_nFrames; i++ ) {
 			m_data_L[i] = buffer[i * SAMPLE_CHANNELS ];
 			m_data_R[i] = buffer[i * SAMPLE_CHANNELS + 1 ];
@@ -244,39 +428,77 @@ bool Sample::load( float fBpm )
 	}
 	delete[] buffer;
 
-	// Apply modifiers (if present/altered).
-	if ( ! applyLoops() ) {
-		WARNINGLOG( "Unable to apply loops" );
+	if ( bStore ) {
+		SampleCache::store( getFilepath(), m_nSampleRate, m_nFrames,
+							sound_info.channels, m_data_L, m_data_R );
 	}
-	applyVelocity();
-	applyPan();
-#ifdef H2CORE_HAVE_RUBBERBAND
-	applyRubberband( fBpm );
-#else
-	if ( ! execRubberbandCli( fBpm ) ) {
-		WARNINGLOG( "Unable to apply rubberband" );
+
+	return true;
+}
+
+bool Sample::loadHead( SNDFILE* file, const SF_INFO& soundInfo,
+					   int nHeadFrames )
+{
+	// Unlike in load() the file is read frame-wise. This way all
+	// channels beyond the first two are skipped properly.
+	const int nChannels = soundInfo.channels;
+	std::vector<float> buffer(
+		static_cast<size_t>(nHeadFrames) * nChannels, 0 );
+	const sf_count_t nRead = sf_readf_float( file, buffer.data(), nHeadFrames );
+	if ( nRead < nHeadFrames ) {
+		WARNINGLOG( QString( "Only [%1/%2] frames of the head of [%3] could be read" )
+					.arg( nRead ).arg( nHeadFrames ).arg( getFilepath() ) );
+	}
+
+	if ( sf_close( file ) != 0 ){
+		WARNINGLOG( QString( "Unable to close sample file %1" ).arg( getFilepath() ) );
+	}
+
+	unload();
+
+	m_nFrames = soundInfo.frames;
+	m_nHeadFrames = nHeadFrames;
+	m_nSampleRate = soundInfo.samplerate;
+
+	m_data_L = new float[ m_nHeadFrames ];
+	if ( nChannels == 1 ) {
+		std::copy( buffer.begin(), buffer.end(), m_data_L );
+		m_data_R = m_data_L;
+	} else {
+		m_data_R = new float[ m_nHeadFrames ];
+		for ( int i = 0; i < m_nHeadFrames; i++ ) {
+			m_data_L[i] = buffer[ i * nChannels ];
+			m_data_R[i] = buffer[ i * nChannels + 1 ];
+		}
 	}
-#endif
 
 	m_bIsLoaded = true;
 
 	return true;
 }
 
-void Sample::unload()
+void Sample::freeData()
 {
-	if ( m_data_L != nullptr ) {
-		delete [] m_data_L;
+	if ( m_pBuffer == nullptr ) {
+		if ( m_data_R != nullptr && m_data_R != m_data_L ) {
+			delete [] m_data_R;
+		}
+		if ( m_data_L != nullptr ) {
+			delete [] m_data_L;
+		}
 	}
+	m_pBuffer = nullptr;
+	m_data_L = m_data_R = nullptr;
+}
 
-	if ( m_data_R != nullptr ) {
-		delete [] m_data_R;
-	}
-	m_nFrames = m_nSampleRate = 0;
+void Sample::unload()
+{
+	freeData();
+	m_nFrames = m_nHeadFrames = m_nSampleRate = 0;
 	/** #m_bIsModified = false; leave this unchanged as pan,
 	    velocity, loop and rubberband are kept unchanged */
 
-	m_data_L = m_data_R = nullptr;
+	m_pResampled = nullptr;
 
 	m_bIsLoaded = false;
 }
@@ -317,8 +539,9 @@ bool Sample::applyLoops()
 	int loop_length =  m_loops.end_frame - m_loops.loop_frame;
 	int new_length = full_length + loop_length * m_loops.count;
 
+	// Mono samples write the same frames to both channels.
 	float* new_data_l = new float[ new_length ];
-	float* new_data_r = new float[ new_length ];
+	float* new_data_r = isMono() ? new_data_l : new float[ new_length ];
 
 	// copy full_length frames to new_data
 	if ( m_loops.mode==Loops::REVERSE && ( m_loops.count==0 || full_loop ) ) {
@@ -374,8 +597,7 @@ bool Sample::applyLoops()
 		}
 		assert( x==new_length );
 	}
-	delete[] m_data_L;
-	delete[] m_data_R;
+	freeData();
 	m_data_L = new_data_l;
 	m_data_R = new_data_r;
 	m_nFrames = new_length;
@@ -407,7 +629,9 @@ void Sample::applyVelocity()
 		float step = ( y - k ) / length;;
 		for ( int z = start_frame ; z < end_frame; z++ ) {
 			m_data_L[z] = m_data_L[z] * y;
-			m_data_R[z] = m_data_R[z] * y;
+			if ( m_data_R != m_data_L ) {
+				m_data_R[z] = m_data_R[z] * y;
+			}
 			y-=step;
 		}
 	}
@@ -420,6 +644,12 @@ void Sample::applyPan()
 	if( m_panEnvelope.size() == 0 ) {
 		return;
 	}
+
+	if ( isMono() ) {
+		// Panning results in distinct channels.
+		m_data_R = new float[ m_nFrames ];
+		memcpy( m_data_R, m_data_L, m_nFrames * sizeof( float ) );
+	}
 	
 	float inv_resolution = m_nFrames / 841.0F;
 	for ( int i = 1; i < m_panEnvelope.size(); i++ ) {
@@ -606,8 +836,7 @@ void Sample::applyRubberband( float fBpm ) {
 		retrieved += n;
 	}
 	
-	delete [] m_data_L;
-	delete [] m_data_R;
+	freeData();
 	m_data_L = new float[ retrieved ];
 	m_data_R = new float[ retrieved ];
 	memcpy( m_data_L, out_data_l, retrieved*sizeof( float ) );
@@ -636,7 +865,21 @@ bool Sample::execRubberbandCli( float fBpm )
 		return false;
 	}
 
-	QString outfilePath =  QDir::tempPath() + "/tmp_rb_outfile.wav";
+	// Layers are loaded in parallel. Each invocation must use files of
+	// its own. Both are removed when going out of scope.
+	QTemporaryFile outfile( QDir::tempPath() + "/tmp_rb_outfile_XXXXXX.wav" );
+	QTemporaryFile rubberResultFile(
+		QDir::tempPath() + "/tmp_rb_result_file_XXXXXX.wav" );
+	if ( ! outfile.open() || ! rubberResultFile.open() ) {
+		ERRORLOG( "Unable to create temporary files for rubberband" );
+		return false;
+	}
+	// Only the unique names are required. The files are written by
+	// libsndfile and rubberband.
+	outfile.close();
+	rubberResultFile.close();
+
+	const QString outfilePath = outfile.fileName();
 	if( !write( outfilePath ) ) {
 		ERRORLOG( "unable to write sample" );
 		return false;
@@ -660,7 +903,7 @@ bool Sample::execRubberbandCli( float fBpm )
 	QString rCs = QString( " %1" ).arg( m_rubberband.c_settings );
 	float fFrequency = Note::pitchToFrequency( ( double )m_rubberband.pitch );
 	QString rFs = QString( " %1" ).arg( fFrequency );
-	QString rubberResultPath = QDir::tempPath() + "/tmp_rb_result_file.wav";
+	const QString rubberResultPath = rubberResultFile.fileName();
 
 	arguments << "-D" << QString( " %1" ).arg( durationtime ) 	//stretch or squash to make output file X seconds long
 			  << "--threads"					//assume multi-CPU even if only one CPU is identified
@@ -678,7 +921,7 @@ bool Sample::execRubberbandCli( float fBpm )
 	}
 
 	delete pRubberbandProc;
-	if ( QFile( rubberResultPath ).exists() == false ) {
+	if ( QFileInfo( rubberResultPath ).size() == 0 ) {
 		_ERRORLOG( QString( "Rubberband reimporter File %1 not found" ).arg( rubberResultPath ) );
 		return false;
 	}
@@ -688,16 +931,10 @@ bool Sample::execRubberbandCli( float fBpm )
 		return false;
 	}
 
-	QFile( outfilePath ).remove();
-
-	QFile( rubberResultPath ).remove();
-
-	m_nFrames = p_Rubberbanded->getFrames();
-
-	m_data_L = p_Rubberbanded->getData_L();
-	m_data_R = p_Rubberbanded->getData_R();
-	p_Rubberbanded->m_data_L = nullptr;
-	p_Rubberbanded->m_data_R = nullptr;
+	// The data of the result is shared via the SampleRegistry and
+	// must not be taken over.
+	freeData();
+	setBuffer( p_Rubberbanded->m_pBuffer );
 
 	m_bIsModified = true;
 	
@@ -719,10 +956,18 @@ Sample::Loops::LoopMode Sample::parseLoopMode( const QString& sMode )
 
 bool Sample::write( const QString& path, int format ) const
 {
+	if ( isStreamed() ) {
+		ERRORLOG( QString( "Streamed sample [%1] is not held in memory as a whole" )
+				  .arg( m_sFilepath ) );
+		return false;
+	}
+
+	const float* pData_L = getData_L();
+	const float* pData_R = getData_R();
 	float* obuf = new float[ SAMPLE_CHANNELS * m_nFrames ];
 	for ( int i = 0; i < m_nFrames; ++i ) {
-		float value_l = m_data_L[i];
-		float value_r = m_data_R[i];
+		float value_l = pData_L[i];
+		float value_r = pData_R[i];
 		
 		if ( value_l > 1.f ) {
 			value_l = 1.f;
@@ -832,6 +1077,11 @@ QString Sample::Rubberband::toQString( const QString& sPrefix, bool bShort ) con
 }
 
 QString Sample::toQString( const QString& sPrefix, bool bShort ) const {
+	QString sBuffer = "nullptr";
+	if ( m_pBuffer != nullptr ) {
+		sBuffer = QString( "%1 users%2" ).arg( m_pBuffer.use_count() )
+			.arg( m_pBuffer->isMapped() ? ", mapped" : "" );
+	}
 	QString s = Base::sPrintIndention;
 	QString sOutput;
 	if ( ! bShort ) {
@@ -842,6 +1092,10 @@ QString Sample::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_sFilepath ) )
 			.append( QString( "%1%2m_nFrames: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_nFrames ) )
+			.append( QString( "%1%2m_nHeadFrames: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nHeadFrames ) )
+			.append( QString( "%1%2m_pBuffer: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( sBuffer ) )
 			.append( QString( "%1%2m_nSampleRate: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_nSampleRate ) )
 			.append( QString( "%1%2m_bIsModified: %3\n" ).arg( sPrefix ).arg( s )
@@ -871,6 +1125,8 @@ QString Sample::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( " m_bIsLoaded: %1" ).arg( m_bIsLoaded ) )
 			.append( QString( ", m_sFilepath: %1" ).arg( m_sFilepath ) )
 			.append( QString( ", m_nFrames: %1" ).arg( m_nFrames ) )
+			.append( QString( ", m_nHeadFrames: %1" ).arg( m_nHeadFrames ) )
+			.append( QString( ", m_pBuffer: %1" ).arg( sBuffer ) )
 			.append( QString( ", m_nSampleRate: %1" ).arg( m_nSampleRate ) )
 			.append( QString( ", m_bIsModified: %1" ).arg( m_bIsModified ) )
 			.append( ", m_panEnvelope: [" );
@@ -29,6 +29,7 @@
 
 #include <core/License.h>
 #include <core/Object.h>
+#include <core/Sampler/SampleRegistry.h>
 
 namespace H2Core
 {
@@ -130,6 +131,11 @@ class Sample : public H2Core::Object<Sample>
 		};
 
 	static QString sndfileFormatToQString( int nFormat );
+	/** Opens @a sPath for reading using libsndfile and stores its
+	 * metadata in @a pInfo.
+	 *
+	 * \return nullptr on failure. */
+	static SNDFILE* openSndfile( const QString& sPath, SF_INFO* pInfo );
 
 		/**
 		 * Sample constructor
@@ -185,9 +191,9 @@ class Sample : public H2Core::Object<Sample>
 		 * (two per default) channels in the audio file. If
 		 * there are more, Hydrogen will _NOT_ downmix its
 		 * content but simply extract the first two channels
-		 * and display a warning message. For mono file the
-		 * same content will be assigned to both the left
-		 * (#m_data_L) and right channel (#m_data_R).
+		 * and display a warning message. For mono files the
+		 * content is stored just once and both the left
+		 * (#m_data_L) and right channel (#m_data_R) point to it.
 		 *
 		 * If the total number of frames in the file is larger
 		 * than the maximum value of an `int', the content is
@@ -198,9 +204,29 @@ class Sample : public H2Core::Object<Sample>
 		 * rubberband, and envelope modifications in case they were
 		 * set by the user.
 		 *
+		 * \param fBpm Tempo targeted by the rubberband modifications.
+		 * \param nStreamingHead If positive, samples without any
+		 *   modifications holding more than twice as many frames are
+		 *   only loaded up to this frame. The remainder is streamed
+		 *   from disk by the #SampleStreamer during playback.
+		 * \param bUseCache Whether to use the #SampleCache. Unmodified
+		 *   samples found in there are mapped instead of loaded.
+		 * \param format Format the sample data is stored in once all
+		 *   modifications were applied. Packed integer formats are
+		 *   rendered directly by the #Sampler while getData_L() and
+		 *   getData_R() convert them to float on first access.
+		 *   Streamed samples are always stored as float.
+		 *
+		 * In case another sample loaded the same file with the same
+		 * modifications, its data is shared via the #SampleRegistry
+		 * instead.
+		 *
 		 * \fn load()
 		 */
-		bool load( float fBpm = 120 );
+		bool load( float fBpm = 120, int nStreamingHead = 0,
+				   bool bUseCache = false,
+				   ResampleKernels::Format format =
+				   ResampleKernels::Format::Float );
 		/**
 		 * Flush the current content of the left and right
 		 * channel and the current metadata.
@@ -217,17 +243,67 @@ class Sample : public H2Core::Object<Sample>
 
 		/** \return #m_nFrames accessor */
 		int getFrames() const;
+		/** \return #m_nHeadFrames */
+		int getHeadFrames() const;
+		/** \return Whether only the beginning of the sample is held
+		 * in memory. */
+		bool isStreamed() const;
 		/** \return #m_nSampleRate */
 		int getSampleRate() const;
+		/** \return Whether #m_data_L and #m_data_R are the same
+		 * buffer. */
+		bool isMono() const;
+		/** \return Format the data of the sample is stored in. */
+		ResampleKernels::Format getFormat() const;
+		/** \return Data of the left channel in case it is stored in
+		 * a packed integer format, nullptr otherwise. */
+		const void* getPackedData_L() const;
+		/** \return Same as getPackedData_L() for the right channel. */
+		const void* getPackedData_R() const;
 
 		/** \return data size, which is calculated by
 		 * #m_nFrames time sizeof( float ) * 2
 		 */
 		int getSize() const;
-		/** \return #m_data_L*/
+		/** \return #m_data_L. Holds #m_nHeadFrames frames. For
+		 * packed samples the float version of #m_pBuffer is created
+		 * on first access, which must not happen in the audio
+		 * thread. */
 		float* getData_L() const;
-		/** \return #m_data_R*/
+		/** \return #m_data_R. Holds #m_nHeadFrames frames. Same as
+		 * getData_L() for mono samples. */
 		float* getData_R() const;
+
+		/**
+		 * Copy of the sample data converted to a different sample
+		 * rate. It is created in the background by #ResampleCache and
+		 * allows the #Sampler to render unpitched notes without
+		 * interpolating.
+		 */
+		struct Resampled {
+			int nSampleRate;
+			int nFrames;
+			std::vector<float> data_L;
+			/** Empty for mono samples. #data_L holds both channels
+			 * then. */
+			std::vector<float> data_R;
+		};
+		/**
+		 * Must only be called by the audio thread or while holding
+		 * the lock of the #AudioEngine.
+		 *
+		 * \return Converted copy of the sample data in case one for
+		 *   @a nSampleRate is present. nullptr otherwise.
+		 */
+		const Resampled* getResampled( int nSampleRate ) const;
+		/**
+		 * Replaces #m_pResampled. Must only be called while holding
+		 * the lock of the #AudioEngine.
+		 *
+		 * \return Previous copy. It should be destructed after
+		 *   releasing the lock.
+		 */
+		std::shared_ptr<Resampled> setResampled( std::shared_ptr<Resampled> pResampled );
 		/**
 		 * #m_bIsModified setter
 		 * \param value the new value for #m_bIsModified
@@ -268,6 +344,32 @@ class Sample : public H2Core::Object<Sample>
 		 * \return String presentation of current object.*/
 		QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
 	private:
+		/** Reads the first @a nHeadFrames frames of @a file into
+		 * #m_data_L and #m_data_R and closes it. */
+		bool loadHead( SNDFILE* file, const SF_INFO& soundInfo, int nHeadFrames );
+		/** Decodes the sample file into #m_data_L and #m_data_R.
+		 * Streamed samples are loaded using loadHead().
+		 *
+		 * \param bStore Whether to add the decoded data to the
+		 *   #SampleCache. */
+		bool decode( int nStreamingHead, bool bStore );
+		/** Frees #m_data_L and #m_data_R unless they belong to
+		 * #m_pBuffer. */
+		void freeData();
+		/** \return Identifier of the sample file and all modifiers
+		 * used by the #SampleRegistry. Empty in case the file does not
+		 * exist. */
+		QString getRegistryKey( float fBpm, int nStreamingHead,
+								ResampleKernels::Format format ) const;
+		/** Uses the data of @a pBuffer. */
+		void setBuffer( std::shared_ptr<SampleRegistry::Buffer> pBuffer );
+		/** Replaces the loaded float data by a #SampleRegistry::Buffer
+		 * stored in @a format. Streamed samples are left as they
+		 * are. */
+		void pack( ResampleKernels::Format format );
+		/** Hands the loaded data over to the #SampleRegistry or
+		 * replaces it with the one registered for @a sKey. */
+		void share( const QString& sKey );
 		/** \return sample duration in seconds */
 		double getSampleDuration() const;
 
@@ -299,9 +401,21 @@ class Sample : public H2Core::Object<Sample>
 		bool				m_bIsLoaded;
 		QString				m_sFilepath;          ///< filepath of the sample
 		int					m_nFrames;            ///< number of frames in this sample
+		/** Number of frames held in #m_data_L and #m_data_R. Smaller
+		 * than #m_nFrames for streamed samples. */
+		int					m_nHeadFrames;
 		int					m_nSampleRate;       ///< samplerate for this sample
-		float*				m_data_L;            ///< left channel data
+		/** Left channel data. nullptr for samples stored in a packed
+		 * format. */
+		float*				m_data_L;
 		float*				m_data_R;            ///< right channel data
+		/** Buffer #m_data_L and #m_data_R point into once the sample
+		 * is loaded. It is shared with all other samples using the
+		 * same file and modifiers. */
+		std::shared_ptr<SampleRegistry::Buffer> m_pBuffer;
+		/** Data converted to the sample rate of the audio driver.
+		 * Dropped whenever the sample is (un)loaded. */
+		std::shared_ptr<Resampled> m_pResampled;
 		bool				m_bIsModified;       ///< true if sample is modified
 		PanEnvelope			m_panEnvelope;      ///< pan envelope vector
 		VelocityEnvelope	m_velocityEnvelope; ///< velocity envelope vector
@@ -341,11 +455,45 @@ inline int Sample::getFrames() const
 	return m_nFrames;
 }
 
+inline int Sample::getHeadFrames() const
+{
+	return m_nHeadFrames;
+}
+
+inline bool Sample::isStreamed() const
+{
+	return m_nHeadFrames < m_nFrames;
+}
+
 inline int Sample::getSampleRate() const
 {
 	return m_nSampleRate;
 }
 
+inline bool Sample::isMono() const
+{
+	if ( m_pBuffer != nullptr ) {
+		return m_pBuffer->isMono();
+	}
+	return m_data_L != nullptr && m_data_L == m_data_R;
+}
+
+inline ResampleKernels::Format Sample::getFormat() const
+{
+	return m_pBuffer != nullptr ? m_pBuffer->getFormat() :
+		ResampleKernels::Format::Float;
+}
+
+inline const void* Sample::getPackedData_L() const
+{
+	return m_pBuffer != nullptr ? m_pBuffer->getPackedData_L() : nullptr;
+}
+
+inline const void* Sample::getPackedData_R() const
+{
+	return m_pBuffer != nullptr ? m_pBuffer->getPackedData_R() : nullptr;
+}
+
 inline double Sample::getSampleDuration() const
 {
 	return static_cast<double>(m_nFrames) / static_cast<double>(m_nSampleRate);
@@ -358,14 +506,36 @@ inline int Sample::getSize() const
 
 inline float* Sample::getData_L() const
 {
+	if ( m_data_L == nullptr && m_pBuffer != nullptr ) {
+		return m_pBuffer->getData_L();
+	}
 	return m_data_L;
 }
 
 inline float* Sample::getData_R() const
 {
+	if ( m_data_R == nullptr && m_pBuffer != nullptr ) {
+		return m_pBuffer->getData_R();
+	}
 	return m_data_R;
 }
 
+inline const Sample::Resampled* Sample::getResampled( int nSampleRate ) const
+{
+	if ( m_pResampled != nullptr &&
+		 m_pResampled->nSampleRate == nSampleRate ) {
+		return m_pResampled.get();
+	}
+	return nullptr;
+}
+
+inline std::shared_ptr<Sample::Resampled> Sample::setResampled(
+	std::shared_ptr<Resampled> pResampled )
+{
+	m_pResampled.swap( pResampled );
+	return pResampled;
+}
+
 inline void Sample::setIsModified( bool is_modified )
 {
 	m_bIsModified = is_modified;
@@ -939,13 +939,16 @@ std::shared_ptr<Song> Song::getEmptySong( std::shared_ptr<SoundLibraryDatabase>
 	const QString sDefaultDrumkitPath = Filesystem::drumkit_default_kit();
 	auto pDrumkit = pSoundLibraryDatabase->getDrumkit( sDefaultDrumkitPath );
 	if ( pDrumkit == nullptr ) {
-		for ( const auto& pEntry : pSoundLibraryDatabase->getDrumkitDatabase() ) {
+		const auto pDrumkitEntries = pSoundLibraryDatabase->getDrumkitEntries();
+		for ( const auto& pEntry : *pDrumkitEntries ) {
 			if ( pEntry.second != nullptr ) {
-				WARNINGLOG( QString( "Unable to retrieve default drumkit [%1]. Using kit [%2] instead." )
-							.arg( sDefaultDrumkitPath )
-							.arg( pEntry.first ) );
-				pDrumkit = pEntry.second;
-				break;
+				pDrumkit = pSoundLibraryDatabase->getDrumkit( pEntry.first );
+				if ( pDrumkit != nullptr ) {
+					WARNINGLOG( QString( "Unable to retrieve default drumkit [%1]. Using kit [%2] instead." )
+								.arg( sDefaultDrumkitPath )
+								.arg( pEntry.first ) );
+					break;
+				}
 			}
 		}
 	}
@@ -22,15 +22,24 @@
 
 #include <QDir>
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/NotePool.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/CoreActionController.h>
+#include <core/DrumkitSwitcher.h>
 #include <core/EventQueue.h>
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Drumkit.h>
 #include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
 #include <core/Basics/PatternList.h>
 #include <core/Basics/Pattern.h>
 #include <core/Basics/Playlist.h>
@@ -40,6 +49,7 @@
 #include "core/MidiMap.h"
 #include <core/Helpers/Xml.h>
 #include <core/SoundLibrary/SoundLibraryDatabase.h>
+#include <core/Sampler/SampleCache.h>
 
 #include <core/IO/AlsaMidiDriver.h>
 #include <core/IO/MidiOutput.h>
@@ -1270,6 +1280,19 @@ bool CoreActionController::setDrumkit( const QString& sDrumkit ) {
 	return setDrumkit( std::make_shared<Drumkit>(pDrumkit) );
 }
 
+/** Instrument a note of the current song will be assigned to when
+ * switching drumkits. */
+struct NoteMapping {
+	std::shared_ptr<Note> pNote;
+	/** State of the note the mapping was resolved for. */
+	QString sType;
+	int nInstrumentId;
+	/** Result of Note::findMappedInstrument(). */
+	std::shared_ptr<Instrument> pInstrument;
+	std::shared_ptr<ADSR> pAdsr;
+	QString sNewType;
+};
+
 bool CoreActionController::setDrumkit( std::shared_ptr<Drumkit> pNewDrumkit ) {
 	if ( pNewDrumkit == nullptr ) {
 		ERRORLOG( "Provided Drumkit is not valid" );
@@ -1284,6 +1307,13 @@ bool CoreActionController::setDrumkit( std::shared_ptr<Drumkit> pNewDrumkit ) {
 		ERRORLOG( "No song set yet" );
 		return false;
 	}
+
+	// Kits can be switched both from the calling thread and the
+	// #DrumkitSwitcher. Doing so concurrently would mess up the death
+	// row.
+	static std::mutex switchMutex;
+	std::lock_guard<std::mutex> switchLock( switchMutex );
+
 	auto pPreviousDrumkit = pSong->getDrumkit();
 	if ( pPreviousDrumkit == pNewDrumkit ) {
 		return true;
@@ -1311,26 +1341,136 @@ bool CoreActionController::setDrumkit( std::shared_ptr<Drumkit> pNewDrumkit ) {
 	pNewDrumkit->loadSamples(
 		pAudioEngine->getTransportPosition()->getBpm());
 
+	// Mapping the notes of all patterns onto the new kit involves
+	// lookups in both kits as well as copying ADSRs. This is done up
+	// front while the audio engine is only locked for collecting the
+	// notes themselves.
+	const auto pNewDrumkitMap = pNewDrumkit->toDrumkitMap();
+	std::shared_ptr<DrumkitMap> pPreviousDrumkitMap = nullptr;
+	std::vector<NoteMapping> noteMappings;
+
+	// The previous kit is still the one of the song and its instrument
+	// list might be altered by the GUI while we are mapping. We resolve
+	// against a snapshot of it instead.
+	std::shared_ptr<Drumkit> pPreviousDrumkitSnapshot = nullptr;
+	std::vector<std::shared_ptr<Instrument>> previousInstruments;
+	QString sPreviousName, sPreviousPath;
+
 	pAudioEngine->lock( RIGHT_HERE );
+	if ( pPreviousDrumkit != nullptr ) {
+		pPreviousDrumkitMap = pPreviousDrumkit->toDrumkitMap();
+		previousInstruments.reserve( pPreviousDrumkit->getInstruments()->size() );
+		for ( const auto& ppInstrument : *pPreviousDrumkit->getInstruments() ) {
+			previousInstruments.push_back( ppInstrument );
+		}
+		sPreviousName = pPreviousDrumkit->getName();
+		sPreviousPath = pPreviousDrumkit->getPath();
+	}
+	for ( const auto& ppPattern : *pSong->getPatternList() ) {
+		std::lock_guard<std::mutex> guard( ppPattern->getNotesMutex() );
+		for ( const auto& [ _, ppNote ] : *ppPattern->getNotes() ) {
+			if ( ppNote != nullptr ) {
+				noteMappings.push_back( { ppNote, ppNote->getType(),
+						ppNote->getInstrumentId(), nullptr, nullptr, "" } );
+			}
+		}
+	}
+	pAudioEngine->unlock();
+
+	if ( pPreviousDrumkit != nullptr ) {
+		pPreviousDrumkitSnapshot = std::make_shared<Drumkit>();
+		pPreviousDrumkitSnapshot->setName( sPreviousName );
+		pPreviousDrumkitSnapshot->setPath( sPreviousPath );
+		for ( const auto& ppInstrument : previousInstruments ) {
+			pPreviousDrumkitSnapshot->getInstruments()->add( ppInstrument );
+		}
+	}
+
+	std::unordered_map<const Note*, const NoteMapping*> noteMappingLookup;
+	noteMappingLookup.reserve( noteMappings.size() );
+	for ( auto& mapping : noteMappings ) {
+		mapping.sNewType = mapping.sType;
+		mapping.pInstrument = Note::findMappedInstrument(
+			&mapping.sNewType, mapping.nInstrumentId, pNewDrumkit,
+			pNewDrumkitMap, pPreviousDrumkitSnapshot, pPreviousDrumkitMap );
+		if ( mapping.pInstrument != nullptr ) {
+			mapping.pAdsr = mapping.pInstrument->copyAdsr();
+		}
+		noteMappingLookup[ mapping.pNote.get() ] = &mapping;
+	}
+
+	// Instruments of the previous kit without any notes left. Their
+	// samples are freed after unlocking the audio engine.
+	std::vector<std::shared_ptr<Instrument>> releasedInstruments;
+
+	pAudioEngine->lock( RIGHT_HERE );
+
+	// In case instruments of the previous kit were added, removed, or
+	// reordered while resolving, the mappings are stale.
+	bool bPreviousDrumkitChanged = false;
+	if ( pPreviousDrumkit != nullptr ) {
+		const auto pInstruments = pPreviousDrumkit->getInstruments();
+		bPreviousDrumkitChanged =
+			pInstruments->size() != previousInstruments.size();
+		for ( int ii = 0; ! bPreviousDrumkitChanged &&
+				  ii < pInstruments->size(); ++ii ) {
+			bPreviousDrumkitChanged =
+				pInstruments->get( ii ) != previousInstruments[ ii ];
+		}
+		if ( bPreviousDrumkitChanged ) {
+			pPreviousDrumkitMap = pPreviousDrumkit->toDrumkitMap();
+		}
+	}
 
 	// Add all instruments of the previous drumkit to the death row. This way
 	// all notes in audio engine and sampler queue can be rendered till they are
 	// done. Unloading their samples will be done at a latter point.
 	if ( pPreviousDrumkit != nullptr ) {
 		for ( const auto& ppInstrument : *pPreviousDrumkit->getInstruments() ) {
-			pHydrogen->addInstrumentToDeathRow( ppInstrument );
+			pHydrogen->addInstrumentToDeathRow( ppInstrument,
+												&releasedInstruments );
 		}
 	}
 
 	// Instead of letting all notes associated with this instrument ring till
-	// the end, we discard those for which playback did not started yet and make
-	// the remaining ones enter ADSR release phase.
+	// the end, we discard those for which playback did not started yet and
+	// either fade out the remaining ones or make them enter ADSR release
+	// phase.
 	pAudioEngine->clearNoteQueues();
-	pAudioEngine->getSampler()->releasePlayingNotes();
+	const int nCrossfade = Preferences::get_instance()->m_nDrumkitCrossfade;
+	if ( nCrossfade > 0 ) {
+		pAudioEngine->getSampler()->fadeOutPlayingNotes(
+			static_cast<float>(nCrossfade) / 1000 );
+	} else {
+		pAudioEngine->getSampler()->releasePlayingNotes();
+	}
 	pAudioEngine->getSampler()->clearLastUsedLayers();
 
 	pSong->setDrumkit( pNewDrumkit );
-	pSong->getPatternList()->mapTo( pNewDrumkit, pPreviousDrumkit );
+
+	// Notes altered or added while resolving the mappings are mapped
+	// from scratch.
+	for ( const auto& ppPattern : *pSong->getPatternList() ) {
+		ppPattern->setDrumkitName( pNewDrumkit->getName() );
+		std::lock_guard<std::mutex> guard( ppPattern->getNotesMutex() );
+		for ( const auto& [ _, ppNote ] : *ppPattern->getNotes() ) {
+			if ( ppNote == nullptr ) {
+				continue;
+			}
+			const auto it = noteMappingLookup.find( ppNote.get() );
+			if ( ! bPreviousDrumkitChanged && it != noteMappingLookup.end() &&
+				 it->second->sType == ppNote->getType() &&
+				 it->second->nInstrumentId == ppNote->getInstrumentId() ) {
+				ppNote->assignInstrument( it->second->pInstrument,
+										  it->second->pAdsr,
+										  it->second->sNewType );
+			}
+			else {
+				ppNote->mapTo( pNewDrumkit, pNewDrumkitMap, pPreviousDrumkit,
+							   pPreviousDrumkitMap );
+			}
+		}
+	}
 
 	pHydrogen->renameJackPorts( pSong );
 
@@ -1341,8 +1481,15 @@ bool CoreActionController::setDrumkit( std::shared_ptr<Drumkit> pNewDrumkit ) {
 			Event::Trigger::Suppress );
 	}
 
+	pAudioEngine->getNotePool()->reserveLayerInfos( pNewDrumkit );
+	pAudioEngine->updateResampleCache( pNewDrumkit );
+
 	pAudioEngine->unlock();
 
+	for ( const auto& ppInstrument : releasedInstruments ) {
+		ppInstrument->unloadSamples();
+	}
+
 	initExternalControlInterfaces();
 
 	pHydrogen->setIsModified( true );
@@ -1352,6 +1499,34 @@ bool CoreActionController::setDrumkit( std::shared_ptr<Drumkit> pNewDrumkit ) {
 	return true;
 }
 
+bool CoreActionController::setDrumkitInBackground( const QString& sDrumkit ) {
+	auto pHydrogen = Hydrogen::get_instance();
+	ASSERT_HYDROGEN
+	auto pDrumkit = pHydrogen->getSoundLibraryDatabase()
+		->getDrumkit( sDrumkit );
+	if ( pDrumkit == nullptr ) {
+		ERRORLOG( QString( "Drumkit [%1] could not be loaded." )
+				  .arg( sDrumkit ) );
+		return false;
+	}
+
+	return setDrumkitInBackground( std::make_shared<Drumkit>(pDrumkit) );
+}
+
+bool CoreActionController::setDrumkitInBackground( std::shared_ptr<Drumkit> pDrumkit ) {
+	if ( pDrumkit == nullptr ) {
+		ERRORLOG( "Provided Drumkit is not valid" );
+		return false;
+	}
+
+	auto pHydrogen = Hydrogen::get_instance();
+	ASSERT_HYDROGEN
+
+	pHydrogen->getDrumkitSwitcher()->request( pDrumkit );
+
+	return true;
+}
+
 bool CoreActionController::upgradeDrumkit(const QString &sDrumkitPath,
                                           const QString &sNewPath) {
 	auto pHydrogen = Hydrogen::get_instance();
@@ -1607,6 +1782,32 @@ bool CoreActionController::validateDrumkit( const QString& sDrumkitPath,
 	return true;
 }
 
+bool CoreActionController::prewarmSampleCache( const QString& sDrumkitPath ) {
+	if ( ! SampleCache::isEnabled() ) {
+		ERRORLOG( "The sample cache is disabled. Set 'sampleCacheSize' in the preferences first." );
+		return false;
+	}
+
+	const QFileInfo info( sDrumkitPath );
+	const QString sDrumkitDir = info.isDir() ? info.absoluteFilePath() :
+		info.absolutePath();
+	auto pDrumkit = Drumkit::load( sDrumkitDir, false, true );
+	if ( pDrumkit == nullptr ) {
+		ERRORLOG( QString( "Unable to load drumkit from source path [%1]" )
+				  .arg( sDrumkitPath ) );
+		return false;
+	}
+
+	// Samples missing in the cache are added while loading them.
+	pDrumkit->loadSamples();
+	pDrumkit->unloadSamples();
+
+	INFOLOG( QString( "Samples of [%1] cached. Cache size: [%2] bytes" )
+			 .arg( pDrumkit->getName() ).arg( SampleCache::getSize() ) );
+
+	return true;
+}
+
 std::shared_ptr<Drumkit> CoreActionController::retrieveDrumkit( const QString& sDrumkitPath, bool* bIsCompressed, QString *sDrumkitDir, QString* sTemporaryFolder ) {
 	auto pHydrogen = Hydrogen::get_instance();
 	assert( pHydrogen );
@@ -2358,7 +2559,8 @@ bool CoreActionController::toggleGridCell( int nColumn, int nRow ){
 	return true;
 }
 
-bool CoreActionController::handleNote( int nNote, float fVelocity, bool bNoteOff ) {
+bool CoreActionController::handleNote( int nNote, float fVelocity, bool bNoteOff,
+									   long long nTimestamp, int nFrameOffset ) {
 	const auto pPref = Preferences::get_instance();
 	auto pHydrogen = Hydrogen::get_instance();
 	ASSERT_HYDROGEN
@@ -2439,7 +2641,8 @@ bool CoreActionController::handleNote( int nNote, float fVelocity, bool bNoteOff
 		}
 
 		if ( pHydrogen->addRealtimeNote(
-				 nCurrentInstrument, fVelocity, bNoteOff, nNote ) ) {
+				 nCurrentInstrument, fVelocity, bNoteOff, nNote, nTimestamp,
+				 nFrameOffset ) ) {
 			instrumentStrings << QString( "%1 (%2)" )
 				.arg( ppInstrument->getName() ).arg( nCurrentInstrument );
 		}
@@ -2488,10 +2691,11 @@ bool CoreActionController::setBpm( float fBpm ) {
 	fBpm = std::clamp( fBpm, static_cast<float>(MIN_BPM),
 						  static_cast<float>(MAX_BPM) );
 
-	pAudioEngine->lock( RIGHT_HERE );
-	// Use tempo in the next process cycle of the audio engine.
-	pAudioEngine->setNextBpm( fBpm );
-	pAudioEngine->unlock();
+	// Use tempo in the next process cycle of the audio engine. The
+	// tempo is stored atomically and does not require the lock.
+	pAudioEngine->pushCommand( [fBpm]() {
+		Hydrogen::get_instance()->getAudioEngine()->setNextBpm( fBpm );
+	}, false );
 
 	// Store it's value in the .h2song file.
 	pSong->setBpm( fBpm );
@@ -282,9 +282,32 @@ class CoreActionController : public H2Core::Object<CoreActionController> {
 	 * and also can be used to reset the parameters of the current
 	 * drumkit to its default values.
 	 *
+	 * All samples of @a pDrumkit are loaded and the instruments the
+	 * notes of all patterns will be mapped to are determined before
+	 * locking the #AudioEngine. It is only locked briefly to publish
+	 * the new kit. Samples of the previous kit no longer in use are
+	 * freed after unlocking it. Notes of the previous kit still
+	 * playing are faded out within Preferences::m_nDrumkitCrossfade
+	 * or enter their release phase in case it is 0.
+	 *
 	 * \param pDrumkit Full-fledged #H2Core::Drumkit to load.
 	 */
 	static bool setDrumkit( std::shared_ptr<Drumkit> pDrumkit );
+	/** Wrapper around setDrumkitInBackground() that allows loading
+	 * drumkits by name or path. See setDrumkit( const QString& ). */
+	static bool setDrumkitInBackground( const QString& sDrumkit );
+	/**
+	 * Schedules setDrumkit() to be run by the #DrumkitSwitcher and
+	 * returns immediately. A switch requested earlier but not
+	 * started yet is replaced.
+	 *
+	 * Used for switches triggered via MIDI or OSC. The handling of
+	 * subsequent messages is not delayed till all samples of
+	 * @a pDrumkit are loaded.
+	 *
+	 * \return false in case the request could not be scheduled.
+	 */
+	static bool setDrumkitInBackground( std::shared_ptr<Drumkit> pDrumkit );
 	/** 
 	 * Upgrades the drumkit found at absolute path @a sDrumkitPath.
 	 *
@@ -307,6 +330,18 @@ class CoreActionController : public H2Core::Object<CoreActionController> {
 	 *   definition or also all previous versions should be checked.
 	 */
 	static bool validateDrumkit( const QString& sDrumkitPath, bool bCheckLegacyVersions = false );
+	/**
+	 * Decodes all samples of the drumkit in @a sDrumkitPath into the
+	 * #SampleCache. Those already present are skipped.
+	 *
+	 * @param sDrumkitPath Can be either an absolute path to a folder
+	 *   containing a drumkit file (drumkit.xml) or an absolute path to
+	 *   a drumkit file itself.
+	 *
+	 * \return false in case the cache is disabled or the drumkit
+	 *   could not be loaded.
+	 */
+	static bool prewarmSampleCache( const QString& sDrumkitPath );
 	/**
 	 * Extracts the compressed .h2drumkit file in @a sDrumkitPath into
 	 * @a sTargetDir.
@@ -448,9 +483,18 @@ class CoreActionController : public H2Core::Object<CoreActionController> {
 		 *   between [36,127] inspired by the General MIDI standard.
 		 * @param fVelocity how "hard" the note was triggered.
 		 * @param bNoteOff whether note should trigger or stop sound.
+		 * @param nTimestamp time the event was received in microseconds
+		 *   (see MidiMessage::currentTimestamp()). If provided, the note
+		 *   will be started at the corresponding frame within the next
+		 *   audio buffer. 0 for events without time information.
+		 * @param nFrameOffset offset of the event within the process
+		 *   cycle it was received in (see MidiMessage::m_nFrameOffset).
+		 *   Used instead of @a nTimestamp to place the note if it is not
+		 *   -1.
 		 *
 		 * @return bool true on success */
-		static bool handleNote( int nNote, float fVelocity, bool bNoteOff = false );
+		static bool handleNote( int nNote, float fVelocity, bool bNoteOff = false,
+								long long nTimestamp = 0, int nFrameOffset = -1 );
 
 	/**
 	 * Loads the drumkit specified in @a sDrumkitPath.
@@ -0,0 +1,142 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/DrumkitSwitcher.h>
+
+#include <core/Basics/Drumkit.h>
+#include <core/CoreActionController.h>
+#include <core/EngineContext.h>
+
+namespace H2Core
+{
+
+DrumkitSwitcher::DrumkitSwitcher()
+	: m_pContext( EngineContext::getCurrent() )
+	, m_pPendingDrumkit( nullptr )
+	, m_bSwitching( false )
+	, m_bShutdown( false )
+{
+	m_worker = std::thread( &DrumkitSwitcher::workerLoop, this );
+}
+
+DrumkitSwitcher::~DrumkitSwitcher() {
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bShutdown = true;
+		m_pPendingDrumkit = nullptr;
+	}
+	m_condition.notify_all();
+	m_worker.join();
+}
+
+void DrumkitSwitcher::request( std::shared_ptr<Drumkit> pDrumkit ) {
+	if ( pDrumkit == nullptr ) {
+		ERRORLOG( "Invalid drumkit" );
+		return;
+	}
+
+	std::shared_ptr<Drumkit> pDiscardedDrumkit;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		pDiscardedDrumkit = m_pPendingDrumkit;
+		m_pPendingDrumkit = pDrumkit;
+	}
+	m_condition.notify_all();
+
+	if ( pDiscardedDrumkit != nullptr ) {
+		INFOLOG( QString( "Request for drumkit [%1] replaced by [%2]" )
+				 .arg( pDiscardedDrumkit->getName() )
+				 .arg( pDrumkit->getName() ) );
+	}
+}
+
+bool DrumkitSwitcher::isBusy() const {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_bSwitching || m_pPendingDrumkit != nullptr;
+}
+
+void DrumkitSwitcher::waitForIdle() {
+	std::unique_lock<std::mutex> lock( m_mutex );
+	m_condition.wait( lock, [&]{
+		return m_bShutdown ||
+			( ! m_bSwitching && m_pPendingDrumkit == nullptr ); } );
+}
+
+void DrumkitSwitcher::workerLoop() {
+	EngineContext::Scope scope( m_pContext );
+
+	while ( true ) {
+		std::shared_ptr<Drumkit> pDrumkit;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_condition.wait( lock, [&]{
+				return m_bShutdown || m_pPendingDrumkit != nullptr; } );
+			if ( m_bShutdown ) {
+				return;
+			}
+			pDrumkit.swap( m_pPendingDrumkit );
+			m_bSwitching = true;
+		}
+
+		if ( ! CoreActionController::setDrumkit( pDrumkit ) ) {
+			ERRORLOG( QString( "Unable to switch to drumkit [%1]" )
+					  .arg( pDrumkit->getName() ) );
+		}
+
+		// Drop our reference before waking up waiting threads.
+		pDrumkit = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_bSwitching = false;
+		}
+		m_condition.notify_all();
+	}
+}
+
+QString DrumkitSwitcher::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	std::lock_guard<std::mutex> lock( m_mutex );
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[DrumkitSwitcher]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_pPendingDrumkit: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_pPendingDrumkit != nullptr ?
+									m_pPendingDrumkit->getName() : "nullptr" ) )
+			.append( QString( "%1%2m_bSwitching: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_bSwitching ) )
+			.append( QString( "%1%2m_bShutdown: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_bShutdown ) );
+	}
+	else {
+		sOutput = QString( "[DrumkitSwitcher]" )
+			.append( QString( " m_pPendingDrumkit: %1" )
+					 .arg( m_pPendingDrumkit != nullptr ?
+						   m_pPendingDrumkit->getName() : "nullptr" ) )
+			.append( QString( ", m_bSwitching: %1" ).arg( m_bSwitching ) )
+			.append( QString( ", m_bShutdown: %1" ).arg( m_bShutdown ) );
+	}
+
+	return sOutput;
+}
+
+};
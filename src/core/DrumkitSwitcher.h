@@ -0,0 +1,97 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_DRUMKIT_SWITCHER_H
+#define H2C_DRUMKIT_SWITCHER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class Drumkit;
+class EngineContext;
+
+/**
+ * Switches the drumkit of the current #Song on a background thread.
+ *
+ * CoreActionController::setDrumkit() decodes all samples of the new
+ * kit and resolves the instruments all notes will be mapped to before
+ * locking the #AudioEngine for a short period to publish the result.
+ * But it still blocks the calling thread till the kit is loaded. This
+ * class runs it on a dedicated worker instead, e.g. for kit switches
+ * triggered via MIDI or OSC, which must not stall the handling of
+ * subsequent messages.
+ *
+ * \ingroup docCore
+ */
+class DrumkitSwitcher : public H2Core::Object<DrumkitSwitcher>
+{
+	H2_OBJECT(DrumkitSwitcher)
+public:
+	/** The worker thread inherits the #EngineContext of the calling
+	 * thread. */
+	DrumkitSwitcher();
+	/** Discards pending requests and joins the worker thread. A switch
+	 * already in progress will be completed first. */
+	~DrumkitSwitcher();
+
+	/**
+	 * Schedules @a pDrumkit to be set via
+	 * CoreActionController::setDrumkit(). A request not yet processed
+	 * is replaced.
+	 *
+	 * Does not block.
+	 */
+	void request( std::shared_ptr<Drumkit> pDrumkit );
+
+	/** \return Whether a request is pending or being processed. */
+	bool isBusy() const;
+	/** Blocks till all requests are processed. */
+	void waitForIdle();
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	void workerLoop();
+
+	EngineContext* m_pContext;
+	std::thread m_worker;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_condition;
+	/** Kit to switch to next. Only accessed while holding
+	 * #m_mutex. */
+	std::shared_ptr<Drumkit> m_pPendingDrumkit;
+	/** Whether the worker is processing a request. */
+	bool m_bSwitching;
+	bool m_bShutdown;
+};
+
+};
+
+#endif // H2C_DRUMKIT_SWITCHER_H
@@ -0,0 +1,122 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/EngineContext.h>
+
+#include <core/config.h>
+#include <core/EventQueue.h>
+#include <core/FX/Effects.h>
+#include <core/Hydrogen.h>
+#include <core/MidiAction.h>
+#include <core/Preferences/Preferences.h>
+
+namespace H2Core
+{
+
+/** Context bound to the current thread. */
+static thread_local EngineContext* s_pCurrentContext = nullptr;
+
+EngineContext::Scope::Scope( EngineContext* pContext )
+	: m_pPrevious( s_pCurrentContext ) {
+	s_pCurrentContext = pContext;
+}
+
+EngineContext::Scope::~Scope() {
+	s_pCurrentContext = m_pPrevious;
+}
+
+EngineContext* EngineContext::getCurrent() {
+	return s_pCurrentContext;
+}
+
+EngineContext::EngineContext( std::shared_ptr<Preferences> pPreferences )
+	: m_pHydrogen( nullptr )
+	, m_pEventQueue( nullptr )
+	, m_pEffects( nullptr )
+	, m_pMidiActionManager( nullptr )
+{
+	// Has to be retrieved before binding the context.
+	if ( pPreferences == nullptr ) {
+		pPreferences = Preferences::get_instance();
+	}
+	m_pPreferences = std::make_shared<Preferences>( pPreferences );
+	m_pPreferences->m_audioDriver = Preferences::AudioDriver::Null;
+	m_pPreferences->m_sMidiDriver = "";
+	m_pPreferences->setOscServerEnabled( false );
+
+	Scope scope( this );
+
+	m_pEventQueue = new EventQueue;
+	m_pMidiActionManager = new MidiActionManager;
+#ifdef H2CORE_HAVE_LADSPA
+	m_pEffects = new Effects;
+#endif
+
+	// Assigns #m_pHydrogen itself.
+	new Hydrogen;
+
+	INFOLOG( "Engine context created" );
+}
+
+EngineContext::~EngineContext() {
+	Scope scope( this );
+
+	delete m_pHydrogen;
+	m_pHydrogen = nullptr;
+#ifdef H2CORE_HAVE_LADSPA
+	delete m_pEffects;
+	m_pEffects = nullptr;
+#endif
+	delete m_pMidiActionManager;
+	m_pMidiActionManager = nullptr;
+	delete m_pEventQueue;
+	m_pEventQueue = nullptr;
+
+	INFOLOG( "Engine context destroyed" );
+}
+
+QString EngineContext::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[EngineContext]\n" ).arg( sPrefix );
+		if ( m_pHydrogen != nullptr ) {
+			sOutput.append( QString( "%1" )
+							.arg( m_pHydrogen->toQString( sPrefix + s, bShort ) ) );
+		} else {
+			sOutput.append( QString( "%1%2m_pHydrogen: nullptr\n" )
+							.arg( sPrefix ).arg( s ) );
+		}
+	}
+	else {
+		sOutput = QString( "[EngineContext] m_pHydrogen: " );
+		if ( m_pHydrogen != nullptr ) {
+			sOutput.append( QString( "%1" )
+							.arg( m_pHydrogen->toQString( "", bShort ) ) );
+		} else {
+			sOutput.append( "nullptr" );
+		}
+	}
+	return sOutput;
+}
+
+};
@@ -0,0 +1,129 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_ENGINE_CONTEXT_H
+#define H2C_ENGINE_CONTEXT_H
+
+#include <core/Object.h>
+
+#include <memory>
+
+namespace H2Core
+{
+
+class Effects;
+class EventQueue;
+class Hydrogen;
+class MidiActionManager;
+class Preferences;
+
+/** Owns a complete set of the subsystems otherwise accessed as
+ * process-wide singletons: #Hydrogen (including its #AudioEngine,
+ * #Sampler, and #SoundLibraryDatabase), #EventQueue, #Effects,
+ * #Preferences, and #MidiActionManager.
+ *
+ * A context is bound to a thread using #Scope. While bound, the
+ * get_instance() methods of all these classes return the members of
+ * the context instead of the global instances. This allows several
+ * independent offline renders - e.g. song exports - to run
+ * concurrently within a single process.
+ *
+ * Threads spawned by the engine on behalf of a context (disk writer,
+ * render workers) inherit the context of the thread creating them.
+ *
+ * The #Logger, #Filesystem, and the OSC/NSM server remain process-wide
+ * and are shared by all contexts.
+ *
+ * \ingroup docCore */
+class EngineContext : public H2Core::Object<EngineContext>
+{
+	H2_OBJECT(EngineContext)
+public:
+	/** Binds a context to the calling thread for the lifetime of the
+	 * object and restores the previous binding afterwards. */
+	class Scope {
+	public:
+		explicit Scope( EngineContext* pContext );
+		~Scope();
+
+		Scope( const Scope& other ) = delete;
+		Scope& operator=( const Scope& other ) = delete;
+
+	private:
+		EngineContext* m_pPrevious;
+	};
+
+	/**
+	 * @param pPreferences Settings the context starts with. They are
+	 *   copied so the context can alter them freely. If nullptr, the
+	 *   #Preferences of the calling thread are used.
+	 *
+	 * Audio and MIDI drivers as well as the OSC server are disabled
+	 * for the context. It is meant to be used with
+	 * Hydrogen::startExportSession().
+	 */
+	EngineContext( std::shared_ptr<Preferences> pPreferences = nullptr );
+	~EngineContext();
+
+	/** \return Context bound to the calling thread or nullptr in case
+	 * the global instances are used. */
+	static EngineContext* getCurrent();
+
+	Hydrogen* getHydrogen() const;
+	EventQueue* getEventQueue() const;
+	Effects* getEffects() const;
+	std::shared_ptr<Preferences> getPreferences() const;
+	MidiActionManager* getMidiActionManager() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	/** Sets #m_pHydrogen while still being constructed since the
+	 * audio drivers already require access. */
+	friend class Hydrogen;
+
+	Hydrogen* m_pHydrogen;
+	EventQueue* m_pEventQueue;
+	Effects* m_pEffects;
+	std::shared_ptr<Preferences> m_pPreferences;
+	MidiActionManager* m_pMidiActionManager;
+};
+
+inline Hydrogen* EngineContext::getHydrogen() const {
+	return m_pHydrogen;
+}
+inline EventQueue* EngineContext::getEventQueue() const {
+	return m_pEventQueue;
+}
+inline Effects* EngineContext::getEffects() const {
+	return m_pEffects;
+}
+inline std::shared_ptr<Preferences> EngineContext::getPreferences() const {
+	return m_pPreferences;
+}
+inline MidiActionManager* EngineContext::getMidiActionManager() const {
+	return m_pMidiActionManager;
+}
+
+};
+
+#endif // H2C_ENGINE_CONTEXT_H
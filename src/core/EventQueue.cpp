@@ -36,7 +36,9 @@ void EventQueue::create_instance()
 
 
 EventQueue::EventQueue() : m_bSilent( false ) {
-	__instance = this;
+	if ( EngineContext::getCurrent() == nullptr ) {
+		__instance = this;
+	}
 }
 
 
@@ -25,6 +25,7 @@
 
 #include <core/Basics/Event.h>
 #include <core/Basics/Note.h>
+#include <core/EngineContext.h>
 #include <core/Object.h>
 
 #include <cassert>
@@ -66,10 +67,18 @@ public:
 	 */
 	static void create_instance();
 	/**
-	 * Returns a pointer to the current EventQueue singleton
+	 * Returns a pointer to the EventQueue of the #EngineContext bound
+	 * to the calling thread or, if there is none, to the singleton
 	 * stored in #__instance.
 	 */
-	static EventQueue* get_instance() { assert(__instance); return __instance; }
+	static EventQueue* get_instance() {
+		const auto pContext = EngineContext::getCurrent();
+		if ( pContext != nullptr ) {
+			return pContext->getEventQueue();
+		}
+		assert(__instance);
+		return __instance;
+	}
 	~EventQueue();
 
 	/**
@@ -133,6 +142,7 @@ public:
 
 private:
 	EventQueue();
+	friend class EngineContext;
 	static EventQueue *__instance;
 
 	std::deque< std::unique_ptr<Event> >m_eventQueue;
@@ -49,7 +49,9 @@ Effects::Effects()
 		: m_pRootGroup( nullptr )
 		, m_pRecentGroup( nullptr )
 {
-	__instance = this;
+	if ( EngineContext::getCurrent() == nullptr ) {
+		__instance = this;
+	}
 
 	m_FXs.resize( MAX_FX );
 
@@ -59,6 +61,10 @@ Effects::Effects()
 
 void Effects::create_instance()
 {
+	if ( EngineContext::getCurrent() != nullptr ) {
+		// The context already holds its own instance.
+		return;
+	}
 	if ( __instance == nullptr ) {
 		__instance = new Effects;
 	}
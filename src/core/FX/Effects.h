@@ -27,6 +27,7 @@
 #if defined(H2CORE_HAVE_LADSPA) || _DOXYGEN_
 
 #include <core/Globals.h>
+#include <core/EngineContext.h>
 #include <core/Object.h>
 #include <core/FX/LadspaFX.h>
 
@@ -49,10 +50,18 @@ public:
 	 */
 	static void create_instance();
 	/**
-	 * Returns a pointer to the current Effects singleton
+	 * Returns a pointer to the Effects of the #EngineContext bound to
+	 * the calling thread or, if there is none, to the singleton
 	 * stored in #__instance.
 	 */
-	static Effects* get_instance() { assert(__instance); return __instance; }
+	static Effects* get_instance() {
+		const auto pContext = EngineContext::getCurrent();
+		if ( pContext != nullptr ) {
+			return pContext->getEffects();
+		}
+		assert(__instance);
+		return __instance;
+	}
 	~Effects();
 
 	std::shared_ptr<LadspaFX> getLadspaFX( int nFX ) const;
@@ -78,6 +87,7 @@ private:
 	std::vector< std::shared_ptr<LadspaFX> > m_FXs;
 
 	Effects();
+	friend class EngineContext;
 
 	void RDFDescend( const QString& sBase, std::shared_ptr<LadspaFXGroup> pGroup,
 					 std::vector< std::shared_ptr<LadspaFXInfo> > pluginList );
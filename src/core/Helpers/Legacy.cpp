@@ -398,7 +398,7 @@ std::shared_ptr<Pattern> Legacy::loadPattern( const QString& pattern_path ) {
 			pNote->setNoteOff( bNoteOff );
 			pNote->setProbability( fProbability );
 			pNote->setInstrumentId( nInstrId );
-			pPattern->insertNote( pNote );
+			pPattern->insertNote( pNote, false );
 
 			note_node = note_node.nextSiblingElement( "note" );
 		}
@@ -433,13 +433,15 @@ std::shared_ptr<Pattern> Legacy::loadPattern( const QString& pattern_path ) {
 				pNote->setLeadLag( noteNode.read_float(
 										 "leadlag", LEAD_LAG_DEFAULT, false, false ) );
 
-				pPattern->insertNote( pNote );
+				pPattern->insertNote( pNote, false );
 
 				noteNode = noteNode.nextSiblingElement( "note" );
 			}
 			sequenceNode = sequenceNode.nextSiblingElement( "sequence" );
 		}
 	}
+	// Publish the snapshot only once all notes are loaded.
+	pPattern->updateNoteSnapshot();
 
 	const QString sDrumkitName = root.read_string(
 		"drumkit_name", "", true, true, true );
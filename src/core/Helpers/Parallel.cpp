@@ -0,0 +1,75 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/Helpers/Parallel.h>
+
+#include <core/EngineContext.h>
+#include <core/Preferences/Preferences.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace H2Core {
+
+int Parallel::getThreadCount( int nTasks ) {
+	const auto pPref = Preferences::get_instance();
+	int nThreads = pPref != nullptr ? pPref->m_nSampleLoadingThreads : 1;
+	if ( nThreads <= 0 ) {
+		nThreads = std::max( 1, static_cast<int>(
+								 std::thread::hardware_concurrency() ) );
+	}
+
+	return std::max( 1, std::min( nThreads, nTasks ) );
+}
+
+void Parallel::run( int nThreads, const std::function<void()>& work ) {
+	auto pContext = EngineContext::getCurrent();
+	auto bindAndWork = [&]() {
+		EngineContext::Scope scope( pContext );
+		work();
+	};
+
+	std::vector<std::thread> workers;
+	for ( int ii = 1; ii < nThreads; ++ii ) {
+		workers.emplace_back( bindAndWork );
+	}
+	work();
+	for ( auto& worker : workers ) {
+		worker.join();
+	}
+}
+
+void Parallel::forEach( int nTasks, const std::function<void(int)>& task ) {
+	if ( nTasks <= 0 ) {
+		return;
+	}
+
+	std::atomic<int> nNextTask( 0 );
+	run( getThreadCount( nTasks ), [&]() {
+		for ( int nnTask = nNextTask++; nnTask < nTasks; nnTask = nNextTask++ ) {
+			task( nnTask );
+		}
+	} );
+}
+};
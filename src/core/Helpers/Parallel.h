@@ -0,0 +1,60 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_PARALLEL_H
+#define H2C_PARALLEL_H
+
+#include <core/Object.h>
+
+#include <functional>
+
+namespace H2Core
+{
+
+/**
+ * Helpers spreading the loading of samples, drumkits, and patterns
+ * across several threads.
+ *
+ * \ingroup docCore
+ */
+class Parallel : public H2Core::Object<Parallel>
+{
+	H2_OBJECT(Parallel)
+public:
+	/** Number of threads used for @a nTasks independent loading
+	 * tasks. It is based on Preferences::m_nSampleLoadingThreads and
+	 * never exceeds @a nTasks. */
+	static int getThreadCount( int nTasks );
+
+	/** Calls @a work in @a nThreads threads and returns once all of
+	 * them are done. The calling thread takes part as well. All
+	 * threads are bound to the #EngineContext of the caller. */
+	static void run( int nThreads, const std::function<void()>& work );
+
+	/** Calls @a task for all indices in [0, @a nTasks) using
+	 * getThreadCount() threads. */
+	static void forEach( int nTasks, const std::function<void(int)>& task );
+};
+
+};
+
+#endif  // H2C_PARALLEL_H
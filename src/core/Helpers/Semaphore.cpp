@@ -0,0 +1,97 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Helpers/Semaphore.h>
+
+#include <cerrno>
+#include <climits>
+
+#ifdef WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#elif defined(__APPLE__)
+#    include <dispatch/dispatch.h>
+#else
+#    include <semaphore.h>
+#endif
+
+namespace H2Core
+{
+
+class Semaphore::Handle {
+public:
+#ifdef WIN32
+	HANDLE handle;
+#elif defined(__APPLE__)
+	dispatch_semaphore_t semaphore;
+#else
+	sem_t semaphore;
+#endif
+};
+
+Semaphore::Semaphore() : m_pHandle( std::make_unique<Handle>() ) {
+#ifdef WIN32
+	m_pHandle->handle = CreateSemaphore( nullptr, 0, LONG_MAX, nullptr );
+#elif defined(__APPLE__)
+	m_pHandle->semaphore = dispatch_semaphore_create( 0 );
+#else
+	sem_init( &m_pHandle->semaphore, 0, 0 );
+#endif
+}
+
+Semaphore::~Semaphore() {
+#ifdef WIN32
+	CloseHandle( m_pHandle->handle );
+#elif defined(__APPLE__)
+	dispatch_release( m_pHandle->semaphore );
+#else
+	sem_destroy( &m_pHandle->semaphore );
+#endif
+}
+
+void Semaphore::post( int nCount ) {
+#ifdef WIN32
+	ReleaseSemaphore( m_pHandle->handle, nCount, nullptr );
+#else
+	for ( int ii = 0; ii < nCount; ++ii ) {
+#ifdef __APPLE__
+		dispatch_semaphore_signal( m_pHandle->semaphore );
+#else
+		sem_post( &m_pHandle->semaphore );
+#endif
+	}
+#endif
+}
+
+void Semaphore::wait() {
+#ifdef WIN32
+	WaitForSingleObject( m_pHandle->handle, INFINITE );
+#elif defined(__APPLE__)
+	dispatch_semaphore_wait( m_pHandle->semaphore, DISPATCH_TIME_FOREVER );
+#else
+	while ( sem_wait( &m_pHandle->semaphore ) != 0 && errno == EINTR ) {
+	}
+#endif
+}
+
+};
@@ -0,0 +1,61 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_SEMAPHORE_H
+#define H2C_SEMAPHORE_H
+
+#include <memory>
+
+namespace H2Core
+{
+
+/**
+ * Counting semaphore. In contrast to a condition variable, waking up a
+ * thread does not require to lock a mutex. post() can thus be called
+ * from realtime threads.
+ *
+ * Not derived from H2Core::Object as it is used by the #Logger itself.
+ *
+ * \ingroup docCore
+ */
+class Semaphore
+{
+public:
+	Semaphore();
+	~Semaphore();
+
+	Semaphore( const Semaphore& ) = delete;
+	Semaphore& operator=( const Semaphore& ) = delete;
+
+	void post( int nCount = 1 );
+	void wait();
+
+private:
+	/** Platform specific handle. Kept out of the header to not pull in
+	 * windows.h. */
+	class Handle;
+	std::unique_ptr<Handle> m_pHandle;
+};
+
+};
+
+#endif  // H2C_SEMAPHORE_H
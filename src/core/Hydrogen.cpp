@@ -39,13 +39,17 @@
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <set>
 
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
+#include <QFileInfo>
 
 #include <core/Hydrogen.h>
 
 #include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/ColumnMap.h>
+#include <core/AudioEngine/NotePool.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/Basics/Adsr.h>
 #include <core/Basics/AutomationPath.h>
@@ -60,6 +64,7 @@
 #include <core/Basics/Playlist.h>
 #include <core/Basics/Sample.h>
 #include <core/CoreActionController.h>
+#include <core/DrumkitSwitcher.h>
 #include <core/EventQueue.h>
 #include <core/FX/Effects.h>
 #include <core/FX/LadspaFX.h>
@@ -119,7 +124,8 @@ Hydrogen::Hydrogen() : m_fBeatCounterBeatLength( 1 )
 					 , m_bSessionIsExported( false )
 					 , m_nHihatOpenness( 127 )
 {
-	if ( __instance ) {
+	auto pContext = EngineContext::getCurrent();
+	if ( pContext == nullptr && __instance ) {
 		ERRORLOG( "Hydrogen audio engine is already running" );
 		throw H2Exception( "Hydrogen audio engine is already running" );
 	}
@@ -135,10 +141,15 @@ Hydrogen::Hydrogen() : m_fBeatCounterBeatLength( 1 )
 	m_pTimeline = std::make_shared<Timeline>();
 
 	m_pAudioEngine = new AudioEngine();
+	m_pDrumkitSwitcher = new DrumkitSwitcher();
 	m_pPlaylist = std::make_shared<Playlist>();
 
 	// Prevent double creation caused by calls from MIDI thread
-	__instance = this;
+	if ( pContext != nullptr ) {
+		pContext->m_pHydrogen = this;
+	} else {
+		__instance = this;
+	}
 
 	m_pAudioEngine->startAudioDrivers();
 
@@ -151,15 +162,22 @@ Hydrogen::~Hydrogen()
 {
 	INFOLOG( "[~Hydrogen]" );
 
+	// Completes a kit switch in progress while the engine is still intact.
+	delete m_pDrumkitSwitcher;
+	m_pDrumkitSwitcher = nullptr;
+
 #ifdef H2CORE_HAVE_OSC
-	NsmClient* pNsmClient = NsmClient::get_instance();
-	if( pNsmClient ) {
-		pNsmClient->shutdown();
-		delete pNsmClient;
-	}
-	OscServer* pOscServer = OscServer::get_instance();
-	if( pOscServer ) {
-		delete pOscServer;
+	// The servers are shared by all engine contexts.
+	if ( __instance == this ) {
+		NsmClient* pNsmClient = NsmClient::get_instance();
+		if( pNsmClient ) {
+			pNsmClient->shutdown();
+			delete pNsmClient;
+		}
+		OscServer* pOscServer = OscServer::get_instance();
+		if( pOscServer ) {
+			delete pOscServer;
+		}
 	}
 #endif
 
@@ -171,7 +189,9 @@ Hydrogen::~Hydrogen()
 
 	delete m_pAudioEngine;
 
-	__instance = nullptr;
+	if ( __instance == this ) {
+		__instance = nullptr;
+	}
 }
 
 void Hydrogen::create_instance()
@@ -336,7 +356,9 @@ void Hydrogen::midiNoteOn( std::shared_ptr<Note> pNote )
 bool Hydrogen::addRealtimeNote(	int		nInstrument,
 								float	fVelocity,
 								bool	bNoteOff,
-								int		nNote )
+								int		nNote,
+								long long nTimestamp,
+								int		nFrameOffset )
 {
 	
 	AudioEngine* pAudioEngine = m_pAudioEngine;
@@ -356,6 +378,26 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 		return false;
 	}
 
+	const float fPan = 0;
+
+	MidiIngressQueue::Entry entry;
+	entry.nInstrument = nInstrument;
+	entry.fVelocity = fVelocity;
+	entry.fPan = fPan;
+	entry.bNoteOff = bNoteOff;
+	entry.nNote = nNote;
+	entry.bPlaySelectedInstrument = bPlaySelectedInstrument;
+	entry.nTimestamp = nTimestamp;
+	entry.nFrameOffset = nFrameOffset;
+
+	// Time stamped notes are handed over to the audio thread as they are
+	// without locking. It resolves the instrument itself. Recording,
+	// however, requires a consistent transport position and pattern.
+	if ( nTimestamp != 0 && ! pPref->getRecordEvents() &&
+		 pAudioEngine->pushMidiIngress( entry ) ) {
+		return true;
+	}
+
 	m_pAudioEngine->lock( RIGHT_HERE );
 	
 	if ( ! bPlaySelectedInstrument ) {
@@ -371,7 +413,6 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 	// Get current pattern and column
 	std::shared_ptr<Pattern> pCurrentPattern = nullptr;
 	long nTickInPattern = 0;
-	const float fPan = 0;
 
 	bool doRecord = pPref->getRecordEvents();
 	if ( getMode() == Song::Mode::Song && doRecord &&
@@ -420,7 +461,7 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 
 		if ( ! pCurrentPattern ) {
 			ERRORLOG( "Current pattern invalid" );
-			pAudioEngine->unlock(); // unlock the audio engine
+			pAudioEngine->unlock();
 			return false;
 		}
 
@@ -493,6 +534,7 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 									 Note::pitchToFrequency( nNote ));
 			}
 
+			std::lock_guard<std::mutex> guard( pCurrentPattern->getNotesMutex() );
 			for ( unsigned nnNote = 0; nnNote < nPatternSize; nnNote++ ) {
 				const Pattern::notes_t* notes = pCurrentPattern->getNotes();
 				FOREACH_NOTE_CST_IT_BOUND_LENGTH( notes, it, nnNote, pCurrentPattern ) {
@@ -547,7 +589,16 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 		pAudioEngine->unlock();
 		return true;
 	}
-	
+
+	// Recorded notes are still started at the frame they were received
+	// at.
+	if ( nTimestamp != 0 && pAudioEngine->pushMidiIngress( entry ) ) {
+		pAudioEngine->unlock();
+		return true;
+	}
+
+	// Audio thread not processing or queue full. Play back the note at
+	// the beginning of the next buffer instead.
 	if ( bPlaySelectedInstrument ) {
 		if ( bNoteOff ) {
 			if ( pSampler->isInstrumentPlaying( pInstrument ) ) {
@@ -555,7 +606,7 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 			}
 		}
 		else { // note on
-			auto pNote2 = std::make_shared<Note>(
+			auto pNote2 = pAudioEngine->getNotePool()->acquire(
 				pInstrument, nRealColumn, fVelocity, fPan );
 
 			int divider = nNote / 12;
@@ -569,13 +620,13 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 	else {
 		if ( bNoteOff ) {
 			if ( pSampler->isInstrumentPlaying( pInstrument ) ) {
-				auto pNoteOff = std::make_shared<Note>( pInstrument );
+				auto pNoteOff = pAudioEngine->getNotePool()->acquire( pInstrument );
 				pNoteOff->setNoteOff( true );
 				midiNoteOn( pNoteOff );
 			}
 		}
 		else { // note on
-			auto pNote2 = std::make_shared<Note>(
+			auto pNote2 = pAudioEngine->getNotePool()->acquire(
 				pInstrument, nRealColumn, fVelocity, fPan );
 			midiNoteOn( pNote2 );
 		}
@@ -588,10 +639,21 @@ bool Hydrogen::addRealtimeNote(	int		nInstrument,
 
 void Hydrogen::toggleNextPattern( int nPatternNumber ) {
 	if ( m_pSong != nullptr && getMode() == Song::Mode::Pattern ) {
-		m_pAudioEngine->lock( RIGHT_HERE );
-		m_pAudioEngine->toggleNextPattern( nPatternNumber );
-		m_pAudioEngine->unlock();
-		EventQueue::get_instance()->pushEvent( Event::Type::NextPatternsChanged, 0 );
+		// Applied by the audio thread at the beginning of its next
+		// cycle. The pattern itself is captured since the pattern list
+		// might be altered before the command is processed.
+		auto pPattern = m_pSong->getPatternList()->get( nPatternNumber );
+		if ( pPattern == nullptr ) {
+			ERRORLOG( QString( "Invalid pattern number [%1]" )
+					  .arg( nPatternNumber ) );
+			return;
+		}
+		m_pAudioEngine->pushCommand( [pPattern]() {
+			Hydrogen::get_instance()->getAudioEngine()->
+				toggleNextPattern( pPattern );
+			EventQueue::get_instance()->pushEvent(
+				Event::Type::NextPatternsChanged, 0 );
+		} );
 
 	} else {
 		ERRORLOG( "can't set next pattern in song mode" );
@@ -600,10 +662,16 @@ void Hydrogen::toggleNextPattern( int nPatternNumber ) {
 
 bool Hydrogen::flushAndAddNextPattern( int nPatternNumber ) {
 	if ( m_pSong != nullptr && getMode() == Song::Mode::Pattern ) {
-		m_pAudioEngine->lock( RIGHT_HERE );
-		m_pAudioEngine->flushAndAddNextPattern( nPatternNumber );
-		m_pAudioEngine->unlock();
-		EventQueue::get_instance()->pushEvent( Event::Type::NextPatternsChanged, 0 );
+		// Applied by the audio thread at the beginning of its next
+		// cycle. An invalid pattern number yields nullptr and just
+		// flushes the next patterns.
+		auto pPattern = m_pSong->getPatternList()->get( nPatternNumber );
+		m_pAudioEngine->pushCommand( [pPattern]() {
+			Hydrogen::get_instance()->getAudioEngine()->
+				flushAndAddNextPattern( pPattern );
+			EventQueue::get_instance()->pushEvent(
+				Event::Type::NextPatternsChanged, 0 );
+		} );
 
 		return true;
 
@@ -620,7 +688,7 @@ void Hydrogen::restartDrivers()
 }
 
 bool Hydrogen::startExportSession( int nSampleRate, int nSampleDepth,
-								   double fCompressionLevel )
+								   double fCompressionLevel, int nRenderThreads )
 {
 	AudioEngine* pAudioEngine = m_pAudioEngine;
 	
@@ -663,6 +731,7 @@ bool Hydrogen::startExportSession( int nSampleRate, int nSampleDepth,
 	pDiskWriterDriver->setSampleRate( static_cast<unsigned>(nSampleRate) );
 	pDiskWriterDriver->setSampleDepth( nSampleDepth );
 	pDiskWriterDriver->setCompressionLevel( fCompressionLevel );
+	pDiskWriterDriver->setRenderThreads( nRenderThreads );
 
 	m_bExportSessionIsActive = true;
 
@@ -670,7 +739,8 @@ bool Hydrogen::startExportSession( int nSampleRate, int nSampleDepth,
 }
 
 /// Export a song to a wav file
-void Hydrogen::startExportSong( const QString& filename)
+void Hydrogen::startExportSong( const QString& filename,
+								const std::vector<ExportStem>& stems )
 {
 	AudioEngine* pAudioEngine = m_pAudioEngine;
 	CoreActionController::locateToTick( 0 );
@@ -679,9 +749,84 @@ void Hydrogen::startExportSong( const QString& filename)
 
 	DiskWriterDriver* pDiskWriterDriver = static_cast<DiskWriterDriver*>(pAudioEngine->getAudioDriver());
 	pDiskWriterDriver->setFileName( filename );
+	pDiskWriterDriver->setStems( stems );
 	pDiskWriterDriver->write();
 }
 
+std::vector<ExportStem> Hydrogen::getExportStems( const QString& sFilename,
+												  bool bPerComponent ) const
+{
+	std::vector<ExportStem> stems;
+
+	std::shared_ptr<Song> pSong = getSong();
+	if ( pSong == nullptr || pSong->getDrumkit() == nullptr ) {
+		ERRORLOG( "No song set yet" );
+		return stems;
+	}
+
+	const QString sSuffix = QFileInfo( sFilename ).suffix();
+	QString sBaseName = sFilename;
+	if ( ! sSuffix.isEmpty() ) {
+		sBaseName.chop( sSuffix.size() + 1 );
+	}
+	// Allow to use just the instrument names when leaving the song name
+	// blank.
+	if ( ! sBaseName.isEmpty() && ! sBaseName.endsWith( "/" ) &&
+		 ! sBaseName.endsWith( "\\" ) ) {
+		sBaseName.append( "-" );
+	}
+
+	// Instruments without any notes are not worth a file.
+	std::set<int> usedInstrumentIds;
+	for ( const auto& ppNote : pSong->getAllNotes() ) {
+		if ( ppNote != nullptr ) {
+			usedInstrumentIds.insert( ppNote->getInstrumentId() );
+		}
+	}
+
+	const auto pInstrumentList = pSong->getDrumkit()->getInstruments();
+	for ( int ii = 0; ii < pInstrumentList->size(); ++ii ) {
+		const auto pInstrument = pInstrumentList->get( ii );
+		if ( pInstrument == nullptr ||
+			 usedInstrumentIds.find( pInstrument->getId() ) ==
+			 usedInstrumentIds.end() ) {
+			continue;
+		}
+
+		// Instruments sharing their name are distinguished by id.
+		QString sName = pInstrument->getName();
+		for ( int jj = 0; jj < pInstrumentList->size(); ++jj ) {
+			const auto pOther = pInstrumentList->get( jj );
+			if ( jj != ii && pOther != nullptr && pOther->getName() == sName ) {
+				sName.append( QString( "_%1" ).arg( pInstrument->getId() ) );
+				break;
+			}
+		}
+
+		if ( ! bPerComponent ) {
+			stems.push_back( { QString( "%1%2.%3" ).arg( sBaseName )
+							   .arg( sName ).arg( sSuffix ),
+							   pInstrument->getId(), -1 } );
+			continue;
+		}
+
+		const auto pComponents = pInstrument->getComponents();
+		for ( int nComponent = 0; nComponent < pComponents->size();
+			  ++nComponent ) {
+			const auto pComponent = pComponents->at( nComponent );
+			if ( pComponent == nullptr ) {
+				continue;
+			}
+			stems.push_back( { QString( "%1%2-%3_%4.%5" ).arg( sBaseName )
+							   .arg( sName ).arg( pComponent->getName() )
+							   .arg( nComponent ).arg( sSuffix ),
+							   pInstrument->getId(), nComponent } );
+		}
+	}
+
+	return stems;
+}
+
 void Hydrogen::stopExportSong()
 {
 	AudioEngine* pAudioEngine = m_pAudioEngine;
@@ -1055,9 +1200,10 @@ void Hydrogen::initJackTimebaseControl()
 #endif
 }
 
-void Hydrogen::addInstrumentToDeathRow( std::shared_ptr<Instrument> pInstr ) {
+void Hydrogen::addInstrumentToDeathRow( std::shared_ptr<Instrument> pInstr,
+										std::vector<std::shared_ptr<Instrument>>* pReleased ) {
 	m_instrumentDeathRow.push_back( pInstr );
-	killInstruments();
+	killInstruments( pReleased );
 }
 
 void Hydrogen::removeInstrumentFromDeathRow( std::shared_ptr<Instrument> pInstr ) {
@@ -1071,7 +1217,7 @@ void Hydrogen::removeInstrumentFromDeathRow( std::shared_ptr<Instrument> pInstr
     }
 }
 
-void Hydrogen::killInstruments() {
+void Hydrogen::killInstruments( std::vector<std::shared_ptr<Instrument>>* pReleased ) {
 	std::shared_ptr<Instrument> pInstr;
 
 	while ( m_instrumentDeathRow.size() > 0 &&
@@ -1081,7 +1227,10 @@ void Hydrogen::killInstruments() {
 		pInstr = m_instrumentDeathRow.front();
 		m_instrumentDeathRow.pop_front();
 
-		if ( pInstr != nullptr  ) {
+		if ( pInstr != nullptr && pReleased != nullptr ) {
+			pReleased->push_back( pInstr );
+		}
+		else if ( pInstr != nullptr  ) {
 			pInstr->unloadSamples();
 		}
 	}
@@ -1388,67 +1537,8 @@ int Hydrogen::getColumnForTick( long nTick, bool bLoopMode, long* pPatternStartT
 		return nColumn;
 	}
 
-	long nTotalTick = 0;
-
-	auto pPatternColumns = pSong->getPatternGroupVector();
-	int nColumns = pPatternColumns->size();
-
-	if ( nColumns == 0 ) {
-		// There are no patterns in the current song.
-		*pPatternStartTick = 0;
-		return 0;
-	}
-
-	// Sum the lengths of all pattern columns and use four quarters in case some
-	// of them are of size zero. If the supplied value nTick is bigger than this
-	// and doesn't belong to the next pattern column, we just found the pattern
-	// list we were searching for.
-	int nPatternSize;
-	for ( int i = 0; i < nColumns; ++i ) {
-		auto pColumn = ( *pPatternColumns )[ i ];
-		if ( pColumn->size() != 0 ) {
-			nPatternSize = pColumn->longestPatternLength();
-		} else {
-			nPatternSize = 4 * H2Core::nTicksPerQuarter;
-		}
-
-		if ( ( nTick >= nTotalTick ) && ( nTick < nTotalTick + nPatternSize ) ) {
-			( *pPatternStartTick ) = nTotalTick;
-			return i;
-		}
-		nTotalTick += nPatternSize;
-	}
-
-	// If the song is played in loop mode, the tick numbers of the
-	// second turn are added on top of maximum tick number of the
-	// song. Therefore, we will introduced periodic boundary
-	// conditions and start the search again.
-	if ( bLoopMode ) {
-		long nLoopTick = 0;
-		// nTotalTicks is now the same as m_nSongSizeInTicks
-		if ( nTotalTick != 0 ) {
-			nLoopTick = nTick % nTotalTick;
-		}
-		nTotalTick = 0;
-		for ( int i = 0; i < nColumns; ++i ) {
-			auto pColumn = ( *pPatternColumns )[ i ];
-			if ( pColumn->size() != 0 ) {
-				nPatternSize = pColumn->longestPatternLength();
-			} else {
-				nPatternSize = 4 * H2Core::nTicksPerQuarter;
-			}
-
-			if ( ( nLoopTick >= nTotalTick )
-				 && ( nLoopTick < nTotalTick + nPatternSize ) ) {
-				( *pPatternStartTick ) = nTotalTick;
-				return i;
-			}
-			nTotalTick += nPatternSize;
-		}
-	}
-
-	( *pPatternStartTick ) = 0;
-	return -1;
+	return m_pAudioEngine->getColumnMap()->findColumn(
+		nTick, bLoopMode, pPatternStartTick );
 }
 
 long Hydrogen::getTickForColumn( int nColumn ) const
@@ -1479,23 +1569,8 @@ long Hydrogen::getTickForColumn( int nColumn ) const
 		}
 	}
 
-	auto pColumns = pSong->getPatternGroupVector();
-	long totalTick = 0;
-	int nPatternSize;
-
-	for ( int i = 0; i < nColumn; ++i ) {
-		auto pColumn = ( *pColumns )[ i ];
-		
-		if ( pColumn->size() > 0 ) {
-			nPatternSize = pColumn->longestPatternLength();
-		}
-		else {
-			nPatternSize = 4 * H2Core::nTicksPerQuarter;
-		}
-		totalTick += nPatternSize;
-	}
-
-	return totalTick;
+	return m_pAudioEngine->getColumnMap()->getColumnStartTick(
+		std::max( nColumn, 0 ) );
 }
 
 void Hydrogen::updateSongSize() {
@@ -1614,6 +1689,9 @@ QString Hydrogen::toQString( const QString& sPrefix, bool bShort ) const {
 		} else {
 			sOutput.append( QString( "nullptr\n" ) );
 		}
+		sOutput.append( QString( "%1%2m_pDrumkitSwitcher: %3\n" ).arg( sPrefix ).arg( s )
+						.arg( m_pDrumkitSwitcher == nullptr ? "nullptr" :
+							  m_pDrumkitSwitcher->toQString( "", true ) ) );
 		sOutput.append(
 			QString( "%1%2m_pSoundLibraryDatabase: %3\n" )
 			.arg( sPrefix ).arg( s )
@@ -1686,6 +1764,9 @@ QString Hydrogen::toQString( const QString& sPrefix, bool bShort ) const {
 		} else {
 			sOutput.append( QString( " nullptr" ) );
 		}
+		sOutput.append( QString( ", m_pDrumkitSwitcher: %1" )
+						.arg( m_pDrumkitSwitcher == nullptr ? "nullptr" :
+							  m_pDrumkitSwitcher->toQString( "", true ) ) );
 		sOutput.append( ", m_pSoundLibraryDatabase: %1" )
 			.append( m_pSoundLibraryDatabase == nullptr ? "nullptr" :
 					 m_pSoundLibraryDatabase->toQString( "", bShort) )
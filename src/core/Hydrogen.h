@@ -25,9 +25,11 @@
 #include <core/config.h>
 #include <core/Basics/Event.h>
 #include <core/Basics/Song.h>
+#include <core/EngineContext.h>
 #include <core/Object.h>
 #include <core/Timeline.h>
 #include <core/IO/AudioOutput.h>
+#include <core/IO/ExportStem.h>
 #include <core/IO/MidiCommon.h>
 #include <core/IO/MidiInput.h>
 #include <core/IO/MidiOutput.h>
@@ -37,10 +39,12 @@
 #include <stdint.h> // for uint32_t et al
 #include <cassert>
 #include <memory>
+#include <vector>
 
 namespace H2Core
 {
 	class AudioEngine;
+	class DrumkitSwitcher;
 	class SoundLibraryDatabase;
 	class Playlist;
 
@@ -138,9 +142,16 @@ public:
 	 */
 	static void		create_instance();
 	/**
-	 * Returns the current Hydrogen instance #__instance.
+	 * Returns the Hydrogen instance of the #EngineContext bound to
+	 * the calling thread or, if there is none, #__instance.
 	 */
-	static Hydrogen*	get_instance(){ return __instance; };
+	static Hydrogen*	get_instance(){
+		const auto pContext = EngineContext::getCurrent();
+		if ( pContext != nullptr ) {
+			return pContext->getHydrogen();
+		}
+		return __instance;
+	};
 
 	/**
 	 * Destructor taking care of most of the clean up.
@@ -151,6 +162,8 @@ public:
 	 * return central instance of the audio engine
 	 */
 	AudioEngine*		getAudioEngine() const;
+	/** Loads drumkits in the background. */
+	DrumkitSwitcher*	getDrumkitSwitcher() const;
 	std::shared_ptr<SoundLibraryDatabase> getSoundLibraryDatabase() const {
 		return m_pSoundLibraryDatabase;
 	}
@@ -245,10 +258,23 @@ public:
 
 	void updateSongSize();
 
+		/**
+		 * Records (if enabled) and plays back a note triggered in
+		 * realtime, e.g. by a MIDI device.
+		 *
+		 * In case @a nTimestamp is provided the note is not passed via
+		 * AudioEngine::noteOn() but handed over to the audio thread
+		 * without locking the audio engine (unless recording) and will
+		 * be started at the frame corresponding to @a nTimestamp. If
+		 * @a nFrameOffset is provided as well, the note is started at
+		 * this offset within the buffer instead.
+		 */
 		bool			addRealtimeNote ( int instrument,
 							  float velocity,
 							  bool noteoff=false,
-							  int msg1=0 );
+							  int msg1=0,
+							  long long nTimestamp=0,
+							  int nFrameOffset=-1 );
 
 		int getHihatOpenness() const;
 		void setHihatOpenness( int nValue );
@@ -343,13 +369,35 @@ public:
 	 * @param fCompressionLevel Trades off audio quality against compression
 	 *   rate defined between 0.0 (maximum quality) and 1.0 (maximum
 	 *   compression).
+	 * @param nRenderThreads Number of threads the #Sampler renders notes
+	 *   with during export. 0 keeps the current setting.
 	 *
 	 * \return true on success
 	 * .*/
 	bool			startExportSession( int nSampleRate, int nSampleDepth,
-										double fCompressionLevel = 0.0 );
+										double fCompressionLevel = 0.0,
+										int nRenderThreads = 0 );
 	void			stopExportSession();
-	void			startExportSong( const QString& filename );
+	/**
+	 * Renders the current song once.
+	 *
+	 * @param filename File the main mix is written to. If empty, only
+	 *   @a stems will be written.
+	 * @param stems Per-instrument or per-component files written in the
+	 *   same pass, e.g. as returned by getExportStems().
+	 */
+	void			startExportSong( const QString& filename,
+									 const std::vector<ExportStem>& stems = {} );
+	/**
+	 * Stems for all instruments of the current song having at least a
+	 * single note.
+	 *
+	 * The filenames are derived from @a sFilename by appending the
+	 * name of the instrument - and of the component if @a bPerComponent
+	 * is true - to its base name.
+	 */
+	std::vector<ExportStem> getExportStems( const QString& sFilename,
+											bool bPerComponent ) const;
 	void			stopExportSong();
 	
 	/************************************************************/
@@ -427,8 +475,14 @@ public:
 	 * it might live on in the undo/redo stack of the GUI). Instead, this
 	 * function will add it to a list of instruments marked for deletion and it
 	 * will be dealt with at a later time (after audio rendering was stopped).
+	 *
+	 * \param pReleased If not nullptr, instruments of the death row
+	 *   ready to be released are not unloaded but handed over to the
+	 *   caller. This way their samples can be freed after unlocking the
+	 *   #AudioEngine.
 	 */
-	void addInstrumentToDeathRow( std::shared_ptr<Instrument> pInstr );
+	void addInstrumentToDeathRow( std::shared_ptr<Instrument> pInstr,
+								  std::vector<std::shared_ptr<Instrument>>* pReleased = nullptr );
 
 		/** Since we are flushing the samples of the instruments in the death
 		 * row at a delayed point in time (like when stopping transport), we
@@ -464,13 +518,16 @@ private:
 	 * bunch of Qt5 stuff and creating an instance of the Logger
 	 * and Preferences.
 	 *
-	 * Only one Hydrogen object is allowed to exist. If the
+	 * Only one global Hydrogen object is allowed to exist. If the
 	 * #__instance object is present, the constructor will throw
-	 * an error.
+	 * an error. Additional instances can only be created by an
+	 * #EngineContext.
 	 */
 	Hydrogen();
+	friend class EngineContext;
 
-		void killInstruments();
+		/** \param pReleased See addInstrumentToDeathRow(). */
+		void killInstruments( std::vector<std::shared_ptr<Instrument>>* pReleased = nullptr );
 
 	void			midiNoteOn( std::shared_ptr<Note> pNote );
 
@@ -557,6 +614,8 @@ private:
 	 */
 	AudioEngine*	m_pAudioEngine;
 
+	DrumkitSwitcher*	m_pDrumkitSwitcher;
+
 	std::shared_ptr<SoundLibraryDatabase> m_pSoundLibraryDatabase;
 
 	std::shared_ptr<Playlist> m_pPlaylist;
@@ -594,6 +653,10 @@ inline AudioEngine* Hydrogen::getAudioEngine() const {
 	return m_pAudioEngine;
 }
 
+inline DrumkitSwitcher* Hydrogen::getDrumkitSwitcher() const {
+	return m_pDrumkitSwitcher;
+}
+
 inline const Hydrogen::GUIState& Hydrogen::getGUIState() const {
 	return m_GUIState;
 }
@@ -372,6 +372,9 @@ void AlsaMidiDriver::midi_action( snd_seq_t *seq_handle )
 				WARNINGLOG( QString( "Unknown MIDI Event. type = %1" ).arg( ( int )ev->type ) );
 			}
 			if ( msg.m_type != MidiMessage::UNKNOWN ) {
+				// Events are delivered directly without a sequencer
+				// queue and do not carry a meaningful time stamp.
+				msg.m_nTimestamp = MidiMessage::currentTimestamp();
 				handleMidiMessage( msg );
 			}
 		}
@@ -68,6 +68,7 @@ static void midiProc ( const MIDIPacketList * pktlist,
 			msg.m_nData2 = packet->data[2];
 		}
 
+		msg.m_nTimestamp = MidiMessage::currentTimestamp();
 		instance->handleMidiMessage( msg );
 		packet = MIDIPacketNext( packet );
 	}
@@ -29,10 +29,16 @@
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
 #include <core/Basics/Sample.h>
+#include <core/EngineContext.h>
 #include <core/IO/DiskWriterDriver.h>
+#include <core/IO/DiskWriterEncoder.h>
+#include <core/Sampler/Sampler.h>
+#include <core/Sampler/SampleStreamer.h>
 
 #include <pthread.h>
 #include <cassert>
+#include <memory>
+#include <vector>
 
 #if defined(WIN32) || _DOXYGEN_
 #include <windows.h>
@@ -49,20 +55,13 @@
 namespace H2Core
 {
 
-pthread_t diskWriterDriverThread;
-
-void* diskWriterDriver_thread( void* param )
+/** Opens @a sFilename for writing using the audio format indicated
+ * by its suffix and the settings of @a pDriver.
+ *
+ * \return `nullptr` on failure. */
+static SNDFILE* openFile( DiskWriterDriver* pDriver, const QString& sFilename )
 {
-
-	DiskWriterDriver *pDriver = ( DiskWriterDriver* )param;
-
-	EventQueue::get_instance()->pushEvent( Event::Type::Progress, 0 );
-
-	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
-	
-	___INFOLOG( "DiskWriterDriver thread started" );
-
-	const auto format = Filesystem::AudioFormatFromSuffix( pDriver->m_sFilename );
+	const auto format = Filesystem::AudioFormatFromSuffix( sFilename );
 
 	SF_INFO soundInfo;
 	soundInfo.samplerate = pDriver->m_nSampleRate;
@@ -118,13 +117,8 @@ void* diskWriterDriver_thread( void* param )
 #endif
 	else {
 		___ERRORLOG( QString( "Unsupported file extension [%1] using libsndfile [%2]" )
-					.arg( pDriver->m_sFilename ).arg( sf_version_string() ) );
-		pDriver->m_bDoneWriting = true;
-		pDriver->m_bWritingFailed = true;
-		EventQueue::get_instance()->pushEvent( Event::Type::Progress, 100 );
-		pthread_exit( nullptr );
+					.arg( sFilename ).arg( sf_version_string() ) );
 		return nullptr;
-
 	}
 
 	// Instead of making audio export fail on non-supported parameter
@@ -161,10 +155,6 @@ void* diskWriterDriver_thread( void* param )
 	if ( !sf_format_check( &soundInfo ) ) {
 		___ERRORLOG( QString( "Error while checking format using libsndfile [%1]" )
 					.arg( sf_version_string() ) );
-		pDriver->m_bDoneWriting = true;
-		pDriver->m_bWritingFailed = true;
-		EventQueue::get_instance()->pushEvent( Event::Type::Progress, 100 );
-		pthread_exit( nullptr );
 		return nullptr;
 	}
 
@@ -173,7 +163,8 @@ void* diskWriterDriver_thread( void* param )
 	// characters of the filename entered in the GUI right. No matter which
 	// encoding was used locally.
 	// We have to terminate the string using a null character ourselves.
-	QString sPaddedPath = pDriver->m_sFilename.append( '\0' );
+	QString sPaddedPath = sFilename;
+	sPaddedPath.append( '\0' );
 	wchar_t* encodedFilename = new wchar_t[ sPaddedPath.size() ];
 
 	sPaddedPath.toWCharArray( encodedFilename );
@@ -182,20 +173,16 @@ void* diskWriterDriver_thread( void* param )
 								   &soundInfo );
 	delete encodedFilename;
 #else
-	SNDFILE* pSndfile = sf_open( pDriver->m_sFilename.toLocal8Bit(), SFM_WRITE,
+	SNDFILE* pSndfile = sf_open( sFilename.toLocal8Bit(), SFM_WRITE,
 							   &soundInfo );
 #endif
 
 	if ( pSndfile == nullptr ) {
 		___ERRORLOG( QString( "Unable to open file [%1] with format [%2] using libsndfile [%3]: %4" )
-					.arg( pDriver->m_sFilename )
+					.arg( sFilename )
 					.arg( Sample::sndfileFormatToQString( soundInfo.format ) )
 					.arg( sf_version_string() )
 					.arg( sf_strerror( pSndfile ) ) );
-		pDriver->m_bDoneWriting = true;
-		pDriver->m_bWritingFailed = true;
-		EventQueue::get_instance()->pushEvent( Event::Type::Progress, 100 );
-		pthread_exit( nullptr );
 		return nullptr;
 	}
 
@@ -227,7 +214,67 @@ void* diskWriterDriver_thread( void* param )
 	}
 #endif
 
-	float *pData = new float[ pDriver->m_nBufferSize * 2 ];	// always stereo
+	return pSndfile;
+}
+
+void* diskWriterDriver_thread( void* param )
+{
+
+	DiskWriterDriver *pDriver = ( DiskWriterDriver* )param;
+	EngineContext::Scope scope( pDriver->m_pEngineContext );
+
+	EventQueue::get_instance()->pushEvent( Event::Type::Progress, 0 );
+
+	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	
+	___INFOLOG( "DiskWriterDriver thread started" );
+
+	// Used to terminate this thread in case not all files could be
+	// opened.
+	auto abortOpening = [&](){
+		pDriver->m_bDoneWriting = true;
+		pDriver->m_bWritingFailed = true;
+		EventQueue::get_instance()->pushEvent( Event::Type::Progress, 100 );
+		pthread_exit( nullptr );
+	};
+
+	// The main mix is omitted in case no filename was provided.
+	SNDFILE* pSndfile = nullptr;
+	if ( ! pDriver->m_sFilename.isEmpty() ) {
+		pSndfile = openFile( pDriver, pDriver->m_sFilename );
+		if ( pSndfile == nullptr ) {
+			abortOpening();
+			return nullptr;
+		}
+	}
+
+	std::vector<SNDFILE*> stemFiles;
+	std::vector<Sampler::StemTrack> stemTracks;
+	for ( const auto& stem : pDriver->m_stems ) {
+		auto pStemFile = openFile( pDriver, stem.sFilename );
+		if ( pStemFile == nullptr ) {
+			if ( pSndfile != nullptr ) {
+				sf_close( pSndfile );
+			}
+			for ( auto& ppStemFile : stemFiles ) {
+				sf_close( ppStemFile );
+			}
+			abortOpening();
+			return nullptr;
+		}
+		stemFiles.push_back( pStemFile );
+		stemTracks.push_back( { stem.nInstrumentId, stem.nComponentIdx } );
+	}
+
+	// Encoding is done in a separate thread while the next blocks
+	// are rendered.
+	std::vector<SNDFILE*> files;
+	if ( pSndfile != nullptr ) {
+		files.push_back( pSndfile );
+	}
+	files.insert( files.end(), stemFiles.begin(), stemFiles.end() );
+	auto pEncoder = std::make_unique<DiskWriterEncoder>( files );
+	std::vector<DiskWriterEncoder::Input> encoderInputs( files.size() );
 
 	float *pData_L = pDriver->m_pOut_L;
 	float *pData_R = pDriver->m_pOut_R;
@@ -236,45 +283,85 @@ void* diskWriterDriver_thread( void* param )
 	auto pSong = pHydrogen->getSong();
 	auto pSampler = pHydrogen->getAudioEngine()->getSampler();
 
+	const int nOldRenderThreads = pSampler->getRenderThreads();
+	if ( pDriver->m_nRenderThreads > 0 ) {
+		pSampler->setRenderThreads( pDriver->m_nRenderThreads );
+	}
+
+	if ( stemTracks.size() > 0 ) {
+		pSampler->setStemTracks( stemTracks );
+	}
+
+	// Rendering is faster than real time. Streamed samples have to be
+	// waited for instead of being rendered with gaps.
+	pSampler->getSampleStreamer()->setOffline( true );
+
 	// always rolling, no user interaction
 	pAudioEngine->play();
 
 	auto pPatternColumns = pSong->getPatternGroupVector();
 	int nColumns = pPatternColumns->size();
 
+	// Length of all columns in frames. Tempo and size of the columns
+	// do not change during export.
+	std::vector<int> columnLengthsInFrames( nColumns );
+	for ( int ii = 0; ii < nColumns; ++ii ) {
+		auto pColumn = ( *pPatternColumns )[ ii ];
+		int nPatternSize;
+		if ( pColumn->size() != 0 ) {
+			nPatternSize = pColumn->longestPatternLength();
+		} else {
+			nPatternSize = 4 * H2Core::nTicksPerQuarter;
+		}
+
+		const float fTicksize = AudioEngine::computeTickSize(
+			pDriver->m_nSampleRate, AudioEngine::getBpmAtColumn( ii ) );
+		columnLengthsInFrames[ ii ] = fTicksize * nPatternSize;
+	}
+
 	// Used to cleanly terminate this thread and close all handlers.
 	auto tearDown = [&](){
+		// Blocks still pending are written before the files are
+		// closed.
+		pEncoder->finish();
+		pEncoder = nullptr;
 		pDriver->m_bDoneWriting = true;
-		delete[] pData;
-		pData = nullptr;
 
-		sf_close( pSndfile );
+		if ( pSndfile != nullptr ) {
+			sf_close( pSndfile );
+		}
+		for ( auto& ppStemFile : stemFiles ) {
+			sf_close( ppStemFile );
+		}
+		if ( stemTracks.size() > 0 ) {
+			pSampler->setStemTracks( {} );
+		}
+
+		if ( pDriver->m_nRenderThreads > 0 ) {
+			pSampler->setRenderThreads( nOldRenderThreads );
+		}
+		pSampler->getSampleStreamer()->setOffline( false );
 
 		___INFOLOG( "DiskWriterDriver thread end" );
 
 		pthread_exit( nullptr );
 	};
+
+	// There is no deadline to meet during export. All columns are
+	// rendered in blocks as large as the engine does support. Only
+	// the end of the song is approached in chunks of the buffer size
+	// the driver was initialized with since the detection of
+	// trailing silence below depends on it.
+	const int nTailBufferSize = std::min(
+		pDriver->m_nBufferSize, static_cast<unsigned>(MAX_BUFFER_SIZE) );
 	
-	int nPatternSize, nBufferWriteLength;
-	float fBpm;
-	float fTicksize = 0;
+	int nBufferWriteLength;
 	int nMaxNumberOfSilentFrames = 200;
 	for ( int patternPosition = 0; patternPosition < nColumns; ++patternPosition ) {
 		
-		auto pColumn = ( *pPatternColumns )[ patternPosition ];
-		if ( pColumn->size() != 0 ) {
-			nPatternSize = pColumn->longestPatternLength();
-		} else {
-			nPatternSize = 4 * H2Core::nTicksPerQuarter;
-		}
-
-		fBpm = AudioEngine::getBpmAtColumn( patternPosition );
-		fTicksize = AudioEngine::computeTickSize( pDriver->m_nSampleRate, fBpm );
-		
 		//here we have the pattern length in frames dependent from bpm and samplerate
-		int nPatternLengthInFrames = fTicksize * nPatternSize;
+		const int nPatternLengthInFrames = columnLengthsInFrames[ patternPosition ];
 		int nFrameNumber = 0;
-		int nLastRun = 0;
 		int nSuccessiveZeros = 0;
 		while ( ( patternPosition < nColumns - 1 && // render all
 													// frames in
@@ -286,23 +373,18 @@ void* diskWriterDriver_thread( void* param )
 				  ( nFrameNumber < nPatternLengthInFrames ||
 					pSampler->isRenderingNotes() ) ) ) {
 			
-			int nUsedBuffer = pDriver->m_nBufferSize;
-			
-			// This will calculate the size from -last- (end of
-			// pattern) used frame buffer, which is mostly smaller
-			// than pDriver->m_nBufferSize. But it only applies for
-			// all patterns except of the last one. The latter we will
-			// let ring until there is no further audio to process.
-			if( patternPosition < nColumns - 1 &&
-				nPatternLengthInFrames - nFrameNumber < pDriver->m_nBufferSize ){
-				nLastRun = nPatternLengthInFrames - nFrameNumber;
-				nUsedBuffer = nLastRun;
-			};
-
-			// Check whether the driver was stopped (since
-			// AudioEngine::stopAudioDrivers() locks the audio engine
-			// and the call to pDriver->m_processCallback) can not
-			// acquire the lock).
+			int nUsedBuffer;
+			if ( patternPosition < nColumns - 1 ) {
+				nUsedBuffer = std::min( MAX_BUFFER_SIZE,
+										nPatternLengthInFrames - nFrameNumber );
+			}
+			else {
+				// The last pattern we will let ring until there is no
+				// further audio to process.
+				nUsedBuffer = nTailBufferSize;
+			}
+
+			// Check whether the driver was stopped.
 			if ( ! pDriver->m_bIsRunning ) {
 				___ERRORLOG( "Driver was stop before export was completed." );
 				EventQueue::get_instance()->pushEvent( Event::Type::Progress, -1 );
@@ -310,28 +392,13 @@ void* diskWriterDriver_thread( void* param )
 				tearDown();
 				return nullptr;
 			}
-			
-			int ret = pDriver->m_processCallback( nUsedBuffer, nullptr );
 
-			// Only try a reasonable amount of times.
-			int nMutexLockAttempts = 0;
-			
-			// In case the DiskWriter couldn't acquire the lock of the AudioEngine.
-			while( ret == 2 ) {
-				ret = pDriver->m_processCallback( nUsedBuffer, nullptr );
-
-				// No need for a sleep() statement in here because the
-				// AudioEngine::tryLockFor() in the processCallback
-				// already introduces a delay.
-				nMutexLockAttempts++;
-				if ( nMutexLockAttempts > 30 ) {
-					___ERRORLOG( "Too many attempts to lock the AudioEngine. Aborting." );
-					
-					EventQueue::get_instance()->pushEvent( Event::Type::Progress, -1 );
-					pDriver->m_bWritingFailed = true;
-					tearDown();
-					return nullptr;
-				}
+			if ( pAudioEngine->renderOffline( nUsedBuffer ) != 0 ) {
+				___ERRORLOG( "Audio engine is not ready for rendering. Aborting." );
+				EventQueue::get_instance()->pushEvent( Event::Type::Progress, -1 );
+				pDriver->m_bWritingFailed = true;
+				tearDown();
+				return nullptr;
 			}
 
 			if ( patternPosition == nColumns - 1 &&
@@ -371,31 +438,15 @@ void* diskWriterDriver_thread( void* param )
 			
 			nFrameNumber += nBufferWriteLength;
 			
-			for ( unsigned ii = 0; ii < nBufferWriteLength; ii++ ) {
-				if( pData_L[ ii ] > 1 ) {
-					pData[ ii * 2 ] = 1;
-				} else if( pData_L[ ii ] < -1 ) {
-					pData[ ii * 2 ] = -1;
-				} else {
-					pData[ ii * 2 ] = pData_L[ ii ];
-				}
-				
-				if( pData_R[ ii ] > 1 ){
-					pData[ ii * 2 + 1 ] = 1;
-				} else if ( pData_R[ ii ] < -1 ) {
-					pData[ ii * 2 + 1 ] = -1;
-				} else {
-					pData[ ii * 2 + 1 ] = pData_R[ ii ];
-				}
+			int nInput = 0;
+			if ( pSndfile != nullptr ) {
+				encoderInputs[ nInput++ ] = { pData_L, pData_R };
 			}
-			
-			const int res = sf_writef_float( pSndfile, pData, nBufferWriteLength );
-			if ( res != ( int )nBufferWriteLength ) {
-				___ERRORLOG( QString( "Error during sf_write_float using [%1]. Floats written: [%2], target: [%3]. %4" )
-							.arg( sf_version_string() ).arg( res )
-							.arg( nBufferWriteLength )
-							.arg( sf_strerror( nullptr ) ) );
-
+			for ( int ii = 0; ii < stemFiles.size(); ++ii ) {
+				encoderInputs[ nInput++ ] = { pSampler->getStemOut_L( ii ),
+											  pSampler->getStemOut_R( ii ) };
+			}
+			if ( ! pEncoder->push( encoderInputs, nBufferWriteLength ) ) {
 				EventQueue::get_instance()->pushEvent( Event::Type::Progress, -1 );
 				pDriver->m_bWritingFailed = true;
 				tearDown();
@@ -418,6 +469,13 @@ void* diskWriterDriver_thread( void* param )
 		}
 	}
 
+	if ( ! pEncoder->finish() ) {
+		EventQueue::get_instance()->pushEvent( Event::Type::Progress, -1 );
+		pDriver->m_bWritingFailed = true;
+		tearDown();
+		return nullptr;
+	}
+
 	// Explicitly mark export as finished.
 	EventQueue::get_instance()->pushEvent( Event::Type::Progress, 100 );
 	
@@ -439,7 +497,9 @@ DiskWriterDriver::DiskWriterDriver( audioProcessCallback processCallback )
 		, m_bIsRunning( false )
 		, m_bDoneWriting( false )
 		, m_bWritingFailed( false )
-		, m_fCompressionLevel( 0.0 ) {
+		, m_fCompressionLevel( 0.0 )
+		, m_nRenderThreads( 0 )
+		, m_pEngineContext( nullptr ) {
 }
 
 
@@ -455,8 +515,9 @@ int DiskWriterDriver::init( unsigned nBufferSize )
 
 	m_nBufferSize = nBufferSize;
 	
-	m_pOut_L = new float[ m_nBufferSize ];
-	m_pOut_R = new float[ m_nBufferSize ];
+	// Large enough for the blocks rendered during export.
+	m_pOut_L = new float[ MAX_BUFFER_SIZE ];
+	m_pOut_R = new float[ MAX_BUFFER_SIZE ];
 
 	return 0;
 }
@@ -471,11 +532,12 @@ void DiskWriterDriver::write()
 	INFOLOG( "" );
 
 	m_bIsRunning = true;
+	m_pEngineContext = EngineContext::getCurrent();
 	
 	pthread_attr_t attr;
 	pthread_attr_init( &attr );
 
-	pthread_create( &diskWriterDriverThread, &attr, diskWriterDriver_thread, this );
+	pthread_create( &m_thread, &attr, diskWriterDriver_thread, this );
 }
 
 /// disconnect
@@ -485,7 +547,7 @@ void DiskWriterDriver::disconnect()
 	
 	m_bIsRunning = false;
 
-	pthread_join( diskWriterDriverThread, nullptr );
+	pthread_join( m_thread, nullptr );
 
 	delete[] m_pOut_L;
 	m_pOut_L = nullptr;
@@ -520,7 +582,16 @@ QString DiskWriterDriver::toQString( const QString& sPrefix, bool bShort ) const
 			.append( QString( "%1%2m_bWritingFailed: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_bWritingFailed ) )
 			.append( QString( "%1%2m_fCompressionLevel: %3\n" ).arg( sPrefix ).arg( s )
-					 .arg( m_fCompressionLevel ) );
+					 .arg( m_fCompressionLevel ) )
+			.append( QString( "%1%2m_nRenderThreads: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nRenderThreads ) )
+			.append( QString( "%1%2m_stems: [\n" ).arg( sPrefix ).arg( s ) );
+		for ( const auto& sstem : m_stems ) {
+			sOutput.append( QString( "%1%2%2[%3] instrument: %4, component: %5\n" )
+							.arg( sPrefix ).arg( s ).arg( sstem.sFilename )
+							.arg( sstem.nInstrumentId ).arg( sstem.nComponentIdx ) );
+		}
+		sOutput.append( QString( "%1%2]\n" ).arg( sPrefix ).arg( s ) );
 	} else {
 		sOutput = QString( "[DiskWriterDriver]" )
 			.append( QString( " m_nSampleRate: %1" ).arg( m_nSampleRate ) )
@@ -531,7 +602,13 @@ QString DiskWriterDriver::toQString( const QString& sPrefix, bool bShort ) const
 			.append( QString( ", m_bDoneWriting: %1" ).arg( m_bDoneWriting ) )
 			.append( QString( ", m_bWritingFailed: %1" ).arg( m_bWritingFailed ) )
 			.append( QString( ", m_fCompressionLevel: %1" )
-					 .arg( m_fCompressionLevel ) );
+					 .arg( m_fCompressionLevel ) )
+			.append( QString( ", m_nRenderThreads: %1" ).arg( m_nRenderThreads ) )
+			.append( QString( ", m_stems: [" ) );
+		for ( const auto& sstem : m_stems ) {
+			sOutput.append( QString( "[%1] " ).arg( sstem.sFilename ) );
+		}
+		sOutput.append( "]" );
 	}
 
 	return sOutput;
@@ -26,14 +26,20 @@
 #include <sndfile.h>
 
 #include <inttypes.h>
+#include <pthread.h>
+#include <vector>
 
 #include <core/IO/AudioOutput.h>
+#include <core/IO/ExportStem.h>
 #include <core/Object.h>
 
 namespace H2Core
 {
 
+class EngineContext;
+
 	void* diskWriterDriver_thread( void *param );
+
 ///
 /// Driver for export audio to disk
 ///
@@ -50,10 +56,20 @@ class DiskWriterDriver : public Object<DiskWriterDriver>, public AudioOutput
 		/** A value between 0.0 (maximum quality) and 1.0 (maximum
 		 * compression). */
 		double					m_fCompressionLevel;
+		/** Number of threads used by the #Sampler while exporting. 0
+		 * keeps the current setting. */
+		int						m_nRenderThreads;
+		/** Stems rendered alongside the main mix during the same
+		 * pass. In case #m_sFilename is empty, the main mix is not
+		 * written at all. */
+		std::vector<ExportStem>	m_stems;
 		audioProcessCallback	m_processCallback;
 		float*					m_pOut_L;
 		float*					m_pOut_R;
 		bool					 m_bIsRunning;
+		/** Context of the thread calling write(). It is bound to the
+		 * writer thread. */
+		EngineContext*			m_pEngineContext;
 
 		DiskWriterDriver( audioProcessCallback processCallback );
 		~DiskWriterDriver();
@@ -85,6 +101,9 @@ class DiskWriterDriver : public Object<DiskWriterDriver>, public AudioOutput
 		m_nSampleDepth = nNewDepth;
 	}
 		void setCompressionLevel( double fCompressionLevel );
+	void setRenderThreads( int nThreads ) {
+		m_nRenderThreads = nThreads;
+	}
 
 		virtual float* getOut_L() override {
 			return m_pOut_L;
@@ -96,9 +115,13 @@ class DiskWriterDriver : public Object<DiskWriterDriver>, public AudioOutput
 		void  setFileName( const QString& sFilename ){
 			m_sFilename = sFilename;
 		}
+	void setStems( const std::vector<ExportStem>& stems ) {
+		m_stems = stems;
+	}
 
 	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
 	private:
+		pthread_t m_thread;
 
 };
 
@@ -0,0 +1,203 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/IO/DiskWriterEncoder.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <core/config.h>
+
+namespace H2Core
+{
+
+static_assert( ( DiskWriterEncoder::nBlocks & ( DiskWriterEncoder::nBlocks - 1 ) ) == 0,
+			   "Number of blocks must be a power of two" );
+
+DiskWriterEncoder::DiskWriterEncoder( const std::vector<SNDFILE*>& files )
+	: m_files( files )
+	, m_bFinishing( false )
+	, m_bFailed( false )
+	, m_bProducerWaiting( false )
+	, m_bConsumerWaiting( false )
+	, m_nWritePos( 0 )
+	, m_nReadPos( 0 )
+{
+	m_buffer.resize( nBlocks * m_files.size() * 2 * MAX_BUFFER_SIZE );
+	for ( int ii = 0; ii < nBlocks; ++ii ) {
+		m_blockFrames[ ii ] = 0;
+	}
+
+	m_thread = std::thread( &DiskWriterEncoder::encoderLoop, this );
+}
+
+DiskWriterEncoder::~DiskWriterEncoder() {
+	finish();
+}
+
+float* DiskWriterEncoder::getBlock( size_t nBlock, int nFile ) {
+	return m_buffer.data() +
+		( nBlock * m_files.size() + nFile ) * 2 * MAX_BUFFER_SIZE;
+}
+
+void DiskWriterEncoder::wakeUp( const std::atomic<bool>& bWaiting ) {
+	// The waiting side sets its flag before checking the positions
+	// again. Either it sees the update of the positions or we see its
+	// flag. Passing the mutex ensures it already waits on the
+	// condition.
+	if ( bWaiting.load() ) {
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+		}
+		m_condition.notify_all();
+	}
+}
+
+/** NaN check which is not folded away by -ffast-math (as `f != f` and
+ * std::isnan() are). */
+static inline bool isNaN( float fValue ) {
+	uint32_t nBits;
+	memcpy( &nBits, &fValue, sizeof( nBits ) );
+	return ( nBits & 0x7fffffff ) > 0x7f800000;
+}
+
+void DiskWriterEncoder::clampAndInterleave( const float* pIn_L,
+											const float* pIn_R,
+											float* pOut, int nFrames ) {
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		// NaN would pass both std::min and std::max unaltered.
+		const float fIn_L = isNaN( pIn_L[ ii ] ) ? 0.0f : pIn_L[ ii ];
+		const float fIn_R = isNaN( pIn_R[ ii ] ) ? 0.0f : pIn_R[ ii ];
+		pOut[ 2 * ii ] = std::min( std::max( fIn_L, -1.0f ), 1.0f );
+		pOut[ 2 * ii + 1 ] = std::min( std::max( fIn_R, -1.0f ), 1.0f );
+	}
+}
+
+bool DiskWriterEncoder::push( const std::vector<Input>& inputs, int nFrames ) {
+	if ( inputs.size() != m_files.size() || nFrames < 0 ||
+		 nFrames > MAX_BUFFER_SIZE ) {
+		ERRORLOG( QString( "Invalid block: [%1] inputs for [%2] files, [%3] frames" )
+				  .arg( inputs.size() ).arg( m_files.size() ).arg( nFrames ) );
+		return false;
+	}
+
+	const size_t nWritePos = m_nWritePos.load( std::memory_order_relaxed );
+	if ( nWritePos - m_nReadPos.load( std::memory_order_acquire ) >= nBlocks ) {
+		// All blocks are still waiting to be encoded.
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_bProducerWaiting = true;
+		m_condition.wait( lock, [&]() {
+			return nWritePos - m_nReadPos.load() < nBlocks; } );
+		m_bProducerWaiting = false;
+	}
+
+	const size_t nBlock = nWritePos & ( nBlocks - 1 );
+	for ( int ii = 0; ii < inputs.size(); ++ii ) {
+		clampAndInterleave( inputs[ ii ].pData_L, inputs[ ii ].pData_R,
+							getBlock( nBlock, ii ), nFrames );
+	}
+	m_blockFrames[ nBlock ] = nFrames;
+
+	m_nWritePos.store( nWritePos + 1 );
+	wakeUp( m_bConsumerWaiting );
+
+	return ! m_bFailed.load();
+}
+
+bool DiskWriterEncoder::finish() {
+	if ( m_thread.joinable() ) {
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_bFinishing = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	return ! m_bFailed.load();
+}
+
+void DiskWriterEncoder::encoderLoop() {
+	while ( true ) {
+		const size_t nReadPos = m_nReadPos.load( std::memory_order_relaxed );
+		if ( nReadPos == m_nWritePos.load( std::memory_order_acquire ) ) {
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_bConsumerWaiting = true;
+			m_condition.wait( lock, [&]() {
+				return m_bFinishing.load() || nReadPos != m_nWritePos.load(); } );
+			m_bConsumerWaiting = false;
+
+			if ( nReadPos == m_nWritePos.load( std::memory_order_acquire ) ) {
+				// Finishing and all blocks are written.
+				return;
+			}
+		}
+
+		const size_t nBlock = nReadPos & ( nBlocks - 1 );
+		const int nFrames = m_blockFrames[ nBlock ];
+
+		// After a failure the remaining blocks are still consumed to
+		// not stall the producer.
+		for ( int ii = 0; ii < m_files.size() && ! m_bFailed.load(); ++ii ) {
+			const int res = sf_writef_float( m_files[ ii ],
+											 getBlock( nBlock, ii ), nFrames );
+			if ( res != nFrames ) {
+				ERRORLOG( QString( "Error during sf_write_float using [%1]. Floats written: [%2], target: [%3]. %4" )
+						  .arg( sf_version_string() ).arg( res )
+						  .arg( nFrames )
+						  .arg( sf_strerror( m_files[ ii ] ) ) );
+				m_bFailed = true;
+			}
+		}
+
+		m_nReadPos.store( nReadPos + 1 );
+		wakeUp( m_bProducerWaiting );
+	}
+}
+
+QString DiskWriterEncoder::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[DiskWriterEncoder]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_files: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_files.size() ) )
+			.append( QString( "%1%2m_nWritePos: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nWritePos.load() ) )
+			.append( QString( "%1%2m_nReadPos: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nReadPos.load() ) )
+			.append( QString( "%1%2m_bFailed: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_bFailed.load() ) );
+	}
+	else {
+		sOutput = QString( "[DiskWriterEncoder] " )
+			.append( QString( "m_files: %1" ).arg( m_files.size() ) )
+			.append( QString( ", m_nWritePos: %1" ).arg( m_nWritePos.load() ) )
+			.append( QString( ", m_nReadPos: %1" ).arg( m_nReadPos.load() ) )
+			.append( QString( ", m_bFailed: %1" ).arg( m_bFailed.load() ) );
+	}
+
+	return sOutput;
+}
+
+};
@@ -0,0 +1,144 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_DISK_WRITER_ENCODER_H
+#define H2C_DISK_WRITER_ENCODER_H
+
+#include <sndfile.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+/**
+ * Encodes and writes the audio rendered during export in a thread of
+ * its own.
+ *
+ * Compressed formats like FLAC, Ogg/Vorbis, Opus, or MP3 can take
+ * longer to encode than the song takes to render. Rendered blocks are
+ * handed over via a bounded lock-free single-producer single-consumer
+ * ring of #nBlocks blocks. This way the #DiskWriterDriver can render
+ * the next block while the previous ones are still being encoded.
+ *
+ * The producer clamps and interleaves the rendered channels while
+ * copying them into the ring. Blocks are published via the atomic
+ * read and write positions alone. The mutex is only taken to put
+ * either side to sleep in case the ring is full or empty and to wake
+ * it up again.
+ *
+ * \ingroup docCore docAudioDriver
+ */
+class DiskWriterEncoder : public H2Core::Object<DiskWriterEncoder>
+{
+	H2_OBJECT(DiskWriterEncoder)
+public:
+	/** Number of blocks in the ring. Must be a power of two. */
+	static constexpr int nBlocks = 4;
+
+	/** Both channels of a single file within a block. */
+	struct Input {
+		const float* pData_L;
+		const float* pData_R;
+	};
+
+	/**
+	 * Starts the encoder thread.
+	 *
+	 * @param files Opened files the blocks are written to. They are
+	 *   not closed by the encoder.
+	 */
+	DiskWriterEncoder( const std::vector<SNDFILE*>& files );
+	/** Calls finish(). */
+	~DiskWriterEncoder();
+
+	/**
+	 * Copies @a nFrames frames of every file in @a inputs - in the
+	 * same order as the files passed to the constructor - into the
+	 * ring. Waits in case no block is available.
+	 *
+	 * Must only be called by a single thread at a time.
+	 *
+	 * @return `false` in case writing a previous block failed.
+	 */
+	bool push( const std::vector<Input>& inputs, int nFrames );
+
+	/**
+	 * Waits till all pending blocks were written and stops the encoder
+	 * thread.
+	 *
+	 * @return `false` in case writing any of the blocks failed.
+	 */
+	bool finish();
+
+	/**
+	 * Clamps @a nFrames frames of both channels to [-1, 1] and
+	 * interleaves them into @a pOut. NaN is written as silence.
+	 *
+	 * Written branch-free so it is vectorized by the compiler.
+	 */
+	static void clampAndInterleave( const float* pIn_L, const float* pIn_R,
+									float* pOut, int nFrames );
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	void encoderLoop();
+
+	float* getBlock( size_t nBlock, int nFile );
+	/** Wakes up the other side in case it is waiting on
+	 * #m_condition as indicated by @a bWaiting. */
+	void wakeUp( const std::atomic<bool>& bWaiting );
+
+	std::vector<SNDFILE*> m_files;
+	/** Interleaved data of all blocks. Each block holds
+	 * #MAX_BUFFER_SIZE stereo frames for every file. */
+	std::vector<float> m_buffer;
+	/** Number of frames stored in each block. */
+	int m_blockFrames[ nBlocks ];
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::atomic<bool> m_bFinishing;
+	std::atomic<bool> m_bFailed;
+	/** Set while the producer waits for a free block. */
+	std::atomic<bool> m_bProducerWaiting;
+	/** Set while the encoder thread waits for a new block. */
+	std::atomic<bool> m_bConsumerWaiting;
+
+	/** Producer and consumer positions are placed on different cache
+	 * lines to avoid false sharing. */
+	alignas(64) std::atomic<size_t> m_nWritePos;
+	alignas(64) std::atomic<size_t> m_nReadPos;
+};
+
+};
+
+#endif // H2C_DISK_WRITER_ENCODER_H
@@ -0,0 +1,48 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_EXPORT_STEM_H
+#define H2C_EXPORT_STEM_H
+
+#include <QString>
+
+namespace H2Core
+{
+
+/** An additional file written during export holding the contribution
+ * of a single instrument or component to the main mix.
+ *
+ * Kept apart from the #DiskWriterDriver to not expose libsndfile to
+ * everyone including Hydrogen.h.
+ *
+ * \ingroup docCore docAudioDriver */
+struct ExportStem {
+	QString sFilename;
+	int nInstrumentId;
+	/** Index of the #InstrumentComponent or -1 to sum up all components
+	 * of the instrument. */
+	int nComponentIdx;
+};
+
+};
+
+#endif // H2C_EXPORT_STEM_H
@@ -44,6 +44,7 @@
 #include <core/Basics/Song.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Preferences/Preferences.h>
+#include <core/Sampler/Sampler.h>
 #include <core/Globals.h>
 #include <core/EventQueue.h>
 
@@ -74,6 +75,8 @@ int JackAudioDriver::jackDriverBufferSize( jack_nframes_t nframes, void* param )
 	__INFOLOG( QString("new JACK buffer size: [%1]")
 			   .arg( QString::number( static_cast<int>(nframes) ) ) );
 	JackAudioDriver::jackServerBufferSize = nframes;
+	Hydrogen::get_instance()->getAudioEngine()->getSampler()
+		->setBufferSize( nframes );
 	return 0;
 }
 
@@ -77,6 +77,11 @@ JackMidiDriver::JackMidiWrite(jack_nframes_t nframes)
 	events = jack_midi_get_event_count(buf);
 #endif
 
+	// All events of this cycle are handed to the same process cycle of
+	// the audio engine. Within it, they are placed at their own frame
+	// offset.
+	const long long nTimestamp = MidiMessage::currentTimestamp();
+
 	for (i = 0; i < events; i++) {
 		MidiMessage msg;
 
@@ -119,6 +124,8 @@ JackMidiDriver::JackMidiWrite(jack_nframes_t nframes)
 			msg.m_nData1 = buffer[1];
 			msg.m_nData2 = buffer[2];
 		}
+		msg.m_nTimestamp = nTimestamp;
+		msg.m_nFrameOffset = static_cast<int>(event.time);
 		handleMidiMessage( msg );
 	}
 }
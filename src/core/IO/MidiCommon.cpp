@@ -21,6 +21,8 @@
 
 #include <core/IO/MidiCommon.h>
 
+#include <chrono>
+
 namespace H2Core
 {
 
@@ -30,6 +32,13 @@ void MidiMessage::clear() {
 	m_nData2 = -1;
 	m_nChannel = -1;
 	m_sysexData.clear();
+	m_nTimestamp = 0;
+	m_nFrameOffset = -1;
+}
+
+long long MidiMessage::currentTimestamp() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch() ).count();
 }
 
 void MidiMessage::setType( int nStatusByte ) {
@@ -118,6 +127,10 @@ QString MidiMessage::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_nData2 ) )
 			.append( QString( "%1%2m_nChannel: %3\n" )
 					 .arg( m_nChannel ) )
+			.append( QString( "%1%2m_nTimestamp: %3\n" )
+					 .arg( m_nTimestamp ) )
+			.append( QString( "%1%2m_nFrameOffset: %3\n" )
+					 .arg( m_nFrameOffset ) )
 			.append( QString( "%1%2m_sysexData: [" ) );
 		bool bIsFirst = true;
 		for ( const auto& dd : m_sysexData ) {
@@ -137,6 +150,8 @@ QString MidiMessage::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", m_nData1: %1" ).arg( m_nData1 ) )
 			.append( QString( ", m_nData2: %1" ).arg( m_nData2 ) )
 			.append( QString( ", m_nChannel: %1" ).arg( m_nChannel ) )
+			.append( QString( ", m_nTimestamp: %1" ).arg( m_nTimestamp ) )
+			.append( QString( ", m_nFrameOffset: %1" ).arg( m_nFrameOffset ) )
 			.append( QString( ", m_sysexData: [" ) );
 		bool bIsFirst = true;
 		for ( const auto& dd : m_sysexData ) {
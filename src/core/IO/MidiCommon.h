@@ -95,12 +95,25 @@ public:
 	int m_nData2;
 	int m_nChannel;
 	std::vector<unsigned char> m_sysexData;
+	/** Time the message was received by the driver in microseconds
+	 * as returned by currentTimestamp(). 0 if unknown. */
+	long long m_nTimestamp;
+	/** Offset in frames of the message within the process cycle it was
+	 * received in. Only provided by drivers that run in sync with the
+	 * audio engine, such as JACK. -1 if unknown. */
+	int m_nFrameOffset;
 
 	MidiMessage()
 			: m_type( UNKNOWN )
 			, m_nData1( -1 )
 			, m_nData2( -1 )
-			, m_nChannel( -1 ) {}
+			, m_nChannel( -1 )
+			, m_nTimestamp( 0 )
+			, m_nFrameOffset( -1 ) {}
+
+	/** Monotonic clock in microseconds shared by the MIDI drivers and
+	 * the #AudioEngine to place incoming notes within a buffer. */
+	static long long currentTimestamp();
 
 	/** Reset message */
 	void clear();
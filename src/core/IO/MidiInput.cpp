@@ -234,7 +234,8 @@ void MidiInput::handleNoteOnMessage( const MidiMessage& msg ) {
 		return;
 	}
 
-	CoreActionController::handleNote( nNote, fVelocity, false );
+	CoreActionController::handleNote( nNote, fVelocity, false, msg.m_nTimestamp,
+									  msg.m_nFrameOffset );
 }
 
 /*
@@ -256,7 +257,8 @@ void MidiInput::handleNoteOffMessage( const MidiMessage& msg, bool CymbalChoke )
 		return;
 	}
 
-	CoreActionController::handleNote( msg.m_nData1, 0.0, true );
+	CoreActionController::handleNote( msg.m_nData1, 0.0, true, msg.m_nTimestamp,
+									  msg.m_nFrameOffset );
 }
 
 void MidiInput::handleSysexMessage( const MidiMessage& msg )
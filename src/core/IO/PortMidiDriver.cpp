@@ -40,6 +40,7 @@
 #include <porttime.h>
 #define TIME_PROC ((int32_t (*)(void *)) Pt_Time)
 
+#include <algorithm>
 #include <pthread.h>
 
 namespace H2Core
@@ -102,6 +103,11 @@ void* PortMidiDriver_thread( void* param )
 					msg.setType( nEventType );
 					msg.m_nData1 = Pm_MessageData1( buffer[0].message );
 					msg.m_nData2 = Pm_MessageData2( buffer[0].message );
+					// PortMidi time stamps events in milliseconds using
+					// PortTime.
+					msg.m_nTimestamp = MidiMessage::currentTimestamp() -
+						1000 * static_cast<long long>(
+							std::max( Pt_Time() - buffer[0].timestamp, 0 ) );
 					instance->handleMidiMessage( msg );
 				}
 			}
@@ -22,9 +22,12 @@
 
 #include "core/Logger.h"
 #include "core/Helpers/Filesystem.h"
+#include "core/Helpers/Semaphore.h"
 #include <core/Version.h>
 
+#include <algorithm>
 #include <cstdio>
+#include <ctime>
 #include <chrono>
 #include <thread>
 #include <QtCore/QDir>
@@ -83,9 +86,11 @@ void* loggerThread_func( void* param ) {
 	Logger::queue_t::iterator it, last;
 
 	while ( pLogger->__running ) {
-		pthread_mutex_lock( &pLogger->__mutex );
-		pthread_cond_wait( &pLogger->__messages_available, &pLogger->__mutex );
-		pthread_mutex_unlock( &pLogger->__mutex );
+		pLogger->m_pMessagesAvailable->wait();
+		// Messages logged from here on post the semaphore again. All
+		// earlier ones are picked up below.
+		pLogger->m_bWakeUpPending.exchange( false );
+		pLogger->processRtRecords();
 		if ( !queue->empty() ) {
 			for ( it = last = queue->begin() ; it != queue->end() ; ++it ) {
 				last = it;
@@ -150,12 +155,22 @@ Logger* Logger::create_instance( const QString& sLogFilePath, bool bUseStdout,
 }
 
 Logger::Logger( const QString& sLogFilePath, bool bUseStdout, bool bLogTimestamps ) :
+	m_rtSlots( new RtSlot[ nRtCapacity ] ),
+	m_nRtEnqueuePos( 0 ),
+	m_nRtDequeuePos( 0 ),
+	m_nRtDropped( 0 ),
+	m_pMessagesAvailable( std::make_unique<Semaphore>() ),
+	m_bWakeUpPending( false ),
 	__running( true ),
 	m_sLogFilePath( sLogFilePath ),
 	m_bUseStdout( bUseStdout ),
 	m_bLogTimestamps( bLogTimestamps ) {
 	__instance = this;
 
+	for ( size_t ii = 0; ii < nRtCapacity; ++ii ) {
+		m_rtSlots[ ii ].nSequence.store( ii, std::memory_order_relaxed );
+	}
+
 	m_prefixList << "" << "(E) " << "(W) " << "(I) " << "(D) " << "(C)" << "(L) ";
 #ifdef WIN32
 	m_colorList << "" << "" << "" << "" << "" << "" << "";
@@ -179,7 +194,6 @@ Logger::Logger( const QString& sLogFilePath, bool bUseStdout, bool bLogTimestamp
 	pthread_attr_t attr;
 	pthread_attr_init( &attr );
 	pthread_mutex_init( &__mutex, nullptr );
-	pthread_cond_init( &__messages_available, nullptr );
 	pthread_create( &loggerThread, &attr, loggerThread_func, this );
 
 	if ( should_log( Info ) ) {
@@ -192,10 +206,18 @@ Logger::Logger( const QString& sLogFilePath, bool bUseStdout, bool bLogTimestamp
 
 Logger::~Logger() {
 	__running = false;
-	pthread_cond_broadcast ( &__messages_available );
+	m_pMessagesAvailable->post();
 	pthread_join( loggerThread, nullptr );
 }
 
+void Logger::wakeUp() {
+	// Only the first message after the logger thread woke up posts the
+	// semaphore. It picks up all others in one go.
+	if ( ! m_bWakeUpPending.exchange( true ) ) {
+		m_pMessagesAvailable->post();
+	}
+}
+
 void Logger::log( unsigned level, const QString& sClassName, const char* func_name,
 				  const QString& sMsg, const QString& sColor ) {
 
@@ -203,6 +225,25 @@ void Logger::log( unsigned level, const QString& sClassName, const char* func_na
 		return;
 	}
 
+	QString sTimestampPrefix;
+	if ( m_bLogTimestamps ) {
+		sTimestampPrefix = QString( "[%1] " )
+			.arg( QDateTime::currentDateTime().toString( "hh:mm:ss.zzz" ) );
+	}
+
+	const QString tmp = formatMessage( level, sClassName, func_name, sMsg,
+									   sColor, sTimestampPrefix );
+
+	pthread_mutex_lock( &__mutex );
+	__msg_queue.push_back( tmp );
+	pthread_mutex_unlock( &__mutex );
+	wakeUp();
+}
+
+QString Logger::formatMessage( unsigned level, const QString& sClassName,
+							  const char* func_name, const QString& sMsg,
+							  const QString& sColor,
+							  const QString& sTimestampPrefix ) const {
 	int i;
 	switch( level ) {
 	case Error:
@@ -228,29 +269,155 @@ void Logger::log( unsigned level, const QString& sClassName, const char* func_na
 		break;
 	}
 
-	QString sTimestampPrefix;
-	if ( m_bLogTimestamps ) {
-		sTimestampPrefix = QString( "[%1] " )
-			.arg( QDateTime::currentDateTime().toString( "hh:mm:ss.zzz" ) );
-	}
-
 	const QString sCol = sColor.isEmpty() ? m_colorList[ i ] : sColor;
 
-	const QString tmp = QString( "%1%2%3[%4::%5] %6\033[0m\n" )
+	return QString( "%1%2%3[%4::%5] %6\033[0m\n" )
 		.arg( sCol ).arg( sTimestampPrefix ).arg( m_prefixList[i] )
 		.arg( sClassName ).arg( func_name ).arg( sMsg );
+}
 
-	pthread_mutex_lock( &__mutex );
-	__msg_queue.push_back( tmp );
-	pthread_mutex_unlock( &__mutex );
-	pthread_cond_broadcast( &__messages_available );
+bool Logger::RtRateLimiter::allow( long long nNowMs, int* pSuppressed ) {
+	long long nLastMs = m_nLastMs.load( std::memory_order_relaxed );
+	if ( nNowMs - nLastMs < nRtRateLimitMs ||
+		 ! m_nLastMs.compare_exchange_strong( nLastMs, nNowMs,
+											  std::memory_order_relaxed ) ) {
+		m_nSuppressed.fetch_add( 1, std::memory_order_relaxed );
+		return false;
+	}
+
+	*pSuppressed = m_nSuppressed.exchange( 0, std::memory_order_relaxed );
+	return true;
+}
+
+void Logger::logRtRecord( unsigned level, const char* sClassName,
+						  const char* sFuncName, RtRateLimiter* pRateLimiter,
+						  const char* sFormat, const RtArg* pArgs, int nArgs ) {
+	if ( level == None ) {
+		return;
+	}
+
+	// Reading the system clock does neither lock nor allocate.
+	const long long nNowMs =
+		std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch() ).count();
+
+	int nSuppressed = 0;
+	if ( pRateLimiter != nullptr && ! pRateLimiter->allow( nNowMs, &nSuppressed ) ) {
+		return;
+	}
+
+	RtSlot* pSlot;
+	size_t nPos = m_nRtEnqueuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		pSlot = &m_rtSlots[ nPos & ( nRtCapacity - 1 ) ];
+		const size_t nSequence = pSlot->nSequence.load( std::memory_order_acquire );
+		const auto nDiff = static_cast<std::ptrdiff_t>(nSequence) -
+			static_cast<std::ptrdiff_t>(nPos);
+		if ( nDiff == 0 ) {
+			if ( m_nRtEnqueuePos.compare_exchange_weak(
+					 nPos, nPos + 1, std::memory_order_relaxed ) ) {
+				break;
+			}
+		}
+		else if ( nDiff < 0 ) {
+			// Ring is full.
+			m_nRtDropped.fetch_add( 1, std::memory_order_relaxed );
+			wakeUp();
+			return;
+		}
+		else {
+			nPos = m_nRtEnqueuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	auto& record = pSlot->record;
+	record.nLevel = level;
+	record.sClassName = sClassName;
+	record.sFuncName = sFuncName;
+	record.sFormat = sFormat;
+	record.nArgs = std::min( nArgs, nRtMaxArgs );
+	for ( int ii = 0; ii < record.nArgs; ++ii ) {
+		record.args[ ii ] = pArgs[ ii ];
+	}
+	record.nSuppressed = nSuppressed;
+	record.nTimestampMs = nNowMs;
+
+	pSlot->nSequence.store( nPos + 1, std::memory_order_release );
+
+	wakeUp();
+}
+
+void Logger::processRtRecords() {
+	std::list<QString> messages;
+
+	size_t nPos = m_nRtDequeuePos.load( std::memory_order_relaxed );
+	for ( ;; ) {
+		auto pSlot = &m_rtSlots[ nPos & ( nRtCapacity - 1 ) ];
+		const size_t nSequence = pSlot->nSequence.load( std::memory_order_acquire );
+		if ( static_cast<std::ptrdiff_t>(nSequence) -
+			 static_cast<std::ptrdiff_t>(nPos + 1) < 0 ) {
+			// Ring is empty.
+			break;
+		}
+
+		// The logger thread is the only consumer.
+		const RtRecord record = pSlot->record;
+		pSlot->nSequence.store( nPos + nRtCapacity, std::memory_order_release );
+		++nPos;
+
+		QString sMsg( record.sFormat );
+		for ( int ii = 0; ii < record.nArgs; ++ii ) {
+			const auto& arg = record.args[ ii ];
+			if ( arg.bIsInteger ) {
+				sMsg = sMsg.arg( arg.nValue );
+			} else {
+				sMsg = sMsg.arg( arg.fValue );
+			}
+		}
+		if ( record.nSuppressed > 0 ) {
+			sMsg.append( QString( " [%1 similar messages suppressed]" )
+						 .arg( record.nSuppressed ) );
+		}
+
+		QString sTimestampPrefix;
+		if ( m_bLogTimestamps ) {
+			sTimestampPrefix = QString( "[%1] " )
+				.arg( QDateTime::fromMSecsSinceEpoch( record.nTimestampMs )
+					  .toString( "hh:mm:ss.zzz" ) );
+		}
+
+		messages.push_back( formatMessage(
+			record.nLevel, record.sClassName, record.sFuncName, sMsg, "",
+			sTimestampPrefix ) );
+	}
+
+	const int nDropped = m_nRtDropped.exchange( 0, std::memory_order_relaxed );
+	if ( nDropped > 0 ) {
+		messages.push_back( formatMessage(
+			Warning, "Logger", "processRtRecords",
+			QString( "[%1] realtime log messages dropped" ).arg( nDropped ),
+			"", "" ) );
+	}
+
+	if ( messages.size() > 0 ) {
+		pthread_mutex_lock( &__mutex );
+		__msg_queue.splice( __msg_queue.end(), messages );
+		pthread_mutex_unlock( &__mutex );
+	}
+
+	// Published only after the messages were handed to #__msg_queue.
+	// This way flush() does not miss them.
+	m_nRtDequeuePos.store( nPos );
 }
 
 void Logger::flush() const {
 
 	int nTimeout = 100;
 	for ( int ii = 0; ii < nTimeout; ++ii ) {
-		if ( __msg_queue.empty() ) {
+		// The realtime ring is checked first since its messages are
+		// moved into #__msg_queue.
+		if ( m_nRtDequeuePos.load() == m_nRtEnqueuePos.load() &&
+			 __msg_queue.empty() ) {
 			break;
 		}
 
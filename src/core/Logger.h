@@ -23,10 +23,12 @@
 #ifndef H2C_LOGGER_H
 #define H2C_LOGGER_H
 
+#include <atomic>
 #include <cassert>
 #include <list>
 #include <pthread.h>
 #include <memory>
+#include <type_traits>
 #include <QtCore/QString>
 #include <QStringList>
 
@@ -36,6 +38,8 @@ class QStringList;
 
 namespace H2Core {
 
+class Semaphore;
+
 /**
  * Class for writing logs to the console
  */
@@ -56,6 +60,52 @@ class Logger {
 		/** message queue type */
 		typedef std::list<QString> queue_t;
 
+		/** Maximum number of numerical arguments of a message logged
+		 * using logRt(). */
+		static constexpr int nRtMaxArgs = 6;
+		/** Maximum number of pending messages logged using logRt().
+		 * Must be a power of two. */
+		static constexpr int nRtCapacity = 512;
+		/** Messages logged at the same call site of logRt() are
+		 * dropped for this many milliseconds after the last one was
+		 * written. */
+		static constexpr int nRtRateLimitMs = 1000;
+
+		/** Numerical argument of a message logged using logRt(). */
+		struct RtArg {
+			bool bIsInteger;
+			long long nValue;
+			double fValue;
+
+			template<typename T,
+					 typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+			RtArg( T value )
+				: bIsInteger( std::is_integral_v<T> )
+				, nValue( static_cast<long long>(value) )
+				, fValue( static_cast<double>(value) ) {}
+			RtArg() : bIsInteger( true ), nValue( 0 ), fValue( 0 ) {}
+		};
+
+		/**
+		 * Per call site state used to rate-limit messages logged by
+		 * logRt(). Lock-free and intended to be a `static` variable
+		 * (see the `*LOG_RT` macros in Object.h).
+		 */
+		class RtRateLimiter {
+		public:
+			RtRateLimiter() : m_nLastMs( -nRtRateLimitMs ), m_nSuppressed( 0 ) {}
+			/**
+			 * \param nNowMs current time in milliseconds.
+			 * \param pSuppressed number of messages dropped since the
+			 *   last one was written.
+			 *
+			 * \return whether the message should be written. */
+			bool allow( long long nNowMs, int* pSuppressed );
+		private:
+			std::atomic<long long> m_nLastMs;
+			std::atomic<int> m_nSuppressed;
+		};
+
 		/**
 		 * create the logger instance if not exists, set the log level and return the instance
 		 * \param msk the logging level bitmask
@@ -111,6 +161,9 @@ class Logger {
 	 */
 	void flush() const;
 
+		/** File all messages are written to (in addition to stdout). */
+		const QString& getLogFilePath() const { return m_sLogFilePath; }
+
 		/**
 		 * parse a log level string and return the corresponding bit mask
 		 * \param lvl the log level string
@@ -128,6 +181,38 @@ class Logger {
 		void log( unsigned level, const QString& sClassName,
 				  const char* func_name, const QString& sMsg,
 				  const QString& sColor = "" );
+		/**
+		 * Log function safe to be called from realtime threads, like
+		 * the audio and MIDI driver callbacks.
+		 *
+		 * Neither allocates memory nor locks. Instead, a fixed-size
+		 * record is put into a lock-free ring and formatting is done
+		 * by the logger thread. In case the ring is full, the message
+		 * is dropped (and the number of dropped messages is reported
+		 * later on).
+		 *
+		 * \param level used to output the corresponding level string
+		 * \param sClassName the name of the calling class. Must have
+		 *   static storage duration.
+		 * \param sFuncName the name of the calling function. Must have
+		 *   static storage duration.
+		 * \param pRateLimiter optional state used to drop repeated
+		 *   messages.
+		 * \param sFormat string literal with placeholders `%1`, `%2`,
+		 *   ... for @a args.
+		 * \param args up to #nRtMaxArgs numerical values.
+		 */
+		template<typename... Args>
+		void logRt( unsigned level, const char* sClassName,
+					const char* sFuncName, RtRateLimiter* pRateLimiter,
+					const char* sFormat, Args... args ) {
+			static_assert( sizeof...(Args) <= nRtMaxArgs,
+						   "Too many arguments for realtime log message" );
+			const RtArg argArray[] = { RtArg(), RtArg( args )... };
+			logRtRecord( level, sClassName, sFuncName, pRateLimiter,
+						 sFormat, &argArray[ 1 ], sizeof...(Args) );
+		}
+
 		/**
 		 * needed for being able to access logger internal
 		 * \param param is a pointer to the logger instance
@@ -156,6 +241,52 @@ class Logger {
 		};
 
 	private:
+		/** Fixed-size POD record of a message logged using logRt(). */
+		struct RtRecord {
+			unsigned nLevel;
+			const char* sClassName;
+			const char* sFuncName;
+			const char* sFormat;
+			int nArgs;
+			RtArg args[ nRtMaxArgs ];
+			int nSuppressed;
+			/** Milliseconds since epoch. */
+			long long nTimestampMs;
+		};
+		struct RtSlot {
+			std::atomic<size_t> nSequence;
+			RtRecord record;
+		};
+
+		void logRtRecord( unsigned level, const char* sClassName,
+						  const char* sFuncName, RtRateLimiter* pRateLimiter,
+						  const char* sFormat, const RtArg* pArgs, int nArgs );
+		/** Formats all pending records of logRt() and appends them to
+		 * #__msg_queue. Only to be called by the logger thread. */
+		void processRtRecords();
+		/** Builds the final line written to the log. */
+		QString formatMessage( unsigned level, const QString& sClassName,
+							   const char* func_name, const QString& sMsg,
+							   const QString& sColor,
+							   const QString& sTimestampPrefix ) const;
+
+		std::unique_ptr<RtSlot[]> m_rtSlots;
+		/** Producer and consumer positions are placed on different
+		 * cache lines to avoid false sharing. */
+		alignas(64) std::atomic<size_t> m_nRtEnqueuePos;
+		alignas(64) std::atomic<size_t> m_nRtDequeuePos;
+		/** Number of records dropped because the ring was full. */
+		std::atomic<int> m_nRtDropped;
+
+		/** Wakes up the logger thread. Neither locks nor allocates. */
+		void wakeUp();
+		/** Posted by log() and logRt() to wake up the logger thread. */
+		std::unique_ptr<Semaphore> m_pMessagesAvailable;
+		/** Whether #m_pMessagesAvailable was already posted since the
+		 * logger thread last woke up. Avoids posting it for every
+		 * single message. */
+		std::atomic<bool> m_bWakeUpPending;
+
 		/**
 		 * Object holding the current H2Core::Logger
 		 * singleton. It is initialized with NULL, set with
@@ -168,7 +299,6 @@ class Logger {
 		queue_t __msg_queue;            ///< the message queue
 		static unsigned __bit_msk;      ///< the bitmask of log_level_t
 		static const char* __levels[];  ///< levels strings
-		pthread_cond_t __messages_available;
 	QString m_sLogFilePath;
 
 		QStringList m_prefixList;
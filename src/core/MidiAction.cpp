@@ -141,7 +141,9 @@ QString Action::toQString( const QString& sPrefix, bool bShort ) const {
 MidiActionManager* MidiActionManager::__instance = nullptr;
 
 MidiActionManager::MidiActionManager() {
-	__instance = this;
+	if ( EngineContext::getCurrent() == nullptr ) {
+		__instance = this;
+	}
 
 	m_nLastBpmChangeCCParameter = -1;
 	/*
@@ -218,7 +220,9 @@ MidiActionManager::MidiActionManager() {
 
 MidiActionManager::~MidiActionManager() {
 	//INFOLOG( "ActionManager delete" );
-	__instance = nullptr;
+	if ( __instance == this ) {
+		__instance = nullptr;
+	}
 }
 
 void MidiActionManager::create_instance() {
@@ -1086,9 +1090,10 @@ bool MidiActionManager::next_bar( std::shared_ptr<Action> , Hydrogen* pHydrogen
 		// Restart transport at the beginning of the pattern
 		CoreActionController::locateToColumn( 0 );
 		if ( pHydrogen->getPatternMode() == Song::PatternMode::Stacked ) {
-			pAudioEngine->lock( RIGHT_HERE );
-			pAudioEngine->updatePlayingPatterns( Event::Trigger::Default );
-			pAudioEngine->unlock();
+			pAudioEngine->pushCommand( []() {
+				Hydrogen::get_instance()->getAudioEngine()->
+					updatePlayingPatterns( Event::Trigger::Default );
+			} );
 		}
 	}
 	else {
@@ -1287,13 +1292,13 @@ bool MidiActionManager::redo_action( std::shared_ptr<Action> , Hydrogen* ) {
 
 bool MidiActionManager::loadNextDrumkit( std::shared_ptr<Action>, Hydrogen* ) {
 	auto pHydrogen = H2Core::Hydrogen::get_instance();
-	return CoreActionController::setDrumkit(
+	return CoreActionController::setDrumkitInBackground(
 		pHydrogen->getSoundLibraryDatabase()->getNextDrumkit() );
 }
 
 bool MidiActionManager::loadPrevDrumkit( std::shared_ptr<Action>, Hydrogen* ) {
 	auto pHydrogen = H2Core::Hydrogen::get_instance();
-	return CoreActionController::setDrumkit(
+	return CoreActionController::setDrumkitInBackground(
 		pHydrogen->getSoundLibraryDatabase()->getPreviousDrumkit() );
 }
 
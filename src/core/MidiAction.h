@@ -21,6 +21,7 @@
  */
 #ifndef ACTION_H
 #define ACTION_H
+#include <core/EngineContext.h>
 #include <core/Object.h>
 #include <map>
 #include <memory>
@@ -251,10 +252,18 @@ class MidiActionManager : public H2Core::Object<MidiActionManager>
 		 */
 		static void create_instance();
 		/**
-		 * Returns a pointer to the current MidiActionManager
-		 * singleton stored in #__instance.
+		 * Returns a pointer to the MidiActionManager of the
+		 * #EngineContext bound to the calling thread or, if there
+		 * is none, to the singleton stored in #__instance.
 		 */
-		static MidiActionManager* get_instance() { assert(__instance); return __instance; }
+		static MidiActionManager* get_instance() {
+			const auto pContext = H2Core::EngineContext::getCurrent();
+			if ( pContext != nullptr ) {
+				return pContext->getMidiActionManager();
+			}
+			assert(__instance);
+			return __instance;
+		}
 
 		const QStringList& getActionList() const {
 			return m_actionList;
@@ -258,6 +258,23 @@ template<typename T> atomic_obj_cpt_t Object<T>::counters;
 #define ___WARNINGLOG(x) __LOG_STATIC(H2Core::Logger::Warning,  (x) );
 #define ___ERRORLOG(x)  __LOG_STATIC( H2Core::Logger::Error,    (x) );
 
+// Realtime-safe logging macros (see Logger::logRt()). The first
+// argument is a string literal with placeholders %1, %2, ... followed
+// by up to Logger::nRtMaxArgs numerical arguments. Repeated messages of
+// the same call site are rate-limited.
+#define __LOG_RT( cls, lvl, ... )  { static H2Core::Logger::RtRateLimiter __rtRateLimiter; \
+		if( H2Core::Logger::get_instance()->should_log( (lvl) ) ) { H2Core::Logger::get_instance()->logRt( (lvl), (cls), __FUNCTION__, &__rtRateLimiter, __VA_ARGS__ ); } }
+
+// Object instance and class method realtime logging macros
+#define INFOLOG_RT(...)     __LOG_RT( _class_name(), H2Core::Logger::Info,    __VA_ARGS__ );
+#define WARNINGLOG_RT(...)  __LOG_RT( _class_name(), H2Core::Logger::Warning, __VA_ARGS__ );
+#define ERRORLOG_RT(...)    __LOG_RT( _class_name(), H2Core::Logger::Error,   __VA_ARGS__ );
+
+// Realtime logging macros usable without an object
+#define ___INFOLOG_RT(...)     __LOG_RT( nullptr, H2Core::Logger::Info,    __VA_ARGS__ );
+#define ___WARNINGLOG_RT(...)  __LOG_RT( nullptr, H2Core::Logger::Warning, __VA_ARGS__ );
+#define ___ERRORLOG_RT(...)    __LOG_RT( nullptr, H2Core::Logger::Error,   __VA_ARGS__ );
+
 // Can be called without or with a single argument
 #define CLOCK(...)      __LOG_METHOD( H2Core::Logger::Debug, base_clock( QString( "%1" ).arg( #__VA_ARGS__ ) ) );
 #define CLOCKIN(...)    __LOG_METHOD( H2Core::Logger::Debug, base_clock_in( QString( "%1" ).arg( #__VA_ARGS__ ) ) );
@@ -938,7 +938,7 @@ void OscServer::SONG_EDITOR_TOGGLE_GRID_CELL_Handler(lo_arg **argv, int argc) {
 void OscServer::LOAD_DRUMKIT_Handler(lo_arg **argv, int argc) {
 	INFOLOG( "processing message" );
 
-	H2Core::CoreActionController::setDrumkit(
+	H2Core::CoreActionController::setDrumkitInBackground(
 		QString::fromUtf8( &argv[0]->s ) );
 }
 
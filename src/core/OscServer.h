@@ -781,7 +781,7 @@ class OscServer : public H2Core::Object<OscServer>
 		 */
 		static void SONG_EDITOR_TOGGLE_GRID_CELL_Handler(lo_arg **argv, int argc);
 		/**
-		 * Triggers CoreActionController::setDrumkit().
+		 * Triggers CoreActionController::setDrumkitInBackground().
 		 *
 		 * The handler expects the user to provide the drumkit name. 
 		 * (row the pattern resides in within the SongEditor). The
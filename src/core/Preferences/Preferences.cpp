@@ -105,6 +105,13 @@ Preferences::Preferences()
 	, m_bUseMetronome( false )
 	, m_fMetronomeVolume( 0.5 )
 	, m_nMaxNotes( 256 )
+	, m_voiceStealing( VoiceStealing::Oldest )
+	, m_nSamplerThreads( 1 )
+	, m_nSampleStreamingHead( 0 )
+	, m_sampleStorage( ResampleKernels::Format::Float )
+	, m_nSampleCacheSize( 0 )
+	, m_nSampleLoadingThreads( 0 )
+	, m_nDrumkitCrossfade( 0 )
 	, m_nBufferSize( 1024 )
 	, m_nSampleRate( 44100 )
 	, m_sOSSDevice( "/dev/dsp" )
@@ -284,6 +291,13 @@ Preferences::Preferences( std::shared_ptr<Preferences> pOther )
 	, m_bUseMetronome( pOther->m_bUseMetronome )
 	, m_fMetronomeVolume( pOther->m_fMetronomeVolume )
 	, m_nMaxNotes( pOther->m_nMaxNotes )
+	, m_voiceStealing( pOther->m_voiceStealing )
+	, m_nSamplerThreads( pOther->m_nSamplerThreads )
+	, m_nSampleStreamingHead( pOther->m_nSampleStreamingHead )
+	, m_sampleStorage( pOther->m_sampleStorage )
+	, m_nSampleCacheSize( pOther->m_nSampleCacheSize )
+	, m_nSampleLoadingThreads( pOther->m_nSampleLoadingThreads )
+	, m_nDrumkitCrossfade( pOther->m_nDrumkitCrossfade )
 	, m_nBufferSize( pOther->m_nBufferSize )
 	, m_nSampleRate( pOther->m_nSampleRate )
 	, m_sOSSDevice( pOther->m_sOSSDevice )
@@ -575,6 +589,51 @@ std::shared_ptr<Preferences> Preferences::load( const QString& sPath, const bool
 			"metronome_volume", pPref->m_fMetronomeVolume, false, false, bSilent );
 		pPref->m_nMaxNotes = audioEngineNode.read_int(
 			"maxNotes", pPref->m_nMaxNotes, false, false, bSilent );
+		const int nVoiceStealing = audioEngineNode.read_int(
+			"voiceStealing", static_cast<int>(pPref->m_voiceStealing),
+			false, false, bSilent );
+		if ( nVoiceStealing >= static_cast<int>(VoiceStealing::Oldest) &&
+			 nVoiceStealing <= static_cast<int>(VoiceStealing::LowestPriority) ) {
+			pPref->m_voiceStealing = static_cast<VoiceStealing>(nVoiceStealing);
+		}
+		else {
+			WARNINGLOG( QString( "Unable to parse <voiceStealing>: [%1]" )
+						.arg( nVoiceStealing ) );
+		}
+		pPref->m_nSamplerThreads = std::clamp(
+			audioEngineNode.read_int( "samplerThreads", pPref->m_nSamplerThreads,
+									  false, false, bSilent ),
+			1, Preferences::nMaxSamplerThreads );
+		pPref->m_nSampleStreamingHead = std::max(
+			audioEngineNode.read_int( "sampleStreamingHead",
+									  pPref->m_nSampleStreamingHead,
+									  false, false, bSilent ), 0 );
+		const int nSampleStorage = audioEngineNode.read_int(
+			"sampleStorage", static_cast<int>(pPref->m_sampleStorage),
+			false, false, bSilent );
+		if ( nSampleStorage >= static_cast<int>(ResampleKernels::Format::Float) &&
+			 nSampleStorage <= static_cast<int>(ResampleKernels::Format::Int24) ) {
+			pPref->m_sampleStorage =
+				static_cast<ResampleKernels::Format>(nSampleStorage);
+		}
+		else {
+			WARNINGLOG( QString( "Unable to parse <sampleStorage>: [%1]" )
+						.arg( nSampleStorage ) );
+		}
+		pPref->m_nSampleCacheSize = std::max(
+			audioEngineNode.read_int( "sampleCacheSize",
+									  pPref->m_nSampleCacheSize,
+									  false, false, bSilent ), 0 );
+		pPref->m_nSampleLoadingThreads = std::clamp(
+			audioEngineNode.read_int( "sampleLoadingThreads",
+									  pPref->m_nSampleLoadingThreads,
+									  false, false, bSilent ),
+			0, Preferences::nMaxSampleLoadingThreads );
+		pPref->m_nDrumkitCrossfade = std::clamp(
+			audioEngineNode.read_int( "drumkitCrossfade",
+									  pPref->m_nDrumkitCrossfade,
+									  false, false, bSilent ),
+			0, Preferences::nMaxDrumkitCrossfade );
 		pPref->m_nBufferSize = audioEngineNode.read_int(
 			"buffer_size", pPref->m_nBufferSize, false, false, bSilent );
 		pPref->m_nSampleRate = audioEngineNode.read_int(
@@ -1154,6 +1213,15 @@ bool Preferences::saveTo( const QString& sPath, const bool bSilent ) const {
 		audioEngineNode.write_bool( "use_metronome", m_bUseMetronome );
 		audioEngineNode.write_float( "metronome_volume", m_fMetronomeVolume );
 		audioEngineNode.write_int( "maxNotes", m_nMaxNotes );
+		audioEngineNode.write_int( "voiceStealing",
+								   static_cast<int>(m_voiceStealing) );
+		audioEngineNode.write_int( "samplerThreads", m_nSamplerThreads );
+		audioEngineNode.write_int( "sampleStreamingHead", m_nSampleStreamingHead );
+		audioEngineNode.write_int( "sampleStorage",
+								   static_cast<int>(m_sampleStorage) );
+		audioEngineNode.write_int( "sampleCacheSize", m_nSampleCacheSize );
+		audioEngineNode.write_int( "sampleLoadingThreads", m_nSampleLoadingThreads );
+		audioEngineNode.write_int( "drumkitCrossfade", m_nDrumkitCrossfade );
 		audioEngineNode.write_int( "buffer_size", m_nBufferSize );
 		audioEngineNode.write_int( "samplerate", m_nSampleRate );
 
@@ -1447,6 +1515,19 @@ QString Preferences::audioDriverToQString( const Preferences::AudioDriver& drive
 	}
 }
 
+QString Preferences::voiceStealingToQString( const VoiceStealing& voiceStealing ) {
+	switch ( voiceStealing ) {
+	case VoiceStealing::Oldest:
+		return "Oldest";
+	case VoiceStealing::Quietest:
+		return "Quietest";
+	case VoiceStealing::LowestPriority:
+		return "LowestPriority";
+	default:
+		return "Unhandled voice stealing policy";
+	}
+}
+
 bool Preferences::checkJackSupport() {
 	// Check whether the Logger is already available.
 	const bool bUseLogger = Logger::isAvailable();
@@ -1687,6 +1768,20 @@ QString Preferences::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( s ).arg( m_fMetronomeVolume ) )
 			.append( QString( "%1%2m_nMaxNotes: %3\n" ).arg( sPrefix )
 					 .arg( s ).arg( m_nMaxNotes ) )
+			.append( QString( "%1%2m_voiceStealing: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( voiceStealingToQString( m_voiceStealing ) ) )
+			.append( QString( "%1%2m_nSamplerThreads: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_nSamplerThreads ) )
+			.append( QString( "%1%2m_nSampleStreamingHead: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_nSampleStreamingHead ) )
+			.append( QString( "%1%2m_sampleStorage: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( static_cast<int>(m_sampleStorage) ) )
+			.append( QString( "%1%2m_nSampleCacheSize: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_nSampleCacheSize ) )
+			.append( QString( "%1%2m_nSampleLoadingThreads: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_nSampleLoadingThreads ) )
+			.append( QString( "%1%2m_nDrumkitCrossfade: %3\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_nDrumkitCrossfade ) )
 			.append( QString( "%1%2m_nBufferSize: %3\n" ).arg( sPrefix )
 					 .arg( s ).arg( m_nBufferSize ) )
 			.append( QString( "%1%2m_nSampleRate: %3\n" ).arg( sPrefix )
@@ -1933,6 +2028,20 @@ QString Preferences::toQString( const QString& sPrefix, bool bShort ) const {
 					 .arg( m_fMetronomeVolume ) )
 			.append( QString( ", m_nMaxNotes: %1" )
 					 .arg( m_nMaxNotes ) )
+			.append( QString( ", m_voiceStealing: %1" )
+					 .arg( voiceStealingToQString( m_voiceStealing ) ) )
+			.append( QString( ", m_nSamplerThreads: %1" )
+					 .arg( m_nSamplerThreads ) )
+			.append( QString( ", m_nSampleStreamingHead: %1" )
+					 .arg( m_nSampleStreamingHead ) )
+			.append( QString( ", m_sampleStorage: %1" )
+					 .arg( static_cast<int>(m_sampleStorage) ) )
+			.append( QString( ", m_nSampleCacheSize: %1" )
+					 .arg( m_nSampleCacheSize ) )
+			.append( QString( ", m_nSampleLoadingThreads: %1" )
+					 .arg( m_nSampleLoadingThreads ) )
+			.append( QString( ", m_nDrumkitCrossfade: %1" )
+					 .arg( m_nDrumkitCrossfade ) )
 			.append( QString( ", m_nBufferSize: %1" )
 					 .arg( m_nBufferSize ) )
 			.append( QString( ", m_nSampleRate: %1" )
@@ -31,10 +31,12 @@
 #include <core/Preferences/Theme.h>
 #include <core/Preferences/Shortcuts.h>
 
+#include <core/EngineContext.h>
 #include <core/MidiAction.h>
 #include <core/Globals.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Object.h>
+#include <core/Sampler/ResampleKernels.h>
 
 #include <QStringList>
 #include <QDomDocument>
@@ -180,9 +182,32 @@ public:
 		preFader = 1
 	};
 
+	/** Determines which note is stopped by the #H2Core::Sampler once
+	 * more than #m_nMaxNotes notes are playing at the same time. The
+	 * stolen note is faded out within a couple of milliseconds. */
+	enum class VoiceStealing {
+		/** The note started first. */
+		Oldest = 0,
+		/** The note currently contributing the least, judging by note
+		 * velocity, envelope, and instrument volume. */
+		Quietest = 1,
+		/** The oldest note of the instrument located furthest down in
+		 * the drumkit. */
+		LowestPriority = 2
+	};
+	static QString voiceStealingToQString( const VoiceStealing& voiceStealing );
+
 	static void				create_instance();
+	/** \return Preferences of the #EngineContext bound to the calling
+	 * thread or, if there is none, the global ones. */
 	static std::shared_ptr<Preferences> get_instance(){
-		assert(__instance); return __instance; }
+		const auto pContext = EngineContext::getCurrent();
+		if ( pContext != nullptr ) {
+			return pContext->getPreferences();
+		}
+		assert(__instance);
+		return __instance;
+	}
 
 		Preferences();
 		Preferences( std::shared_ptr<Preferences> pOther );
@@ -259,6 +284,52 @@ public:
 	float				m_fMetronomeVolume;
 	/// max notes
 	unsigned			m_nMaxNotes;
+	VoiceStealing		m_voiceStealing;
+	/**
+	 * Number of threads used by the #Sampler to render notes,
+	 * including the audio thread itself. 1 renders all notes serially.
+	 * The output does not depend on this value.
+	 */
+	int					m_nSamplerThreads;
+	/** Upper bound of #m_nSamplerThreads. */
+	static constexpr int nMaxSamplerThreads = 16;
+	/**
+	 * Number of frames of instrument layer samples held in memory.
+	 * Samples more than twice as long are streamed from disk during
+	 * playback (see #SampleStreamer). 0 loads all samples entirely.
+	 *
+	 * The head has to cover the time required to open the file and
+	 * prefetch the following frames, e.g. 65536 frames.
+	 */
+	int					m_nSampleStreamingHead;
+	/**
+	 * Format in which samples held in memory are stored. Packed
+	 * integer formats halve (#ResampleKernels::Format::Int16) or
+	 * reduce by a quarter (#ResampleKernels::Format::Int24) the
+	 * memory footprint of a drumkit at the cost of quantization.
+	 * Streamed samples are always kept as float.
+	 */
+	ResampleKernels::Format	m_sampleStorage;
+	/**
+	 * Maximum size in MiB of the on-disk cache of decoded instrument
+	 * layer samples (see #SampleCache). 0 disables the cache.
+	 */
+	int					m_nSampleCacheSize;
+	/**
+	 * Number of threads decoding the samples of a drumkit
+	 * concurrently. 0 uses one per CPU core.
+	 */
+	int					m_nSampleLoadingThreads;
+	/** Upper bound of #m_nSampleLoadingThreads. */
+	static constexpr int nMaxSampleLoadingThreads = 64;
+	/**
+	 * Duration in milliseconds within which notes of the previous
+	 * drumkit are faded out when switching kits. 0 lets them enter
+	 * their ADSR release phase instead.
+	 */
+	int					m_nDrumkitCrossfade;
+	/** Upper bound of #m_nDrumkitCrossfade. */
+	static constexpr int nMaxDrumkitCrossfade = 1000;
 	/** 
 	 * Buffer size of the audio.
 	 *
@@ -498,6 +498,7 @@ void SMFWriter::save( const QString& sFilename, std::shared_ptr<Song> pSong,
 				  nLastNumerator, nLastDenominator , 0 ), nullptr );
 
 	AutomationPath* pAutomationPath = pSong->getVelocityAutomationPath();
+	AutomationPath::Cursor automationCursor;
 
 	auto pInstrumentList = pSong->getDrumkit()->getInstruments();
 	int nTick = 0;
@@ -623,7 +624,7 @@ void SMFWriter::save( const QString& sFilename, std::shared_ptr<Song> pSong,
 					(fNoteTick - static_cast<float>(nTick)) /
 					static_cast<float>(nColumnLength);
 				const float fVelocityAdjustment =
-					pAutomationPath->get_value( fColumnPos );
+					pAutomationPath->get_value( fColumnPos, automationCursor );
 				const int nVelocity = static_cast<int>(
 					127.0 * pCopiedNote->getVelocity() * fVelocityAdjustment );
 
@@ -0,0 +1,210 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/RenderThreadPool.h>
+
+#include <core/EngineContext.h>
+#include <core/Helpers/Semaphore.h>
+
+#include <algorithm>
+
+#ifndef WIN32
+#    include <pthread.h>
+#endif
+
+namespace H2Core
+{
+
+/** Number of times an idle worker checks for new tasks before it goes
+ * to sleep. */
+static constexpr int nSpinIterations = 256;
+
+static inline uint32_t generationOf( uint64_t nState ) {
+	return static_cast<uint32_t>( nState >> 32 );
+}
+static inline int taskOf( uint64_t nState ) {
+	return static_cast<int>( nState & 0xffffffff );
+}
+
+RenderThreadPool::RenderThreadPool( int nThreads )
+	: m_pSemaphore( std::make_unique<Semaphore>() )
+	, m_nState( 0 )
+	, m_nTasks( 0 )
+	, m_nCompletedTasks( 0 )
+	, m_nSleepingWorkers( 0 )
+	, m_bShutdown( false )
+	, m_task( nullptr )
+	, m_pContext( nullptr )
+	, m_pEngineContext( EngineContext::getCurrent() )
+{
+	for ( int ii = 1; ii < nThreads; ++ii ) {
+		m_workers.emplace_back( &RenderThreadPool::workerLoop, this );
+	}
+}
+
+RenderThreadPool::~RenderThreadPool() {
+	m_bShutdown.store( true );
+	m_pSemaphore->post( static_cast<int>(m_workers.size()) );
+
+	for ( auto& worker : m_workers ) {
+		worker.join();
+	}
+}
+
+void RenderThreadPool::run( int nTasks, Task task, void* pContext ) {
+	if ( nTasks <= 0 ) {
+		return;
+	}
+
+	if ( m_workers.empty() || nTasks == 1 ) {
+		for ( int ii = 0; ii < nTasks; ++ii ) {
+			task( ii, pContext );
+		}
+		return;
+	}
+
+	adoptScheduling();
+
+	// All tasks of the previous batch are completed. No worker is
+	// reading the fields below.
+	m_task = task;
+	m_pContext = pContext;
+	m_nTasks.store( nTasks, std::memory_order_relaxed );
+	m_nCompletedTasks.store( 0, std::memory_order_relaxed );
+
+	const uint32_t nGeneration =
+		generationOf( m_nState.load( std::memory_order_relaxed ) ) + 1;
+	m_nState.store( static_cast<uint64_t>(nGeneration) << 32 );
+
+	// Workers announce going to sleep before checking the generation one
+	// last time. Either they see the new one or we see them.
+	const int nSleepingWorkers = m_nSleepingWorkers.load();
+	if ( nSleepingWorkers > 0 ) {
+		m_pSemaphore->post( std::min( nSleepingWorkers, nTasks - 1 ) );
+	}
+
+	// Tasks not picked up by the workers yet are executed right away
+	// instead of waiting for them to wake up.
+	executeTasks( nGeneration );
+
+	// Only tasks claimed by workers are still processed. They write into
+	// memory owned by the caller and have to be finished.
+	while ( m_nCompletedTasks.load( std::memory_order_acquire ) < nTasks ) {
+		std::this_thread::yield();
+	}
+}
+
+void RenderThreadPool::executeTasks( uint32_t nGeneration ) {
+	uint64_t nState = m_nState.load( std::memory_order_acquire );
+	while ( generationOf( nState ) == nGeneration &&
+			taskOf( nState ) < m_nTasks.load( std::memory_order_relaxed ) ) {
+		if ( m_nState.compare_exchange_weak( nState, nState + 1,
+											 std::memory_order_acq_rel,
+											 std::memory_order_acquire ) ) {
+			m_task( taskOf( nState ), m_pContext );
+			m_nCompletedTasks.fetch_add( 1, std::memory_order_release );
+			nState = m_nState.load( std::memory_order_acquire );
+		}
+	}
+}
+
+void RenderThreadPool::adoptScheduling() {
+#ifndef WIN32
+	// Only done once per driver thread calling us.
+	if ( m_callerThread == std::this_thread::get_id() ) {
+		return;
+	}
+	m_callerThread = std::this_thread::get_id();
+
+	int nPolicy;
+	sched_param param;
+	if ( pthread_getschedparam( pthread_self(), &nPolicy, &param ) != 0 ) {
+		return;
+	}
+	for ( auto& worker : m_workers ) {
+		if ( pthread_setschedparam( worker.native_handle(), nPolicy,
+									&param ) != 0 ) {
+			WARNINGLOG( QString( "Unable to apply scheduling policy [%1] and priority [%2] to render thread" )
+						.arg( nPolicy ).arg( param.sched_priority ) );
+			break;
+		}
+	}
+#endif
+}
+
+void RenderThreadPool::workerLoop() {
+	EngineContext::Scope scope( m_pEngineContext );
+
+	uint32_t nSeenGeneration = 0;
+	while ( true ) {
+		uint32_t nGeneration =
+			generationOf( m_nState.load( std::memory_order_acquire ) );
+		for ( int ii = 0; ii < nSpinIterations &&
+				  nGeneration == nSeenGeneration &&
+				  ! m_bShutdown.load( std::memory_order_relaxed ); ++ii ) {
+			std::this_thread::yield();
+			nGeneration = generationOf( m_nState.load( std::memory_order_acquire ) );
+		}
+
+		if ( nGeneration == nSeenGeneration && ! m_bShutdown.load() ) {
+			m_nSleepingWorkers.fetch_add( 1 );
+			nGeneration = generationOf( m_nState.load() );
+			if ( nGeneration == nSeenGeneration && ! m_bShutdown.load() ) {
+				m_pSemaphore->wait();
+			}
+			m_nSleepingWorkers.fetch_sub( 1 );
+			nGeneration = generationOf( m_nState.load( std::memory_order_acquire ) );
+		}
+
+		if ( m_bShutdown.load() ) {
+			return;
+		}
+
+		if ( nGeneration == nSeenGeneration ) {
+			// Woken up by a post meant for a worker which did not go to
+			// sleep after all.
+			continue;
+		}
+
+		nSeenGeneration = nGeneration;
+		executeTasks( nGeneration );
+	}
+}
+
+QString RenderThreadPool::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[RenderThreadPool]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_nThreads: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getThreads() ) )
+			.append( QString( "%1%2m_nTasks: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nTasks.load() ) );
+	}
+	else {
+		sOutput = QString( "[RenderThreadPool] m_nThreads: %1" )
+			.arg( getThreads() )
+			.append( QString( ", m_nTasks: %1" ).arg( m_nTasks.load() ) );
+	}
+	return sOutput;
+}
+
+};
@@ -0,0 +1,127 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_RENDER_THREAD_POOL_H
+#define H2C_RENDER_THREAD_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class EngineContext;
+class Semaphore;
+
+/**
+ * Small fork-join pool used by the #Sampler to render notes in
+ * parallel within a single process cycle.
+ *
+ * The calling thread - usually the audio thread - participates in the
+ * work itself. Tasks are claimed dynamically via an atomic counter, so
+ * the pool does not decide which result ends up where. Callers needing
+ * deterministic output have to write into per-task storage and reduce
+ * it in a fixed order afterwards.
+ *
+ * run() neither locks a mutex nor waits for workers to wake up. Workers
+ * spin briefly on the generation of the current batch before they go to
+ * sleep on a semaphore. The calling thread claims all tasks not picked
+ * up yet itself and only waits for those already being processed by a
+ * worker. Workers adopt the scheduling policy and priority of the
+ * calling thread (not supported on Windows) in order to not be preempted
+ * by threads the audio thread takes precedence over while it is
+ * waiting for them. It is applied to all of them at once by the first
+ * run() of a new calling thread, so the workers themselves never
+ * touch their scheduling.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class RenderThreadPool : public H2Core::Object<RenderThreadPool>
+{
+	H2_OBJECT(RenderThreadPool)
+public:
+	typedef void (*Task)( int nTask, void* pContext );
+
+	/**
+	 * @param nThreads Total number of threads rendering, including the
+	 *   one calling run(). A value of 1 results in a pool without
+	 *   workers executing all tasks serially.
+	 */
+	RenderThreadPool( int nThreads );
+	~RenderThreadPool();
+
+	/**
+	 * Executes @a task for every index in [0, @a nTasks) and returns
+	 * once all of them are done.
+	 *
+	 * Must not be called concurrently.
+	 */
+	void run( int nTasks, Task task, void* pContext );
+
+	int getThreads() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	void workerLoop();
+	/** Claims and executes tasks of batch @a nGeneration until none is
+	 * left. */
+	void executeTasks( uint32_t nGeneration );
+	/** Applies the scheduling of the thread calling run() to all
+	 * workers in case the calling thread changed. */
+	void adoptScheduling();
+
+	std::vector<std::thread> m_workers;
+	std::unique_ptr<Semaphore> m_pSemaphore;
+
+	/** Generation of the current batch in the upper and index of the
+	 * next unclaimed task in the lower 32 bits. Keeping both in a
+	 * single word allows to claim a task and to ensure it belongs to
+	 * the current batch at once. */
+	std::atomic<uint64_t> m_nState;
+	std::atomic<int> m_nTasks;
+	std::atomic<int> m_nCompletedTasks;
+	/** Number of workers about to wait or waiting on #m_pSemaphore. */
+	std::atomic<int> m_nSleepingWorkers;
+	std::atomic<bool> m_bShutdown;
+
+	/** Only altered by run() while no task is claimed. */
+	Task m_task;
+	void* m_pContext;
+
+	std::thread::id m_callerThread;
+	/** Context of the thread creating the pool. Bound to all
+	 * workers. */
+	EngineContext* m_pEngineContext;
+};
+
+inline int RenderThreadPool::getThreads() const {
+	return static_cast<int>(m_workers.size()) + 1;
+}
+
+};
+
+#endif // H2C_RENDER_THREAD_POOL_H
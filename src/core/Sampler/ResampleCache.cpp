@@ -0,0 +1,323 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/ResampleCache.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/InstrumentList.h>
+
+namespace H2Core
+{
+
+/** Maximum number of frames copied from a sample while holding the
+ * lock of the audio engine. */
+static constexpr int nCopyChunkFrames = 65536;
+
+/** Number of zero crossings of the sinc filter on each side of its
+ * center. */
+static constexpr int nSincZeroCrossings = 32;
+/** Number of table entries between two zero crossings. */
+static constexpr int nSincPhases = 256;
+/** Fraction of the lower Nyquist frequency used as cutoff. Leaves
+ * room for the transition band of the filter. */
+static constexpr double fSincRolloff = 0.97;
+
+/** Blackman-windowed sinc evaluated at multiples of 1 /
+ * #nSincPhases. */
+static const std::vector<float>& sincTable() {
+	static const std::vector<float> table = [](){
+		const int nSize = nSincZeroCrossings * nSincPhases + 2;
+		std::vector<float> values( nSize, 0 );
+		for ( int ii = 0; ii < nSize; ++ii ) {
+			const double fX = static_cast<double>(ii) / nSincPhases;
+			if ( fX >= nSincZeroCrossings ) {
+				break;
+			}
+			const double fSinc = ii == 0 ? 1 :
+				std::sin( M_PI * fX ) / ( M_PI * fX );
+			const double fWindow = 0.42 +
+				0.5 * std::cos( M_PI * fX / nSincZeroCrossings ) +
+				0.08 * std::cos( 2 * M_PI * fX / nSincZeroCrossings );
+			values[ ii ] = static_cast<float>( fSinc * fWindow );
+		}
+		return values;
+	}();
+	return table;
+}
+
+ResampleCache::ResampleCache( AudioEngine* pAudioEngine )
+	: m_pAudioEngine( pAudioEngine )
+	, m_nSampleRate( 0 )
+	, m_bPending( false )
+	, m_bShutdown( false )
+	, m_bAbort( false )
+{
+	m_worker = std::thread( &ResampleCache::workerLoop, this );
+}
+
+ResampleCache::~ResampleCache() {
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bShutdown = true;
+		m_bAbort = true;
+	}
+	m_condition.notify_all();
+	m_worker.join();
+}
+
+void ResampleCache::rebuild( std::shared_ptr<Drumkit> pDrumkit,
+							 int nSampleRate ) {
+	std::vector<std::shared_ptr<Sample>> samples;
+	if ( pDrumkit != nullptr && nSampleRate > 0 ) {
+		for ( const auto& pInstrument : *pDrumkit->getInstruments() ) {
+			if ( pInstrument == nullptr ) {
+				continue;
+			}
+			for ( const auto& pComponent : *pInstrument->getComponents() ) {
+				if ( pComponent == nullptr ) {
+					continue;
+				}
+				for ( const auto& pLayer : pComponent->getLayers() ) {
+					if ( pLayer != nullptr && pLayer->getSample() != nullptr ) {
+						samples.push_back( pLayer->getSample() );
+					}
+				}
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_pendingSamples.swap( samples );
+		m_nSampleRate = nSampleRate;
+		m_bPending = true;
+		m_bAbort = true;
+	}
+	m_condition.notify_one();
+
+	// The previously pending samples are released here, outside of
+	// the mutex.
+}
+
+void ResampleCache::workerLoop() {
+	while ( true ) {
+		std::vector<std::shared_ptr<Sample>> samples;
+		int nSampleRate;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_condition.wait( lock, [&]{ return m_bShutdown || m_bPending; } );
+			if ( m_bShutdown ) {
+				return;
+			}
+			samples.swap( m_pendingSamples );
+			nSampleRate = m_nSampleRate;
+			m_bPending = false;
+			m_bAbort = false;
+		}
+
+		for ( const auto& pSample : samples ) {
+			if ( m_bAbort ) {
+				break;
+			}
+			process( pSample, nSampleRate );
+		}
+	}
+}
+
+void ResampleCache::process( std::shared_ptr<Sample> pSample, int nSampleRate ) {
+	// The sample data can be replaced or freed at any time the engine
+	// is not locked. We copy it in chunks to not block the audio
+	// thread for too long in case of large samples.
+	std::vector<float> data_L, data_R;
+	const float* pOriginalData = nullptr;
+	bool bMono = false;
+	int nFrames = 0;
+	int nSourceRate = 0;
+	int nCopiedFrames = 0;
+	do {
+		if ( m_bAbort ) {
+			return;
+		}
+		m_pAudioEngine->lock( RIGHT_HERE );
+		if ( pOriginalData == nullptr ) {
+			// Streamed samples are not held in memory as a whole and
+			// packed ones are rendered from their packed data.
+			if ( ! pSample->isLoaded() || pSample->isStreamed() ||
+				 pSample->getFormat() != ResampleKernels::Format::Float ||
+				 pSample->getData_L() == nullptr ||
+				 pSample->getData_R() == nullptr ||
+				 pSample->getSampleRate() <= 0 ||
+				 pSample->getSampleRate() == nSampleRate ||
+				 pSample->getResampled( nSampleRate ) != nullptr ) {
+				m_pAudioEngine->unlock();
+				return;
+			}
+			pOriginalData = pSample->getData_L();
+			bMono = pSample->isMono();
+			nFrames = pSample->getFrames();
+			nSourceRate = pSample->getSampleRate();
+			data_L.resize( nFrames );
+			if ( ! bMono ) {
+				data_R.resize( nFrames );
+			}
+		}
+		else if ( pSample->getData_L() != pOriginalData ||
+				  pSample->getFrames() != nFrames ) {
+			// Sample was reloaded in the meantime.
+			m_pAudioEngine->unlock();
+			return;
+		}
+		const int nChunk = std::min( nCopyChunkFrames, nFrames - nCopiedFrames );
+		std::copy_n( pSample->getData_L() + nCopiedFrames, nChunk,
+					 data_L.begin() + nCopiedFrames );
+		if ( ! bMono ) {
+			std::copy_n( pSample->getData_R() + nCopiedFrames, nChunk,
+						 data_R.begin() + nCopiedFrames );
+		}
+		nCopiedFrames += nChunk;
+		m_pAudioEngine->unlock();
+	} while ( nCopiedFrames < nFrames );
+
+	auto pResampled = convert( data_L.data(),
+							   bMono ? data_L.data() : data_R.data(), nFrames,
+							   nSourceRate, nSampleRate, &m_bAbort );
+	if ( pResampled == nullptr ) {
+		return;
+	}
+
+	std::shared_ptr<Sample::Resampled> pPrevious;
+	m_pAudioEngine->lock( RIGHT_HERE );
+	if ( ! m_bAbort && pSample->getData_L() == pOriginalData &&
+		 pSample->getFrames() == nFrames &&
+		 pSample->getSampleRate() == nSourceRate ) {
+		pPrevious = pSample->setResampled( pResampled );
+	}
+	m_pAudioEngine->unlock();
+
+	// pPrevious is freed here, outside of the lock.
+}
+
+std::shared_ptr<Sample::Resampled> ResampleCache::convert(
+	const float* pData_L, const float* pData_R, int nFrames,
+	int nSourceRate, int nTargetRate, const std::atomic<bool>* pAbort )
+{
+	if ( pData_L == nullptr || pData_R == nullptr || nFrames <= 0 ||
+		 nSourceRate <= 0 || nTargetRate <= 0 ) {
+		return nullptr;
+	}
+
+	const long long nTargetFrames =
+		static_cast<long long>(nFrames) * nTargetRate / nSourceRate;
+	if ( nTargetFrames <= 0 ||
+		 nTargetFrames > std::numeric_limits<int>::max() ) {
+		return nullptr;
+	}
+
+	auto pResampled = std::make_shared<Sample::Resampled>();
+	pResampled->nSampleRate = nTargetRate;
+	pResampled->nFrames = static_cast<int>(nTargetFrames);
+	const bool bMono = pData_L == pData_R;
+	pResampled->data_L.resize( nTargetFrames );
+	if ( ! bMono ) {
+		pResampled->data_R.resize( nTargetFrames );
+	}
+
+	const auto& table = sincTable();
+	const int nTableEnd = nSincZeroCrossings * nSincPhases;
+
+	// When downsampling the cutoff has to be lowered to the Nyquist
+	// frequency of the target rate in order to avoid aliasing. This
+	// widens the filter in the source domain.
+	const double fCutoff = fSincRolloff *
+		std::min( 1.0, static_cast<double>(nTargetRate) / nSourceRate );
+	const int nRadius = static_cast<int>(
+		std::ceil( nSincZeroCrossings / fCutoff ) );
+	const double fTableScale = fCutoff * nSincPhases;
+
+	for ( long long nn = 0; nn < nTargetFrames; ++nn ) {
+		if ( pAbort != nullptr && ( nn & 0xffff ) == 0 && *pAbort ) {
+			return nullptr;
+		}
+
+		// Exact position in the source using integer arithmetic.
+		const long long nNumerator = nn * nSourceRate;
+		const long long nCenter = nNumerator / nTargetRate;
+		const double fFraction =
+			static_cast<double>( nNumerator % nTargetRate ) / nTargetRate;
+
+		const long long nFirst = std::max( 0LL, nCenter - nRadius + 1 );
+		const long long nLast = std::min( static_cast<long long>(nFrames) - 1,
+										  nCenter + nRadius );
+
+		double fSum_L = 0, fSum_R = 0;
+		for ( long long kk = nFirst; kk <= nLast; ++kk ) {
+			const double fTablePos =
+				std::abs( static_cast<double>(nCenter - kk) + fFraction ) *
+				fTableScale;
+			const int nIndex = static_cast<int>(fTablePos);
+			if ( nIndex >= nTableEnd ) {
+				continue;
+			}
+			const double fWeight = table[ nIndex ] +
+				( table[ nIndex + 1 ] - table[ nIndex ] ) *
+				( fTablePos - nIndex );
+			fSum_L += fWeight * pData_L[ kk ];
+			if ( ! bMono ) {
+				fSum_R += fWeight * pData_R[ kk ];
+			}
+		}
+
+		pResampled->data_L[ nn ] = static_cast<float>( fSum_L * fCutoff );
+		if ( ! bMono ) {
+			pResampled->data_R[ nn ] = static_cast<float>( fSum_R * fCutoff );
+		}
+	}
+
+	return pResampled;
+}
+
+QString ResampleCache::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[ResampleCache]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_nSampleRate: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nSampleRate ) )
+			.append( QString( "%1%2m_bPending: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_bPending ) );
+	}
+	else {
+		sOutput = QString( "[ResampleCache] m_nSampleRate: %1" )
+			.arg( m_nSampleRate )
+			.append( QString( ", m_bPending: %1" ).arg( m_bPending ) );
+	}
+	return sOutput;
+}
+
+};
@@ -0,0 +1,117 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_RESAMPLE_CACHE_H
+#define H2C_RESAMPLE_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <core/Basics/Sample.h>
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class AudioEngine;
+class Drumkit;
+
+/**
+ * Converts the samples of the current drumkit to the sample rate of
+ * the audio driver in the background.
+ *
+ * The results are stored in the samples themselves (see
+ * Sample::getResampled()) and allow the #Sampler to render unpitched
+ * notes of samples recorded at a different rate than the one of the
+ * audio driver using a plain copy instead of interpolating on the
+ * fly. The conversion uses a windowed sinc filter and is thus of
+ * higher quality than any of the realtime interpolation modes.
+ *
+ * The price is memory: every sample with a rate different from the
+ * one of the driver is held twice.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class ResampleCache : public H2Core::Object<ResampleCache>
+{
+	H2_OBJECT(ResampleCache)
+public:
+	ResampleCache( AudioEngine* pAudioEngine );
+	/** Discards all pending work and joins the worker thread. */
+	~ResampleCache();
+
+	/**
+	 * Schedules the conversion of all samples in @a pDrumkit to
+	 * @a nSampleRate. Work pending from a previous call is
+	 * discarded.
+	 *
+	 * Does not block and is therefore safe to be called while holding
+	 * the lock of the #AudioEngine.
+	 */
+	void rebuild( std::shared_ptr<Drumkit> pDrumkit, int nSampleRate );
+
+	/**
+	 * Converts the provided audio data from @a nSourceRate to
+	 * @a nTargetRate using a Blackman-windowed sinc filter. For mono
+	 * data - @a pData_L and @a pData_R being the same - only
+	 * Sample::Resampled::data_L is filled.
+	 *
+	 * \param pAbort If not nullptr, conversion will be stopped as
+	 *   soon as it is set to true.
+	 *
+	 * \return Converted data or nullptr in case the conversion was
+	 *   aborted or the arguments are invalid.
+	 */
+	static std::shared_ptr<Sample::Resampled> convert(
+		const float* pData_L, const float* pData_R, int nFrames,
+		int nSourceRate, int nTargetRate,
+		const std::atomic<bool>* pAbort = nullptr );
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	void workerLoop();
+	/** Converts a single sample and installs the result. */
+	void process( std::shared_ptr<Sample> pSample, int nSampleRate );
+
+	AudioEngine* m_pAudioEngine;
+	std::thread m_worker;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	/** Samples still to be converted. Only accessed while holding
+	 * #m_mutex. */
+	std::vector<std::shared_ptr<Sample>> m_pendingSamples;
+	/** Sample rate the pending samples will be converted to. */
+	int m_nSampleRate;
+	bool m_bPending;
+	bool m_bShutdown;
+	/** Set whenever the current batch of work became obsolete. */
+	std::atomic<bool> m_bAbort;
+};
+
+};
+
+#endif // H2C_RESAMPLE_CACHE_H
@@ -0,0 +1,137 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/config.h>
+#include <core/Sampler/Interpolation.h>
+#include <core/Sampler/ResampleKernels.h>
+
+#include <atomic>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+
+static_assert( static_cast<int>(Interpolation::InterpolateMode::Hermite) ==
+			   nModes - 1, "Kernel tables do not match interpolation modes" );
+
+static Isa detectIsa() {
+#if defined(H2CORE_HAVE_X86_SIMD)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx512f" ) ) {
+		return Isa::AVX512;
+	}
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		return Isa::AVX2;
+	}
+	if ( __builtin_cpu_supports( "sse2" ) ) {
+		return Isa::SSE2;
+	}
+#endif
+	return Isa::Scalar;
+}
+
+static std::atomic<int>& currentIsa() {
+	static std::atomic<int> isa( static_cast<int>(getSupportedIsa()) );
+	return isa;
+}
+
+Isa getSupportedIsa() {
+	static const Isa isa = detectIsa();
+	return isa;
+}
+
+Isa getIsa() {
+	return static_cast<Isa>(currentIsa().load( std::memory_order_relaxed ));
+}
+
+void setIsa( Isa isa ) {
+	if ( static_cast<int>(isa) > static_cast<int>(getSupportedIsa()) ) {
+		isa = getSupportedIsa();
+	}
+	currentIsa().store( static_cast<int>(isa), std::memory_order_relaxed );
+}
+
+Kernel getKernel( int nMode ) {
+	return getKernel( getIsa(), nMode );
+}
+
+Kernel getKernel( Isa isa, int nMode ) {
+	return getKernelFor<float>( isa, nMode );
+}
+
+template < typename T >
+static KernelT<T> selectKernel( Isa isa, int nMode,
+								const KernelT<T>* pKernelsSse2,
+								const KernelT<T>* pKernelsAvx2,
+								const KernelT<T>* pKernelsAvx512 ) {
+	if ( nMode < 0 || nMode >= nModes ||
+		 static_cast<int>(isa) > static_cast<int>(getSupportedIsa()) ) {
+		return nullptr;
+	}
+
+	switch ( isa ) {
+	case Isa::SSE2:
+		return pKernelsSse2[ nMode ];
+	case Isa::AVX2:
+		return pKernelsAvx2[ nMode ];
+	case Isa::AVX512:
+		return pKernelsAvx512[ nMode ];
+	default:
+		return nullptr;
+	}
+}
+
+template <>
+KernelT<float> getKernelFor<float>( Isa isa, int nMode ) {
+	return selectKernel<float>( isa, nMode, kernelsSse2, kernelsAvx2,
+								kernelsAvx512 );
+}
+
+template <>
+KernelT<int16_t> getKernelFor<int16_t>( Isa isa, int nMode ) {
+	return selectKernel<int16_t>( isa, nMode, kernelsInt16Sse2,
+								  kernelsInt16Avx2, kernelsInt16Avx512 );
+}
+
+template <>
+KernelT<Int24> getKernelFor<Int24>( Isa isa, int nMode ) {
+	return selectKernel<Int24>( isa, nMode, kernelsInt24Sse2,
+								kernelsInt24Avx2, kernelsInt24Avx512 );
+}
+
+const char* isaToString( Isa isa ) {
+	switch ( isa ) {
+	case Isa::Scalar:
+		return "Scalar";
+	case Isa::SSE2:
+		return "SSE2";
+	case Isa::AVX2:
+		return "AVX2";
+	case Isa::AVX512:
+		return "AVX-512";
+	default:
+		return "<unknown>";
+	}
+}
+
+};
+};
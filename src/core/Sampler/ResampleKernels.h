@@ -0,0 +1,226 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_RESAMPLE_KERNELS_H
+#define H2C_RESAMPLE_KERNELS_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace H2Core
+{
+
+/**
+ * Vectorized implementations of the body of the resampling loop in
+ * #Sampler for all #Interpolation::InterpolateMode.
+ *
+ * The kernels are compiled for several x86 instruction sets in
+ * separate translation units and the widest one supported by the
+ * running CPU is selected at runtime. On other architectures only the
+ * scalar path of the #Sampler is available.
+ *
+ * In contrast to the scalar path - which accumulates the sample
+ * position frame by frame in double precision - the kernels compute
+ * the position of each frame directly and do the interpolation itself
+ * in single precision. For sample data within [-1, 1] the results
+ * differ from the scalar path by no more than #fTolerance.
+ *
+ * Apart from 32 bit float, sample data can be stored as packed 16 or
+ * 24 bit integers (see #Format). The kernels gather the integers and
+ * widen them to float before interpolating.
+ *
+ * Headers of this module must not include any Qt header since the
+ * kernels are compiled using instruction set specific flags.
+ */
+namespace ResampleKernels
+{
+	/** Ordered from narrowest to widest. */
+	enum class Isa {
+		/** The scalar per-frame code path within the #Sampler. */
+		Scalar = 0,
+		SSE2 = 1,
+		AVX2 = 2,
+		AVX512 = 3
+	};
+
+	/** Matches the number of #Interpolation::InterpolateMode. */
+	static constexpr int nModes = 5;
+
+	/** Maximum absolute deviation from the scalar path for sample data
+	 * within [-1, 1]. */
+	static constexpr float fTolerance = 1e-5;
+
+	/** Layouts the sample data handed to the kernels can be stored
+	 * in. */
+	enum class Format {
+		Float = 0,
+		/** Signed 16 bit integers. */
+		Int16 = 1,
+		/** Signed 24 bit little-endian integers packed into three
+		 * bytes each. */
+		Int24 = 2
+	};
+
+	struct Int24 {
+		uint8_t bytes[ 3 ];
+	};
+	static_assert( sizeof( Int24 ) == 3, "Int24 has to be packed" );
+
+	/** Integer data is read in words of 32 bit. Buffers holding it have
+	 * to be followed by this many readable bytes. */
+	static constexpr int nPackedPadding = 4;
+
+	static constexpr float fInt16Scale = 1.0f / 32768.0f;
+	static constexpr float fInt24Scale = 1.0f / 8388608.0f;
+
+	// Conversions between the formats. They are static to not share
+	// any definition with the instruction set specific translation
+	// units.
+	static inline float toFloat( float fValue ) {
+		return fValue;
+	}
+	static inline float toFloat( int16_t nValue ) {
+		return static_cast<float>(nValue) * fInt16Scale;
+	}
+	static inline float toFloat( const Int24& value ) {
+		const int32_t nValue = static_cast<int32_t>(
+			static_cast<uint32_t>(value.bytes[ 0 ]) |
+			static_cast<uint32_t>(value.bytes[ 1 ]) << 8 |
+			static_cast<uint32_t>(value.bytes[ 2 ]) << 16 );
+		// Sign extension
+		return static_cast<float>( ( nValue ^ 0x800000 ) - 0x800000 ) *
+			fInt24Scale;
+	}
+	/** NaN check which is not folded away by -ffast-math. */
+	static inline bool isNaN( float fValue ) {
+		uint32_t nBits;
+		memcpy( &nBits, &fValue, sizeof( nBits ) );
+		return ( nBits & 0x7fffffff ) > 0x7f800000;
+	}
+	/** Rounds @a fValue to the nearest integer. Values outside of
+	 * [-1, 1) are clipped and NaN is mapped to silence. */
+	static inline int16_t toInt16( float fValue ) {
+		if ( isNaN( fValue ) ) {
+			return 0;
+		}
+		const float fScaled = fValue * 32768.0f;
+		if ( fScaled <= -32768.0f ) {
+			return -32768;
+		}
+		if ( fScaled >= 32767.0f ) {
+			return 32767;
+		}
+		return static_cast<int16_t>(
+			fScaled < 0 ? fScaled - 0.5f : fScaled + 0.5f );
+	}
+	/** See toInt16(). */
+	static inline Int24 toInt24( float fValue ) {
+		int32_t nValue = 0;
+		const double fScaled = static_cast<double>(fValue) * 8388608.0;
+		if ( isNaN( fValue ) ) {
+			nValue = 0;
+		}
+		else if ( fScaled <= -8388608.0 ) {
+			nValue = -8388608;
+		}
+		else if ( fScaled >= 8388607.0 ) {
+			nValue = 8388607;
+		}
+		else {
+			nValue = static_cast<int32_t>(
+				fScaled < 0 ? fScaled - 0.5 : fScaled + 0.5 );
+		}
+		const uint32_t nBits = static_cast<uint32_t>(nValue);
+		return { { static_cast<uint8_t>( nBits & 0xff ),
+				   static_cast<uint8_t>( ( nBits >> 8 ) & 0xff ),
+				   static_cast<uint8_t>( ( nBits >> 16 ) & 0xff ) } };
+	}
+
+	/**
+	 * Interpolates @a nFrames output frames starting at @a fSamplePos
+	 * and advancing @a fStep input frames per output frame.
+	 *
+	 * Frames are read without bounds checking. The caller has to ensure
+	 * all frames within [fSamplePos - 1, fSamplePos + nFrames * fStep +
+	 * 2] are part of the sample data.
+	 *
+	 * For mono samples @a pSample_data_L and @a pSample_data_R are the
+	 * same and the data is interpolated just once.
+	 */
+	template < typename T >
+	using KernelT = void (*)( float* __restrict__ pBuffer_L,
+							  float* __restrict__ pBuffer_R,
+							  const T* __restrict__ pSample_data_L,
+							  const T* __restrict__ pSample_data_R,
+							  int nFrames, double fSamplePos, double fStep );
+	typedef KernelT<float> Kernel;
+
+	/** @return Widest instruction set supported by both the build and
+	 *   the CPU. */
+	Isa getSupportedIsa();
+	/** @return Instruction set currently used by the #Sampler. */
+	Isa getIsa();
+	/** Restricts the kernels used to @a isa. Values wider than
+	 * getSupportedIsa() are clamped. Mainly used for benchmarking and
+	 * testing. */
+	void setIsa( Isa isa );
+
+	/** @return Kernel for interpolation mode @a nMode
+	 *   (#Interpolation::InterpolateMode) using the current
+	 *   instruction set or `nullptr` in case the scalar path should be
+	 *   used. */
+	Kernel getKernel( int nMode );
+	/** @return Kernel for @a nMode using @a isa or `nullptr` in case
+	 *   @a isa is not supported. */
+	Kernel getKernel( Isa isa, int nMode );
+	/** Same as getKernel() but for sample data stored as @a T (float,
+	 * int16_t, or #Int24). */
+	template < typename T >
+	KernelT<T> getKernelFor( Isa isa, int nMode );
+	template <>
+	KernelT<float> getKernelFor<float>( Isa isa, int nMode );
+	template <>
+	KernelT<int16_t> getKernelFor<int16_t>( Isa isa, int nMode );
+	template <>
+	KernelT<Int24> getKernelFor<Int24>( Isa isa, int nMode );
+	template < typename T >
+	KernelT<T> getKernelFor( int nMode ) {
+		return getKernelFor<T>( getIsa(), nMode );
+	}
+
+	const char* isaToString( Isa isa );
+
+	// Kernel tables of the individual translation units. Empty entries
+	// in case the build does not support the instruction set.
+	extern const Kernel kernelsSse2[ nModes ];
+	extern const Kernel kernelsAvx2[ nModes ];
+	extern const Kernel kernelsAvx512[ nModes ];
+	extern const KernelT<int16_t> kernelsInt16Sse2[ nModes ];
+	extern const KernelT<int16_t> kernelsInt16Avx2[ nModes ];
+	extern const KernelT<int16_t> kernelsInt16Avx512[ nModes ];
+	extern const KernelT<Int24> kernelsInt24Sse2[ nModes ];
+	extern const KernelT<Int24> kernelsInt24Avx2[ nModes ];
+	extern const KernelT<Int24> kernelsInt24Avx512[ nModes ];
+};
+
+};
+
+#endif // H2C_RESAMPLE_KERNELS_H
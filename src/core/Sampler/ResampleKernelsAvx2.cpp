@@ -0,0 +1,143 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+// Compiled with -mavx2 (see src/core/CMakeLists.txt). Do not include
+// anything but intrinsics and the kernel headers.
+
+#include <core/config.h>
+#include <core/Sampler/ResampleKernels.h>
+
+#ifdef H2CORE_HAVE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+namespace
+{
+	struct Avx2Vec {
+		static constexpr int nWidth = 8;
+		struct F {
+			__m256 v;
+		};
+		typedef __m256i I;
+
+		static inline F set1( float f ) {
+			return { _mm256_set1_ps( f ) };
+		}
+		static inline void store( float* p, F f ) {
+			_mm256_storeu_ps( p, f.v );
+		}
+		static inline void positions( double fSamplePos, double fStep,
+									  int nFrame, I* pIdx, F* pMu ) {
+			const __m256d start = _mm256_set1_pd( fSamplePos );
+			const __m256d step = _mm256_set1_pd( fStep );
+			const __m256d pos0 = _mm256_add_pd(
+				start, _mm256_mul_pd( _mm256_set_pd( nFrame + 3, nFrame + 2,
+													 nFrame + 1, nFrame ),
+									  step ) );
+			const __m256d pos1 = _mm256_add_pd(
+				start, _mm256_mul_pd( _mm256_set_pd( nFrame + 7, nFrame + 6,
+													 nFrame + 5, nFrame + 4 ),
+									  step ) );
+			// Positions are positive. Truncation equals floor.
+			const __m128i idx0 = _mm256_cvttpd_epi32( pos0 );
+			const __m128i idx1 = _mm256_cvttpd_epi32( pos1 );
+			const __m128 mu0 = _mm256_cvtpd_ps(
+				_mm256_sub_pd( pos0, _mm256_cvtepi32_pd( idx0 ) ) );
+			const __m128 mu1 = _mm256_cvtpd_ps(
+				_mm256_sub_pd( pos1, _mm256_cvtepi32_pd( idx1 ) ) );
+			*pIdx = _mm256_insertf128_si256(
+				_mm256_castsi128_si256( idx0 ), idx1, 1 );
+			pMu->v = _mm256_insertf128_ps( _mm256_castps128_ps256( mu0 ), mu1, 1 );
+		}
+		static inline F gather( const float* p, I idx, int nOffset ) {
+			return { _mm256_i32gather_ps(
+					p, _mm256_add_epi32( idx, _mm256_set1_epi32( nOffset ) ),
+					4 ) };
+		}
+		static inline F gather( const int16_t* p, I idx, int nOffset ) {
+			// 32 bit words starting at each sample. The upper half
+			// belongs to the next one and is dropped while extending
+			// the sign.
+			const __m256i words = _mm256_i32gather_epi32(
+				reinterpret_cast<const int*>(p),
+				_mm256_add_epi32( idx, _mm256_set1_epi32( nOffset ) ), 2 );
+			return { _mm256_mul_ps(
+					_mm256_cvtepi32_ps( _mm256_srai_epi32(
+											_mm256_slli_epi32( words, 16 ), 16 ) ),
+					_mm256_set1_ps( fInt16Scale ) ) };
+		}
+		static inline F gather( const Int24* p, I idx, int nOffset ) {
+			const __m256i offsets = _mm256_mullo_epi32(
+				_mm256_add_epi32( idx, _mm256_set1_epi32( nOffset ) ),
+				_mm256_set1_epi32( 3 ) );
+			const __m256i words = _mm256_i32gather_epi32(
+				reinterpret_cast<const int*>(p), offsets, 1 );
+			return { _mm256_mul_ps(
+					_mm256_cvtepi32_ps( _mm256_srai_epi32(
+											_mm256_slli_epi32( words, 8 ), 8 ) ),
+					_mm256_set1_ps( fInt24Scale ) ) };
+		}
+	};
+
+	inline Avx2Vec::F operator+( Avx2Vec::F a, Avx2Vec::F b ) {
+		return { _mm256_add_ps( a.v, b.v ) };
+	}
+	inline Avx2Vec::F operator-( Avx2Vec::F a, Avx2Vec::F b ) {
+		return { _mm256_sub_ps( a.v, b.v ) };
+	}
+	inline Avx2Vec::F operator*( Avx2Vec::F a, Avx2Vec::F b ) {
+		return { _mm256_mul_ps( a.v, b.v ) };
+	}
+};
+};
+};
+
+#include <core/Sampler/ResampleKernelsImpl.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsAvx2[ nModes ] = H2_RESAMPLE_KERNEL_TABLE( Avx2Vec, float );
+	const KernelT<int16_t> kernelsInt16Avx2[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Avx2Vec, int16_t );
+	const KernelT<Int24> kernelsInt24Avx2[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Avx2Vec, Int24 );
+};
+};
+
+#else
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsAvx2[ nModes ] = {};
+	const KernelT<int16_t> kernelsInt16Avx2[ nModes ] = {};
+	const KernelT<Int24> kernelsInt24Avx2[ nModes ] = {};
+};
+};
+
+#endif
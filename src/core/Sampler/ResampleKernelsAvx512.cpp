@@ -0,0 +1,145 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+// Compiled with -mavx512f (see src/core/CMakeLists.txt). Do not
+// include anything but intrinsics and the kernel headers.
+
+#include <core/config.h>
+#include <core/Sampler/ResampleKernels.h>
+
+#ifdef H2CORE_HAVE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+namespace
+{
+	struct Avx512Vec {
+		static constexpr int nWidth = 16;
+		struct F {
+			__m512 v;
+		};
+		typedef __m512i I;
+
+		static inline F set1( float f ) {
+			return { _mm512_set1_ps( f ) };
+		}
+		static inline void store( float* p, F f ) {
+			_mm512_storeu_ps( p, f.v );
+		}
+		static inline void positions( double fSamplePos, double fStep,
+									  int nFrame, I* pIdx, F* pMu ) {
+			const __m512d start = _mm512_set1_pd( fSamplePos );
+			const __m512d step = _mm512_set1_pd( fStep );
+			const __m512d pos0 = _mm512_add_pd(
+				start, _mm512_mul_pd(
+					_mm512_set_pd( nFrame + 7, nFrame + 6, nFrame + 5, nFrame + 4,
+								   nFrame + 3, nFrame + 2, nFrame + 1, nFrame ),
+					step ) );
+			const __m512d pos1 = _mm512_add_pd(
+				start, _mm512_mul_pd(
+					_mm512_set_pd( nFrame + 15, nFrame + 14, nFrame + 13,
+								   nFrame + 12, nFrame + 11, nFrame + 10,
+								   nFrame + 9, nFrame + 8 ),
+					step ) );
+			// Positions are positive. Truncation equals floor.
+			const __m256i idx0 = _mm512_cvttpd_epi32( pos0 );
+			const __m256i idx1 = _mm512_cvttpd_epi32( pos1 );
+			const __m256 mu0 = _mm512_cvtpd_ps(
+				_mm512_sub_pd( pos0, _mm512_cvtepi32_pd( idx0 ) ) );
+			const __m256 mu1 = _mm512_cvtpd_ps(
+				_mm512_sub_pd( pos1, _mm512_cvtepi32_pd( idx1 ) ) );
+			*pIdx = _mm512_inserti64x4( _mm512_castsi256_si512( idx0 ), idx1, 1 );
+			pMu->v = _mm512_castpd_ps( _mm512_insertf64x4(
+				_mm512_castps_pd( _mm512_castps256_ps512( mu0 ) ),
+				_mm256_castps_pd( mu1 ), 1 ) );
+		}
+		static inline F gather( const float* p, I idx, int nOffset ) {
+			return { _mm512_i32gather_ps(
+					_mm512_add_epi32( idx, _mm512_set1_epi32( nOffset ) ),
+					p, 4 ) };
+		}
+		static inline F gather( const int16_t* p, I idx, int nOffset ) {
+			// 32 bit words starting at each sample. The upper half
+			// belongs to the next one and is dropped while extending
+			// the sign.
+			const __m512i words = _mm512_i32gather_epi32(
+				_mm512_add_epi32( idx, _mm512_set1_epi32( nOffset ) ), p, 2 );
+			return { _mm512_mul_ps(
+					_mm512_cvtepi32_ps( _mm512_srai_epi32(
+											_mm512_slli_epi32( words, 16 ), 16 ) ),
+					_mm512_set1_ps( fInt16Scale ) ) };
+		}
+		static inline F gather( const Int24* p, I idx, int nOffset ) {
+			const __m512i offsets = _mm512_mullo_epi32(
+				_mm512_add_epi32( idx, _mm512_set1_epi32( nOffset ) ),
+				_mm512_set1_epi32( 3 ) );
+			const __m512i words = _mm512_i32gather_epi32( offsets, p, 1 );
+			return { _mm512_mul_ps(
+					_mm512_cvtepi32_ps( _mm512_srai_epi32(
+											_mm512_slli_epi32( words, 8 ), 8 ) ),
+					_mm512_set1_ps( fInt24Scale ) ) };
+		}
+	};
+
+	inline Avx512Vec::F operator+( Avx512Vec::F a, Avx512Vec::F b ) {
+		return { _mm512_add_ps( a.v, b.v ) };
+	}
+	inline Avx512Vec::F operator-( Avx512Vec::F a, Avx512Vec::F b ) {
+		return { _mm512_sub_ps( a.v, b.v ) };
+	}
+	inline Avx512Vec::F operator*( Avx512Vec::F a, Avx512Vec::F b ) {
+		return { _mm512_mul_ps( a.v, b.v ) };
+	}
+};
+};
+};
+
+#include <core/Sampler/ResampleKernelsImpl.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsAvx512[ nModes ] = H2_RESAMPLE_KERNEL_TABLE( Avx512Vec, float );
+	const KernelT<int16_t> kernelsInt16Avx512[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Avx512Vec, int16_t );
+	const KernelT<Int24> kernelsInt24Avx512[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Avx512Vec, Int24 );
+};
+};
+
+#else
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsAvx512[ nModes ] = {};
+	const KernelT<int16_t> kernelsInt16Avx512[ nModes ] = {};
+	const KernelT<Int24> kernelsInt24Avx512[ nModes ] = {};
+};
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_RESAMPLE_KERNELS_IMPL_H
+#define H2C_RESAMPLE_KERNELS_IMPL_H
+
+// Shared implementation of the kernels declared in ResampleKernels.h.
+// It is included by the instruction set specific translation units
+// only, each providing a vector type `V` with
+//
+//  - `V::nWidth`: number of frames processed at once
+//  - `V::F`: vector of floats supporting `+`, `-`, and `*`
+//  - `V::I`: vector of 32 bit integers
+//  - `V::set1( float )`
+//  - `V::store( float*, V::F )`
+//  - `V::positions( fSamplePos, fStep, nFrame, V::I*, V::F* )`:
+//       integer and fractional part of the positions of the frames
+//       starting at @a nFrame
+//  - `V::gather( const float*, V::I, int nOffset )`
+//  - `V::gather( const int16_t*, V::I, int nOffset )` and
+//    `V::gather( const Int24*, V::I, int nOffset )`: gather integer
+//    sample data and widen it to float (see toFloat())
+//
+// Since this code is compiled with instruction set specific flags,
+// everything is kept in an anonymous namespace of the including
+// translation unit and no other (inline) library code is used.
+
+#include <core/Sampler/ResampleKernels.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+namespace
+{
+	// Same order as in #Interpolation::InterpolateMode
+	static constexpr int nLinear = 0;
+	static constexpr int nCosine = 1;
+	static constexpr int nThird = 2;
+	static constexpr int nCubic = 3;
+	static constexpr int nHermite = 4;
+
+	/** Scalar version used for the trailing frames not filling up a
+	 * whole vector. */
+	struct ScalarVec {
+		static constexpr int nWidth = 1;
+		typedef float F;
+		typedef int I;
+
+		static inline F set1( float f ) {
+			return f;
+		}
+		static inline void store( float* p, F f ) {
+			*p = f;
+		}
+		static inline void positions( double fSamplePos, double fStep,
+									  int nFrame, I* pIdx, F* pMu ) {
+			const double fPos = fSamplePos + static_cast<double>(nFrame) * fStep;
+			*pIdx = static_cast<int>(fPos);
+			*pMu = static_cast<float>( fPos - static_cast<double>(*pIdx) );
+		}
+		template < typename T >
+		static inline F gather( const T* p, I idx, int nOffset ) {
+			return toFloat( p[ idx + nOffset ] );
+		}
+	};
+
+	/** (1 - cos( mu * 3.14159 )) / 2 - as used by
+	 * #Interpolation::cosine_Interpolate() - for mu in [0, 1). cos() is
+	 * shifted to sin() on [-pi/2, pi/2] and approximated by its Taylor
+	 * series. The truncation error is below 1e-7. */
+	template < class V >
+	inline typename V::F cosineWeight( typename V::F mu ) {
+		const auto y = mu * V::set1( 3.14159f ) - V::set1( 1.57079633f );
+		const auto y2 = y * y;
+		auto p = V::set1( -1.0f / 39916800.0f );
+		p = p * y2 + V::set1( 1.0f / 362880.0f );
+		p = p * y2 + V::set1( -1.0f / 5040.0f );
+		p = p * y2 + V::set1( 1.0f / 120.0f );
+		p = p * y2 + V::set1( -1.0f / 6.0f );
+		p = p * y2 + V::set1( 1.0f );
+		const auto fSin = p * y;
+		return ( V::set1( 1.0f ) + fSin ) * V::set1( 0.5f );
+	}
+
+	template < class V, int nMode, typename T >
+	inline typename V::F interpolate( const T* pData, typename V::I idx,
+									  typename V::F mu ) {
+		const auto y1 = V::gather( pData, idx, 0 );
+		const auto y2 = V::gather( pData, idx, 1 );
+
+		if constexpr ( nMode == nLinear ) {
+			return y1 * ( V::set1( 1.0f ) - mu ) + y2 * mu;
+		}
+		else if constexpr ( nMode == nCosine ) {
+			const auto mu2 = cosineWeight<V>( mu );
+			return y1 * ( V::set1( 1.0f ) - mu2 ) + y2 * mu2;
+		}
+		else {
+			const auto y0 = V::gather( pData, idx, -1 );
+			const auto y3 = V::gather( pData, idx, 2 );
+
+			if constexpr ( nMode == nThird ) {
+				const auto c0 = y1;
+				const auto c1 = V::set1( 0.5f ) * ( y2 - y0 );
+				const auto c3 = V::set1( 1.5f ) * ( y1 - y2 ) +
+					V::set1( 0.5f ) * ( y3 - y0 );
+				const auto c2 = y0 - y1 + c1 - c3;
+				return ( ( c3 * mu + c2 ) * mu + c1 ) * mu + c0;
+			}
+			else if constexpr ( nMode == nCubic ) {
+				const auto mu2 = mu * mu;
+				const auto a0 = y3 - y2 - y0 + y1;
+				const auto a1 = y0 - y1 - a0;
+				const auto a2 = y2 - y0;
+				const auto a3 = y1;
+				return a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3;
+			}
+			else {
+				const auto mu2 = mu * mu;
+				const auto a0 = V::set1( -0.5f ) * y0 + V::set1( 1.5f ) * y1 -
+					V::set1( 1.5f ) * y2 + V::set1( 0.5f ) * y3;
+				const auto a1 = y0 - V::set1( 2.5f ) * y1 +
+					V::set1( 2.0f ) * y2 - V::set1( 0.5f ) * y3;
+				const auto a2 = V::set1( -0.5f ) * y0 + V::set1( 0.5f ) * y2;
+				const auto a3 = y1;
+				return a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3;
+			}
+		}
+	}
+
+	template < class V, int nMode, typename T >
+	void resampleKernel( float* __restrict__ pBuffer_L,
+						 float* __restrict__ pBuffer_R,
+						 const T* __restrict__ pSample_data_L,
+						 const T* __restrict__ pSample_data_R,
+						 int nFrames, double fSamplePos, double fStep ) {
+		// Mono samples hold the same data for both channels. It is
+		// interpolated just once.
+		const bool bMono = pSample_data_L == pSample_data_R;
+
+		int nFrame = 0;
+		for ( ; nFrame + V::nWidth <= nFrames; nFrame += V::nWidth ) {
+			typename V::I idx;
+			typename V::F mu;
+			V::positions( fSamplePos, fStep, nFrame, &idx, &mu );
+			const auto val_L = interpolate<V, nMode, T>( pSample_data_L, idx, mu );
+			V::store( &pBuffer_L[ nFrame ], val_L );
+			V::store( &pBuffer_R[ nFrame ], bMono ? val_L :
+					  interpolate<V, nMode, T>( pSample_data_R, idx, mu ) );
+		}
+
+		for ( ; nFrame < nFrames; ++nFrame ) {
+			ScalarVec::I idx;
+			ScalarVec::F mu;
+			ScalarVec::positions( fSamplePos, fStep, nFrame, &idx, &mu );
+			pBuffer_L[ nFrame ] =
+				interpolate<ScalarVec, nMode, T>( pSample_data_L, idx, mu );
+			pBuffer_R[ nFrame ] = bMono ? pBuffer_L[ nFrame ] :
+				interpolate<ScalarVec, nMode, T>( pSample_data_R, idx, mu );
+		}
+	}
+};
+
+#define H2_RESAMPLE_KERNEL_TABLE( V, T ) {						\
+		&resampleKernel< V, nLinear, T >,							\
+		&resampleKernel< V, nCosine, T >,							\
+		&resampleKernel< V, nThird, T >,							\
+		&resampleKernel< V, nCubic, T >,							\
+		&resampleKernel< V, nHermite, T > }
+
+};
+};
+
+#endif // H2C_RESAMPLE_KERNELS_IMPL_H
@@ -0,0 +1,120 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+// Compiled with -msse2 (see src/core/CMakeLists.txt). Do not include
+// anything but intrinsics and the kernel headers.
+
+#include <core/config.h>
+#include <core/Sampler/ResampleKernels.h>
+
+#ifdef H2CORE_HAVE_X86_SIMD
+
+#include <emmintrin.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+namespace
+{
+	struct Sse2Vec {
+		static constexpr int nWidth = 4;
+		struct F {
+			__m128 v;
+		};
+		typedef __m128i I;
+
+		static inline F set1( float f ) {
+			return { _mm_set1_ps( f ) };
+		}
+		static inline void store( float* p, F f ) {
+			_mm_storeu_ps( p, f.v );
+		}
+		static inline void positions( double fSamplePos, double fStep,
+									  int nFrame, I* pIdx, F* pMu ) {
+			const __m128d start = _mm_set1_pd( fSamplePos );
+			const __m128d step = _mm_set1_pd( fStep );
+			const __m128d pos0 = _mm_add_pd(
+				start, _mm_mul_pd( _mm_set_pd( nFrame + 1, nFrame ), step ) );
+			const __m128d pos1 = _mm_add_pd(
+				start, _mm_mul_pd( _mm_set_pd( nFrame + 3, nFrame + 2 ), step ) );
+			// Positions are positive. Truncation equals floor.
+			const __m128i idx0 = _mm_cvttpd_epi32( pos0 );
+			const __m128i idx1 = _mm_cvttpd_epi32( pos1 );
+			const __m128 mu0 = _mm_cvtpd_ps(
+				_mm_sub_pd( pos0, _mm_cvtepi32_pd( idx0 ) ) );
+			const __m128 mu1 = _mm_cvtpd_ps(
+				_mm_sub_pd( pos1, _mm_cvtepi32_pd( idx1 ) ) );
+			*pIdx = _mm_unpacklo_epi64( idx0, idx1 );
+			pMu->v = _mm_movelh_ps( mu0, mu1 );
+		}
+		template < typename T >
+		static inline F gather( const T* p, I idx, int nOffset ) {
+			// There is no gather instruction prior to AVX2.
+			alignas( 16 ) int indices[ nWidth ];
+			_mm_store_si128( reinterpret_cast<__m128i*>(indices), idx );
+			return { _mm_set_ps( toFloat( p[ indices[ 3 ] + nOffset ] ),
+								 toFloat( p[ indices[ 2 ] + nOffset ] ),
+								 toFloat( p[ indices[ 1 ] + nOffset ] ),
+								 toFloat( p[ indices[ 0 ] + nOffset ] ) ) };
+		}
+	};
+
+	inline Sse2Vec::F operator+( Sse2Vec::F a, Sse2Vec::F b ) {
+		return { _mm_add_ps( a.v, b.v ) };
+	}
+	inline Sse2Vec::F operator-( Sse2Vec::F a, Sse2Vec::F b ) {
+		return { _mm_sub_ps( a.v, b.v ) };
+	}
+	inline Sse2Vec::F operator*( Sse2Vec::F a, Sse2Vec::F b ) {
+		return { _mm_mul_ps( a.v, b.v ) };
+	}
+};
+};
+};
+
+#include <core/Sampler/ResampleKernelsImpl.h>
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsSse2[ nModes ] = H2_RESAMPLE_KERNEL_TABLE( Sse2Vec, float );
+	const KernelT<int16_t> kernelsInt16Sse2[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Sse2Vec, int16_t );
+	const KernelT<Int24> kernelsInt24Sse2[ nModes ] =
+		H2_RESAMPLE_KERNEL_TABLE( Sse2Vec, Int24 );
+};
+};
+
+#else
+
+namespace H2Core
+{
+namespace ResampleKernels
+{
+	const Kernel kernelsSse2[ nModes ] = {};
+	const KernelT<int16_t> kernelsInt16Sse2[ nModes ] = {};
+	const KernelT<Int24> kernelsInt24Sse2[ nModes ] = {};
+};
+};
+
+#endif
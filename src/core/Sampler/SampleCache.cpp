@@ -0,0 +1,279 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/Sampler/SampleCache.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <core/Helpers/Filesystem.h>
+#include <core/Preferences/Preferences.h>
+
+namespace H2Core
+{
+
+/** Leading part of each entry. Padded to 64 bytes to keep the
+ * following sample data aligned. */
+struct SampleCacheHeader {
+	char sMagic[ 8 ];
+	int32_t nVersion;
+	int32_t nSampleRate;
+	int64_t nFrames;
+	int32_t nChannels;
+	char padding[ 36 ];
+};
+static_assert( sizeof( SampleCacheHeader ) == 64,
+			   "Unexpected size of the sample cache header" );
+
+static const char sampleCacheMagic[ 8 ] = { 'H', '2', 'S', 'C', 'A', 'C', 'H', 'E' };
+static constexpr int32_t nSampleCacheVersion = 1;
+static const QString sampleCacheSuffix = "h2sc";
+
+std::mutex SampleCache::m_mutex;
+long long SampleCache::m_nSize = -1;
+
+SampleCache::Entry::Entry()
+	: m_pFile( nullptr )
+	, m_pMapping( nullptr )
+	, m_pData_L( nullptr )
+	, m_pData_R( nullptr )
+	, m_nFrames( 0 )
+	, m_nSampleRate( 0 )
+	, m_nChannels( 0 )
+{
+}
+
+SampleCache::Entry::~Entry() {
+	if ( m_pFile != nullptr && m_pMapping != nullptr ) {
+		m_pFile->unmap( m_pMapping );
+	}
+}
+
+bool SampleCache::isEnabled() {
+	const auto pPref = Preferences::get_instance();
+	return pPref != nullptr && pPref->m_nSampleCacheSize > 0;
+}
+
+QString SampleCache::getDirectory() {
+	return Filesystem::cache_dir() + "samples/";
+}
+
+QString SampleCache::getEntryPath( const QString& sPath ) {
+	const QFileInfo info( sPath );
+	if ( ! info.exists() ) {
+		return "";
+	}
+
+	const QString sKey = QString( "%1\n%2\n%3" )
+		.arg( info.absoluteFilePath() ).arg( info.size() )
+		.arg( info.lastModified().toMSecsSinceEpoch() );
+	const QString sHash = QString::fromLatin1(
+		QCryptographicHash::hash( sKey.toUtf8(),
+								  QCryptographicHash::Sha1 ).toHex() );
+
+	return getDirectory() + sHash + "." + sampleCacheSuffix;
+}
+
+std::shared_ptr<SampleCache::Entry> SampleCache::lookup( const QString& sPath ) {
+	const QString sEntryPath = getEntryPath( sPath );
+	if ( sEntryPath.isEmpty() || ! QFileInfo::exists( sEntryPath ) ) {
+		return nullptr;
+	}
+
+	auto pFile = std::make_unique<QFile>( sEntryPath );
+	if ( ! pFile->open( QIODevice::ReadOnly ) ) {
+		WARNINGLOG( QString( "Unable to open cache entry [%1] of [%2]" )
+					.arg( sEntryPath ).arg( sPath ) );
+		return nullptr;
+	}
+
+	SampleCacheHeader header;
+	const bool bValid =
+		pFile->read( reinterpret_cast<char*>(&header), sizeof( header ) ) ==
+		sizeof( header ) &&
+		std::memcmp( header.sMagic, sampleCacheMagic,
+					 sizeof( sampleCacheMagic ) ) == 0 &&
+		header.nVersion == nSampleCacheVersion &&
+		( header.nChannels == 1 || header.nChannels == 2 ) &&
+		header.nFrames > 0 && header.nSampleRate > 0 &&
+		pFile->size() == static_cast<qint64>( sizeof( header ) ) +
+		header.nFrames * header.nChannels * static_cast<qint64>( sizeof( float ) );
+	if ( ! bValid ) {
+		WARNINGLOG( QString( "Removing invalid cache entry [%1] of [%2]" )
+					.arg( sEntryPath ).arg( sPath ) );
+		pFile->remove();
+		return nullptr;
+	}
+
+	// Copy-on-write. Processes sharing the entry never see modifications.
+	uchar* pMapping = pFile->map( 0, pFile->size(), QFileDevice::MapPrivateOption );
+	if ( pMapping == nullptr ) {
+		WARNINGLOG( QString( "Unable to map cache entry [%1] of [%2]: %3" )
+					.arg( sEntryPath ).arg( sPath ).arg( pFile->errorString() ) );
+		return nullptr;
+	}
+
+	// Mark the entry as recently used.
+	pFile->setFileTime( QDateTime::currentDateTime(),
+						QFileDevice::FileModificationTime );
+
+	auto pEntry = std::shared_ptr<Entry>( new Entry() );
+	pEntry->m_nFrames = static_cast<int>(header.nFrames);
+	pEntry->m_nSampleRate = header.nSampleRate;
+	pEntry->m_nChannels = header.nChannels;
+	pEntry->m_pMapping = pMapping;
+	pEntry->m_pData_L = reinterpret_cast<float*>( pMapping + sizeof( header ) );
+	pEntry->m_pData_R = header.nChannels == 2 ?
+		pEntry->m_pData_L + header.nFrames : pEntry->m_pData_L;
+	pEntry->m_pFile = std::move( pFile );
+
+	return pEntry;
+}
+
+bool SampleCache::store( const QString& sPath, int nSampleRate, int nFrames,
+						 int nChannels, const float* pData_L,
+						 const float* pData_R ) {
+	const auto pPref = Preferences::get_instance();
+	if ( pPref == nullptr || nFrames <= 0 || nSampleRate <= 0 ||
+		 pData_L == nullptr || pData_R == nullptr ) {
+		return false;
+	}
+	nChannels = std::clamp( nChannels, 1, 2 );
+
+	const long long nLimit =
+		static_cast<long long>(pPref->m_nSampleCacheSize) * 1024 * 1024;
+	const long long nEntrySize = static_cast<long long>( sizeof( SampleCacheHeader ) ) +
+		static_cast<long long>(nFrames) * nChannels * sizeof( float );
+	if ( nEntrySize > nLimit ) {
+		return false;
+	}
+
+	const QString sEntryPath = getEntryPath( sPath );
+	if ( sEntryPath.isEmpty() ||
+		 ! Filesystem::path_usable( getDirectory(), true, false ) ) {
+		return false;
+	}
+
+	SampleCacheHeader header;
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.sMagic, sampleCacheMagic, sizeof( sampleCacheMagic ) );
+	header.nVersion = nSampleCacheVersion;
+	header.nSampleRate = nSampleRate;
+	header.nFrames = nFrames;
+	header.nChannels = nChannels;
+
+	// Entries only show up under their final name once they are
+	// complete. This way concurrent processes do not read partially
+	// written ones.
+	QSaveFile file( sEntryPath );
+	if ( ! file.open( QIODevice::WriteOnly ) ) {
+		WARNINGLOG( QString( "Unable to create cache entry [%1] of [%2]: %3" )
+					.arg( sEntryPath ).arg( sPath ).arg( file.errorString() ) );
+		return false;
+	}
+	const qint64 nDataSize = static_cast<qint64>(nFrames) * sizeof( float );
+	file.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+	file.write( reinterpret_cast<const char*>(pData_L), nDataSize );
+	if ( nChannels == 2 ) {
+		file.write( reinterpret_cast<const char*>(pData_R), nDataSize );
+	}
+	if ( ! file.commit() ) {
+		WARNINGLOG( QString( "Unable to write cache entry [%1] of [%2]: %3" )
+					.arg( sEntryPath ).arg( sPath ).arg( file.errorString() ) );
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if ( m_nSize < 0 ) {
+		m_nSize = computeSize();
+	} else {
+		m_nSize += nEntrySize;
+	}
+	if ( m_nSize > nLimit ) {
+		// Leave some headroom to not scan the folder on every
+		// subsequent call.
+		evict( nLimit / 10 * 9 );
+	}
+
+	return true;
+}
+
+long long SampleCache::getSize() {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	m_nSize = computeSize();
+	return m_nSize;
+}
+
+void SampleCache::clear() {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	evict( 0 );
+}
+
+long long SampleCache::computeSize() {
+	long long nSize = 0;
+	const auto entries = QDir( getDirectory() ).entryInfoList(
+		QStringList( "*." + sampleCacheSuffix ), QDir::Files );
+	for ( const auto& entry : entries ) {
+		nSize += entry.size();
+	}
+	return nSize;
+}
+
+void SampleCache::evict( long long nTargetSize ) {
+	// Oldest entries first.
+	const auto entries = QDir( getDirectory() ).entryInfoList(
+		QStringList( "*." + sampleCacheSuffix ), QDir::Files,
+		QDir::Time | QDir::Reversed );
+
+	long long nSize = 0;
+	for ( const auto& entry : entries ) {
+		nSize += entry.size();
+	}
+
+	int nRemoved = 0;
+	for ( const auto& entry : entries ) {
+		if ( nSize <= nTargetSize ) {
+			break;
+		}
+		// Entries still mapped by some process stay valid on POSIX
+		// systems. On Windows their removal fails.
+		if ( QFile::remove( entry.absoluteFilePath() ) ) {
+			nSize -= entry.size();
+			++nRemoved;
+		}
+	}
+
+	if ( nRemoved > 0 ) {
+		INFOLOG( QString( "[%1] entries evicted. Cache size: [%2] bytes" )
+				 .arg( nRemoved ).arg( nSize ) );
+	}
+	m_nSize = nSize;
+}
+
+};
@@ -0,0 +1,162 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_SAMPLE_CACHE_H
+#define H2C_SAMPLE_CACHE_H
+
+#include <memory>
+#include <mutex>
+
+#include <QFile>
+#include <QString>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+/**
+ * Persistent on-disk cache of decoded instrument layer samples.
+ *
+ * Each sample file is stored as deinterleaved float data in a file of
+ * its own within getDirectory(). The name of this file is derived
+ * from the absolute path, size, and modification time of the sample
+ * file. Altering the latter thus results in a new entry while the
+ * outdated one is evicted eventually.
+ *
+ * Entries are memory mapped instead of read. Kits load without
+ * decoding their samples and several Hydrogen processes using the
+ * same samples share the same pages.
+ *
+ * The overall size of the cache is limited by
+ * Preferences::m_nSampleCacheSize. The least recently used entries
+ * are evicted first.
+ *
+ * All members are thread-safe and can be used by several processes at
+ * once.
+ *
+ * \ingroup docCore
+ */
+class SampleCache : public H2Core::Object<SampleCache>
+{
+	H2_OBJECT(SampleCache)
+public:
+	/**
+	 * Decoded data of a single sample mapped into memory.
+	 *
+	 * The mapping is private. Writing to the data does neither alter
+	 * the cache nor other processes using it.
+	 */
+	class Entry {
+	public:
+		/** Unmaps the data. */
+		~Entry();
+
+		float* getData_L() const;
+		/** \return Same as getData_L() for mono samples. */
+		float* getData_R() const;
+		int getFrames() const;
+		int getSampleRate() const;
+		/** \return 1 or 2 */
+		int getChannels() const;
+
+	private:
+		friend class SampleCache;
+		Entry();
+
+		std::unique_ptr<QFile> m_pFile;
+		uchar* m_pMapping;
+		float* m_pData_L;
+		float* m_pData_R;
+		int m_nFrames;
+		int m_nSampleRate;
+		int m_nChannels;
+	};
+
+	/** \return Whether Preferences::m_nSampleCacheSize is positive. */
+	static bool isEnabled();
+
+	/**
+	 * Maps the cached data of the sample file @a sPath.
+	 *
+	 * \return nullptr in case no valid entry is present.
+	 */
+	static std::shared_ptr<Entry> lookup( const QString& sPath );
+
+	/**
+	 * Adds the decoded data of the sample file @a sPath to the cache
+	 * and evicts the least recently used entries in case the cache
+	 * grew too large.
+	 *
+	 * \param nChannels If 1, just @a pData_L is stored.
+	 */
+	static bool store( const QString& sPath, int nSampleRate, int nFrames,
+					   int nChannels, const float* pData_L,
+					   const float* pData_R );
+
+	/** \return Combined size of all entries in bytes. */
+	static long long getSize();
+	/** Removes all entries. */
+	static void clear();
+
+	/** \return Folder holding all entries. */
+	static QString getDirectory();
+	/** \return Path of the entry for the sample file @a sPath or an
+	 * empty string in case the latter could not be found. The entry
+	 * itself does not have to exist. */
+	static QString getEntryPath( const QString& sPath );
+
+private:
+	/** Removes the least recently used entries till the overall
+	 * size is below @a nTargetSize. Requires #m_mutex to be
+	 * locked. */
+	static void evict( long long nTargetSize );
+	/** Requires #m_mutex to be locked. */
+	static long long computeSize();
+
+	static std::mutex m_mutex;
+	/** Overall size of all entries as known to this process. -1
+	 * till the cache folder is scanned for the first time. Entries
+	 * added by other processes are taken into account on the next
+	 * eviction. */
+	static long long m_nSize;
+};
+
+inline float* SampleCache::Entry::getData_L() const {
+	return m_pData_L;
+}
+inline float* SampleCache::Entry::getData_R() const {
+	return m_pData_R;
+}
+inline int SampleCache::Entry::getFrames() const {
+	return m_nFrames;
+}
+inline int SampleCache::Entry::getSampleRate() const {
+	return m_nSampleRate;
+}
+inline int SampleCache::Entry::getChannels() const {
+	return m_nChannels;
+}
+
+};
+
+#endif // H2C_SAMPLE_CACHE_H
@@ -0,0 +1,237 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+
+#include <core/Sampler/SampleRegistry.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace H2Core
+{
+
+std::mutex SampleRegistry::m_mutex;
+std::map<QString, SampleRegistry::Entry> SampleRegistry::m_entries;
+
+SampleRegistry::Buffer::Buffer( float* pData_L, float* pData_R, int nFrames,
+								int nHeadFrames, int nSampleRate )
+	: m_pData_L( pData_L )
+	, m_pData_R( pData_R )
+	, m_nFrames( nFrames )
+	, m_nHeadFrames( nHeadFrames )
+	, m_nSampleRate( nSampleRate )
+	, m_pCacheEntry( nullptr )
+	, m_format( ResampleKernels::Format::Float )
+	, m_bUnpacked( false )
+{
+}
+
+SampleRegistry::Buffer::Buffer( std::shared_ptr<SampleCache::Entry> pCacheEntry )
+	: m_pData_L( pCacheEntry->getData_L() )
+	, m_pData_R( pCacheEntry->getData_R() )
+	, m_nFrames( pCacheEntry->getFrames() )
+	, m_nHeadFrames( pCacheEntry->getFrames() )
+	, m_nSampleRate( pCacheEntry->getSampleRate() )
+	, m_pCacheEntry( pCacheEntry )
+	, m_format( ResampleKernels::Format::Float )
+	, m_bUnpacked( false )
+{
+}
+
+template < typename T >
+static void packChannel( const float* pData, int nFrames, T (*convert)( float ),
+						 std::vector<uint8_t>& packed ) {
+	packed.assign( static_cast<size_t>(nFrames) * sizeof( T ) +
+				   ResampleKernels::nPackedPadding, 0 );
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		const T value = convert( pData[ ii ] );
+		memcpy( &packed[ static_cast<size_t>(ii) * sizeof( T ) ], &value,
+				sizeof( T ) );
+	}
+}
+
+template < typename T >
+static float* unpackChannel( const std::vector<uint8_t>& packed, int nFrames ) {
+	auto pData = new float[ nFrames ];
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		T value;
+		memcpy( &value, &packed[ static_cast<size_t>(ii) * sizeof( T ) ],
+				sizeof( T ) );
+		pData[ ii ] = ResampleKernels::toFloat( value );
+	}
+	return pData;
+}
+
+SampleRegistry::Buffer::Buffer( ResampleKernels::Format format,
+								const float* pData_L, const float* pData_R,
+								int nFrames, int nSampleRate )
+	: m_pData_L( nullptr )
+	, m_pData_R( nullptr )
+	, m_nFrames( nFrames )
+	, m_nHeadFrames( nFrames )
+	, m_nSampleRate( nSampleRate )
+	, m_pCacheEntry( nullptr )
+	, m_format( format )
+	, m_bUnpacked( false )
+{
+	const bool bMono = pData_L == pData_R;
+	if ( format == ResampleKernels::Format::Int16 ) {
+		packChannel<int16_t>( pData_L, nFrames, &ResampleKernels::toInt16,
+							  m_packed_L );
+		if ( ! bMono ) {
+			packChannel<int16_t>( pData_R, nFrames, &ResampleKernels::toInt16,
+								  m_packed_R );
+		}
+	}
+	else if ( format == ResampleKernels::Format::Int24 ) {
+		packChannel<ResampleKernels::Int24>(
+			pData_L, nFrames, &ResampleKernels::toInt24, m_packed_L );
+		if ( ! bMono ) {
+			packChannel<ResampleKernels::Int24>(
+				pData_R, nFrames, &ResampleKernels::toInt24, m_packed_R );
+		}
+	}
+	else {
+		// Plain copy
+		m_pData_L = new float[ nFrames ];
+		memcpy( m_pData_L, pData_L, nFrames * sizeof( float ) );
+		if ( bMono ) {
+			m_pData_R = m_pData_L;
+		} else {
+			m_pData_R = new float[ nFrames ];
+			memcpy( m_pData_R, pData_R, nFrames * sizeof( float ) );
+		}
+	}
+}
+
+void SampleRegistry::Buffer::unpack() const {
+	std::call_once( m_unpacked, [&]() {
+		if ( m_format == ResampleKernels::Format::Int16 ) {
+			m_pData_L = unpackChannel<int16_t>( m_packed_L, m_nFrames );
+			m_pData_R = m_packed_R.empty() ? m_pData_L :
+				unpackChannel<int16_t>( m_packed_R, m_nFrames );
+		}
+		else {
+			m_pData_L = unpackChannel<ResampleKernels::Int24>(
+				m_packed_L, m_nFrames );
+			m_pData_R = m_packed_R.empty() ? m_pData_L :
+				unpackChannel<ResampleKernels::Int24>( m_packed_R, m_nFrames );
+		}
+		m_bUnpacked = true;
+	} );
+}
+
+SampleRegistry::Buffer::~Buffer() {
+	if ( m_pCacheEntry == nullptr ) {
+		if ( m_pData_R != m_pData_L ) {
+			delete [] m_pData_R;
+		}
+		delete [] m_pData_L;
+	}
+}
+
+long long SampleRegistry::Buffer::getSize() const {
+	if ( m_format != ResampleKernels::Format::Float ) {
+		long long nSize = static_cast<long long>(m_packed_L.size()) +
+			static_cast<long long>(m_packed_R.size());
+		if ( m_bUnpacked ) {
+			nSize += static_cast<long long>(m_nHeadFrames) *
+				( isMono() ? 1 : 2 ) * sizeof( float );
+		}
+		return nSize;
+	}
+
+	const int nChannels = m_pData_L == m_pData_R ? 1 : 2;
+	return static_cast<long long>(m_nHeadFrames) * nChannels * sizeof( float );
+}
+
+std::shared_ptr<SampleRegistry::Buffer> SampleRegistry::lookup( const QString& sKey ) {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	const auto it = m_entries.find( sKey );
+	if ( it == m_entries.end() ) {
+		return nullptr;
+	}
+	return it->second.pBuffer.lock();
+}
+
+std::shared_ptr<SampleRegistry::Buffer> SampleRegistry::insert(
+	const QString& sKey, const QString& sPath, std::shared_ptr<Buffer> pBuffer ) {
+	if ( sKey.isEmpty() || pBuffer == nullptr ) {
+		return pBuffer;
+	}
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+	purge();
+	auto& entry = m_entries[ sKey ];
+	auto pRegistered = entry.pBuffer.lock();
+	if ( pRegistered != nullptr ) {
+		return pRegistered;
+	}
+	entry.sPath = sPath;
+	entry.pBuffer = pBuffer;
+
+	return pBuffer;
+}
+
+std::vector<SampleRegistry::Info> SampleRegistry::getInfos() {
+	std::vector<Info> infos;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		purge();
+		for ( const auto& it : m_entries ) {
+			const auto pBuffer = it.second.pBuffer.lock();
+			if ( pBuffer == nullptr ) {
+				continue;
+			}
+			// Do not count our own reference.
+			infos.push_back( { it.second.sPath, pBuffer->getFrames(),
+							   pBuffer->getSampleRate(), pBuffer->getSize(),
+							   pBuffer->isMapped(),
+							   pBuffer.use_count() - 1 } );
+		}
+	}
+
+	std::sort( infos.begin(), infos.end(), []( const Info& a, const Info& b ) {
+		return a.nBytes > b.nBytes; } );
+
+	return infos;
+}
+
+long long SampleRegistry::getSize() {
+	long long nSize = 0;
+	for ( const auto& info : getInfos() ) {
+		nSize += info.nBytes;
+	}
+	return nSize;
+}
+
+void SampleRegistry::purge() {
+	for ( auto it = m_entries.begin(); it != m_entries.end(); ) {
+		if ( it->second.pBuffer.expired() ) {
+			it = m_entries.erase( it );
+		} else {
+			++it;
+		}
+	}
+}
+
+};
@@ -0,0 +1,221 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+
+#ifndef H2C_SAMPLE_REGISTRY_H
+#define H2C_SAMPLE_REGISTRY_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QString>
+
+#include <core/Object.h>
+#include <core/Sampler/ResampleKernels.h>
+#include <core/Sampler/SampleCache.h>
+
+namespace H2Core
+{
+
+/**
+ * Process-wide registry of decoded sample data.
+ *
+ * Samples loading the same file with the same loop, envelope, and
+ * rubberband parameters share a single #Buffer instead of decoding
+ * and holding the audio data each on their own. This is the case
+ * when e.g. using a file in several instruments, loading the same kit
+ * in several songs, or keeping the kit of the current song next to
+ * the one in the #SoundLibraryDatabase.
+ *
+ * Buffers are reference counted by the Samples using them. The
+ * registry itself holds weak references only and a buffer is freed
+ * as soon as the last Sample using it is unloaded.
+ *
+ * All members are thread-safe.
+ *
+ * \ingroup docCore
+ */
+class SampleRegistry : public H2Core::Object<SampleRegistry>
+{
+	H2_OBJECT(SampleRegistry)
+public:
+	/**
+	 * Decoded data of a single sample. It must not be altered once
+	 * created.
+	 */
+	class Buffer {
+	public:
+		/** Takes ownership of @a pData_L and @a pData_R, which have
+		 * to be allocated using new[]. Both are the same for mono
+		 * samples. */
+		Buffer( float* pData_L, float* pData_R, int nFrames,
+				int nHeadFrames, int nSampleRate );
+		/** Uses the data mapped by @a pCacheEntry in place. */
+		Buffer( std::shared_ptr<SampleCache::Entry> pCacheEntry );
+		/** Stores a copy of @a pData_L and @a pData_R converted to the
+		 * packed integer @a format. Both are the same for mono
+		 * samples. */
+		Buffer( ResampleKernels::Format format, const float* pData_L,
+				const float* pData_R, int nFrames, int nSampleRate );
+		~Buffer();
+
+		/** Float version of the data. In case it is stored in a
+		 * packed format, it is converted on first access and kept
+		 * alongside. This allocates and must not be done by the audio
+		 * thread. */
+		float* getData_L() const;
+		float* getData_R() const;
+		ResampleKernels::Format getFormat() const;
+		/** \return Data stored in getFormat() followed by
+		 * ResampleKernels::nPackedPadding bytes. nullptr for
+		 * ResampleKernels::Format::Float. */
+		const void* getPackedData_L() const;
+		const void* getPackedData_R() const;
+		bool isMono() const;
+		int getFrames() const;
+		/** \return Number of frames held by getData_L() and
+		 * getData_R(). */
+		int getHeadFrames() const;
+		int getSampleRate() const;
+		/** \return Whether the data is mapped from the
+		 * #SampleCache. */
+		bool isMapped() const;
+		/** \return Memory occupied by the data in bytes. */
+		long long getSize() const;
+
+	private:
+		/** Converts the packed data to float once. */
+		void unpack() const;
+
+		/** Lazily created for packed buffers. */
+		mutable float* m_pData_L;
+		mutable float* m_pData_R;
+		int m_nFrames;
+		int m_nHeadFrames;
+		int m_nSampleRate;
+		std::shared_ptr<SampleCache::Entry> m_pCacheEntry;
+		ResampleKernels::Format m_format;
+		/** Packed data of the left and right channel. The latter is
+		 * empty for mono samples. */
+		std::vector<uint8_t> m_packed_L;
+		std::vector<uint8_t> m_packed_R;
+		mutable std::once_flag m_unpacked;
+		mutable std::atomic<bool> m_bUnpacked;
+	};
+
+	/** Snapshot of a single registered buffer. */
+	struct Info {
+		QString sPath;
+		int nFrames;
+		int nSampleRate;
+		long long nBytes;
+		bool bMapped;
+		/** Number of Samples sharing the buffer. */
+		long nUsers;
+	};
+
+	/**
+	 * \param sKey Identifier of the file and the modifications
+	 *   applied to its content as created by Sample.
+	 *
+	 * \return Buffer registered for @a sKey or nullptr if none is in
+	 *   use.
+	 */
+	static std::shared_ptr<Buffer> lookup( const QString& sKey );
+	/**
+	 * Registers @a pBuffer decoded from the file @a sPath.
+	 *
+	 * \return The buffer already registered for @a sKey in case
+	 *   another thread was faster. @a pBuffer otherwise.
+	 */
+	static std::shared_ptr<Buffer> insert( const QString& sKey,
+										   const QString& sPath,
+										   std::shared_ptr<Buffer> pBuffer );
+
+	/** \return All buffers currently in use ordered by decreasing
+	 * size. */
+	static std::vector<Info> getInfos();
+	/** \return Combined size of all buffers in use in bytes. Each
+	 * one is accounted for only once regardless of the number of
+	 * Samples sharing it. */
+	static long long getSize();
+
+private:
+	struct Entry {
+		QString sPath;
+		std::weak_ptr<Buffer> pBuffer;
+	};
+
+	/** Drops the entries of all freed buffers. Requires #m_mutex to
+	 * be locked. */
+	static void purge();
+
+	static std::mutex m_mutex;
+	static std::map<QString, Entry> m_entries;
+};
+
+inline float* SampleRegistry::Buffer::getData_L() const {
+	if ( m_format != ResampleKernels::Format::Float ) {
+		unpack();
+	}
+	return m_pData_L;
+}
+inline float* SampleRegistry::Buffer::getData_R() const {
+	if ( m_format != ResampleKernels::Format::Float ) {
+		unpack();
+	}
+	return m_pData_R;
+}
+inline ResampleKernels::Format SampleRegistry::Buffer::getFormat() const {
+	return m_format;
+}
+inline const void* SampleRegistry::Buffer::getPackedData_L() const {
+	return m_packed_L.empty() ? nullptr : m_packed_L.data();
+}
+inline const void* SampleRegistry::Buffer::getPackedData_R() const {
+	return m_packed_R.empty() ? getPackedData_L() : m_packed_R.data();
+}
+inline bool SampleRegistry::Buffer::isMono() const {
+	if ( m_format != ResampleKernels::Format::Float ) {
+		return m_packed_R.empty();
+	}
+	return m_pData_L != nullptr && m_pData_L == m_pData_R;
+}
+inline int SampleRegistry::Buffer::getFrames() const {
+	return m_nFrames;
+}
+inline int SampleRegistry::Buffer::getHeadFrames() const {
+	return m_nHeadFrames;
+}
+inline int SampleRegistry::Buffer::getSampleRate() const {
+	return m_nSampleRate;
+}
+inline bool SampleRegistry::Buffer::isMapped() const {
+	return m_pCacheEntry != nullptr;
+}
+
+};
+
+#endif // H2C_SAMPLE_REGISTRY_H
@@ -0,0 +1,439 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <core/Sampler/SampleStreamer.h>
+
+#include <algorithm>
+
+#include <core/Basics/Event.h>
+#include <core/Basics/Sample.h>
+#include <core/EngineContext.h>
+#include <core/EventQueue.h>
+
+namespace H2Core
+{
+
+/** Time the prefetch thread waits for new work while streams are
+ * active. Streams are acquired by the audio thread without notifying
+ * it. */
+static constexpr std::chrono::milliseconds streamingPollInterval( 1 );
+/** Time the prefetch thread waits for new work while idle. The heads
+ * of streamed samples have to be considerably longer. */
+static constexpr std::chrono::milliseconds idlePollInterval( 50 );
+/** Minimum time between two #Event::Type::StreamUnderrun. */
+static constexpr std::chrono::milliseconds underrunReportInterval( 500 );
+/** Time a read() in offline mode waits for the prefetch thread to
+ * make progress before giving up on the missing frames. */
+static constexpr std::chrono::seconds offlineReadTimeout( 5 );
+
+SampleStreamer::Stream::Stream()
+	: state( State::Free )
+	, pSample( nullptr )
+	, pFile( nullptr )
+	, nChannels( 0 )
+	, nHeadFrames( 0 )
+	, nFrames( 0 )
+	, nWritten( 0 )
+	, nRead( 0 )
+	, bFailed( false )
+{
+}
+
+SampleStreamer::SampleStreamer( int nStreams )
+	: m_bShutdown( false )
+	, m_bWakeUp( false )
+	, m_bOffline( false )
+	, m_nActiveStreams( 0 )
+	, m_nUnderruns( 0 )
+	, m_nMissingFrames( 0 )
+	, m_nReportedUnderruns( 0 )
+	, m_pEngineContext( EngineContext::getCurrent() )
+{
+	for ( int ii = 0; ii < nStreams; ++ii ) {
+		m_streams.push_back( std::make_unique<Stream>() );
+	}
+	m_worker = std::thread( &SampleStreamer::workerLoop, this );
+}
+
+SampleStreamer::~SampleStreamer() {
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bShutdown = true;
+	}
+	m_condition.notify_all();
+	m_fillCondition.notify_all();
+	m_worker.join();
+
+	for ( auto& ppStream : m_streams ) {
+		close( *ppStream );
+	}
+}
+
+int SampleStreamer::acquire( std::shared_ptr<Sample> pSample ) {
+	if ( pSample == nullptr || ! pSample->isStreamed() ) {
+		return -1;
+	}
+
+	for ( int ii = 0; ii < m_streams.size(); ++ii ) {
+		auto& stream = *m_streams[ ii ];
+		State expected = State::Free;
+		if ( stream.state.compare_exchange_strong(
+				 expected, State::Claimed, std::memory_order_acq_rel ) ) {
+			// The previous sample was already dropped by the prefetch
+			// thread. No memory is freed here.
+			stream.pSample = pSample;
+			stream.nRead.store( 0, std::memory_order_relaxed );
+			m_nActiveStreams.fetch_add( 1, std::memory_order_relaxed );
+			stream.state.store( State::Requested, std::memory_order_release );
+			return ii;
+		}
+	}
+
+	return -1;
+}
+
+void SampleStreamer::release( int nStream ) {
+	if ( nStream < 0 || nStream >= m_streams.size() ) {
+		return;
+	}
+	m_streams[ nStream ]->state.store( State::Released,
+									   std::memory_order_release );
+	m_nActiveStreams.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+bool SampleStreamer::read( int nStream, const Sample* pSample, int nStart,
+						   int nFrames, float* pOut_L, float* pOut_R ) {
+	const int nSampleFrames = pSample->getFrames();
+	const int nHeadFrames = pSample->getHeadFrames();
+	const int nEnd = nStart + nFrames;
+
+	Stream* pStream = nullptr;
+	int nAvailable = nHeadFrames;
+	if ( nStream >= 0 && nStream < m_streams.size() ) {
+		pStream = m_streams[ nStream ].get();
+		// The sample of a stream is only altered while it is not
+		// acquired.
+		if ( pStream->state.load( std::memory_order_acquire ) ==
+			 State::Streaming && pStream->pSample.get() == pSample ) {
+			nAvailable = pStream->nWritten.load( std::memory_order_acquire );
+		}
+	}
+
+	// Offline rendering is not bound to real time and waits for the
+	// prefetch thread instead of rendering silence.
+	if ( pStream != nullptr && nAvailable < std::min( nEnd, nSampleFrames ) &&
+		 m_bOffline.load( std::memory_order_relaxed ) ) {
+		nAvailable = waitForFrames( *pStream, pSample, nStart,
+									std::min( nEnd, nSampleFrames ) );
+	}
+
+	int nPos = nStart;
+	auto zero = [&]( int nUntil ) {
+		std::fill_n( &pOut_L[ nPos - nStart ], nUntil - nPos, 0.0f );
+		std::fill_n( &pOut_R[ nPos - nStart ], nUntil - nPos, 0.0f );
+		nPos = nUntil;
+	};
+
+	// Before the beginning of the sample.
+	if ( nPos < 0 ) {
+		zero( std::min( 0, nEnd ) );
+	}
+
+	// Head held in memory.
+	const int nHeadEnd = std::min( nEnd, nHeadFrames );
+	if ( nPos < nHeadEnd ) {
+		std::copy_n( &pSample->getData_L()[ nPos ], nHeadEnd - nPos,
+					 &pOut_L[ nPos - nStart ] );
+		std::copy_n( &pSample->getData_R()[ nPos ], nHeadEnd - nPos,
+					 &pOut_R[ nPos - nStart ] );
+		nPos = nHeadEnd;
+	}
+
+	// Prefetched frames. nAvailable only exceeds the head in case
+	// pStream is valid.
+	const int nRingEnd = std::min( { nEnd, nAvailable, nSampleFrames } );
+	while ( nPos < nRingEnd ) {
+		const int nIndex = nPos & ( nRingFrames - 1 );
+		const int nCopy = std::min( nRingEnd - nPos, nRingFrames - nIndex );
+		std::copy_n( &pStream->data_L[ nIndex ], nCopy, &pOut_L[ nPos - nStart ] );
+		std::copy_n( &pStream->data_R[ nIndex ], nCopy, &pOut_R[ nPos - nStart ] );
+		nPos += nCopy;
+	}
+
+	// Frames not prefetched yet.
+	bool bComplete = true;
+	const int nMissingEnd = std::min( nEnd, nSampleFrames );
+	if ( nPos < nMissingEnd ) {
+		m_nMissingFrames.fetch_add( nMissingEnd - nPos,
+									std::memory_order_relaxed );
+		m_nUnderruns.fetch_add( 1, std::memory_order_relaxed );
+		bComplete = false;
+		zero( nMissingEnd );
+	}
+
+	// Beyond the end of the sample.
+	if ( nPos < nEnd ) {
+		zero( nEnd );
+	}
+
+	// Allow the prefetch thread to overwrite all frames preceding
+	// this read.
+	if ( pStream != nullptr &&
+		 nStart > pStream->nRead.load( std::memory_order_relaxed ) ) {
+		pStream->nRead.store( nStart, std::memory_order_release );
+	}
+
+	return bComplete;
+}
+
+void SampleStreamer::setOffline( bool bOffline ) {
+	m_bOffline.store( bOffline, std::memory_order_relaxed );
+}
+
+int SampleStreamer::waitForFrames( Stream& stream, const Sample* pSample,
+								   int nStart, int nUntil ) {
+	// Frames preceding this read are not required anymore. Releasing
+	// them right away allows the prefetch thread to use the whole ring
+	// buffer.
+	if ( nStart > stream.nRead.load( std::memory_order_relaxed ) ) {
+		stream.nRead.store( nStart, std::memory_order_release );
+	}
+
+	int nAvailable = pSample->getHeadFrames();
+	auto isDone = [&]() {
+		if ( m_bShutdown ) {
+			return true;
+		}
+		const State state = stream.state.load( std::memory_order_acquire );
+		if ( state == State::Claimed || state == State::Requested ) {
+			return false;
+		}
+		if ( state != State::Streaming || stream.pSample.get() != pSample ||
+			 stream.bFailed.load( std::memory_order_acquire ) ) {
+			return true;
+		}
+		nAvailable = stream.nWritten.load( std::memory_order_acquire );
+		return nAvailable >= nUntil;
+	};
+
+	std::unique_lock<std::mutex> lock( m_mutex );
+	while ( ! isDone() ) {
+		const int nPrevious = nAvailable;
+		m_bWakeUp = true;
+		m_condition.notify_one();
+		if ( ! m_fillCondition.wait_for( lock, offlineReadTimeout, isDone ) &&
+			 nAvailable == nPrevious ) {
+			ERRORLOG( QString( "Prefetching [%1] stalled at frame [%2]" )
+					  .arg( pSample->getFilepath() ).arg( nAvailable ) );
+			break;
+		}
+	}
+
+	return nAvailable;
+}
+
+void SampleStreamer::workerLoop() {
+	EngineContext::Scope scope( m_pEngineContext );
+
+	while ( ! m_bShutdown ) {
+		bool bBusy = false;
+		for ( auto& ppStream : m_streams ) {
+			auto& stream = *ppStream;
+			switch ( stream.state.load( std::memory_order_acquire ) ) {
+			case State::Requested:
+				open( stream );
+				bBusy = true;
+				break;
+			case State::Streaming:
+				if ( fill( stream ) ) {
+					bBusy = true;
+				}
+				break;
+			case State::Released:
+				close( stream );
+				stream.state.store( State::Free, std::memory_order_release );
+				break;
+			default:
+				break;
+			}
+		}
+
+		reportUnderruns();
+
+		if ( m_bOffline.load( std::memory_order_relaxed ) ) {
+			// Taking the mutex ensures readers are either waiting or
+			// did not check for new frames yet.
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+			}
+			m_fillCondition.notify_all();
+		}
+
+		if ( ! bBusy ) {
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_condition.wait_for(
+				lock, m_nActiveStreams.load( std::memory_order_relaxed ) > 0 ?
+				streamingPollInterval : idlePollInterval,
+				[&]{ return m_bShutdown.load() || m_bWakeUp.exchange( false ); } );
+		}
+	}
+}
+
+void SampleStreamer::open( Stream& stream ) {
+	const auto pSample = stream.pSample;
+	stream.nHeadFrames = pSample->getHeadFrames();
+	stream.nFrames = pSample->getFrames();
+	if ( stream.data_L.size() == 0 ) {
+		stream.data_L.resize( nRingFrames );
+		stream.data_R.resize( nRingFrames );
+	}
+
+	SF_INFO soundInfo = {0};
+	stream.pFile = Sample::openSndfile( pSample->getFilepath(), &soundInfo );
+	if ( stream.pFile == nullptr ) {
+		ERRORLOG( QString( "Unable to open [%1] for streaming: %2" )
+				  .arg( pSample->getFilepath() )
+				  .arg( sf_strerror( nullptr ) ) );
+	}
+	else if ( sf_seek( stream.pFile, stream.nHeadFrames, SEEK_SET ) < 0 ) {
+		ERRORLOG( QString( "Unable to seek to frame [%1] in [%2]" )
+				  .arg( stream.nHeadFrames ).arg( pSample->getFilepath() ) );
+		sf_close( stream.pFile );
+		stream.pFile = nullptr;
+	}
+	else {
+		stream.nChannels = soundInfo.channels;
+		const size_t nRequiredSize =
+			static_cast<size_t>(nReadFrames) * stream.nChannels;
+		if ( m_readBuffer.size() < nRequiredSize ) {
+			m_readBuffer.resize( nRequiredSize );
+		}
+	}
+
+	stream.bFailed.store( stream.pFile == nullptr, std::memory_order_relaxed );
+	stream.nWritten.store( stream.nHeadFrames, std::memory_order_relaxed );
+
+	// The stream might have been released in the meantime.
+	State expected = State::Requested;
+	stream.state.compare_exchange_strong( expected, State::Streaming,
+										  std::memory_order_acq_rel );
+}
+
+bool SampleStreamer::fill( Stream& stream ) {
+	if ( stream.pFile == nullptr ) {
+		return false;
+	}
+
+	const int nWritten = stream.nWritten.load( std::memory_order_relaxed );
+	const int nRead = std::max( stream.nRead.load( std::memory_order_acquire ),
+								stream.nHeadFrames );
+	const int nLimit = std::min( stream.nFrames, nRead + nRingFrames );
+	const int nFrames = std::min( nReadFrames, nLimit - nWritten );
+	if ( nFrames <= 0 ) {
+		return false;
+	}
+
+	const sf_count_t nDecoded =
+		sf_readf_float( stream.pFile, m_readBuffer.data(), nFrames );
+	if ( nDecoded < nFrames ) {
+		// The file was altered after loading the sample. Padding with
+		// silence avoids underruns till the end of the sample.
+		WARNINGLOG( QString( "Unable to read frames [%1, %2) of [%3]" )
+					.arg( nWritten + std::max( nDecoded, sf_count_t( 0 ) ) )
+					.arg( nWritten + nFrames )
+					.arg( stream.pSample->getFilepath() ) );
+		std::fill( m_readBuffer.begin() +
+				   std::max( nDecoded, sf_count_t( 0 ) ) * stream.nChannels,
+				   m_readBuffer.begin() + nFrames * stream.nChannels, 0.0f );
+	}
+
+	// Mono files are played on both channels.
+	const int nRightOffset = stream.nChannels > 1 ? 1 : 0;
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		const int nIndex = ( nWritten + ii ) & ( nRingFrames - 1 );
+		stream.data_L[ nIndex ] = m_readBuffer[ ii * stream.nChannels ];
+		stream.data_R[ nIndex ] =
+			m_readBuffer[ ii * stream.nChannels + nRightOffset ];
+	}
+
+	stream.nWritten.store( nWritten + nFrames, std::memory_order_release );
+
+	return true;
+}
+
+void SampleStreamer::close( Stream& stream ) {
+	if ( stream.pFile != nullptr ) {
+		sf_close( stream.pFile );
+		stream.pFile = nullptr;
+	}
+	// Samples are freed in here rather than in the audio thread.
+	stream.pSample = nullptr;
+	stream.nWritten.store( 0, std::memory_order_relaxed );
+	stream.bFailed.store( false, std::memory_order_relaxed );
+}
+
+void SampleStreamer::reportUnderruns() {
+	const int nUnderruns = m_nUnderruns.load( std::memory_order_relaxed );
+	if ( nUnderruns == m_nReportedUnderruns ) {
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if ( now - m_lastReport < underrunReportInterval ) {
+		return;
+	}
+
+	WARNINGLOG( QString( "[%1] new underruns. [%2] frames missing in total" )
+				.arg( nUnderruns - m_nReportedUnderruns )
+				.arg( getMissingFrames() ) );
+	EventQueue::get_instance()->pushEvent(
+		Event::Type::StreamUnderrun, nUnderruns - m_nReportedUnderruns );
+
+	m_nReportedUnderruns = nUnderruns;
+	m_lastReport = now;
+}
+
+QString SampleStreamer::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[SampleStreamer]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_streams: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getStreams() ) )
+			.append( QString( "%1%2m_nActiveStreams: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getActiveStreams() ) )
+			.append( QString( "%1%2m_nUnderruns: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getUnderruns() ) )
+			.append( QString( "%1%2m_nMissingFrames: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getMissingFrames() ) );
+	}
+	else {
+		sOutput = QString( "[SampleStreamer] m_streams: %1" )
+			.arg( getStreams() )
+			.append( QString( ", m_nActiveStreams: %1" ).arg( getActiveStreams() ) )
+			.append( QString( ", m_nUnderruns: %1" ).arg( getUnderruns() ) )
+			.append( QString( ", m_nMissingFrames: %1" ).arg( getMissingFrames() ) );
+	}
+	return sOutput;
+}
+
+};
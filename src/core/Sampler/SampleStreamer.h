@@ -0,0 +1,228 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef H2C_SAMPLE_STREAMER_H
+#define H2C_SAMPLE_STREAMER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class EngineContext;
+class Sample;
+
+/**
+ * Streams the remainder of samples only partially held in memory
+ * (see Sample::isStreamed()) from disk.
+ *
+ * Each voice playing such a sample acquires one of a fixed number of
+ * streams. While the voice renders the head of the sample kept in
+ * memory, a background thread decodes the following frames into a
+ * ring buffer of the stream and keeps it filled as the voice
+ * advances.
+ *
+ * Frames not prefetched in time are rendered as silence. Such
+ * underruns are counted and reported via
+ * #Event::Type::StreamUnderrun. During offline rendering, which is
+ * not bound to real time, read() instead waits for the prefetch
+ * thread to catch up (see setOffline()).
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class SampleStreamer : public H2Core::Object<SampleStreamer>
+{
+	H2_OBJECT(SampleStreamer)
+public:
+	/** Frames buffered by each stream. Must be a power of two. */
+	static constexpr int nRingFrames = 65536;
+	/** Frames decoded at once by the prefetch thread. */
+	static constexpr int nReadFrames = 4096;
+
+	SampleStreamer( int nStreams );
+	/** Closes all files and joins the prefetch thread. */
+	~SampleStreamer();
+
+	/**
+	 * Reserves a stream prefetching the frames of @a pSample
+	 * following its head. Real-time safe.
+	 *
+	 * \return Index of the stream or -1 in case all of them are in
+	 *   use.
+	 */
+	int acquire( std::shared_ptr<Sample> pSample );
+	/**
+	 * Hands @a nStream back. Its file is closed by the prefetch
+	 * thread. Real-time safe.
+	 */
+	void release( int nStream );
+	/**
+	 * Copies frames [@a nStart, @a nStart + @a nFrames) of @a pSample
+	 * into @a pOut_L and @a pOut_R. Frames outside of the sample are
+	 * set to zero.
+	 *
+	 * Real-time safe. Can be called concurrently for different
+	 * streams. @a nStart must not decrease between subsequent calls
+	 * for the same stream.
+	 *
+	 * \param nStream Stream acquired for @a pSample. If -1, just the
+	 *   head is available.
+	 *
+	 * \return false if some frames were not prefetched yet. They are
+	 *   replaced by silence.
+	 */
+	bool read( int nStream, const Sample* pSample, int nStart, int nFrames,
+			   float* pOut_L, float* pOut_R );
+
+	/**
+	 * In offline mode read() blocks till all requested frames were
+	 * prefetched instead of replacing them by silence. Intended for
+	 * audio export, which renders faster than real time. read() is
+	 * not real-time safe while it is enabled.
+	 */
+	void setOffline( bool bOffline );
+	bool isOffline() const;
+
+	/** \return Number of read() calls since creation which could not
+	 * be served completely. */
+	int getUnderruns() const;
+	/** \return Number of frames replaced by silence since creation. */
+	long long getMissingFrames() const;
+	/** \return Number of streams currently acquired. */
+	int getActiveStreams() const;
+	int getStreams() const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	enum class State {
+		/** Can be acquired. */
+		Free,
+		/** Taken by acquire() but not handed to the prefetch thread
+		 * yet. */
+		Claimed,
+		/** Prefetch thread has to open the file. */
+		Requested,
+		Streaming,
+		/** Prefetch thread has to close the file. */
+		Released
+	};
+
+	struct Stream {
+		Stream();
+
+		std::atomic<State> state;
+		std::shared_ptr<Sample> pSample;
+
+		/** Only accessed by the prefetch thread. */
+		SNDFILE* pFile;
+		int nChannels;
+		int nHeadFrames;
+		int nFrames;
+
+		/** Frames below this one are present in the ring buffer or
+		 * the head of the sample. */
+		std::atomic<int> nWritten;
+		/** Frames below this one are not required by the reader
+		 * anymore. */
+		std::atomic<int> nRead;
+		/** Set by the prefetch thread in case the file could not be
+		 * opened. No frames beyond the head will arrive. */
+		std::atomic<bool> bFailed;
+
+		/** Allocated by the prefetch thread on first use. */
+		std::vector<float> data_L;
+		std::vector<float> data_R;
+	};
+
+	void workerLoop();
+	void open( Stream& stream );
+	/** \return Whether any frames were decoded. */
+	bool fill( Stream& stream );
+	void close( Stream& stream );
+	void reportUnderruns();
+	/** Blocks till frames up to @a nUntil of @a pSample were
+	 * prefetched into @a stream or no further progress can be made.
+	 *
+	 * \return Frames available afterwards. */
+	int waitForFrames( Stream& stream, const Sample* pSample, int nStart,
+					   int nUntil );
+
+	std::vector<std::unique_ptr<Stream>> m_streams;
+
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::atomic<bool> m_bShutdown;
+	/** Wakes up the prefetch thread before its poll interval elapsed. */
+	std::atomic<bool> m_bWakeUp;
+
+	std::atomic<bool> m_bOffline;
+	/** Notified by the prefetch thread after each pass in offline
+	 * mode. Uses #m_mutex. */
+	std::condition_variable m_fillCondition;
+
+	std::atomic<int> m_nActiveStreams;
+	std::atomic<int> m_nUnderruns;
+	std::atomic<long long> m_nMissingFrames;
+	/** Value of #m_nUnderruns at the time of the last event. */
+	int m_nReportedUnderruns;
+	std::chrono::steady_clock::time_point m_lastReport;
+
+	/** Interleaved frames read from file. Only accessed by the
+	 * prefetch thread. */
+	std::vector<float> m_readBuffer;
+
+	/** Context of the thread creating the streamer. Bound to the
+	 * prefetch thread. */
+	EngineContext* m_pEngineContext;
+};
+
+inline int SampleStreamer::getUnderruns() const {
+	return m_nUnderruns.load( std::memory_order_relaxed );
+}
+inline long long SampleStreamer::getMissingFrames() const {
+	return m_nMissingFrames.load( std::memory_order_relaxed );
+}
+inline int SampleStreamer::getActiveStreams() const {
+	return m_nActiveStreams.load( std::memory_order_relaxed );
+}
+inline bool SampleStreamer::isOffline() const {
+	return m_bOffline.load( std::memory_order_relaxed );
+}
+inline int SampleStreamer::getStreams() const {
+	return static_cast<int>(m_streams.size());
+}
+
+};
+
+#endif // H2C_SAMPLE_STREAMER_H
@@ -20,15 +20,18 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <type_traits>
 
 #include <core/IO/AudioOutput.h>
 #include <core/IO/JackAudioDriver.h>
 
 #include <core/Basics/Adsr.h>
 #include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/NotePool.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/Globals.h>
 #include <core/Hydrogen.h>
@@ -47,7 +50,11 @@
 #include <core/EventQueue.h>
 
 #include <core/FX/Effects.h>
+#include <core/Sampler/RenderThreadPool.h>
+#include <core/Sampler/ResampleKernels.h>
+#include <core/Sampler/SampleStreamer.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/VoiceTable.h>
 
 #include <iostream>
 #include <QDebug>
@@ -75,6 +82,12 @@ Sampler::Sampler()
 		, m_pMainOut_R( nullptr )
 		, m_pPreviewInstrument( nullptr )
 		, m_interpolateMode( Interpolation::InterpolateMode::Linear )
+		, m_pRenderThreadPool( nullptr )
+		, m_pSampleStreamer( nullptr )
+		, m_nRenderBufferSize( 0 )
+		, m_nStemTracks( 0 )
+		, m_pVoiceTable( nullptr )
+		, m_nFadingVoices( 0 )
 {
 	
 	
@@ -92,6 +105,29 @@ Sampler::Sampler()
 	// dummy instrument used for playback track
 	m_pPlaybackTrackInstrument = createInstrument( PLAYBACK_INSTR_ID, sEmptySampleFilename, 0.8 );
 	m_nPlayBackSamplePosition = 0;
+
+	// The voice table is large enough for the maximum number of notes
+	// which can be set in the preferences dialog. Larger values set
+	// in the config file are respected too.
+	const auto pPref = Preferences::get_instance();
+	const int nMaxNotes = pPref != nullptr ?
+		std::max( static_cast<int>(pPref->m_nMaxNotes), 512 ) : 512;
+	m_pVoiceTable = new VoiceTable( nMaxNotes + nMaxFadingVoices );
+
+	// Avoid allocations in the audio thread for regular note counts.
+	m_noteRenderJobs.reserve( m_pVoiceTable->getCapacity() );
+	m_layerRenderJobs.reserve( m_pVoiceTable->getCapacity() );
+	m_renderBuffer.resize( 2 * MAX_BUFFER_SIZE );
+
+	m_pStagingBuffer = std::make_shared<StagingBuffer>();
+	if ( pPref != nullptr && pPref->m_nSamplerThreads > 1 ) {
+		m_pRenderThreadPool = new RenderThreadPool( pPref->m_nSamplerThreads );
+		// Will be adjusted once the audio driver is started.
+		updateStagingBuffer( m_pRenderThreadPool->getThreads(),
+							 pPref->m_nBufferSize );
+	}
+
+	m_pSampleStreamer = new SampleStreamer( nMaxStreams );
 }
 
 
@@ -101,6 +137,9 @@ Sampler::~Sampler()
 
 	delete[] m_pMainOut_L;
 	delete[] m_pMainOut_R;
+	delete m_pRenderThreadPool;
+	delete m_pVoiceTable;
+	delete m_pSampleStreamer;
 
 	m_pPreviewInstrument = nullptr;
 	m_pPlaybackTrackInstrument = nullptr;
@@ -111,50 +150,67 @@ void Sampler::process( uint32_t nFrames )
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
 	if ( pSong == nullptr ) {
-		ERRORLOG( "no song" );
+		ERRORLOG_RT( "no song" );
 		return;
 	}
 	
 	memset( m_pMainOut_L, 0, nFrames * sizeof( float ) );
 	memset( m_pMainOut_R, 0, nFrames * sizeof( float ) );
+	for ( int nTrack = 0; nTrack < m_nStemTracks; ++nTrack ) {
+		memset( getStemOut_L( nTrack ), 0, nFrames * sizeof( float ) );
+		memset( getStemOut_R( nTrack ), 0, nFrames * sizeof( float ) );
+	}
 
-	// Max notes limit
-	int nMaxNotes = Preferences::get_instance()->m_nMaxNotes;
-	while ( ( int )m_playingNotesQueue.size() > nMaxNotes ) {
-		auto pOldNote = m_playingNotesQueue[ 0 ];
-		m_playingNotesQueue.erase( m_playingNotesQueue.begin() );
-		if ( pOldNote->getInstrument() != nullptr ) {
-			pOldNote->getInstrument()->dequeue( pOldNote );
-			WARNINGLOG( QString( "Number of playing notes [%1] exceeds maximum [%2]. Dropping note [%3]" )
-						.arg( m_playingNotesQueue.size() ).arg( nMaxNotes )
-						.arg( pOldNote->toQString() ) );
-		}
-		else {
-			ERRORLOG( QString( "Old note in Sampler has no instrument! [%1]" )
-					  .arg( pOldNote->toQString() ) );
+	// Max notes limit. Surplus notes are not dropped right away but
+	// faded out to avoid clicks.
+	const int nMaxNotes = std::min(
+		static_cast<int>(Preferences::get_instance()->m_nMaxNotes),
+		m_pVoiceTable->getCapacity() - nMaxFadingVoices );
+	auto pAudioDriver = pHydrogen->getAudioOutput();
+	const int nSampleRate = pAudioDriver != nullptr ?
+		static_cast<int>(pAudioDriver->getSampleRate()) : 44100;
+	int nStolenVoices = 0;
+	while ( m_pVoiceTable->size() - m_nFadingVoices > nMaxNotes ) {
+		const int nVoice = findVoiceToSteal();
+		if ( nVoice == VoiceTable::nInvalid ) {
+			break;
 		}
+		fadeOutVoice( nVoice, nSampleRate );
+		++nStolenVoices;
+	}
+	if ( nStolenVoices > 0 ) {
+		WARNINGLOG_RT( "Number of playing notes exceeds maximum [%1]. Fading out [%2] notes using policy [%3]",
+					   nMaxNotes, nStolenVoices,
+					   Preferences::voiceStealingToQString(
+						   Preferences::get_instance()->m_voiceStealing ) );
 	}
 
 	// Render next `nFrames` audio frames of all playing notes.
-	unsigned i = 0;
+	renderNotes( nFrames );
+
 	std::shared_ptr<Note> pNote = nullptr;
-	while ( i < m_playingNotesQueue.size() ) {
-		pNote = m_playingNotesQueue[ i ];
-		if ( renderNote( pNote, nFrames ) ) {
-			// End of note was reached during rendering.
-			m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
-			if ( pNote->getInstrument() != nullptr ) {
-				pNote->getInstrument()->dequeue( pNote );
-			} else {
-				ERRORLOG( QString( "Playing note in sampler does not have instrument! [%1]" )
-						  .arg( pNote->prettyName() ) );
+	for ( const auto& noteJob : m_noteRenderJobs ) {
+		auto& voice = ( *m_pVoiceTable )[ noteJob.nVoice ];
+		bool bEnded = noteJob.bEnded;
+		if ( voice.fFadeStep > 0 ) {
+			voice.fFadeGain -= voice.fFadeStep * nFrames;
+			if ( voice.fFadeGain <= 0 ) {
+				bEnded = true;
 			}
+		}
+
+		if ( bEnded ) {
+			// End of note was reached during rendering.
+			pNote = voice.pNote;
+			removeVoice( noteJob.nVoice );
 			m_queuedNoteOffs.push_back( pNote );
-		} else {
-			// As finished notes are poped above 
-			++i;
 		}
 	}
+	pNote = nullptr;
+
+	// Release our references to the rendered notes and samples.
+	m_layerRenderJobs.clear();
+	m_noteRenderJobs.clear();
 
 	if ( m_queuedNoteOffs.size() > 0 ) {
 		MidiOutput* pMidiOut = pHydrogen->getMidiOutput();
@@ -172,8 +228,8 @@ void Sampler::process( uint32_t nFrames )
 					}
 				}
 				else {
-					ERRORLOG( QString( "Queued note off in sampler does not have instrument! [%1]" )
-							  .arg( pNote->toQString() ) );
+					ERRORLOG_RT( "Queued note off in sampler does not have instrument! Position: [%1]",
+								 pNote->getPosition() );
 				}
 
 		
@@ -188,20 +244,249 @@ void Sampler::process( uint32_t nFrames )
 }
 
 bool Sampler::isRenderingNotes() const {
-	return m_playingNotesQueue.size() > 0;
+	return m_pVoiceTable->size() > 0;
+}
+
+int Sampler::getPlayingNotesNumber() const {
+	return m_pVoiceTable->size();
+}
+
+std::vector<std::shared_ptr<Note>> Sampler::getPlayingNotesQueue() const {
+	std::vector<std::shared_ptr<Note>> notes;
+	notes.reserve( m_pVoiceTable->size() );
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		notes.push_back( ( *m_pVoiceTable )[ nVoice ].pNote );
+	}
+	return notes;
+}
+
+int Sampler::findVoiceToSteal() const {
+	const auto voiceStealing = Preferences::get_instance()->m_voiceStealing;
+
+	std::shared_ptr<InstrumentList> pInstrumentList = nullptr;
+	const auto pSong = Hydrogen::get_instance()->getSong();
+	if ( pSong != nullptr && pSong->getDrumkit() != nullptr ) {
+		pInstrumentList = pSong->getDrumkit()->getInstruments();
+	}
+
+	int nCandidate = VoiceTable::nInvalid;
+	float fCandidateValue = 0;
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		const auto& voice = ( *m_pVoiceTable )[ nVoice ];
+		if ( voice.fFadeStep > 0 ) {
+			continue;
+		}
+		const auto pNote = voice.pNote;
+		const auto pInstrument = pNote->getInstrument();
+
+		// Voices are visited from oldest to newest. Only a strictly
+		// better value replaces the candidate.
+		float fValue;
+		switch ( voiceStealing ) {
+		case Preferences::VoiceStealing::Quietest:
+			fValue = -1 * pNote->getVelocity() * pInstrument->getVolume() *
+				( pNote->getAdsr() != nullptr ? pNote->getAdsr()->getValue() : 1 );
+			break;
+		case Preferences::VoiceStealing::LowestPriority:
+			// Instruments not part of the drumkit, like the metronome,
+			// are never preferred.
+			fValue = pInstrumentList != nullptr ?
+				pInstrumentList->index( pInstrument ) : -1;
+			break;
+		case Preferences::VoiceStealing::Oldest:
+		default:
+			return nVoice;
+		}
+
+		if ( nCandidate == VoiceTable::nInvalid || fValue > fCandidateValue ) {
+			nCandidate = nVoice;
+			fCandidateValue = fValue;
+		}
+	}
+
+	return nCandidate;
+}
+
+void Sampler::fadeOutVoice( int nVoice, int nSampleRate, float fFadeTime ) {
+	auto& voice = ( *m_pVoiceTable )[ nVoice ];
+	const float fFadeStep = 1.0 / std::max( 1.0f, fFadeTime * nSampleRate );
+	if ( voice.fFadeStep > 0 ) {
+		// Already fading. Only speed it up.
+		if ( fFadeStep * voice.fFadeGain > voice.fFadeStep ) {
+			voice.fFadeStep = fFadeStep * voice.fFadeGain;
+		}
+		return;
+	}
+	voice.fFadeGain = 1.0;
+	voice.fFadeStep = fFadeStep;
+	++m_nFadingVoices;
+}
+
+void Sampler::removeVoice( int nVoice ) {
+	auto& voice = ( *m_pVoiceTable )[ nVoice ];
+	if ( voice.pNote == nullptr ) {
+		return;
+	}
+	if ( voice.fFadeStep > 0 ) {
+		--m_nFadingVoices;
+	}
+	if ( voice.pNote->getInstrument() != nullptr ) {
+		voice.pNote->getInstrument()->dequeue( voice.pNote );
+	}
+	releaseStreams( voice.pNote );
+	m_pVoiceTable->remove( nVoice );
+}
+
+void Sampler::releaseStreams( std::shared_ptr<Note> pNote ) {
+	for ( const auto& [ _, ppSelectedLayerInfo ] :
+			  pNote->getAllSelectedLayerInfos() ) {
+		if ( ppSelectedLayerInfo != nullptr &&
+			 ppSelectedLayerInfo->nStream != -1 ) {
+			m_pSampleStreamer->release( ppSelectedLayerInfo->nStream );
+			ppSelectedLayerInfo->nStream = -1;
+		}
+	}
+}
+
+void Sampler::setRenderThreads( int nThreads ) {
+	nThreads = std::clamp( nThreads, 1, Preferences::nMaxSamplerThreads );
+	if ( nThreads == getRenderThreads() ) {
+		return;
+	}
+
+	// Spawn and join the worker threads outside of the lock.
+	RenderThreadPool* pNewPool = nullptr;
+	if ( nThreads > 1 ) {
+		pNewPool = new RenderThreadPool( nThreads );
+	}
+
+	updateStagingBuffer( nThreads,
+						 std::atomic_load( &m_pStagingBuffer )->nBufferSize );
+
+	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	pAudioEngine->lock( RIGHT_HERE );
+	auto pOldPool = m_pRenderThreadPool;
+	m_pRenderThreadPool = pNewPool;
+	pAudioEngine->unlock();
+	delete pOldPool;
+
+	INFOLOG( QString( "Rendering notes using [%1] threads" ).arg( nThreads ) );
+}
+
+void Sampler::setBufferSize( unsigned nBufferSize ) {
+	if ( nBufferSize == std::atomic_load( &m_pStagingBuffer )->nBufferSize ) {
+		return;
+	}
+
+	updateStagingBuffer( getRenderThreads(), nBufferSize );
+}
+
+void Sampler::updateStagingBuffer( int nThreads, unsigned nBufferSize ) {
+	// Fully sized before the audio thread gets to see it.
+	auto pStagingBuffer = std::make_shared<StagingBuffer>();
+	pStagingBuffer->nBufferSize = nBufferSize;
+	if ( nThreads > 1 && nBufferSize > 0 ) {
+		pStagingBuffer->nLayers = std::min( nStagedLayersPerThread * nThreads,
+											m_pVoiceTable->getCapacity() );
+		pStagingBuffer->data.resize(
+			pStagingBuffer->nLayers * 2 * nBufferSize, 0 );
+	}
+
+	std::lock_guard<std::mutex> guard( m_stagingBufferMutex );
+	auto pOldStagingBuffer =
+		std::atomic_exchange( &m_pStagingBuffer, pStagingBuffer );
+
+	// The audio thread may still be rendering into the previous
+	// buffer. It is kept so it does not get freed in there.
+	m_retiredStagingBuffers.erase(
+		std::remove_if( m_retiredStagingBuffers.begin(),
+						m_retiredStagingBuffers.end(),
+						[]( const std::shared_ptr<StagingBuffer>& ppBuffer ) {
+							return ppBuffer.use_count() == 1; } ),
+		m_retiredStagingBuffers.end() );
+	if ( pOldStagingBuffer != nullptr ) {
+		m_retiredStagingBuffers.push_back( pOldStagingBuffer );
+	}
+}
+
+int Sampler::getRenderThreads() const {
+	return m_pRenderThreadPool != nullptr ?
+		m_pRenderThreadPool->getThreads() : 1;
+}
+
+void Sampler::setStemTracks( const std::vector<StemTrack>& tracks ) {
+	// Allocate the new buffers outside of the lock.
+	std::vector<float> stemBuffer;
+	std::vector<StemTrackEntry> stemTrackMap;
+	if ( tracks.size() > 0 ) {
+		stemBuffer.resize( 2 * tracks.size() * MAX_BUFFER_SIZE, 0 );
+		for ( int nTrack = 0; nTrack < tracks.size(); ++nTrack ) {
+			const auto track = tracks[ nTrack ];
+			stemTrackMap.push_back( { track.nInstrumentId,
+									  std::max( track.nComponentIdx, -1 ),
+									  nTrack } );
+		}
+		std::stable_sort( stemTrackMap.begin(), stemTrackMap.end(),
+						  []( const StemTrackEntry& a, const StemTrackEntry& b ) {
+							  return std::make_pair( a.nInstrumentId, a.nComponentIdx ) <
+								  std::make_pair( b.nInstrumentId, b.nComponentIdx ); } );
+	}
+
+	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	pAudioEngine->lock( RIGHT_HERE );
+	m_stemBuffer.swap( stemBuffer );
+	m_stemTrackMap.swap( stemTrackMap );
+	m_nStemTracks = static_cast<int>(tracks.size());
+	pAudioEngine->unlock();
+}
+
+int Sampler::findStemTrack( int nInstrumentId, int nComponentIdx ) const {
+	auto find = [&]( int nComponent ) {
+		const auto it = std::lower_bound(
+			m_stemTrackMap.begin(), m_stemTrackMap.end(),
+			std::make_pair( nInstrumentId, nComponent ),
+			[]( const StemTrackEntry& entry, const std::pair<int, int>& key ) {
+				return std::make_pair( entry.nInstrumentId,
+									   entry.nComponentIdx ) < key; } );
+		if ( it != m_stemTrackMap.end() && it->nInstrumentId == nInstrumentId &&
+			 it->nComponentIdx == nComponent ) {
+			return it->nTrack;
+		}
+		return -1;
+	};
+
+	// A stem of the particular component takes precedence over one of
+	// the whole instrument.
+	const int nTrack = find( nComponentIdx );
+	if ( nTrack >= 0 ) {
+		return nTrack;
+	}
+	return find( -1 );
+}
+
+float* Sampler::getStemOut_L( int nTrack ) {
+	return m_stemBuffer.data() + 2 * nTrack * MAX_BUFFER_SIZE;
+}
+
+float* Sampler::getStemOut_R( int nTrack ) {
+	return m_stemBuffer.data() + ( 2 * nTrack + 1 ) * MAX_BUFFER_SIZE;
 }
 
 void Sampler::noteOn( std::shared_ptr<Note> pNote )
 {
 	assert( pNote );
 	if ( pNote == nullptr ) {
-		ERRORLOG( "Invalid note" );
+		ERRORLOG_RT( "Invalid note" );
 		return;
 	}
 
 	if ( pNote->getInstrument() == nullptr ||
 		 pNote->getAdsr() == nullptr ) {
-		ERRORLOG( QString( "Invalid note [%1]" ).arg( pNote->toQString() ) );
+		ERRORLOG_RT( "Invalid note at position [%1]", pNote->getPosition() );
 		return;
 	}
 
@@ -225,7 +510,10 @@ void Sampler::noteOn( std::shared_ptr<Note> pNote )
 		const auto pSong = Hydrogen::get_instance()->getSong();
 
 		// remove all notes using the same mute group
-		for ( const auto& pOtherNote: m_playingNotesQueue ) {	// delete older note
+		for ( int nVoice = m_pVoiceTable->getFirstOfMuteGroup( nMuteGrp );
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = m_pVoiceTable->getNextOfMuteGroup( nVoice ) ) {
+			const auto& pOtherNote = ( *m_pVoiceTable )[ nVoice ].pNote;
 			if ( pOtherNote != nullptr &&
 				 pOtherNote->getInstrument() != nullptr &&
 				 pOtherNote->getAdsr() != nullptr &&
@@ -249,7 +537,10 @@ void Sampler::noteOn( std::shared_ptr<Note> pNote )
 
 	//note off notes
 	if ( pNote->getNoteOff() ){
-		for ( const auto& pOtherNote: m_playingNotesQueue ) {
+		for ( int nVoice = m_pVoiceTable->getFirstOfInstrument( pInstr.get() );
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = m_pVoiceTable->getNextOfInstrument( nVoice ) ) {
+			const auto& pOtherNote = ( *m_pVoiceTable )[ nVoice ].pNote;
 			if ( pOtherNote != nullptr &&
 				 pOtherNote->getInstrument() != nullptr &&
 				 pOtherNote->getAdsr() != nullptr &&
@@ -260,14 +551,29 @@ void Sampler::noteOn( std::shared_ptr<Note> pNote )
 	}
 
 	if ( ! pNote->getNoteOff() ){
+		if ( m_pVoiceTable->isFull() ) {
+			// More notes were started within a single process cycle than
+			// there are voices. There is no time left for fading out.
+			int nVictim = findVoiceToSteal();
+			if ( nVictim == VoiceTable::nInvalid ) {
+				nVictim = m_pVoiceTable->getFirst();
+			}
+			WARNINGLOG_RT( "No voice left. Dropping note of instrument [%1] at position [%2]",
+						   ( *m_pVoiceTable )[ nVictim ].pNote->getInstrumentId(),
+						   ( *m_pVoiceTable )[ nVictim ].pNote->getPosition() );
+			removeVoice( nVictim );
+		}
 		pInstr->enqueue( pNote );
-		m_playingNotesQueue.push_back( pNote );
+		m_pVoiceTable->add( pNote );
 	}
 }
 
 void Sampler::midiKeyboardNoteOff( int key )
 {
-	for ( const auto& pNote: m_playingNotesQueue ) {
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		const auto& pNote = ( *m_pVoiceTable )[ nVoice ].pNote;
 		if ( pNote->getMidiMsg() == key &&
 			 pNote->getAdsr() != nullptr ) {
 			pNote->getAdsr()->release();
@@ -447,11 +753,14 @@ inline float Sampler::panLaw( float fPan, std::shared_ptr<Song> pSong ) {
 }
 
 void Sampler::handleTimelineOrTempoChange() {
-	if ( m_playingNotesQueue.size() == 0 ) {
+	if ( m_pVoiceTable->size() == 0 ) {
 		return;
 	}
 
-	for ( auto& ppNote : m_playingNotesQueue ) {
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		const auto& ppNote = ( *m_pVoiceTable )[ nVoice ].pNote;
 		if ( ppNote == nullptr || ppNote->getInstrument() == nullptr ) {
 			continue;
 		}
@@ -519,7 +828,7 @@ void Sampler::handleTimelineOrTempoChange() {
 }
 
 void Sampler::handleSongSizeChange() {
-	if ( m_playingNotesQueue.size() == 0 ) {
+	if ( m_pVoiceTable->size() == 0 ) {
 		return;
 	}
 
@@ -527,7 +836,10 @@ void Sampler::handleSongSizeChange() {
 		static_cast<long>(std::floor(Hydrogen::get_instance()->getAudioEngine()->
 									 getTransportPosition()->getTickOffsetSongSize()));
 	
-	for ( auto ppNote : m_playingNotesQueue ) {
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		const auto& ppNote = ( *m_pVoiceTable )[ nVoice ].pNote;
 		
 		// DEBUGLOG( QString( "pos: %1 -> %2, nTickOffset: %3, note: %4" )
 		// 		  .arg( ppNote->getPosition() )
@@ -548,30 +860,119 @@ void Sampler::handleSongSizeChange() {
 
 //------------------------------------------------------------------
 
-bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
+void Sampler::renderNotes( unsigned nBufferSize )
+{
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		prepareNote( nVoice, nBufferSize );
+	}
+
+	// Each layer rendered in parallel requires its own staging buffer.
+	// Notes are rendered in parallel as long as the buffers for all of
+	// their layers are available. The remaining ones are rendered
+	// serially reusing a single buffer.
+	const auto pStagingBuffer = std::atomic_load( &m_pStagingBuffer );
+	int nParallelNotes = 0;
+	int nStagedLayers = 0;
+	if ( m_pRenderThreadPool != nullptr &&
+		 nBufferSize <= pStagingBuffer->nBufferSize ) {
+		for ( const auto& noteJob : m_noteRenderJobs ) {
+			if ( nStagedLayers + noteJob.nLayers > pStagingBuffer->nLayers ) {
+				break;
+			}
+			nStagedLayers += noteJob.nLayers;
+			++nParallelNotes;
+		}
+	}
+	if ( nParallelNotes < 2 ) {
+		nParallelNotes = 0;
+		nStagedLayers = 0;
+	}
+
+	// Layers are stored in the order of their notes.
+	for ( int ii = 0; ii < nStagedLayers; ++ii ) {
+		auto& job = m_layerRenderJobs[ ii ];
+		job.pBuffer_L = &pStagingBuffer->data[ ii * 2 * nBufferSize ];
+		job.pBuffer_R = &pStagingBuffer->data[ ii * 2 * nBufferSize + nBufferSize ];
+	}
+
+	if ( nParallelNotes > 0 ) {
+		m_nRenderBufferSize = nBufferSize;
+		m_pRenderThreadPool->run( nParallelNotes, &Sampler::renderNoteTask,
+								  this );
+		for ( int ii = 0; ii < nStagedLayers; ++ii ) {
+			mixLayer( m_layerRenderJobs[ ii ] );
+		}
+	}
+
+	for ( size_t ii = nStagedLayers; ii < m_layerRenderJobs.size(); ++ii ) {
+		auto& job = m_layerRenderJobs[ ii ];
+		job.pBuffer_L = &m_renderBuffer[ 0 ];
+		job.pBuffer_R = &m_renderBuffer[ MAX_BUFFER_SIZE ];
+		renderLayer( job, nBufferSize );
+		mixLayer( job );
+	}
+
+	for ( auto& noteJob : m_noteRenderJobs ) {
+		for ( int ii = noteJob.nFirstLayer;
+			  ii < noteJob.nFirstLayer + noteJob.nLayers; ++ii ) {
+			if ( ! m_layerRenderJobs[ ii ].bEnded ) {
+				noteJob.bEnded = false;
+			}
+		}
+	}
+}
+
+void Sampler::renderNoteTask( int nTask, void* pContext )
 {
+	auto pSampler = static_cast<Sampler*>(pContext);
+	const auto& noteJob = pSampler->m_noteRenderJobs[ nTask ];
+
+	// All layers of a note share its ADSR and filter state and have to be
+	// rendered sequentially.
+	for ( int ii = noteJob.nFirstLayer;
+		  ii < noteJob.nFirstLayer + noteJob.nLayers; ++ii ) {
+		pSampler->renderLayer( pSampler->m_layerRenderJobs[ ii ],
+							   pSampler->m_nRenderBufferSize );
+	}
+}
+
+void Sampler::prepareNote( int nVoice, unsigned nBufferSize )
+{
+	const auto& voice = ( *m_pVoiceTable )[ nVoice ];
+	const auto pNote = voice.pNote;
+
+	// Notes without any layer to render are considered ended.
+	NoteRenderJob noteJob;
+	noteJob.nVoice = nVoice;
+	noteJob.nFirstLayer = static_cast<int>(m_layerRenderJobs.size());
+	noteJob.nLayers = 0;
+	noteJob.bEnded = true;
+	m_noteRenderJobs.push_back( noteJob );
+
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
 	if ( pSong == nullptr ) {
-		ERRORLOG( "no song" );
-		return true;
+		ERRORLOG_RT( "no song" );
+		return;
 	}
 
 	if ( pNote == nullptr ) {
-		return true;
+		return;
 	}
 
 	auto pInstr = pNote->getInstrument();
 	if ( pInstr == nullptr ) {
-		ERRORLOG( "NULL instrument" );
-		return true;
+		ERRORLOG_RT( "NULL instrument" );
+		return;
 	}
 
 	long long nFrame;
 	auto pAudioDriver = pHydrogen->getAudioOutput();
 	if ( pAudioDriver == nullptr ) {
-		ERRORLOG( "AudioDriver is not ready!" );
-		return true;
+		ERRORLOG_RT( "AudioDriver is not ready!" );
+		return;
 	}
 
 	auto pAudioEngine = pHydrogen->getAudioEngine();
@@ -607,11 +1008,11 @@ bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
 			
 			if ( nBufferSize < nInitialBufferPos ) {
 				// this note is not valid. it's in the future...let's skip it....
-				ERRORLOG( QString( "Note pos in the future?? nFrame: %1, note start: %2, nInitialBufferPos: %3, nBufferSize: %4" )
-						  .arg( nFrame ).arg( pNote->getNoteStart() )
-						  .arg( nInitialBufferPos ).arg( nBufferSize ) );
+				ERRORLOG_RT( "Note pos in the future?? nFrame: %1, note start: %2, nInitialBufferPos: %3, nBufferSize: %4",
+							 nFrame, pNote->getNoteStart(),
+							 nInitialBufferPos, nBufferSize );
 
-				return true;
+				return;
 			}
 		}
 	}
@@ -684,17 +1085,10 @@ bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
 	}
 
 	auto pComponents = pInstr->getComponents();
-	auto returnValues = std::vector<bool>( pComponents->size() );
-
-	for ( int ii = 0; ii < pComponents->size(); ++ii ){
-		returnValues[ ii ] = false;
-	}
-
 	for ( int ii = 0; ii < pComponents->size(); ++ii ) {
 		auto pCompo = pComponents->at( ii );
 		if ( pCompo == nullptr ) {
-			ERRORLOG( QString( "Component [%1] is invalid" ).arg( ii ) );
-			returnValues[ ii ] = true;
+			ERRORLOG_RT( "Component [%1] is invalid", ii );
 			continue;
 		}
 
@@ -702,15 +1096,14 @@ bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
 		if ( pSelectedLayerInfo == nullptr ||
 			 pSelectedLayerInfo->pLayer == nullptr ) {
 			// Component skipped
-			returnValues[ ii ] = true;
 			continue;
 		}
 
 		auto pLayer = pSelectedLayerInfo->pLayer;
 		auto pSample = pLayer->getSample();
 		if ( pSample == nullptr ) {
-			DEBUGLOG( "Selected layer has no sample!" );
-			returnValues[ ii ] = true;
+			__LOG_RT( _class_name(), H2Core::Logger::Debug,
+					  "Selected layer has no sample!" );
 			continue;
 		}
 
@@ -724,11 +1117,10 @@ bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
 			// harmful. So, we just log a warning if the difference is
 			// larger, which might be caused by a different problem.
 			if ( pSelectedLayerInfo->fSamplePosition >= pSample->getFrames() + 3 ) {
-				WARNINGLOG( QString( "sample position [%1] out of bounds [0,%2]. The layer has been resized during note play?" )
-							.arg( pSelectedLayerInfo->fSamplePosition )
-							.arg( pSample->getFrames() ) );
+				WARNINGLOG_RT( "sample position [%1] out of bounds [0,%2]. The layer has been resized during note play?",
+							   pSelectedLayerInfo->fSamplePosition,
+							   pSample->getFrames() );
 			}
-			returnValues[ ii ] = true;
 			continue;
 		}
 
@@ -812,34 +1204,56 @@ bool Sampler::renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize )
 			}
 		}
 
-		// Actual rendering.
-		returnValues[ ii ] = renderNoteResample(
-			pSample, pNote, pSelectedLayerInfo, pCompo, ii, nBufferSize,
-			nInitialBufferPos, fCost_L, fCost_R, fCostTrack_L, fCostTrack_R,
-			fLayerPitch );
+		// Actual rendering is done in renderLayer().
+		LayerRenderJob job;
+		job.pNote = pNote;
+		job.pSample = pSample;
+		job.pSelectedLayerInfo = pSelectedLayerInfo;
+		job.nComponentIdx = ii;
+		job.nInitialBufferPos = static_cast<int>(nInitialBufferPos);
+		job.fCost_L = fCost_L;
+		job.fCost_R = fCost_R;
+		job.fCostTrack_L = fCostTrack_L;
+		job.fCostTrack_R = fCostTrack_R;
+		job.fLayerPitch = fLayerPitch;
+		job.fFadeGain = voice.fFadeGain;
+		job.fFadeStep = voice.fFadeStep;
+		job.nFinalBufferPos = job.nInitialBufferPos;
+		job.bRendered = false;
+		job.bEnded = true;
+		job.pBuffer_L = nullptr;
+		job.pBuffer_R = nullptr;
+		m_layerRenderJobs.push_back( job );
+		++m_noteRenderJobs.back().nLayers;
 	}
-
-	for ( const auto& bReturnValue : returnValues ) {
-		if ( ! bReturnValue ) {
-			return false;
-		}
-	}
-	return true;
 }
 
 /// Copy sample data to buffer, filling buffer with trailing silence at end of
-/// sample data.
+/// sample data. Packed integer data (see ResampleKernels::Format) is widened
+/// to float.
+template < typename T >
 void copySample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
-				 float *__restrict__ pSample_data_L, float *__restrict__ pSample_data_R,
+				 const T *__restrict__ pSample_data_L,
+				 const T *__restrict__ pSample_data_R,
 				 int nFrames, double fSamplePos, float fStep, int nSampleFrames )
 {
 	int nSamplePos = static_cast<int>(fSamplePos);
 	int nFramesFromSample = std::min( nFrames, nSampleFrames - nSamplePos );
 
-	memcpy( pBuffer_L, &pSample_data_L[ nSamplePos ],
-			nFramesFromSample * sizeof( float ) );
-	memcpy( pBuffer_R, &pSample_data_R[ nSamplePos ],
-			nFramesFromSample * sizeof( float ) );
+	if constexpr ( std::is_same_v<T, float> ) {
+		memcpy( pBuffer_L, &pSample_data_L[ nSamplePos ],
+				nFramesFromSample * sizeof( float ) );
+		memcpy( pBuffer_R, &pSample_data_R[ nSamplePos ],
+				nFramesFromSample * sizeof( float ) );
+	}
+	else {
+		for ( int ii = 0; ii < nFramesFromSample; ++ii ) {
+			pBuffer_L[ ii ] =
+				ResampleKernels::toFloat( pSample_data_L[ nSamplePos + ii ] );
+			pBuffer_R[ ii ] =
+				ResampleKernels::toFloat( pSample_data_R[ nSamplePos + ii ] );
+		}
+	}
 
 	if ( nFramesFromSample < nFrames ) {
 		memset( &pBuffer_L[ nFramesFromSample ], '0',
@@ -872,10 +1286,22 @@ void copySample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
 /// checking where it's not needed, without having to hand-write
 /// specialisations for each.
 ///
-template < Interpolation::InterpolateMode mode >
-void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
-			   float *__restrict__ pSample_data_L, float *__restrict__ pSample_data_R,
-			   int nFrames, double &fSamplePos, float fStep, int nSampleFrames )
+/// On CPUs supporting it, the "middle" range is handed to a vectorized kernel
+/// (see ResampleKernels.h) matching this code within
+/// ResampleKernels::fTolerance.
+///
+/// Mono samples (@a bMono) use the same data for both channels. It is
+/// interpolated just once.
+///
+/// Packed integer data (@a T, see ResampleKernels::Format) is widened to
+/// float right after reading each frame.
+///
+template < Interpolation::InterpolateMode mode, bool bMono, typename T >
+void resampleChannels( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+					   const T *__restrict__ pSample_data_L,
+					   const T *__restrict__ pSample_data_R,
+					   int nFrames, double &fSamplePos, float fStep,
+					   int nSampleFrames )
 {
 	auto getSampleFrames = [&](	int nSamplePos,
 								float &l0, float &l1, float &l2, float &l3,
@@ -883,24 +1309,42 @@ void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
 		l0 = l1 = l2 = l3 = r0 = r1 = r2 = r3 = 0.0;
 		// Some required frames are off the beginning or end of the sample.
 		if ( nSamplePos >= 1 && nSamplePos < nSampleFrames + 1 ) {
-			l0 = pSample_data_L[ nSamplePos-1 ];
-			r0 = pSample_data_R[ nSamplePos-1 ];
+			l0 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos-1 ] );
+			if constexpr ( ! bMono ) {
+				r0 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos-1 ] );
+			}
 		}
 		// Each successive frame may be past the end of the sample so check individually.
 		if ( nSamplePos < nSampleFrames ) {
-			l1 = pSample_data_L[ nSamplePos ];
-			r1 = pSample_data_R[ nSamplePos ];
+			l1 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos ] );
+			if constexpr ( ! bMono ) {
+				r1 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos ] );
+			}
 			if ( nSamplePos+1 < nSampleFrames ) {
-				l2 = pSample_data_L[ nSamplePos+1 ];
-				r2 = pSample_data_R[ nSamplePos+1 ];
+				l2 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos+1 ] );
+				if constexpr ( ! bMono ) {
+					r2 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos+1 ] );
+				}
 				if ( nSamplePos+2 < nSampleFrames ) {
-					l3 = pSample_data_L[ nSamplePos+2 ];
-					r3 = pSample_data_R[ nSamplePos+2 ];
+					l3 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos+2 ] );
+					if constexpr ( ! bMono ) {
+						r3 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos+2 ] );
+					}
 				}
 			}
 		}
 	};
 
+	// Interpolates the right channel unless the sample is mono.
+	auto interpolate_R = [&]( float r0, float r1, float r2, float r3,
+							  double fDiff, float fVal_L ) {
+		if constexpr ( bMono ) {
+			return fVal_L;
+		} else {
+			return Interpolation::interpolate<mode>( r0, r1, r2, r3, fDiff );
+		}
+	};
+
 	float fVal_L, fVal_R;
 	int nFrame;
 	float l0, l1, l2, l3, r0, r1, r2, r3;
@@ -915,7 +1359,7 @@ void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
 		getSampleFrames( 0, l0, l1, l2, l3, r0, r1, r2, r3);
 
 		fVal_L = Interpolation::interpolate<mode>( l0, l1, l2, l3, fDiff );
-		fVal_R = Interpolation::interpolate<mode>( r0, r1, r2, r3, fDiff );
+		fVal_R = interpolate_R( r0, r1, r2, r3, fDiff, fVal_L );
 		pBuffer_L[nFrame] = fVal_L;
 		pBuffer_R[nFrame] = fVal_R;
 		fSamplePos += fStep;
@@ -924,20 +1368,33 @@ void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
 	// Fast iterations for main body of sample, with unconditional sample lookup
 	int nFastFrames = std::min( nFrames,
 								static_cast<int>( ( nSampleFrames - 2 - fSamplePos ) /  fStep ) );
+
+	// Use vectorized kernels if supported by the CPU.
+	auto kernel = ResampleKernels::getKernelFor<T>( static_cast<int>(mode) );
+	if ( kernel != nullptr && nFrame < nFastFrames ) {
+		kernel( &pBuffer_L[ nFrame ], &pBuffer_R[ nFrame ],
+				pSample_data_L, pSample_data_R, nFastFrames - nFrame,
+				fSamplePos, fStep );
+		fSamplePos += static_cast<double>(nFastFrames - nFrame) * fStep;
+		nFrame = nFastFrames;
+	}
+
 	for ( ; nFrame < nFastFrames; nFrame++) {
 		int nSamplePos = static_cast<int>(fSamplePos);
 		double fDiff = fSamplePos - nSamplePos;
 		// Gather frame samples
-		l0 = pSample_data_L[ nSamplePos-1 ];
-		l1 = pSample_data_L[ nSamplePos ];
-		l2 = pSample_data_L[ nSamplePos+1 ];
-		l3 = pSample_data_L[ nSamplePos+2 ];
-		r0 = pSample_data_R[ nSamplePos-1 ];
-		r1 = pSample_data_R[ nSamplePos ];
-		r2 = pSample_data_R[ nSamplePos+1 ];
-		r3 = pSample_data_R[ nSamplePos+2 ];
+		l0 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos-1 ] );
+		l1 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos ] );
+		l2 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos+1 ] );
+		l3 = ResampleKernels::toFloat( pSample_data_L[ nSamplePos+2 ] );
+		if constexpr ( ! bMono ) {
+			r0 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos-1 ] );
+			r1 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos ] );
+			r2 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos+1 ] );
+			r3 = ResampleKernels::toFloat( pSample_data_R[ nSamplePos+2 ] );
+		}
 		fVal_L = Interpolation::interpolate<mode>( l0, l1, l2, l3, fDiff );
-		fVal_R = Interpolation::interpolate<mode>( r0, r1, r2, r3, fDiff );
+		fVal_R = interpolate_R( r0, r1, r2, r3, fDiff, fVal_L );
 		pBuffer_L[nFrame] = fVal_L;
 		pBuffer_R[nFrame] = fVal_R;
 		fSamplePos += fStep;
@@ -948,49 +1405,144 @@ void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
 		double fDiff = fSamplePos - nSamplePos;
 		getSampleFrames( nSamplePos, l0, l1, l2, l3, r0, r1, r2, r3);
 		fVal_L = Interpolation::interpolate<mode>( l0, l1, l2, l3, fDiff );
-		fVal_R = Interpolation::interpolate<mode>( r0, r1, r2, r3, fDiff );
+		fVal_R = interpolate_R( r0, r1, r2, r3, fDiff, fVal_L );
 		pBuffer_L[nFrame] = fVal_L;
 		pBuffer_R[nFrame] = fVal_R;
 		fSamplePos += fStep;
 	}
 }
 
-/// Resample with runtime-selection of interpolation mode
-void resample( Interpolation::InterpolateMode mode,
-			   float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
-			   float *__restrict__ pSample_data_L, float *__restrict__ pSample_data_R,
+/// Resample with compile-time selection of the channel layout
+template < Interpolation::InterpolateMode mode, typename T >
+void resample( float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+			   const T *__restrict__ pSample_data_L, const T *__restrict__ pSample_data_R,
 			   int nFrames, double &fSamplePos, float fStep, int nSampleFrames )
 {
+	if ( pSample_data_L == pSample_data_R ) {
+		resampleChannels< mode, true, T >( pBuffer_L, pBuffer_R, pSample_data_L,
+										pSample_data_R, nFrames, fSamplePos,
+										fStep, nSampleFrames );
+	} else {
+		resampleChannels< mode, false, T >( pBuffer_L, pBuffer_R, pSample_data_L,
+										 pSample_data_R, nFrames, fSamplePos,
+										 fStep, nSampleFrames );
+	}
+}
+
+/// Resample with runtime-selection of interpolation mode
+template < typename T >
+void resampleData( Interpolation::InterpolateMode mode,
+				   float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+				   const T *__restrict__ pSample_data_L,
+				   const T *__restrict__ pSample_data_R,
+				   int nFrames, double &fSamplePos, float fStep, int nSampleFrames )
+{
 
 	switch (mode) {
 	case Interpolation::InterpolateMode::Linear:
-		resample< Interpolation::InterpolateMode::Linear >
+		resample< Interpolation::InterpolateMode::Linear, T >
 			( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
 			  nFrames, fSamplePos, fStep, nSampleFrames );
 		break;
 	case Interpolation::InterpolateMode::Cosine:
-		resample< Interpolation::InterpolateMode::Cosine >
+		resample< Interpolation::InterpolateMode::Cosine, T >
 			( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
 			  nFrames, fSamplePos, fStep, nSampleFrames );
 		break;
 	case Interpolation::InterpolateMode::Third:
-		resample< Interpolation::InterpolateMode::Third >
+		resample< Interpolation::InterpolateMode::Third, T >
 			( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
 			  nFrames, fSamplePos, fStep, nSampleFrames );
 		break;
 	case Interpolation::InterpolateMode::Cubic:
-		resample< Interpolation::InterpolateMode::Cubic >
+		resample< Interpolation::InterpolateMode::Cubic, T >
 			( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
 			  nFrames, fSamplePos, fStep, nSampleFrames );
 		break;
 	case Interpolation::InterpolateMode::Hermite:
-		resample< Interpolation::InterpolateMode::Hermite >
+		resample< Interpolation::InterpolateMode::Hermite, T >
 			( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
 			  nFrames, fSamplePos, fStep, nSampleFrames );
 		break;
 	}
 }
 
+void resample( Interpolation::InterpolateMode mode,
+			   float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+			   float *__restrict__ pSample_data_L, float *__restrict__ pSample_data_R,
+			   int nFrames, double &fSamplePos, float fStep, int nSampleFrames )
+{
+	resampleData<float>( mode, pBuffer_L, pBuffer_R, pSample_data_L,
+						 pSample_data_R, nFrames, fSamplePos, fStep,
+						 nSampleFrames );
+}
+
+/// Render frames of a sample stored in a packed integer format (see
+/// Sample::getFormat()).
+template < typename T >
+void renderPacked( Interpolation::InterpolateMode mode, const Sample* pSample,
+				   float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+				   int nFrames, double fSamplePos, float fStep, bool bResample )
+{
+	const auto pSample_data_L = static_cast<const T*>(pSample->getPackedData_L());
+	const auto pSample_data_R = static_cast<const T*>(pSample->getPackedData_R());
+	if ( bResample ) {
+		resampleData<T>( mode, pBuffer_L, pBuffer_R, pSample_data_L,
+						 pSample_data_R, nFrames, fSamplePos, fStep,
+						 pSample->getFrames() );
+	} else {
+		copySample<T>( pBuffer_L, pBuffer_R, pSample_data_L, pSample_data_R,
+					   nFrames, fSamplePos, fStep, pSample->getFrames() );
+	}
+}
+
+/// Resample or copy frames of a sample only partially held in memory
+/// (see Sample::isStreamed()).
+///
+/// Frames beyond the head are fetched from @a pStreamer in chunks small
+/// enough to reside on the stack. Each chunk contains the neighbouring
+/// frames required for interpolation. Since resample() treats frames
+/// outside of the provided data as silence, the first and last output
+/// frames of each chunk are computed from the same input frames as if
+/// the whole sample would be present.
+void renderStreamed( Interpolation::InterpolateMode mode,
+					 SampleStreamer* pStreamer, int nStream,
+					 const Sample* pSample,
+					 float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+					 int nFrames, double fSamplePos, float fStep, bool bResample )
+{
+	if ( ! bResample ) {
+		pStreamer->read( nStream, pSample, static_cast<int>(fSamplePos),
+						 nFrames, pBuffer_L, pBuffer_R );
+		return;
+	}
+
+	constexpr int nChunkFrames = 1024;
+	float chunk_L[ nChunkFrames ];
+	float chunk_R[ nChunkFrames ];
+
+	// Keep room for the interpolation neighbours and rounding.
+	const int nFramesPerChunk = std::max(
+		1, static_cast<int>( ( nChunkFrames - 5 ) / fStep ) );
+
+	int nFrame = 0;
+	while ( nFrame < nFrames ) {
+		const int nOut = std::min( nFrames - nFrame, nFramesPerChunk );
+		const int nStart = static_cast<int>(fSamplePos) - 1;
+		const int nSpan = std::min(
+			nChunkFrames,
+			static_cast<int>( fSamplePos + nOut * fStep ) + 3 - nStart );
+		pStreamer->read( nStream, pSample, nStart, nSpan, chunk_L, chunk_R );
+
+		double fChunkPos = fSamplePos - nStart;
+		resample( mode, &pBuffer_L[ nFrame ], &pBuffer_R[ nFrame ],
+				  chunk_L, chunk_R, nOut, fChunkPos, fStep, nSpan );
+
+		fSamplePos = nStart + fChunkPos;
+		nFrame += nOut;
+	}
+}
+
 bool Sampler::processPlaybackTrack(int nBufferSize)
 {
 	Hydrogen* pHydrogen = Hydrogen::get_instance();
@@ -999,12 +1551,12 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 
 	if ( pSong == nullptr ) {
-		ERRORLOG( "No song set yet" );
+		ERRORLOG_RT( "No song set yet" );
 		return true;
 	}
 
 	if ( pAudioDriver == nullptr ) {
-		ERRORLOG( "AudioDriver is not ready!" );
+		ERRORLOG_RT( "AudioDriver is not ready!" );
 		return true;
 	}
 
@@ -1017,13 +1569,13 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 
 	const auto pCompo = m_pPlaybackTrackInstrument->getComponents()->front();
 	if ( pCompo == nullptr ) {
-		ERRORLOG( "Invalid component of playback instrument" );
+		ERRORLOG_RT( "Invalid component of playback instrument" );
 		return true;
 	}
 
 	auto pSample = pCompo->getLayer(0)->getSample();
 	if ( pSample == nullptr ) {
-		ERRORLOG( "Unable to process playback track" );
+		ERRORLOG_RT( "Unable to process playback track" );
 		EventQueue::get_instance()->pushEvent( Event::Type::Error,
 												Hydrogen::ErrorMessages::PLAYBACK_TRACK_INVALID );
 		// Disable the playback track
@@ -1083,50 +1635,48 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 	return true;
 }
 
-bool Sampler::renderNoteResample(
-	std::shared_ptr<Sample> pSample,
-	std::shared_ptr<Note> pNote,
-	std::shared_ptr<SelectedLayerInfo> pSelectedLayerInfo,
-	std::shared_ptr<InstrumentComponent> pCompo,
-	int nComponentIdx,
-	int nBufferSize,
-	int nInitialBufferPos,
-	float fCost_L,
-	float fCost_R,
-	float fCostTrack_L,
-	float fCostTrack_R,
-	float fLayerPitch
-)
+void Sampler::renderLayer( LayerRenderJob& job, int nBufferSize )
 {
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pAudioDriver = pHydrogen->getAudioOutput();
-	auto pSong = pHydrogen->getSong();
+	const auto pNote = job.pNote;
+	const auto pSample = job.pSample;
+	const auto pSelectedLayerInfo = job.pSelectedLayerInfo;
+	const int nInitialBufferPos = job.nInitialBufferPos;
 
-	if ( pSong == nullptr ) {
-		ERRORLOG( "Invalid song" );
-		return true;
-	}
+	job.bRendered = false;
+	job.bEnded = true;
 
 	if ( pNote == nullptr ) {
-		ERRORLOG( "Invalid note" );
-		return true;
+		ERRORLOG_RT( "Invalid note" );
+		return;
 	}
 
 	if ( pAudioDriver == nullptr ) {
-		ERRORLOG( "AudioDriver is not ready!" );
-		return true;
+		ERRORLOG_RT( "AudioDriver is not ready!" );
+		return;
 	}
 
 	auto pInstrument = pNote->getInstrument();
 	if ( pInstrument == nullptr || pNote->getAdsr() == nullptr ) {
-		ERRORLOG( "Invalid note instrument" );
-		return true;
+		ERRORLOG_RT( "Invalid note instrument" );
+		return;
 	}
 
-	const float fNotePitch = pNote->getTotalPitch() + fLayerPitch;
+	const float fNotePitch = pNote->getTotalPitch() + job.fLayerPitch;
 	const bool bResample = fNotePitch != 0 ||
 		pSample->getSampleRate() != pAudioDriver->getSampleRate();
 
+	// Unpitched notes of samples recorded at a different rate than the
+	// one of the audio driver can be copied from a version converted in
+	// the background. Exports do not use it to stay deterministic.
+	const Sample::Resampled* pResampled = nullptr;
+	if ( fNotePitch == 0 && bResample &&
+		 ! pHydrogen->getIsExportSessionActive() ) {
+		pResampled = pSample->getResampled(
+			static_cast<int>(pAudioDriver->getSampleRate()) );
+	}
+
 	float fStep;
 	if ( bResample ){
 		fStep = Note::pitchToFrequency( fNotePitch );
@@ -1139,8 +1689,6 @@ bool Sampler::renderNoteResample(
 		fStep = 1;
 	}
 
-	auto pSample_data_L = pSample->getData_L();
-	auto pSample_data_R = pSample->getData_R();
 	const int nSampleFrames = pSample->getFrames();
 	// The number of frames of the sample left to process.
 	const int nRemainingFrames = static_cast<int>(
@@ -1198,10 +1746,10 @@ bool Sampler::renderNoteResample(
 				// In case resonance filtering is active the sampler stops
 				// rendering of the sample at the custom note length but lets
 				// the filter itself ring on.
-				ERRORLOG( QString( "Note end located within the previous processing cycle. nNoteEnd: %1, nNoteLength: %2, fSamplePosition: %3, nFinalBufferPos: %4, fStep: %5")
-						  .arg( nNoteEnd ).arg( pSelectedLayerInfo->nNoteLength )
-						  .arg( pSelectedLayerInfo->fSamplePosition )
-						  .arg( nFinalBufferPos ).arg( fStep ) );
+				ERRORLOG_RT( "Note end located within the previous processing cycle. nNoteEnd: %1, nNoteLength: %2, fSamplePosition: %3, nFinalBufferPos: %4, fStep: %5",
+							 nNoteEnd, pSelectedLayerInfo->nNoteLength,
+							 pSelectedLayerInfo->fSamplePosition,
+							 nFinalBufferPos, fStep );
 			}
 			nNoteEnd = 0;
 		}
@@ -1214,33 +1762,56 @@ bool Sampler::renderNoteResample(
 	}
 
 	auto pADSR = pNote->getAdsr();
-	float fVal_L;
-	float fVal_R;
-
-#ifdef H2CORE_HAVE_JACK
-	float* pTrackOutL = nullptr;
-	float* pTrackOutR = nullptr;
 
-	if ( Preferences::get_instance()->m_bJackTrackOuts ) {
-		auto pJackAudioDriver = dynamic_cast<JackAudioDriver*>( pAudioDriver );
-		if ( pJackAudioDriver != nullptr ) {
-			pTrackOutL = pJackAudioDriver->getTrackOut_L(
-				pInstrument, nComponentIdx );
-			pTrackOutR = pJackAudioDriver->getTrackOut_R(
-				pInstrument, nComponentIdx );
+	float* buffer_L = job.pBuffer_L;
+	float* buffer_R = job.pBuffer_R;
+
+	if ( pResampled != nullptr ) {
+		// Positions and lengths are still tracked in frames of the
+		// original sample.
+		const long long nResampledPos = std::min(
+			std::llround( fSamplePos * pResampled->nSampleRate /
+						  pSample->getSampleRate() ),
+			static_cast<long long>(pResampled->nFrames) );
+		copySample( &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+					pResampled->data_L.data(), pResampled->data_R.empty() ?
+					pResampled->data_L.data() : pResampled->data_R.data(),
+					nFinalBufferPos - nInitialBufferPos, nResampledPos, 1,
+					pResampled->nFrames );
+	}
+	else if ( pSample->isStreamed() ) {
+		if ( pSelectedLayerInfo->nStream == -1 &&
+			 fSamplePos < pSample->getHeadFrames() ) {
+			// Retried while the head is played. Voices not getting a
+			// stream in time fall silent after their head.
+			pSelectedLayerInfo->nStream = m_pSampleStreamer->acquire( pSample );
 		}
-	}
-#endif
-
-	float buffer_L[ nBufferSize ];
-	float buffer_R[ nBufferSize ];
-
-	if ( bResample ) {
+		renderStreamed( m_interpolateMode, m_pSampleStreamer,
+						pSelectedLayerInfo->nStream, pSample.get(),
+						&buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+						nFinalBufferPos - nInitialBufferPos, fSamplePos, fStep,
+						bResample );
+	}
+	else if ( pSample->getFormat() == ResampleKernels::Format::Int16 ) {
+		renderPacked<int16_t>( m_interpolateMode, pSample.get(),
+							   &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+							   nFinalBufferPos - nInitialBufferPos, fSamplePos,
+							   fStep, bResample );
+	}
+	else if ( pSample->getFormat() == ResampleKernels::Format::Int24 ) {
+		renderPacked<ResampleKernels::Int24>(
+			m_interpolateMode, pSample.get(),
+			&buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+			nFinalBufferPos - nInitialBufferPos, fSamplePos, fStep, bResample );
+	}
+	else if ( bResample ) {
 		resample( m_interpolateMode,
-				  &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ], pSample_data_L, pSample_data_R,
+				  &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+				  pSample->getData_L(), pSample->getData_R(),
 				  nFinalBufferPos - nInitialBufferPos, fSamplePos, fStep, nSampleFrames );
 	} else {
-		copySample( &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ], pSample_data_L, pSample_data_R,
+		copySample( &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+					pSample->getData_L(), pSample->getData_R(),
 					nFinalBufferPos - nInitialBufferPos, fSamplePos, fStep, nSampleFrames );
 	}
 
@@ -1251,17 +1822,84 @@ bool Sampler::renderNoteResample(
 
 	// Low pass resonant filter
 	if ( pInstrument->isFilterActive() ) {
+		pNote->applyFilter( &buffer_L[ nInitialBufferPos ],
+							&buffer_R[ nInitialBufferPos ],
+							nFinalBufferPos - nInitialBufferPos );
+	}
+
+	// Fade out of stolen voices. The gain refers to the beginning of the
+	// process cycle.
+	if ( job.fFadeStep > 0 ) {
 		for ( int nBufferPos = nInitialBufferPos; nBufferPos < nFinalBufferPos;
 			  ++nBufferPos ) {
+			const float fGain = std::max(
+				0.0f, job.fFadeGain - job.fFadeStep * ( nBufferPos + 1 ) );
+			buffer_L[ nBufferPos ] *= fGain;
+			buffer_R[ nBufferPos ] *= fGain;
+		}
+	}
+
+	if ( pInstrument->isFilterActive() && pNote->filterSustain() ) {
+		// Note is still ringing, do not end.
+		bRetValue = false;
+	}
+	
+	pSelectedLayerInfo->fSamplePosition += nAvail_bytes * fStep;
+
+	job.nFinalBufferPos = nFinalBufferPos;
+	job.bRendered = true;
+	job.bEnded = bRetValue;
+}
+
+void Sampler::mixLayer( const LayerRenderJob& job )
+{
+	if ( ! job.bRendered ) {
+		return;
+	}
+
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = pHydrogen->getSong();
+	auto pInstrument = job.pNote->getInstrument();
+	if ( pSong == nullptr || pInstrument == nullptr ) {
+		ERRORLOG_RT( "Invalid song or instrument" );
+		return;
+	}
 
-			fVal_L = buffer_L[ nBufferPos ];
-			fVal_R = buffer_R[ nBufferPos ];
+	const int nInitialBufferPos = job.nInitialBufferPos;
+	const int nFinalBufferPos = job.nFinalBufferPos;
+	const float* buffer_L = job.pBuffer_L;
+	const float* buffer_R = job.pBuffer_R;
+	const float fCost_L = job.fCost_L;
+	const float fCost_R = job.fCost_R;
+	float fVal_L;
+	float fVal_R;
 
-			pNote->computeLrValues( &fVal_L, &fVal_R );
+#ifdef H2CORE_HAVE_JACK
+	const float fCostTrack_L = job.fCostTrack_L;
+	const float fCostTrack_R = job.fCostTrack_R;
+	float* pTrackOutL = nullptr;
+	float* pTrackOutR = nullptr;
 
-			buffer_L[ nBufferPos ] = fVal_L;
-			buffer_R[ nBufferPos ] = fVal_R;
+	if ( Preferences::get_instance()->m_bJackTrackOuts ) {
+		auto pJackAudioDriver =
+			dynamic_cast<JackAudioDriver*>( pHydrogen->getAudioOutput() );
+		if ( pJackAudioDriver != nullptr ) {
+			pTrackOutL = pJackAudioDriver->getTrackOut_L(
+				pInstrument, job.nComponentIdx );
+			pTrackOutR = pJackAudioDriver->getTrackOut_R(
+				pInstrument, job.nComponentIdx );
+		}
+	}
+#endif
 
+	float* pStemOutL = nullptr;
+	float* pStemOutR = nullptr;
+	if ( m_nStemTracks > 0 ) {
+		const int nTrack = findStemTrack( pInstrument->getId(),
+										  job.nComponentIdx );
+		if ( nTrack >= 0 ) {
+			pStemOutL = getStemOut_L( nTrack );
+			pStemOutR = getStemOut_R( nTrack );
 		}
 	}
 
@@ -1292,25 +1930,22 @@ bool Sampler::renderNoteResample(
 		m_pMainOut_L[nBufferPos] += fVal_L;
 		m_pMainOut_R[nBufferPos] += fVal_R;
 
+		if ( pStemOutL ) {
+			pStemOutL[nBufferPos] += fVal_L;
+			pStemOutR[nBufferPos] += fVal_R;
+		}
+
 	}
 
 	// update instr peak
 	pInstrument->setPeak_L( std::max( pInstrument->getPeak_L(), fSamplePeak_L ) );
 	pInstrument->setPeak_R( std::max( pInstrument->getPeak_R(), fSamplePeak_R ) );
 
-	if ( pInstrument->isFilterActive() && pNote->filterSustain() ) {
-		// Note is still ringing, do not end.
-		bRetValue = false;
-	}
-	
-	pSelectedLayerInfo->fSamplePosition += nAvail_bytes * fStep;
-
-
 #ifdef H2CORE_HAVE_LADSPA
 	// LADSPA
 	// change the below return logic if you add code after that ifdef
 	if ( pInstrument->isMuted() || pSong->getIsMuted() ) {
-		return bRetValue;
+		return;
 	}
 	float masterVol = pSong->getVolume();
 	for ( unsigned nFX = 0; nFX < MAX_FX; ++nFX ) {
@@ -1326,7 +1961,7 @@ bool Sampler::renderNoteResample(
 			float fFXCost_R = fLevel * masterVol;
 
 			int nBufferPos = nInitialBufferPos;
-			for ( int i = 0; i < nAvail_bytes; ++i ) {
+			for ( int i = 0; i < nFinalBufferPos - nInitialBufferPos; ++i ) {
 
 				fVal_L = buffer_L[ nBufferPos ];
 				fVal_R = buffer_R[ nBufferPos ];
@@ -1338,45 +1973,65 @@ bool Sampler::renderNoteResample(
 		}
 	}
 #endif
-	return bRetValue;
 }
 
 void Sampler::stopPlayingNotes( std::shared_ptr<Instrument> pInstr )
 {
 	if ( pInstr != nullptr ) { // stop all notes using this instrument
-		for ( unsigned i = 0; i < m_playingNotesQueue.size(); ) {
-			auto pNote = m_playingNotesQueue[ i ];
-			assert( pNote );
-			if ( pNote != nullptr && pNote->getInstrument() == pInstr ) {
-				pInstr->dequeue( pNote );
-				m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
-			}
-			++i;
+		int nVoice = m_pVoiceTable->getFirstOfInstrument( pInstr.get() );
+		while ( nVoice != VoiceTable::nInvalid ) {
+			const int nNextVoice = m_pVoiceTable->getNextOfInstrument( nVoice );
+			removeVoice( nVoice );
+			nVoice = nNextVoice;
 		}
 	}
 	else { // stop all notes
-		// delete all copied notes in the playing notes queue
-		for ( unsigned i = 0; i < m_playingNotesQueue.size(); ++i ) {
-			auto pNote = m_playingNotesQueue[i];
-			if ( pNote != nullptr && pNote->getInstrument() != nullptr ) {
+		for ( int nVoice = m_pVoiceTable->getFirst();
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+			const auto& pNote = ( *m_pVoiceTable )[ nVoice ].pNote;
+			if ( pNote == nullptr ) {
+				continue;
+			}
+			if ( pNote->getInstrument() != nullptr ) {
 				pNote->getInstrument()->dequeue( pNote );
 			}
+			releaseStreams( pNote );
 		}
-		m_playingNotesQueue.clear();
+		m_pVoiceTable->clear();
+		m_nFadingVoices = 0;
 	}
 }
 
 void Sampler::releasePlayingNotes( std::shared_ptr<Instrument> pInstr )
 {
-	for ( auto ppNote : m_playingNotesQueue ) {
-		if ( ppNote == nullptr || ppNote->getInstrument() == nullptr ||
-			 ( pInstr == nullptr ||
-			 ( pInstr != nullptr && pInstr == ppNote->getInstrument() ) ) ) {
+	const int nFirstVoice = pInstr != nullptr ?
+		m_pVoiceTable->getFirstOfInstrument( pInstr.get() ) :
+		m_pVoiceTable->getFirst();
+	for ( int nVoice = nFirstVoice; nVoice != VoiceTable::nInvalid;
+		  nVoice = pInstr != nullptr ?
+			  m_pVoiceTable->getNextOfInstrument( nVoice ) :
+			  m_pVoiceTable->getNext( nVoice ) ) {
+		const auto& ppNote = ( *m_pVoiceTable )[ nVoice ].pNote;
+		if ( ppNote->getAdsr() != nullptr ) {
 			ppNote->getAdsr()->release();
 		}
 	}
 }
 
+void Sampler::fadeOutPlayingNotes( float fFadeTime )
+{
+	auto pAudioDriver = Hydrogen::get_instance()->getAudioOutput();
+	const int nSampleRate = pAudioDriver != nullptr ?
+		static_cast<int>(pAudioDriver->getSampleRate()) : 44100;
+
+	for ( int nVoice = m_pVoiceTable->getFirst();
+		  nVoice != VoiceTable::nInvalid;
+		  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+		fadeOutVoice( nVoice, nSampleRate, fFadeTime );
+	}
+}
+
 /// Preview, uses only the first layer
 void Sampler::previewSample(std::shared_ptr<Sample> pSample, int nLength )
 {
@@ -1400,8 +2055,9 @@ void Sampler::previewSample(std::shared_ptr<Sample> pSample, int nLength )
 
 		pLayer->setSample( pSample );
 
-		auto pPreviewNote = std::make_shared<Note>(
-			m_pPreviewInstrument, 0, VELOCITY_MAX, PAN_DEFAULT, nLength );
+		auto pPreviewNote = Hydrogen::get_instance()->getAudioEngine()->
+			getNotePool()->acquire( m_pPreviewInstrument, 0, VELOCITY_MAX,
+									PAN_DEFAULT, nLength );
 
 		stopPlayingNotes( m_pPreviewInstrument );
 		noteOn( pPreviewNote );
@@ -1432,8 +2088,9 @@ void Sampler::previewInstrument( std::shared_ptr<Instrument> pInstr )
 	m_pPreviewInstrument = pInstr;
 	pInstr->setIsPreviewInstrument(true);
 
-	auto pPreviewNote = std::make_shared<Note>(
-		m_pPreviewInstrument, 0, VELOCITY_MAX, PAN_DEFAULT, LENGTH_ENTIRE_SAMPLE );
+	auto pPreviewNote = Hydrogen::get_instance()->getAudioEngine()->
+		getNotePool()->acquire( m_pPreviewInstrument, 0, VELOCITY_MAX,
+								PAN_DEFAULT, LENGTH_ENTIRE_SAMPLE );
 
 	noteOn( pPreviewNote );	// exclusive note
 	Hydrogen::get_instance()->getAudioEngine()->unlock();
@@ -1442,10 +2099,12 @@ void Sampler::previewInstrument( std::shared_ptr<Instrument> pInstr )
 bool Sampler::isInstrumentPlaying( std::shared_ptr<Instrument> pInstrument ) const
 {
 	if ( pInstrument != nullptr ) { // stop all notes using this instrument
-		for ( unsigned j = 0; j < m_playingNotesQueue.size(); j++ ) {
-			if ( m_playingNotesQueue[ j ]->getInstrument() != nullptr &&
-				 pInstrument->getName() ==
-				 m_playingNotesQueue[ j ]->getInstrument()->getName() ) {
+		for ( int nVoice = m_pVoiceTable->getFirst();
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = m_pVoiceTable->getNext( nVoice ) ) {
+			const auto& pNote = ( *m_pVoiceTable )[ nVoice ].pNote;
+			if ( pNote->getInstrument() != nullptr &&
+				 pInstrument->getName() == pNote->getInstrument()->getName() ) {
 				return true;
 			}
 		}
@@ -1479,8 +2138,8 @@ QString Sampler::toQString( const QString& sPrefix, bool bShort ) const {
 	QString sOutput;
 	if ( ! bShort ) {
 		sOutput = QString( "%1[Sampler]\n" ).arg( sPrefix )
-			.append( QString( "%1%2m_playingNotesQueue: [\n" ).arg( sPrefix ).arg( s ) );
-		for ( const auto& ppNote : m_playingNotesQueue ) {
+			.append( QString( "%1%2m_pVoiceTable: [\n" ).arg( sPrefix ).arg( s ) );
+		for ( const auto& ppNote : getPlayingNotesQueue() ) {
 			sOutput.append( ppNote->toQString( sPrefix + s, bShort ) );
 		}
 		sOutput.append( QString( "]\n%1%2m_queuedNoteOffs: [\n" ).arg( sPrefix ).arg( s ) );
@@ -1500,12 +2159,17 @@ QString Sampler::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( "%1%2m_nPlayBackSamplePosition: %3\n" ).arg( sPrefix ).arg( s )
 					 .arg( m_nPlayBackSamplePosition ) )
 			.append( QString( "%1%2m_interpolateMode: %3\n" ).arg( sPrefix ).arg( s )
-					 .arg( Interpolation::ModeToQString( m_interpolateMode ) ) );
+					 .arg( Interpolation::ModeToQString( m_interpolateMode ) ) )
+			.append( QString( "%1%2m_nRenderThreads: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getRenderThreads() ) )
+			.append( QString( "%1%2m_nStemTracks: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nStemTracks ) )
+			.append( QString( "%1" ).arg( m_pSampleStreamer->toQString( sPrefix + s, bShort ) ) );
 	}
 	else {
 		sOutput = QString( "[Sampler] " )
-			.append( "m_playingNotesQueue: [" );
-		for ( const auto& ppNote : m_playingNotesQueue ) {
+			.append( "m_pVoiceTable: [" );
+		for ( const auto& ppNote : getPlayingNotesQueue() ) {
 			sOutput.append( QString( "[%1] " )
 							.arg( ppNote->prettyName() ) );
 		}
@@ -1527,7 +2191,12 @@ QString Sampler::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", m_nPlayBackSamplePosition: %1" )
 					 .arg( m_nPlayBackSamplePosition ) )
 			.append( QString( ", m_interpolateMode: %1" )
-					 .arg( Interpolation::ModeToQString( m_interpolateMode ) ) );
+					 .arg( Interpolation::ModeToQString( m_interpolateMode ) ) )
+			.append( QString( ", m_nRenderThreads: %1" )
+					 .arg( getRenderThreads() ) )
+			.append( QString( ", m_nStemTracks: %1" ).arg( m_nStemTracks ) )
+			.append( QString( ", m_pSampleStreamer: %1" )
+					 .arg( m_pSampleStreamer->toQString( "", bShort ) ) );
 	}
 
 	return sOutput;
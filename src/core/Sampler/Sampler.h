@@ -31,6 +31,7 @@
 #include <inttypes.h>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 namespace H2Core
 {
@@ -41,6 +42,9 @@ class Sample;
 class Instrument;
 class InstrumentComponent;
 class InstrumentLayer;
+class RenderThreadPool;
+class SampleStreamer;
+class VoiceTable;
 struct SelectedLayerInfo;
 
 ///
@@ -190,10 +194,15 @@ public:
 		 * @param pInstr particular instrument for which notes will be release
 		 *   (`nullptr` to release them all) */
 		void releasePlayingNotes( std::shared_ptr<Instrument> pInstr = nullptr );
+		/** Fades out all playing notes within @a fFadeTime seconds.
+		 * Notes already fading out faster keep their fade.
+		 *
+		 * Fading voices do not count towards Preferences::m_nMaxNotes.
+		 * Used to let the notes of a previous drumkit give way to the
+		 * ones of the new kit. */
+		void fadeOutPlayingNotes( float fFadeTime );
 
-	int getPlayingNotesNumber() const {
-		return m_playingNotesQueue.size();
-	}
+	int getPlayingNotesNumber() const;
 
 	void previewSample( std::shared_ptr<Sample> pSample, int length );
 	void previewInstrument( std::shared_ptr<Instrument> pInstr );
@@ -212,6 +221,56 @@ public:
 		return m_interpolateMode;
 	}
 
+	/**
+	 * Sets the number of threads used to render notes (including the
+	 * audio thread). Values larger than 1 render different notes in
+	 * parallel. The resulting audio is identical to the serial one.
+	 *
+	 * Must not be called from within the audio thread. The
+	 * #AudioEngine is locked while swapping the worker pool.
+	 */
+	void setRenderThreads( int nThreads );
+	int getRenderThreads() const;
+	/**
+	 * Sizes the staging buffers used to render notes in parallel
+	 * according to the buffer size @a nBufferSize of the audio driver.
+	 * Cycles with larger buffers are rendered serially.
+	 *
+	 * Must not be called from within the audio thread. The new
+	 * buffers are allocated and sized before they are published to it.
+	 * The #AudioEngine is not locked, as this is reached from the
+	 * buffer size callback of the JACK driver.
+	 */
+	void setBufferSize( unsigned nBufferSize );
+
+	/** Streams samples exceeding
+	 * Preferences::m_nSampleStreamingHead from disk. */
+	SampleStreamer* getSampleStreamer() const;
+
+	/** A single output of a stem export. */
+	struct StemTrack {
+		int nInstrumentId;
+		/** Index of the #InstrumentComponent or -1 to sum up all
+		 * components of the instrument. */
+		int nComponentIdx;
+	};
+	/**
+	 * Mixes every layer additionally into the output of the stem
+	 * track it belongs to. The contribution is the same as the one to
+	 * #m_pMainOut_L and #m_pMainOut_R. Neither the playback track nor
+	 * the returns of the LADSPA effects are part of any stem. An empty
+	 * @a tracks disables the stem outputs.
+	 *
+	 * Must not be called from within the audio thread. The
+	 * #AudioEngine is locked while swapping the buffers.
+	 */
+	void setStemTracks( const std::vector<StemTrack>& tracks );
+	int getStemTrackCount() const {
+		return m_nStemTracks;
+	}
+	float* getStemOut_L( int nTrack );
+	float* getStemOut_R( int nTrack );
+
 	/**
 	 * Loading of the playback track.
 	 *
@@ -237,7 +296,9 @@ public:
 
 		void clearLastUsedLayers();
 
-	const std::vector<std::shared_ptr<Note>>& getPlayingNotesQueue() const;
+	/** \return All notes currently rendered in the order they were
+	 * started. */
+	std::vector<std::shared_ptr<Note>> getPlayingNotesQueue() const;
 
 	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
 	
@@ -248,25 +309,96 @@ private:
 
 	bool processPlaybackTrack(int nBufferSize);
 
-    /** @return false - the note is not ended, true - the note is ended */
-	bool renderNote( std::shared_ptr<Note> pNote, unsigned nBufferSize );
-
-	bool renderNoteResample(
-		std::shared_ptr<Sample> pSample,
-		std::shared_ptr<Note> pNote,
-		std::shared_ptr<SelectedLayerInfo> pSelectedLayerInfo,
-		std::shared_ptr<InstrumentComponent> pCompo,
-		int nComponentIdx,
-		int nBufferSize,
-		int nInitialBufferPos,
-		float cost_L,
-		float cost_R,
-		float cost_track_L,
-		float cost_track_R,
-		float fLayerPitch
-	);
-
-	std::vector<std::shared_ptr<Note>> m_playingNotesQueue;
+	/**
+	 * A single layer of a note to be rendered in the current cycle.
+	 *
+	 * Rendering is split into three stages. Preparation - layer
+	 * selection, gains, and MIDI output - as well as mixing into the
+	 * output buffers are done serially in the order of the voices in
+	 * #m_pVoiceTable. The expensive part in between - resampling,
+	 * ADSR, and filter - only touches the note itself and can be done
+	 * for different notes in parallel. Since the order of summation into
+	 * the output buffers is fixed, the result does not depend on the
+	 * number of render threads.
+	 */
+	struct LayerRenderJob {
+		std::shared_ptr<Note> pNote;
+		std::shared_ptr<Sample> pSample;
+		std::shared_ptr<SelectedLayerInfo> pSelectedLayerInfo;
+		int nComponentIdx;
+		int nInitialBufferPos;
+		float fCost_L;
+		float fCost_R;
+		float fCostTrack_L;
+		float fCostTrack_R;
+		float fLayerPitch;
+		/** Fade out of stolen voices (see VoiceTable::Voice). */
+		float fFadeGain;
+		float fFadeStep;
+		/** Staging buffers holding the rendered frames. */
+		float* pBuffer_L;
+		float* pBuffer_R;
+
+		/** Set by renderLayer(). */
+		int nFinalBufferPos;
+		bool bRendered;
+		/** Whether the end of the layer was reached. */
+		bool bEnded;
+	};
+
+	/** All layers of a note within #m_layerRenderJobs. */
+	struct NoteRenderJob {
+		/** Index of the note within #m_pVoiceTable. */
+		int nVoice;
+		int nFirstLayer;
+		int nLayers;
+		/** Whether the note was completely rendered. */
+		bool bEnded;
+	};
+
+	/** Renders all notes in #m_pVoiceTable and stores whether they
+	 * ended in #m_noteRenderJobs. */
+	void renderNotes( unsigned nBufferSize );
+	/** Appends one #NoteRenderJob and all #LayerRenderJob of the note
+	 * in voice @a nVoice to be rendered in this cycle. */
+	void prepareNote( int nVoice, unsigned nBufferSize );
+	/** Resamples a layer into its staging buffer and applies ADSR and
+	 * filter. Only modifies the state of the job and its note. */
+	void renderLayer( LayerRenderJob& job, int nBufferSize );
+	/** Adds a rendered layer to the main, track, and FX outputs. */
+	void mixLayer( const LayerRenderJob& job );
+	/** Task executed by #m_pRenderThreadPool rendering all layers of
+	 * the @a nTask-th note. */
+	static void renderNoteTask( int nTask, void* pContext );
+	/** Allocates the staging buffers for rendering with @a nThreads
+	 * threads and buffers of size @a nBufferSize and publishes them
+	 * to the audio thread. */
+	void updateStagingBuffer( int nThreads, unsigned nBufferSize );
+
+	/** Picks a voice not fading out yet according to
+	 * Preferences::m_voiceStealing. Requires a scan of all voices but
+	 * is only done in case there are too many of them.
+	 *
+	 * \return VoiceTable::nInvalid if all voices are fading out. */
+	int findVoiceToSteal() const;
+	/** Makes voice @a nVoice fade out within @a fFadeTime seconds. */
+	void fadeOutVoice( int nVoice, int nSampleRate,
+					   float fFadeTime = fStealFadeTime );
+	/** Removes voice @a nVoice without fading it out. */
+	void removeVoice( int nVoice );
+	/** Hands all streams acquired by the layers of @a pNote back to
+	 * #m_pSampleStreamer. */
+	void releaseStreams( std::shared_ptr<Note> pNote );
+
+	/** Duration in seconds of the fade out applied to stolen voices. */
+	static constexpr float fStealFadeTime = 0.005;
+	/** Voices reserved for notes fading out after being stolen. */
+	static constexpr int nMaxFadingVoices = 64;
+
+	/** All notes currently rendered. */
+	VoiceTable* m_pVoiceTable;
+	/** Number of voices in #m_pVoiceTable fading out. */
+	int m_nFadingVoices;
 	std::vector<std::shared_ptr<Note>> m_queuedNoteOffs;
 
 	/// Instrument used for the playback track feature.
@@ -286,6 +418,63 @@ private:
 
 	Interpolation::InterpolateMode m_interpolateMode;
 
+	/** Used to render notes in parallel. `nullptr` in case just one
+	 * thread is used. */
+	RenderThreadPool* m_pRenderThreadPool;
+	SampleStreamer* m_pSampleStreamer;
+	/** Number of voices able to stream their sample at the same
+	 * time. Further ones only play the head of the sample. */
+	static constexpr int nMaxStreams = 64;
+	std::vector<NoteRenderJob> m_noteRenderJobs;
+	std::vector<LayerRenderJob> m_layerRenderJobs;
+	/** Staging buffer of #m_layerRenderJobs rendered serially. Holds
+	 * #MAX_BUFFER_SIZE frames per channel. */
+	std::vector<float> m_renderBuffer;
+	/** Staging buffers of #m_layerRenderJobs rendered in parallel. */
+	struct StagingBuffer {
+		/** Holds #nLayers layers of #nBufferSize frames per
+		 * channel. */
+		std::vector<float> data;
+		int nLayers = 0;
+		unsigned nBufferSize = 0;
+	};
+	/** Replaced as a whole when the number of render threads or the
+	 * buffer size of the driver changes. Accessed via
+	 * std::atomic_load() and std::atomic_exchange() only. */
+	std::shared_ptr<StagingBuffer> m_pStagingBuffer;
+	/** Previous staging buffers possibly still used by the audio
+	 * thread. They are freed by the next updateStagingBuffer() once
+	 * they are not referenced anymore. Guarded by
+	 * #m_stagingBufferMutex. */
+	std::vector<std::shared_ptr<StagingBuffer>> m_retiredStagingBuffers;
+	std::mutex m_stagingBufferMutex;
+	/** Number of layers staged per render thread. Notes exceeding
+	 * the resulting capacity are rendered serially. */
+	static constexpr int nStagedLayersPerThread = 64;
+	/** Buffer size of the current cycle, used by renderNoteTask(). */
+	unsigned m_nRenderBufferSize;
+
+	/** Output buffers of all stem tracks. Each track holds
+	 * #MAX_BUFFER_SIZE frames of the left followed by those of the
+	 * right channel. */
+	std::vector<float> m_stemBuffer;
+	int m_nStemTracks;
+	/** Stem track of an instrument id and component index. */
+	struct StemTrackEntry {
+		int nInstrumentId;
+		/** -1 for all components of the instrument. */
+		int nComponentIdx;
+		int nTrack;
+	};
+	/** All stem tracks sorted by instrument id and component index.
+	 * In contrast to JackAudioDriver::m_trackMap it is not indexed by
+	 * instrument id and thus not bound to #MAX_INSTRUMENTS. Empty in
+	 * case no stems are rendered. */
+	std::vector<StemTrackEntry> m_stemTrackMap;
+	/** @return stem track of the provided instrument component or -1.
+	 * Neither locks nor allocates. */
+	int findStemTrack( int nInstrumentId, int nComponentIdx ) const;
+
 		/** In order to allow for all layers in an #H2Core::InstrumentComponent
 		 * to be selected in a round robin scheme consistently, we keep track of
 		 * which layer was last used by which component. It's important to flush
@@ -294,14 +483,32 @@ private:
 				  std::shared_ptr<InstrumentLayer> > m_lastUsedLayersMap;
 };
 
-inline const std::vector<std::shared_ptr<Note>>& Sampler::getPlayingNotesQueue() const {
-	return m_playingNotesQueue;
+inline SampleStreamer* Sampler::getSampleStreamer() const {
+	return m_pSampleStreamer;
 }
-
 inline void Sampler::clearLastUsedLayers() {
 	m_lastUsedLayersMap.clear();
 }
 
+/** Resamples @a nFrames frames starting at @a fSamplePos of sample
+ * data holding @a nSampleFrames frames into @a pBuffer_L and @a
+ * pBuffer_R. Frames outside of the sample data are treated as
+ * silence. @a fSamplePos is advanced accordingly. */
+void resample( Interpolation::InterpolateMode mode,
+			   float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+			   float *__restrict__ pSample_data_L, float *__restrict__ pSample_data_R,
+			   int nFrames, double &fSamplePos, float fStep, int nSampleFrames );
+
+/** Like resample() but for samples only partially held in memory (see
+ * Sample::isStreamed()). Frames beyond the head are read from stream
+ * @a nStream of @a pStreamer. Copies the frames in case @a bResample
+ * is false. */
+void renderStreamed( Interpolation::InterpolateMode mode,
+					 SampleStreamer* pStreamer, int nStream,
+					 const Sample* pSample,
+					 float *__restrict__ pBuffer_L, float *__restrict__ pBuffer_R,
+					 int nFrames, double fSamplePos, float fStep, bool bResample );
+
 } // namespace
 
 #endif
@@ -0,0 +1,272 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/VoiceTable.h>
+
+#include <algorithm>
+
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
+
+namespace H2Core
+{
+
+void VoiceTable::Index::init( int nMaxKeys ) {
+	size_t nSize = 1;
+	while ( nSize < 2 * static_cast<size_t>(std::max( nMaxKeys, 1 )) ) {
+		nSize <<= 1;
+	}
+	m_entries.assign( nSize, { 0, nInvalid } );
+	m_nMask = nSize - 1;
+}
+
+size_t VoiceTable::Index::home( uint64_t nKey ) const {
+	// Fibonacci hashing. Spreads pointers, which share their lower
+	// bits due to alignment, as well as small integers.
+	return static_cast<size_t>(
+		( nKey * UINT64_C( 0x9E3779B97F4A7C15 ) ) >> 32 ) & m_nMask;
+}
+
+size_t VoiceTable::Index::locate( uint64_t nKey ) const {
+	size_t nPos = home( nKey );
+	while ( m_entries[ nPos ].nVoice != nInvalid &&
+			m_entries[ nPos ].nKey != nKey ) {
+		nPos = ( nPos + 1 ) & m_nMask;
+	}
+	return nPos;
+}
+
+int VoiceTable::Index::find( uint64_t nKey ) const {
+	return m_entries[ locate( nKey ) ].nVoice;
+}
+
+void VoiceTable::Index::set( uint64_t nKey, int nVoice ) {
+	auto& entry = m_entries[ locate( nKey ) ];
+	entry.nKey = nKey;
+	entry.nVoice = nVoice;
+}
+
+void VoiceTable::Index::erase( uint64_t nKey ) {
+	size_t nHole = locate( nKey );
+	if ( m_entries[ nHole ].nVoice == nInvalid ) {
+		return;
+	}
+
+	// Backward shift deletion. All following entries of the same
+	// probing sequence which would become unreachable are moved into
+	// the hole.
+	size_t nPos = nHole;
+	while ( true ) {
+		nPos = ( nPos + 1 ) & m_nMask;
+		if ( m_entries[ nPos ].nVoice == nInvalid ) {
+			break;
+		}
+		const size_t nHome = home( m_entries[ nPos ].nKey );
+		const bool bReachable = nHole <= nPos ?
+			( nHole < nHome && nHome <= nPos ) :
+			( nHole < nHome || nHome <= nPos );
+		if ( ! bReachable ) {
+			m_entries[ nHole ] = m_entries[ nPos ];
+			nHole = nPos;
+		}
+	}
+	m_entries[ nHole ].nVoice = nInvalid;
+}
+
+void VoiceTable::Index::clear() {
+	for ( auto& entry : m_entries ) {
+		entry.nVoice = nInvalid;
+	}
+}
+
+VoiceTable::VoiceTable( int nCapacity )
+	: m_nFirst( nInvalid )
+	, m_nLast( nInvalid )
+	, m_nFree( nInvalid )
+	, m_nSize( 0 )
+{
+	m_voices.resize( std::max( nCapacity, 1 ) );
+	m_instrumentIndex.init( getCapacity() );
+	m_muteGroupIndex.init( getCapacity() );
+	clear();
+}
+
+int VoiceTable::add( std::shared_ptr<Note> pNote ) {
+	if ( isFull() || pNote == nullptr || pNote->getInstrument() == nullptr ) {
+		return nInvalid;
+	}
+
+	const int nVoice = m_nFree;
+	auto& voice = m_voices[ nVoice ];
+	m_nFree = voice.nNext;
+
+	voice.pNote = pNote;
+	voice.pInstrument = pNote->getInstrument().get();
+	voice.nMuteGroup = pNote->getInstrument()->getMuteGroup();
+	voice.fFadeGain = 1.0;
+	voice.fFadeStep = 0.0;
+
+	voice.nPrev = m_nLast;
+	voice.nNext = nInvalid;
+	if ( m_nLast != nInvalid ) {
+		m_voices[ m_nLast ].nNext = nVoice;
+	} else {
+		m_nFirst = nVoice;
+	}
+	m_nLast = nVoice;
+
+	link( m_instrumentIndex, instrumentKey( voice.pInstrument ), nVoice,
+		  &Voice::nPrevOfInstrument, &Voice::nNextOfInstrument );
+
+	voice.nPrevOfMuteGroup = nInvalid;
+	voice.nNextOfMuteGroup = nInvalid;
+	if ( voice.nMuteGroup != -1 ) {
+		link( m_muteGroupIndex, static_cast<uint64_t>(voice.nMuteGroup), nVoice,
+			  &Voice::nPrevOfMuteGroup, &Voice::nNextOfMuteGroup );
+	}
+
+	++m_nSize;
+
+	return nVoice;
+}
+
+void VoiceTable::link( Index& index, uint64_t nKey, int nVoice,
+						int Voice::* pPrev, int Voice::* pNext ) {
+	auto& voice = m_voices[ nVoice ];
+	voice.*pNext = nInvalid;
+
+	const int nHead = index.find( nKey );
+	if ( nHead == nInvalid ) {
+		voice.*pPrev = nVoice;
+		index.set( nKey, nVoice );
+		return;
+	}
+
+	// The head of the list points back to its tail.
+	const int nTail = m_voices[ nHead ].*pPrev;
+	m_voices[ nTail ].*pNext = nVoice;
+	voice.*pPrev = nTail;
+	m_voices[ nHead ].*pPrev = nVoice;
+}
+
+void VoiceTable::unlink( Index& index, uint64_t nKey, int nVoice,
+						  int Voice::* pPrev, int Voice::* pNext ) {
+	auto& voice = m_voices[ nVoice ];
+	const int nHead = index.find( nKey );
+
+	if ( nVoice == nHead ) {
+		if ( voice.*pNext == nInvalid ) {
+			index.erase( nKey );
+		}
+		else {
+			m_voices[ voice.*pNext ].*pPrev = voice.*pPrev;
+			index.set( nKey, voice.*pNext );
+		}
+	}
+	else {
+		m_voices[ voice.*pPrev ].*pNext = voice.*pNext;
+		if ( voice.*pNext != nInvalid ) {
+			m_voices[ voice.*pNext ].*pPrev = voice.*pPrev;
+		}
+		else {
+			m_voices[ nHead ].*pPrev = voice.*pPrev;
+		}
+	}
+
+	voice.*pPrev = nInvalid;
+	voice.*pNext = nInvalid;
+}
+
+void VoiceTable::remove( int nVoice ) {
+	if ( nVoice < 0 || nVoice >= getCapacity() ||
+		 m_voices[ nVoice ].pNote == nullptr ) {
+		return;
+	}
+	auto& voice = m_voices[ nVoice ];
+
+	if ( voice.nPrev != nInvalid ) {
+		m_voices[ voice.nPrev ].nNext = voice.nNext;
+	} else {
+		m_nFirst = voice.nNext;
+	}
+	if ( voice.nNext != nInvalid ) {
+		m_voices[ voice.nNext ].nPrev = voice.nPrev;
+	} else {
+		m_nLast = voice.nPrev;
+	}
+
+	unlink( m_instrumentIndex, instrumentKey( voice.pInstrument ), nVoice,
+			&Voice::nPrevOfInstrument, &Voice::nNextOfInstrument );
+	if ( voice.nMuteGroup != -1 ) {
+		unlink( m_muteGroupIndex, static_cast<uint64_t>(voice.nMuteGroup),
+				nVoice, &Voice::nPrevOfMuteGroup, &Voice::nNextOfMuteGroup );
+	}
+
+	voice.pNote = nullptr;
+	voice.pInstrument = nullptr;
+	voice.nPrev = nInvalid;
+	voice.nNext = m_nFree;
+	m_nFree = nVoice;
+
+	--m_nSize;
+}
+
+void VoiceTable::clear() {
+	for ( int ii = 0; ii < getCapacity(); ++ii ) {
+		auto& voice = m_voices[ ii ];
+		voice.pNote = nullptr;
+		voice.pInstrument = nullptr;
+		voice.nMuteGroup = -1;
+		voice.fFadeGain = 1.0;
+		voice.fFadeStep = 0.0;
+		voice.nPrev = nInvalid;
+		voice.nNext = ii + 1 < getCapacity() ? ii + 1 : nInvalid;
+		voice.nPrevOfInstrument = nInvalid;
+		voice.nNextOfInstrument = nInvalid;
+		voice.nPrevOfMuteGroup = nInvalid;
+		voice.nNextOfMuteGroup = nInvalid;
+	}
+	m_nFree = 0;
+	m_nFirst = nInvalid;
+	m_nLast = nInvalid;
+	m_nSize = 0;
+	m_instrumentIndex.clear();
+	m_muteGroupIndex.clear();
+}
+
+QString VoiceTable::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[VoiceTable]\n" ).arg( sPrefix )
+			.append( QString( "%1%2m_nSize: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_nSize ) )
+			.append( QString( "%1%2capacity: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( getCapacity() ) );
+	}
+	else {
+		sOutput = QString( "[VoiceTable] m_nSize: %1" ).arg( m_nSize )
+			.append( QString( ", capacity: %1" ).arg( getCapacity() ) );
+	}
+	return sOutput;
+}
+
+};
@@ -0,0 +1,209 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_VOICE_TABLE_H
+#define H2C_VOICE_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+class Instrument;
+class Note;
+
+/**
+ * Fixed capacity table of all notes currently rendered by the
+ * #Sampler.
+ *
+ * Voices are stored in slots which are never moved. Free slots as well
+ * as active voices are chained using intrusive lists. In addition to
+ * the list of all voices - ordered by the time they were added - there
+ * is one list per instrument and one per mute group. Adding and
+ * removing voices as well as accessing all voices of an instrument or
+ * mute group is thus done without scanning the whole table and without
+ * allocating any memory after construction.
+ *
+ * Must only be accessed while holding the lock of the #AudioEngine.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class VoiceTable : public H2Core::Object<VoiceTable>
+{
+	H2_OBJECT(VoiceTable)
+public:
+	/** Marks the end of a list. */
+	static constexpr int nInvalid = -1;
+
+	struct Voice {
+		std::shared_ptr<Note> pNote;
+		/** Instrument the voice was indexed with. */
+		const Instrument* pInstrument;
+		/** Mute group the voice was indexed with. -1 if none. */
+		int nMuteGroup;
+		/** Gain applied at the beginning of the next process cycle.
+		 * Stolen voices fade out linearly till it reaches zero. */
+		float fFadeGain;
+		/** Decrement of #fFadeGain per frame. 0 in case the voice was
+		 * not stolen. */
+		float fFadeStep;
+
+		int nPrev;
+		int nNext;
+		/** For the first voice of an instrument or mute group this is
+		 * the last one. See link(). */
+		int nPrevOfInstrument;
+		int nNextOfInstrument;
+		int nPrevOfMuteGroup;
+		int nNextOfMuteGroup;
+	};
+
+	VoiceTable( int nCapacity );
+
+	/**
+	 * Adds @a pNote as the most recent voice.
+	 *
+	 * \return Index of the new voice or #nInvalid in case the table is
+	 *   full or @a pNote has no instrument.
+	 */
+	int add( std::shared_ptr<Note> pNote );
+	void remove( int nVoice );
+	void clear();
+
+	int size() const;
+	int getCapacity() const;
+	bool isFull() const;
+
+	/** \return Oldest voice or #nInvalid if the table is empty. */
+	int getFirst() const;
+	/** \return Voice added after @a nVoice. */
+	int getNext( int nVoice ) const;
+	/** Like getFirst() but restricted to the voices of
+	 * @a pInstrument. */
+	int getFirstOfInstrument( const Instrument* pInstrument ) const;
+	int getNextOfInstrument( int nVoice ) const;
+	int getFirstOfMuteGroup( int nMuteGroup ) const;
+	int getNextOfMuteGroup( int nVoice ) const;
+
+	Voice& operator[]( int nVoice );
+	const Voice& operator[]( int nVoice ) const;
+
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	/**
+	 * Maps keys onto the first voice of the associated list.
+	 *
+	 * Uses open addressing with linear probing in a table at least
+	 * twice as large as the maximum number of keys. Since there can
+	 * not be more distinct keys than voices, it never has to grow.
+	 */
+	class Index {
+	public:
+		void init( int nMaxKeys );
+		int find( uint64_t nKey ) const;
+		void set( uint64_t nKey, int nVoice );
+		void erase( uint64_t nKey );
+		void clear();
+
+	private:
+		struct Entry {
+			uint64_t nKey;
+			/** #nInvalid for empty entries. */
+			int nVoice;
+		};
+		size_t home( uint64_t nKey ) const;
+		size_t locate( uint64_t nKey ) const;
+
+		std::vector<Entry> m_entries;
+		size_t m_nMask;
+	};
+
+	static uint64_t instrumentKey( const Instrument* pInstrument );
+
+	/** Appends @a nVoice to the list stored for @a nKey in @a index.
+	 *
+	 * The lists are ordered by the time voices were added. To append in
+	 * constant time, the previous voice of the head is the tail of the
+	 * list. */
+	void link( Index& index, uint64_t nKey, int nVoice,
+			   int Voice::* pPrev, int Voice::* pNext );
+	void unlink( Index& index, uint64_t nKey, int nVoice,
+				 int Voice::* pPrev, int Voice::* pNext );
+
+	std::vector<Voice> m_voices;
+	int m_nFirst;
+	int m_nLast;
+	/** Head of the list of unused slots chained via Voice::nNext. */
+	int m_nFree;
+	int m_nSize;
+
+	Index m_instrumentIndex;
+	Index m_muteGroupIndex;
+};
+
+inline int VoiceTable::size() const {
+	return m_nSize;
+}
+inline int VoiceTable::getCapacity() const {
+	return static_cast<int>(m_voices.size());
+}
+inline bool VoiceTable::isFull() const {
+	return m_nFree == nInvalid;
+}
+inline int VoiceTable::getFirst() const {
+	return m_nFirst;
+}
+inline int VoiceTable::getNext( int nVoice ) const {
+	return m_voices[ nVoice ].nNext;
+}
+inline int VoiceTable::getFirstOfInstrument( const Instrument* pInstrument ) const {
+	return m_instrumentIndex.find( instrumentKey( pInstrument ) );
+}
+inline int VoiceTable::getNextOfInstrument( int nVoice ) const {
+	return m_voices[ nVoice ].nNextOfInstrument;
+}
+inline int VoiceTable::getFirstOfMuteGroup( int nMuteGroup ) const {
+	if ( nMuteGroup == -1 ) {
+		return nInvalid;
+	}
+	return m_muteGroupIndex.find( static_cast<uint64_t>(nMuteGroup) );
+}
+inline int VoiceTable::getNextOfMuteGroup( int nVoice ) const {
+	return m_voices[ nVoice ].nNextOfMuteGroup;
+}
+inline VoiceTable::Voice& VoiceTable::operator[]( int nVoice ) {
+	return m_voices[ nVoice ];
+}
+inline const VoiceTable::Voice& VoiceTable::operator[]( int nVoice ) const {
+	return m_voices[ nVoice ];
+}
+inline uint64_t VoiceTable::instrumentKey( const Instrument* pInstrument ) {
+	return static_cast<uint64_t>( reinterpret_cast<uintptr_t>(pInstrument) );
+}
+
+};
+
+#endif // H2C_VOICE_TABLE_H
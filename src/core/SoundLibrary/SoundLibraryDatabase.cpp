@@ -23,22 +23,59 @@
 #include <map>
 #include <set>
 
+#include <QFileInfo>
+
 #include <core/SoundLibrary/SoundLibraryDatabase.h>
 
 #include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
 #include <core/Basics/Song.h>
 #include <core/EventQueue.h>
 #include <core/Helpers/Filesystem.h>
+#include <core/Helpers/Parallel.h>
 #include <core/Helpers/Xml.h>
 #include <core/Hydrogen.h>
+#include <core/Version.h>
 
 namespace H2Core
 {
 
 QString SoundLibraryDatabase::m_sPatternBaseCategory = "not_categorized";
 
+std::shared_ptr<DrumkitMap> SoundLibraryDatabase::DrumkitEntry::toDrumkitMap() const {
+	auto pMap = std::make_shared<DrumkitMap>();
+
+	for ( const auto& instrument : instruments ) {
+		if ( ! instrument.sType.isEmpty() ) {
+			if ( ! pMap->addMapping( instrument.nId, instrument.sType ) ) {
+				___ERRORLOG( QString( "Unable to add type [%1] for instrument (id: %2, name: %3)" )
+							 .arg( instrument.sType ).arg( instrument.nId )
+							 .arg( instrument.sName ) );
+			}
+		}
+	}
+
+	return pMap;
+}
+
+std::set<DrumkitMap::Type> SoundLibraryDatabase::DrumkitEntry::getAllTypes() const {
+	std::set<DrumkitMap::Type> types;
+
+	for ( const auto& instrument : instruments ) {
+		if ( ! instrument.sType.isEmpty() ) {
+			types.insert( instrument.sType );
+		}
+	}
+
+	return types;
+}
+
 SoundLibraryDatabase::SoundLibraryDatabase()
+	: m_pDrumkitEntries( std::make_shared<DrumkitEntries>() )
+	, m_bIndexChanged( false )
 {
+	loadIndex();
 	update();
 }
 
@@ -78,7 +115,14 @@ void SoundLibraryDatabase::update()
 
 void SoundLibraryDatabase::updateDrumkits( bool bTriggerEvent ) {
 
-	m_drumkitDatabase.clear();
+	std::lock_guard<std::mutex> updateLock( m_updateMutex );
+
+	QStringList customDrumkitPaths, customDrumkitFolders;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		customDrumkitPaths = m_customDrumkitPaths;
+		customDrumkitFolders = m_customDrumkitFolders;
+	}
 
 	QStringList drumkitPaths;
 	// system drumkits
@@ -92,7 +136,7 @@ void SoundLibraryDatabase::updateDrumkits( bool bTriggerEvent ) {
 			Filesystem::absolute_path( Filesystem::usr_drumkits_dir() + sDrumkitName );
 	}
 	// custom drumkits added by the user
-	for ( const auto& sDrumkitPath : m_customDrumkitPaths ) {
+	for ( const auto& sDrumkitPath : customDrumkitPaths ) {
 		if ( ! drumkitPaths.contains( sDrumkitPath ) ) {
 			drumkitPaths << sDrumkitPath;
 		}
@@ -101,33 +145,110 @@ void SoundLibraryDatabase::updateDrumkits( bool bTriggerEvent ) {
 	// search custom drumkit folders for valid kits. Be careful not to add
 	// directories, which do not correspond to drumkits. This would lead to a
 	// lot of false positive error messages.
-	for ( const auto& sDrumkitFolder : m_customDrumkitFolders ) {
+	for ( const auto& sDrumkitFolder : customDrumkitFolders ) {
 		for ( const auto& sDrumkitName : Filesystem::drumkit_list( sDrumkitFolder ) ) {
 			drumkitPaths << QDir( sDrumkitFolder ).absoluteFilePath( sDrumkitName );
 		}
 	}
 
-	for ( const auto& sDrumkitPath : drumkitPaths ) {
-		auto pDrumkit = Drumkit::load( sDrumkitPath );
-		if ( pDrumkit != nullptr ) {
-			if ( m_drumkitDatabase.find( sDrumkitPath ) !=
-				 m_drumkitDatabase.end() ) {
-				ERRORLOG( QString( "A drumkit was already loaded from [%1]. Something went wrong." )
-						  .arg( sDrumkitPath ) );
-				continue;
+	// Only kits not indexed yet or altered since have to be parsed.
+	std::vector<std::shared_ptr<const DrumkitEntry>> entries( drumkitPaths.size() );
+	std::vector<std::shared_ptr<Drumkit>> drumkits( drumkitPaths.size() );
+	std::vector<qint64> modificationTimes( drumkitPaths.size() );
+	for ( int ii = 0; ii < drumkitPaths.size(); ++ii ) {
+		modificationTimes[ ii ] = getModificationTime(
+			Filesystem::drumkit_file( drumkitPaths[ ii ] ) );
+	}
+	std::vector<int> outdatedKits;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for ( int ii = 0; ii < drumkitPaths.size(); ++ii ) {
+			const auto search = m_drumkitIndex.find( drumkitPaths[ ii ] );
+			if ( search != m_drumkitIndex.end() &&
+				 search->second->nModified == modificationTimes[ ii ] ) {
+				entries[ ii ] = search->second;
 			}
+			else {
+				outdatedKits.push_back( ii );
+			}
+		}
+	}
+
+	Parallel::forEach( outdatedKits.size(), [&]( int nTask ) {
+		const int nKit = outdatedKits[ nTask ];
+		drumkits[ nKit ] = Drumkit::load( drumkitPaths[ nKit ] );
+		if ( drumkits[ nKit ] != nullptr ) {
+			entries[ nKit ] = createEntry( drumkits[ nKit ] );
+		}
+	} );
+
+	auto pDrumkitEntries = std::make_shared<DrumkitEntries>();
+	std::map<QString, std::shared_ptr<Drumkit>> drumkitDatabase;
+	for ( int ii = 0; ii < drumkitPaths.size(); ++ii ) {
+		const auto& sDrumkitPath = drumkitPaths[ ii ];
+		const auto pEntry = entries[ ii ];
+		if ( pEntry == nullptr ) {
+			ERRORLOG( QString( "Unable to load drumkit at [%1]" ).arg( sDrumkitPath ) );
+			continue;
+		}
+
+		if ( pDrumkitEntries->find( sDrumkitPath ) != pDrumkitEntries->end() ) {
+			ERRORLOG( QString( "A drumkit was already loaded from [%1]. Something went wrong." )
+					  .arg( sDrumkitPath ) );
+			continue;
+		}
 
+		if ( drumkits[ ii ] != nullptr ) {
 			INFOLOG( QString( "Drumkit [%1] loaded from [%2]" )
-					 .arg( pDrumkit->getName() ).arg( sDrumkitPath ) );
+					 .arg( pEntry->sName ).arg( sDrumkitPath ) );
 
-			m_drumkitDatabase[ sDrumkitPath ] = pDrumkit;
-			registerUniqueLabel( sDrumkitPath, pDrumkit );
+			// Kits had to be loaded anyway. No need to parse them again
+			// on the next getDrumkit().
+			drumkitDatabase[ sDrumkitPath ] = drumkits[ ii ];
 		}
-		else {
-			ERRORLOG( QString( "Unable to load drumkit at [%1]" ).arg( sDrumkitPath ) );
+
+		( *pDrumkitEntries )[ sDrumkitPath ] = pEntry;
+	}
+
+	INFOLOG( QString( "[%1] drumkits found. [%2] of them had to be parsed." )
+			 .arg( pDrumkitEntries->size() ).arg( outdatedKits.size() ) );
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		// Session kits added by other threads while we were scanning.
+		for ( const auto& sDrumkitPath : m_customDrumkitPaths ) {
+			if ( customDrumkitPaths.contains( sDrumkitPath ) ) {
+				continue;
+			}
+			const auto search = m_pDrumkitEntries->find( sDrumkitPath );
+			if ( search != m_pDrumkitEntries->end() ) {
+				( *pDrumkitEntries )[ sDrumkitPath ] = search->second;
+			}
+			const auto searchDrumkit = m_drumkitDatabase.find( sDrumkitPath );
+			if ( searchDrumkit != m_drumkitDatabase.end() ) {
+				drumkitDatabase[ sDrumkitPath ] = searchDrumkit->second;
+			}
+		}
+
+		for ( const int nnKit : outdatedKits ) {
+			if ( entries[ nnKit ] != nullptr ) {
+				m_drumkitIndex[ drumkitPaths[ nnKit ] ] = entries[ nnKit ];
+				m_bIndexChanged = true;
+			}
+		}
+
+		m_pDrumkitEntries = pDrumkitEntries;
+		m_drumkitDatabase.swap( drumkitDatabase );
+
+		m_drumkitUniqueLabels.clear();
+		for ( const auto& [ _, ppEntry ] : *m_pDrumkitEntries ) {
+			registerUniqueLabel( ppEntry );
 		}
 	}
 
+	saveIndex();
+
 	if ( bTriggerEvent ) {
 		EventQueue::get_instance()->pushEvent( Event::Type::SoundLibraryChanged, 0 );
 	}
@@ -137,8 +258,8 @@ void SoundLibraryDatabase::updateDrumkit( const QString& sDrumkitPath, bool bTri
 
 	auto pDrumkit = Drumkit::load( sDrumkitPath );
 	if ( pDrumkit != nullptr ) {
-		m_drumkitDatabase[ sDrumkitPath ] = pDrumkit;
-		registerUniqueLabel( sDrumkitPath, pDrumkit );
+		addDrumkit( pDrumkit );
+		saveIndex();
 	}
 	else {
 		ERRORLOG( QString( "Unable to load drumkit at [%1]" ).arg( sDrumkitPath ) );
@@ -175,34 +296,77 @@ std::shared_ptr<Drumkit> SoundLibraryDatabase::getDrumkit( const QString& sDrumk
 		return nullptr;
 	}
 
-	if ( m_drumkitDatabase.find( sDrumkitPath ) ==
-		 m_drumkitDatabase.end() ) {
+	bool bIndexed;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		const auto search = m_drumkitDatabase.find( sDrumkitPath );
+		if ( search != m_drumkitDatabase.end() ) {
+			return search->second;
+		}
+		bIndexed = m_pDrumkitEntries->find( sDrumkitPath ) !=
+			m_pDrumkitEntries->end();
+	}
 
-		// Drumkit is not present in database yet. We attempt to load
-		// and add it.
+	if ( bIndexed ) {
+		// Drumkit is known by its index entry only. Loading is done
+		// without holding the lock in order to not block other threads
+		// retrieving kits.
 		auto pDrumkit = Drumkit::load( sDrumkitPath, bUpgrade, false /*bSilent*/ );
 		if ( pDrumkit == nullptr ) {
+			ERRORLOG( QString( "Unable to load drumkit at [%1]" ).arg( sDrumkitPath ) );
 			return nullptr;
 		}
 
-		m_customDrumkitPaths << sDrumkitPath;
+		std::lock_guard<std::mutex> lock( m_mutex );
+		// Another thread might have been faster.
+		const auto [ it, bInserted ] =
+			m_drumkitDatabase.insert( { sDrumkitPath, pDrumkit } );
+		if ( bInserted ) {
+			INFOLOG( QString( "Drumkit [%1] loaded from [%2]" )
+					 .arg( pDrumkit->getName() ).arg( sDrumkitPath ) );
+		}
+
+		return it->second;
+	}
 
-		m_drumkitDatabase[ sDrumkitPath ] = pDrumkit;
-		registerUniqueLabel( sDrumkitPath, pDrumkit );
-		
-		INFOLOG( QString( "Session Drumkit [%1] loaded from [%2]" )
-				  .arg( pDrumkit->getName() )
-				  .arg( sDrumkitPath ) );
+	// Drumkit is not present in database yet. We attempt to load
+	// and add it.
+	auto pDrumkit = Drumkit::load( sDrumkitPath, bUpgrade, false /*bSilent*/ );
+	if ( pDrumkit == nullptr ) {
+		return nullptr;
+	}
 
-		EventQueue::get_instance()->pushEvent( Event::Type::SoundLibraryChanged, 0 );
-		
-		return pDrumkit;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if ( ! m_customDrumkitPaths.contains( sDrumkitPath ) ) {
+			m_customDrumkitPaths << sDrumkitPath;
+		}
 	}
-	
-	return m_drumkitDatabase.at( sDrumkitPath );
+
+	addDrumkit( pDrumkit );
+	saveIndex();
+
+	INFOLOG( QString( "Session Drumkit [%1] loaded from [%2]" )
+			 .arg( pDrumkit->getName() )
+			 .arg( sDrumkitPath ) );
+
+	EventQueue::get_instance()->pushEvent( Event::Type::SoundLibraryChanged, 0 );
+
+	return pDrumkit;
+}
+
+std::shared_ptr<const SoundLibraryDatabase::DrumkitEntries> SoundLibraryDatabase::getDrumkitEntries() const {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_pDrumkitEntries;
 }
 
-std::shared_ptr<Drumkit> SoundLibraryDatabase::getPreviousDrumkit() const {
+bool SoundLibraryDatabase::isDrumkitLoaded( const QString& sDrumkitPath ) const {
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_drumkitDatabase.find( Filesystem::absolute_path( sDrumkitPath ) ) !=
+		m_drumkitDatabase.end();
+}
+
+std::shared_ptr<Drumkit> SoundLibraryDatabase::getPreviousDrumkit() {
 
 	auto pHydrogen = H2Core::Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
@@ -210,24 +374,29 @@ std::shared_ptr<Drumkit> SoundLibraryDatabase::getPreviousDrumkit() const {
 		ERRORLOG( "No song set yet" );
 		return nullptr;
 	}
+	const auto pDrumkitEntries = getDrumkitEntries();
+	if ( pDrumkitEntries->size() == 0 ) {
+		ERRORLOG( "No drumkits available" );
+		return nullptr;
+	}
 
 	const auto sLastLoadedDrumkitPath = pSong->getLastLoadedDrumkitPath();
-	const auto search = m_drumkitDatabase.find( sLastLoadedDrumkitPath );
+	const auto search = pDrumkitEntries->find( sLastLoadedDrumkitPath );
 
-	if ( sLastLoadedDrumkitPath.isEmpty() || search == m_drumkitDatabase.end() ) {
+	if ( sLastLoadedDrumkitPath.isEmpty() || search == pDrumkitEntries->end() ) {
 		// In case we do not find the last loaded kit, we start at the top.
-		return m_drumkitDatabase.begin()->second;
+		return getDrumkit( pDrumkitEntries->begin()->first );
 	}
-	else if ( search == m_drumkitDatabase.begin() ) {
+	else if ( search == pDrumkitEntries->begin() ) {
 		// Periodic boundary conditions. The previous with respect to the first
 		// one is the last.
-		return std::prev( m_drumkitDatabase.end(), 1 )->second;
+		return getDrumkit( std::prev( pDrumkitEntries->end(), 1 )->first );
 	}
 
-	return std::prev( search, 1 )->second;
+	return getDrumkit( std::prev( search, 1 )->first );
 }
 
-std::shared_ptr<Drumkit> SoundLibraryDatabase::getNextDrumkit() const {
+std::shared_ptr<Drumkit> SoundLibraryDatabase::getNextDrumkit() {
 
 	auto pHydrogen = H2Core::Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
@@ -235,26 +404,76 @@ std::shared_ptr<Drumkit> SoundLibraryDatabase::getNextDrumkit() const {
 		ERRORLOG( "No song set yet" );
 		return nullptr;
 	}
+	const auto pDrumkitEntries = getDrumkitEntries();
+	if ( pDrumkitEntries->size() == 0 ) {
+		ERRORLOG( "No drumkits available" );
+		return nullptr;
+	}
 
 	const auto sLastLoadedDrumkitPath = pSong->getLastLoadedDrumkitPath();
-	const auto search = m_drumkitDatabase.find( sLastLoadedDrumkitPath );
+	const auto search = pDrumkitEntries->find( sLastLoadedDrumkitPath );
 
-	if ( sLastLoadedDrumkitPath.isEmpty() || search == m_drumkitDatabase.end() ||
-		 std::next( m_drumkitDatabase.find( sLastLoadedDrumkitPath ), 1 ) ==
-		 m_drumkitDatabase.end() ) {
+	if ( sLastLoadedDrumkitPath.isEmpty() || search == pDrumkitEntries->end() ||
+		 std::next( search, 1 ) == pDrumkitEntries->end() ) {
 		// In case we do not find the last loaded kit or it is located at the
 		// very bottom, we start at the top.
-		return m_drumkitDatabase.begin()->second;
+		return getDrumkit( pDrumkitEntries->begin()->first );
+	}
+
+	return getDrumkit( std::next( search, 1 )->first );
+}
+
+std::shared_ptr<SoundLibraryDatabase::DrumkitEntry> SoundLibraryDatabase::createEntry(
+	std::shared_ptr<Drumkit> pDrumkit ) {
+	auto pEntry = std::make_shared<DrumkitEntry>();
+	pEntry->sPath = pDrumkit->getPath();
+	// Queried after loading since this might have upgraded the kit.
+	pEntry->nModified = getModificationTime(
+		Filesystem::drumkit_file( pDrumkit->getPath() ) );
+	pEntry->sName = pDrumkit->getName();
+	pEntry->context = pDrumkit->getContext();
+
+	for ( const auto& ppInstrument : *pDrumkit->getInstruments() ) {
+		if ( ppInstrument != nullptr ) {
+			pEntry->instruments.push_back( { ppInstrument->getId(),
+											 ppInstrument->getName(),
+											 ppInstrument->getType() } );
+		}
+	}
+
+	return pEntry;
+}
+
+void SoundLibraryDatabase::addDrumkit( std::shared_ptr<Drumkit> pDrumkit ) {
+	std::shared_ptr<const DrumkitEntry> pEntry = createEntry( pDrumkit );
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	// Snapshots handed out before must not change.
+	auto pDrumkitEntries = std::make_shared<DrumkitEntries>( *m_pDrumkitEntries );
+	( *pDrumkitEntries )[ pEntry->sPath ] = pEntry;
+	m_pDrumkitEntries = pDrumkitEntries;
+
+	m_drumkitIndex[ pEntry->sPath ] = pEntry;
+	m_bIndexChanged = true;
+	m_drumkitDatabase[ pEntry->sPath ] = pDrumkit;
+
+	registerUniqueLabel( pEntry );
+}
+
+qint64 SoundLibraryDatabase::getModificationTime( const QString& sPath ) {
+	const QFileInfo fileInfo( sPath );
+	if ( ! fileInfo.exists() ) {
+		return -1;
 	}
 
-	return std::next( search, 1 )->second;
+	return fileInfo.lastModified().toMSecsSinceEpoch();
 }
 
-void SoundLibraryDatabase::registerUniqueLabel( const QString& sDrumkitPath,
-												std::shared_ptr<Drumkit> pDrumkit ) {
+void SoundLibraryDatabase::registerUniqueLabel( std::shared_ptr<const DrumkitEntry> pEntry ) {
 
-	QString sLabel = pDrumkit->getName();
-	const auto drumkitContext = pDrumkit->getContext();
+	QString sLabel = pEntry->sName;
+	const auto drumkitContext = pEntry->context;
 
 	if ( drumkitContext == Drumkit::Context::System ) {
 		/*: suffix appended to a drumkit name in order to make in unique.*/
@@ -283,7 +502,7 @@ void SoundLibraryDatabase::registerUniqueLabel( const QString& sDrumkitPath,
 	};
 
 	// Ensure we do not pick up the label for this kit.
-	m_drumkitUniqueLabels[ sDrumkitPath ] = "";
+	m_drumkitUniqueLabels[ pEntry->sPath ] = "";
 
 	while ( labelContained( sUniqueItemLabel ) ) {
 		sUniqueItemLabel = QString( "%1 (%2)" ).arg( sLabel ).arg( nCount );
@@ -295,10 +514,11 @@ void SoundLibraryDatabase::registerUniqueLabel( const QString& sDrumkitPath,
 		}
 	}
 
-	m_drumkitUniqueLabels[ sDrumkitPath ] = sUniqueItemLabel;
+	m_drumkitUniqueLabels[ pEntry->sPath ] = sUniqueItemLabel;
 }
 
 QString SoundLibraryDatabase::getUniqueLabel( const QString& sDrumkitPath ) const {
+	std::lock_guard<std::mutex> lock( m_mutex );
 	if ( m_drumkitUniqueLabels.find( sDrumkitPath ) ==
 		 m_drumkitUniqueLabels.end() ) {
 		return "";
@@ -308,13 +528,18 @@ QString SoundLibraryDatabase::getUniqueLabel( const QString& sDrumkitPath ) cons
 }
 
 void SoundLibraryDatabase::registerDrumkitFolder( const QString& sDrumkitFolder ) {
+	std::lock_guard<std::mutex> lock( m_mutex );
 	if ( ! m_customDrumkitFolders.contains( sDrumkitFolder ) ) {
 		m_customDrumkitFolders << sDrumkitFolder;
 	}
 }
 
 QStringList SoundLibraryDatabase::getDrumkitFolders() const {
-	QStringList drumkitFolders( m_customDrumkitFolders );
+	QStringList drumkitFolders;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		drumkitFolders = m_customDrumkitFolders;
+	}
 
 	drumkitFolders << Filesystem::sys_drumkits_dir()
 		<< Filesystem::usr_drumkits_dir();
@@ -324,9 +549,10 @@ QStringList SoundLibraryDatabase::getDrumkitFolders() const {
 
 std::set<DrumkitMap::Type> SoundLibraryDatabase::getAllTypes() const {
 	std::set<DrumkitMap::Type> allTypes;
-	for ( const auto& [ _, ppDrumkit ] : m_drumkitDatabase ) {
-		if ( ppDrumkit != nullptr ) {
-			allTypes.merge( ppDrumkit->getAllTypes() );
+	const auto pDrumkitEntries = getDrumkitEntries();
+	for ( const auto& [ _, ppEntry ] : *pDrumkitEntries ) {
+		if ( ppEntry != nullptr ) {
+			allTypes.merge( ppEntry->getAllTypes() );
 		}
 	}
 
@@ -335,52 +561,302 @@ std::set<DrumkitMap::Type> SoundLibraryDatabase::getAllTypes() const {
 
 void SoundLibraryDatabase::updatePatterns( bool bTriggerEvent )
 {
-	m_patternInfoVector.clear();
-	m_patternCategories = QStringList();
+	std::lock_guard<std::mutex> updateLock( m_updateMutex );
 
+	QStringList patternFiles;
 	// search drumkit subdirectories within patterns user directory
 	foreach ( const QString& sDrumkit, Filesystem::pattern_drumkits() ) {
-		loadPatternFromDirectory( Filesystem::patterns_dir( sDrumkit ) );
+		const QString sPatternDir = Filesystem::patterns_dir( sDrumkit );
+		foreach ( const QString& sName, Filesystem::pattern_list( sPatternDir ) ) {
+			patternFiles << sPatternDir + sName;
+		}
 	}
 	// search patterns user directory
-	loadPatternFromDirectory( Filesystem::patterns_dir() );
+	foreach ( const QString& sName,
+			  Filesystem::pattern_list( Filesystem::patterns_dir() ) ) {
+		patternFiles << Filesystem::patterns_dir() + sName;
+	}
+
+	// Only patterns not indexed yet or altered since have to be parsed.
+	std::vector<std::shared_ptr<SoundLibraryInfo>> infos( patternFiles.size() );
+	std::vector<qint64> modificationTimes( patternFiles.size() );
+	for ( int ii = 0; ii < patternFiles.size(); ++ii ) {
+		modificationTimes[ ii ] = getModificationTime( patternFiles[ ii ] );
+	}
+	std::vector<int> outdatedPatterns;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for ( int ii = 0; ii < patternFiles.size(); ++ii ) {
+			const auto search = m_patternIndex.find( patternFiles[ ii ] );
+			if ( search != m_patternIndex.end() &&
+				 search->second.nModified == modificationTimes[ ii ] ) {
+				infos[ ii ] = search->second.pInfo;
+			}
+			else {
+				outdatedPatterns.push_back( ii );
+			}
+		}
+	}
+
+	Parallel::forEach( outdatedPatterns.size(), [&]( int nTask ) {
+		const int nPattern = outdatedPatterns[ nTask ];
+		auto pInfo = std::make_shared<SoundLibraryInfo>();
+		if ( pInfo->load( patternFiles[ nPattern ] ) ) {
+			infos[ nPattern ] = pInfo;
+		}
+	} );
+	for ( const int nnPattern : outdatedPatterns ) {
+		if ( infos[ nnPattern ] != nullptr ) {
+			INFOLOG( QString( "Pattern [%1] of category [%2] loaded from [%3]" )
+					 .arg( infos[ nnPattern ]->getName() )
+					 .arg( infos[ nnPattern ]->getCategory() )
+					 .arg( patternFiles[ nnPattern ] ) );
+
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_patternIndex[ patternFiles[ nnPattern ] ] =
+				{ modificationTimes[ nnPattern ], infos[ nnPattern ] };
+			m_bIndexChanged = true;
+		}
+	}
+
+	m_patternInfoVector.clear();
+	m_patternCategories = QStringList();
+	for ( const auto& ppInfo : infos ) {
+		if ( ppInfo == nullptr ) {
+			continue;
+		}
+
+		m_patternInfoVector.push_back( ppInfo );
+
+		if ( ! m_patternCategories.contains( ppInfo->getCategory() ) ) {
+			m_patternCategories << ppInfo->getCategory();
+		}
+	}
+
+	saveIndex();
 
 	if ( bTriggerEvent ) {
 		EventQueue::get_instance()->pushEvent( Event::Type::SoundLibraryChanged, 0 );
 	}
 }
 
-void SoundLibraryDatabase::loadPatternFromDirectory( const QString& sPatternDir )
-{
-	foreach ( const QString& sName, Filesystem::pattern_list( sPatternDir ) ) {
-		QString sFile = sPatternDir + sName;
-		std::shared_ptr<SoundLibraryInfo> pInfo =
-			std::make_shared<SoundLibraryInfo>();
+QString SoundLibraryDatabase::getIndexPath() {
+	return Filesystem::cache_dir() + "soundLibraryIndex.xml";
+}
 
-		if ( pInfo->load( sFile ) ) {
-			INFOLOG( QString( "Pattern [%1] of category [%2] loaded from [%3]" )
-					 .arg( pInfo->getName() ).arg( pInfo->getCategory() )
-					 .arg( sFile ) );
-			
-			m_patternInfoVector.push_back( pInfo );
-		
-			if ( ! m_patternCategories.contains( pInfo->getCategory() ) ) {
-				m_patternCategories << pInfo->getCategory();
+void SoundLibraryDatabase::loadIndex() {
+	// Only called during construction. No other thread can access the
+	// database yet.
+	m_drumkitIndex.clear();
+	m_patternIndex.clear();
+
+	if ( ! Filesystem::file_exists( getIndexPath(), true ) ) {
+		return;
+	}
+
+	XMLDoc doc;
+	if ( ! doc.read( getIndexPath(), nullptr, true ) ) {
+		WARNINGLOG( QString( "Unable to read sound library index [%1]" )
+					.arg( getIndexPath() ) );
+		return;
+	}
+
+	XMLNode rootNode = doc.firstChildElement( "soundlibrary_index" );
+	if ( rootNode.isNull() ) {
+		WARNINGLOG( QString( "Malformed sound library index [%1]" )
+					.arg( getIndexPath() ) );
+		return;
+	}
+
+	// The format of drumkits and patterns - and thus what we store
+	// about them - might have changed in between versions.
+	if ( rootNode.read_string( "version", "", false, false, true ) !=
+		 QString::fromStdString( get_version() ) ) {
+		INFOLOG( "Sound library index was written by a different version. It will be recreated." );
+		m_bIndexChanged = true;
+		return;
+	}
+
+	XMLNode drumkitListNode = rootNode.firstChildElement( "drumkitList" );
+	XMLNode drumkitNode = drumkitListNode.firstChildElement( "drumkit" );
+	while ( ! drumkitNode.isNull() ) {
+		auto pEntry = std::make_shared<DrumkitEntry>();
+		pEntry->sPath = drumkitNode.read_string( "path", "", false, false, true );
+		pEntry->nModified = drumkitNode.read_string(
+			"modified", "-1", false, false, true ).toLongLong();
+		pEntry->sName = drumkitNode.read_string( "name", "", false, true, true );
+
+		if ( ! pEntry->sPath.isEmpty() ) {
+			pEntry->context = Drumkit::DetermineContext( pEntry->sPath );
+
+			XMLNode instrumentListNode =
+				drumkitNode.firstChildElement( "instrumentList" );
+			XMLNode instrumentNode =
+				instrumentListNode.firstChildElement( "instrument" );
+			while ( ! instrumentNode.isNull() ) {
+				pEntry->instruments.push_back(
+					{ instrumentNode.read_int( "id", EMPTY_INSTR_ID, false, false, true ),
+					  instrumentNode.read_string( "name", "", false, true, true ),
+					  instrumentNode.read_string( "type", "", true, true, true ) } );
+
+				instrumentNode = instrumentNode.nextSiblingElement( "instrument" );
 			}
+
+			m_drumkitIndex[ pEntry->sPath ] = pEntry;
+		}
+
+		drumkitNode = drumkitNode.nextSiblingElement( "drumkit" );
+	}
+
+	XMLNode patternListNode = rootNode.firstChildElement( "patternList" );
+	XMLNode patternNode = patternListNode.firstChildElement( "pattern" );
+	while ( ! patternNode.isNull() ) {
+		const QString sPath = patternNode.read_string( "path", "", false, false, true );
+		if ( ! sPath.isEmpty() ) {
+			auto pInfo = std::make_shared<SoundLibraryInfo>();
+			pInfo->setPath( sPath );
+			pInfo->setType( "pattern" );
+			pInfo->setName( patternNode.read_string( "name", "", false, true, true ) );
+			pInfo->setAuthor( patternNode.read_string( "author", "", false, true, true ) );
+			pInfo->setLicense( License(
+				patternNode.read_string( "license", "", false, true, true ) ) );
+			pInfo->setInfo( patternNode.read_string( "info", "", false, true, true ) );
+			pInfo->setCategory( patternNode.read_string( "category", "", false, true, true ) );
+			pInfo->setDrumkitName(
+				patternNode.read_string( "drumkitName", "", false, true, true ) );
+
+			m_patternIndex[ sPath ] = {
+				patternNode.read_string( "modified", "-1", false, false, true ).toLongLong(),
+				pInfo };
+		}
+
+		patternNode = patternNode.nextSiblingElement( "pattern" );
+	}
+
+	INFOLOG( QString( "[%1] drumkits and [%2] patterns read from sound library index [%3]" )
+			 .arg( m_drumkitIndex.size() ).arg( m_patternIndex.size() )
+			 .arg( getIndexPath() ) );
+}
+
+void SoundLibraryDatabase::saveIndex() {
+	std::lock_guard<std::mutex> fileLock( m_indexFileMutex );
+
+	// The index is written based on a copy in order to not block
+	// threads retrieving drumkits.
+	DrumkitEntries drumkitIndex;
+	std::map<QString, PatternEntry> patternIndex;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if ( ! m_bIndexChanged ) {
+			return;
+		}
+		drumkitIndex = m_drumkitIndex;
+		patternIndex = m_patternIndex;
+		m_bIndexChanged = false;
+	}
+
+	// Entries of removed kits and patterns are dropped.
+	QStringList removedPaths;
+	for ( auto it = drumkitIndex.begin(); it != drumkitIndex.end(); ) {
+		if ( ! Filesystem::file_exists( Filesystem::drumkit_file( it->first ), true ) ) {
+			removedPaths << it->first;
+			it = drumkitIndex.erase( it );
+		} else {
+			++it;
+		}
+	}
+	for ( auto it = patternIndex.begin(); it != patternIndex.end(); ) {
+		if ( ! Filesystem::file_exists( it->first, true ) ) {
+			removedPaths << it->first;
+			it = patternIndex.erase( it );
+		} else {
+			++it;
+		}
+	}
+	if ( removedPaths.size() > 0 ) {
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for ( const auto& sPath : removedPaths ) {
+			m_drumkitIndex.erase( sPath );
+			m_patternIndex.erase( sPath );
 		}
 	}
+
+	auto markUnsaved = [&]() {
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bIndexChanged = true;
+	};
+
+	if ( ! Filesystem::path_usable( Filesystem::cache_dir(), true, false ) ) {
+		ERRORLOG( QString( "Unable to write sound library index. Cache folder [%1] is not usable" )
+				  .arg( Filesystem::cache_dir() ) );
+		markUnsaved();
+		return;
+	}
+
+	XMLDoc doc;
+	XMLNode rootNode = doc.set_root( "soundlibrary_index" );
+	rootNode.write_string( "version", QString::fromStdString( get_version() ) );
+
+	XMLNode drumkitListNode = rootNode.createNode( "drumkitList" );
+	for ( const auto& [ ssPath, ppEntry ] : drumkitIndex ) {
+		XMLNode drumkitNode = drumkitListNode.createNode( "drumkit" );
+		drumkitNode.write_string( "path", ssPath );
+		drumkitNode.write_string( "modified", QString::number( ppEntry->nModified ) );
+		drumkitNode.write_string( "name", ppEntry->sName );
+
+		XMLNode instrumentListNode = drumkitNode.createNode( "instrumentList" );
+		for ( const auto& instrument : ppEntry->instruments ) {
+			XMLNode instrumentNode = instrumentListNode.createNode( "instrument" );
+			instrumentNode.write_int( "id", instrument.nId );
+			instrumentNode.write_string( "name", instrument.sName );
+			instrumentNode.write_string( "type", instrument.sType );
+		}
+	}
+
+	XMLNode patternListNode = rootNode.createNode( "patternList" );
+	for ( const auto& [ ssPath, entry ] : patternIndex ) {
+		XMLNode patternNode = patternListNode.createNode( "pattern" );
+		patternNode.write_string( "path", ssPath );
+		patternNode.write_string( "modified", QString::number( entry.nModified ) );
+		patternNode.write_string( "name", entry.pInfo->getName() );
+		patternNode.write_string( "author", entry.pInfo->getAuthor() );
+		patternNode.write_string( "license",
+								  entry.pInfo->getLicense().getLicenseString() );
+		patternNode.write_string( "info", entry.pInfo->getInfo() );
+		patternNode.write_string( "category", entry.pInfo->getCategory() );
+		patternNode.write_string( "drumkitName", entry.pInfo->getDrumkitName() );
+	}
+
+	if ( ! doc.write( getIndexPath() ) ) {
+		ERRORLOG( QString( "Unable to write sound library index [%1]" )
+				  .arg( getIndexPath() ) );
+		markUnsaved();
+	}
 }
 
 QString SoundLibraryDatabase::toQString( const QString& sPrefix, bool bShort ) const {
 	QString s = Base::sPrintIndention;
 	QString sOutput;
+	std::lock_guard<std::mutex> lock( m_mutex );
 	if ( ! bShort ) {
 		sOutput = QString( "%1[SoundLibraryDatabase]\n" ).arg( sPrefix )
-			.append( QString( "%1%2m_drumkitDatabase:\n" ).arg( sPrefix ).arg( s ) );
+			.append( QString( "%1%2m_pDrumkitEntries:\n" ).arg( sPrefix ).arg( s ) );
+		for ( const auto& [ ssPath, ppEntry ] : *m_pDrumkitEntries ) {
+			sOutput.append( QString( "%1%2%2%3: %4 (%5 instruments)\n" )
+							.arg( sPrefix ).arg( s ).arg( ssPath )
+							.arg( ppEntry->sName ).arg( ppEntry->instruments.size() ) );
+		}
+		sOutput.append( QString( "%1%2m_drumkitDatabase:\n" ).arg( sPrefix ).arg( s ) );
 		for ( const auto& [ ssPath, ddrumkit ] : m_drumkitDatabase ) {
 			sOutput.append( QString( "%1%2%2%3: %4\n" ).arg( sPrefix ).arg( s )
 							.arg( ssPath ).arg( ddrumkit->toQString( "", true ) ) );
 		}
+		sOutput.append( QString( "%1%2m_drumkitIndex: %3 entries\n" ).arg( sPrefix )
+						.arg( s ).arg( m_drumkitIndex.size() ) )
+			.append( QString( "%1%2m_patternIndex: %3 entries\n" ).arg( sPrefix )
+					 .arg( s ).arg( m_patternIndex.size() ) )
+			.append( QString( "%1%2m_bIndexChanged: %3\n" ).arg( sPrefix ).arg( s )
+					 .arg( m_bIndexChanged ) );
 		sOutput.append( QString( "%1%2m_drumkitUniqueLabels:\n" ).arg( sPrefix ).arg( s ) );
 		for ( const auto& [ ssPath, ssLabel ] : m_drumkitUniqueLabels ) {
 			sOutput.append( QString( "%1%2%2%3: %4\n" ).arg( sPrefix ).arg( s )
@@ -400,11 +876,21 @@ QString SoundLibraryDatabase::toQString( const QString& sPrefix, bool bShort ) c
 	}
 	else {
 		sOutput = QString( "[SoundLibraryDatabase] " )
-			.append( "m_drumkitDatabase: " );
+			.append( "m_pDrumkitEntries: " );
+		for ( const auto& [ ssPath, ppEntry ] : *m_pDrumkitEntries ) {
+			sOutput.append( QString( "[%1: %2] " )
+							.arg( ssPath ).arg( ppEntry->sName ) );
+		}
+		sOutput.append( ", m_drumkitDatabase: " );
 		for ( const auto& [ ssPath, ppDrumkit ] : m_drumkitDatabase ) {
 			sOutput.append( QString( "[%1: %2] " )
 							.arg( ssPath ).arg( ppDrumkit->getName() ) );
 		}
+		sOutput.append( QString( ", m_drumkitIndex: %1 entries" )
+						.arg( m_drumkitIndex.size() ) )
+			.append( QString( ", m_patternIndex: %1 entries" )
+					 .arg( m_patternIndex.size() ) )
+			.append( QString( ", m_bIndexChanged: %1" ).arg( m_bIndexChanged ) );
 		sOutput.append( ", m_drumkitUniqueLabels: " );
 		for ( const auto& [ ssPath, ssLabel ] : m_drumkitUniqueLabels ) {
 			sOutput.append( QString( "[%1: %2] " )
@@ -30,6 +30,8 @@
 #include <QStringList>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
 namespace H2Core
@@ -41,6 +43,17 @@ namespace H2Core
 *
 * This class organizes the metadata of all locally installed soundlibrary items.
 *
+* The metadata is stored in an on-disk index (see getIndexPath()). Each
+* entry is keyed by the path of a drumkit folder or pattern file and is
+* valid as long as the modification time of the corresponding
+* drumkit.xml or .h2pattern file does not change. Updates only parse
+* files added or altered since and do so in parallel. Full #Drumkit
+* objects are loaded on demand in getDrumkit().
+*
+* Drumkits are retrieved by the GUI, MIDI, and OSC threads alike. All
+* drumkit-related state is therefore guarded by #m_mutex and the
+* metadata is handed out as immutable snapshots.
+*
 * @author Sebastian Moors
 *
 */
@@ -53,6 +66,34 @@ class SoundLibraryDatabase :    public H2Core::Object<SoundLibraryDatabase>
 	SoundLibraryDatabase();
 	~SoundLibraryDatabase();
 
+		/** Metadata of an installed drumkit. It suffices to list the kit
+		 * and its instruments and to map notes by type without loading
+		 * the kit itself. */
+		struct DrumkitEntry {
+			struct InstrumentEntry {
+				int nId;
+				QString sName;
+				DrumkitMap::Type sType;
+			};
+
+			/** Absolute path to the drumkit folder. */
+			QString sPath;
+			/** Modification time of the drumkit.xml file in
+			 * milliseconds since epoch. */
+			qint64 nModified;
+			QString sName;
+			Drumkit::Context context;
+			std::vector<InstrumentEntry> instruments;
+
+			/** Counterpart of Drumkit::toDrumkitMap(). */
+			std::shared_ptr<DrumkitMap> toDrumkitMap() const;
+			/** Counterpart of Drumkit::getAllTypes(). */
+			std::set<DrumkitMap::Type> getAllTypes() const;
+		};
+		/** Entries are never altered once created. */
+		using DrumkitEntries =
+			std::map<QString, std::shared_ptr<const DrumkitEntry>>;
+
 		/** Null element of the category list*/
 		static QString m_sPatternBaseCategory;
 
@@ -65,12 +106,21 @@ class SoundLibraryDatabase :    public H2Core::Object<SoundLibraryDatabase>
 
 	void update();
 
+	/**
+	 * Rescans all drumkit folders.
+	 *
+	 * Kits whose drumkit.xml did not change since they were indexed
+	 * are not parsed again. All others are loaded in parallel. Kits
+	 * retrieved via getDrumkit() before are dropped and will be loaded
+	 * from disk again on the next request.
+	 */
 	void updateDrumkits( bool bTriggerEvent = true );
 	void updateDrumkit( const QString& sDrumkitPath, bool bTriggerEvent = true );
 	/**
 	 * Retrieve a drumkit from the database.
 	 *
 	 * If the kit is not already present, it will be loaded from disk.
+	 * This also holds for kits only known by their index entry.
 	 *
 	 * @param sDrumkitPath Absolute path to the drumkit directory
 	 *   (containing a drumkit.xml) file as unique identifier.
@@ -83,15 +133,23 @@ class SoundLibraryDatabase :    public H2Core::Object<SoundLibraryDatabase>
 		/** Based on #Song::m_sLastLoadedDrumkitPath get the previous drumkit in
 		 * the data base (the one shown above the last loaded one in the Sound
 		 * Library widget) */
-		std::shared_ptr<Drumkit> getPreviousDrumkit() const;
+		std::shared_ptr<Drumkit> getPreviousDrumkit();
 		/** Based on #Song::m_sLastLoadedDrumkitPath get the next drumkit in the
 		 * data base (the one shown below the last loaded one in the Sound
 		 * Library widget) */
-		std::shared_ptr<Drumkit> getNextDrumkit() const;
+		std::shared_ptr<Drumkit> getNextDrumkit();
 
-	const std::map<QString, std::shared_ptr<Drumkit>>& getDrumkitDatabase() const {
-		return m_drumkitDatabase;
-	}
+		/** Metadata of all drumkits in the database sorted by path.
+		 *
+		 * The snapshot returned is not affected by subsequent
+		 * updates. Keep it alive while iterating it. */
+		std::shared_ptr<const DrumkitEntries> getDrumkitEntries() const;
+		/** \return Whether the #Drumkit located at @a sDrumkitPath was
+		 * already loaded from disk. */
+		bool isDrumkitLoaded( const QString& sDrumkitPath ) const;
+
+		/** Location of the on-disk index. */
+		static QString getIndexPath();
 		/** Retrieves an unique label for the kit associated with @a
 		 * sDrumkitPath. This may serve as a more accessible alternative to the
 		 * absolute path of the kit in the GUI. */
@@ -111,9 +169,10 @@ class SoundLibraryDatabase :    public H2Core::Object<SoundLibraryDatabase>
 	 * @return The list of unique types sorted alphabetically.*/
 	 std::set<DrumkitMap::Type> getAllTypes() const;
 	
+	/** Rescans the pattern folders. Just like in updateDrumkits()
+	 * only files not indexed yet or altered since are parsed. */
 	void updatePatterns( bool bTriggerEvent = true );
 	void printPatterns() const;
-	void loadPatternFromDirectory( const QString& path );
 	bool isPatternInstalled( const QString& sPatternName ) const;
 
 	/** Formatted string version for debugging purposes.
@@ -127,10 +186,52 @@ class SoundLibraryDatabase :    public H2Core::Object<SoundLibraryDatabase>
 	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
 
 private:
-		void registerUniqueLabel( const QString& sDrumkitPath,
-								  std::shared_ptr<Drumkit> pDrumkit );
+		/** Metadata of a pattern file stored in the index. */
+		struct PatternEntry {
+			/** Modification time of the file in milliseconds since
+			 * epoch. */
+			qint64 nModified;
+			std::shared_ptr<SoundLibraryInfo> pInfo;
+		};
+
+		/** Has to be called while holding #m_mutex. */
+		void registerUniqueLabel( std::shared_ptr<const DrumkitEntry> pEntry );
+		/** Creates the index entry of the freshly loaded @a pDrumkit. */
+		static std::shared_ptr<DrumkitEntry> createEntry(
+			std::shared_ptr<Drumkit> pDrumkit );
+		/** Adds @a pDrumkit to both #m_pDrumkitEntries and
+		 * #m_drumkitDatabase. */
+		void addDrumkit( std::shared_ptr<Drumkit> pDrumkit );
+		static qint64 getModificationTime( const QString& sPath );
+
+		void loadIndex();
+		/** Writes #m_drumkitIndex and #m_patternIndex to disk in case
+		 * they changed. */
+		void saveIndex();
+
+		/** Kits found during the last updateDrumkits() or added via
+		 * getDrumkit(), sorted by path. Replaced as a whole on
+		 * changes. */
+		std::shared_ptr<const DrumkitEntries> m_pDrumkitEntries;
+		/** Kits already loaded from disk. */
+		std::map<QString, std::shared_ptr<Drumkit>> m_drumkitDatabase;
+		/** Guards #m_pDrumkitEntries, #m_drumkitDatabase,
+		 * #m_drumkitIndex, #m_patternIndex, #m_bIndexChanged,
+		 * #m_drumkitUniqueLabels, #m_customDrumkitPaths, and
+		 * #m_customDrumkitFolders. Since kits are loaded on demand,
+		 * those are altered by all threads retrieving kits. Drumkits
+		 * are loaded and the index is written without holding it. */
+		mutable std::mutex m_mutex;
+		/** Serializes updateDrumkits() and updatePatterns(). */
+		std::mutex m_updateMutex;
+		/** Serializes writes of the on-disk index. */
+		std::mutex m_indexFileMutex;
 
-	std::map<QString, std::shared_ptr<Drumkit>> m_drumkitDatabase;
+		/** Entries of the on-disk index. Contains kits and patterns
+		 * found in previous sessions as well. */
+		DrumkitEntries m_drumkitIndex;
+		std::map<QString, PatternEntry> m_patternIndex;
+		bool m_bIndexChanged;
 		/** The absolute path to a drumkit folder is not the most accessible way
 		 * to refer to a kit in the GUI. Instead, each kit will also have an
 		 * unique label. It is derived from the name of the drumkit. But as
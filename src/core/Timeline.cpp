@@ -30,7 +30,8 @@ namespace H2Core
 {
 
 Timeline::Timeline() : Object( )
-					 , m_fDefaultBpm( 120 ) {
+					 , m_fDefaultBpm( 120 )
+					 , m_nRevision( 0 ) {
 	updateTempoMarkers();
 }
 
@@ -191,6 +192,9 @@ std::shared_ptr<const Timeline::TempoMarker> Timeline::getTempoMarkerAtColumn( i
 }
 
 void Timeline::updateTempoMarkers() {
+	// Sort first so m_allTempoMarkers is ordered too.
+	sortTempoMarkers();
+
 	if ( isFirstTempoMarkerSpecial() ) {
 
 		std::shared_ptr<TempoMarker> pTempoMarker =
@@ -214,7 +218,7 @@ void Timeline::updateTempoMarkers() {
 		m_allTempoMarkers = m_tempoMarkers;
 	}
 
-	sortTempoMarkers();
+	m_nRevision.fetch_add( 1, std::memory_order_release );
 }
 		
 void Timeline::sortTempoMarkers() {
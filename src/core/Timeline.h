@@ -23,6 +23,7 @@
 #ifndef TIMELINE_H
 #define TIMELINE_H
 
+#include <atomic>
 #include <memory>
 
 #include <core/Object.h>
@@ -164,6 +165,11 @@ public:
 		by "special tempo marker".*/
 	bool isFirstTempoMarkerSpecial() const;
 
+	/** Incremented whenever the tempo markers returned by
+	 * getAllTempoMarkers() change. Used to detect outdated
+	 * #TempoMap. */
+	int getRevision() const;
+
 	/** Adds a Tag to the Timeline.
 	 *
 	 * Fails if there is already a #Tag present at @a nColumn.
@@ -229,6 +235,9 @@ private:
 	 * the last Song::m_fBpm when activating the Timeline.
 	 */
 	float m_fDefaultBpm;
+	/** Read by the audio thread while the markers are altered by the
+	 * GUI. */
+	std::atomic<int> m_nRevision;
 	
 	struct TempoMarkerComparator
 	{
@@ -258,5 +267,8 @@ inline const std::vector<std::shared_ptr<const Timeline::TempoMarker>>& Timeline
 inline const std::vector<std::shared_ptr<const Timeline::Tag>>& Timeline::getAllTags() const {
 	return m_tags;
 }
+inline int Timeline::getRevision() const {
+	return m_nRevision.load( std::memory_order_acquire );
+}
 };
 #endif // TIMELINE_H
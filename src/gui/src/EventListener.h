@@ -61,6 +61,7 @@ class EventListener
 		virtual void progressEvent( int nValue ) { UNUSED( nValue ); }
 		virtual void quitEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void relocationEvent(){}
+		virtual void sampleLoadingProgressEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void selectedPatternChangedEvent() {}
 		virtual void selectedInstrumentChangedEvent() {}
 		virtual void songModeActivationEvent(){}
@@ -69,6 +70,7 @@ class EventListener
 		virtual void soundLibraryChangedEvent(){}
 		virtual void stackedModeActivationEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void stateChangedEvent( const H2Core::AudioEngine::State& state) {}
+		virtual void streamUnderrunEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void tempoChangedEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void timelineActivationEvent(){}
 		virtual void timelineUpdateEvent( int nValue ){ UNUSED( nValue ); }
@@ -120,8 +120,6 @@ ExportSongDialog::ExportSongDialog(QWidget* parent)
 	m_pProgressBar->setValue( 0 );
 	
 	m_bQfileDialog = false;
-	m_bExportTrackouts = false;
-	m_nInstrument = 0;
 	m_sExtension = Filesystem::AudioFormatToSuffix( Filesystem::AudioFormat::Flac );
 	m_bOverwriteFiles = false;
 	m_bOldRubberbandBatchMode = pPref->getRubberBandBatchMode();
@@ -537,11 +535,12 @@ void ExportSongDialog::on_okBtn_clicked()
 
 	m_bOverwriteFiles = false;
 
+	const QString filename = exportNameTxt->text();
+	QString sMixFilename;
 	if( exportTypeCombo->currentIndex() == EXPORT_TO_SINGLE_TRACK ||
 		exportTypeCombo->currentIndex() == EXPORT_TO_BOTH ){
-		m_bExportTrackouts = false;
+		sMixFilename = filename;
 
-		QString filename = exportNameTxt->text();
 		if ( fileInfo.exists() == true && m_bQfileDialog == false ) {
 
 			int res;
@@ -559,178 +558,44 @@ void ExportSongDialog::on_okBtn_clicked()
 				return;
 			}
 		}
-
-		if( exportTypeCombo->currentIndex() == EXPORT_TO_BOTH ){
-			m_bExportTrackouts = true;
-		}
-		
-		/* arm all tracks for export */
-		for (auto i = 0; i < pInstrumentList->size(); i++) {
-			pInstrumentList->get(i)->setCurrentlyExported( true );
-		}
-
-		if ( ! pHydrogen->startExportSession(
-				 nSampleRate, nSampleDepth, fCompressionLevel ) ) {
-			QMessageBox::critical( this, "Hydrogen",
-								   pCommonStrings->getExportSongFailure() );
-			return;
-		}
-		pHydrogen->startExportSong( filename );
-		return;
-	}
-
-	if ( exportTypeCombo->currentIndex() == EXPORT_TO_SEPARATE_TRACKS ){
-		m_bExportTrackouts = true;
-		if ( ! pHydrogen->startExportSession(
-				 nSampleRate, nSampleDepth, fCompressionLevel ) ) {
-			QMessageBox::critical( this, "Hydrogen",
-								   pCommonStrings->getExportSongFailure() );
-			return;
-		}
-		exportTracks();
-		return;
 	}
 
-}
+	// All instrument tracks are rendered in the same pass as the main
+	// mix.
+	std::vector<H2Core::ExportStem> stems;
+	if ( exportTypeCombo->currentIndex() == EXPORT_TO_SEPARATE_TRACKS ||
+		 exportTypeCombo->currentIndex() == EXPORT_TO_BOTH ) {
+		stems = pHydrogen->getExportStems( filename, false );
 
-bool ExportSongDialog::instrumentHasNotes( int nInstrumentId )
-{
-	const auto pSong = Hydrogen::get_instance()->getSong();
-	if ( pSong == nullptr && pSong->getDrumkit() == nullptr ) {
-		return false;
-	}
-	const auto pInstrument =
-		pSong->getDrumkit()->getInstruments()->get( nInstrumentId );
-	if ( pInstrument == nullptr ) {
-		ERRORLOG( QString( "Could not retrieve instrument of id [%1]" )
-				  .arg( nInstrumentId ) );
-		return false;
-	}
-
-	// Check all notes for the provided instrument id. It's a little inefficient
-	// because patterns are likely to be present multiple times. But this way we
-	// do not have to check whether a pattern is actually played back over the
-	// course of a song.
-	for ( const auto& ppNote : pSong->getAllNotes() ) {
-		if ( ppNote != nullptr && ppNote->getInstrumentId() == nInstrumentId ) {
-			return true;
+		for ( const auto& sstem : stems ) {
+			if ( QFile( sstem.sFilename ).exists() == true &&
+				 m_bQfileDialog == false && ! m_bOverwriteFiles ) {
+				const int nRes = QMessageBox::information(
+					this, "Hydrogen", tr( "The file %1 exists. \nOverwrite the existing file?")
+					.arg( sstem.sFilename ),
+					QMessageBox::Yes | QMessageBox::No | QMessageBox::YesToAll );
+				if ( nRes == QMessageBox::No ) {
+					return;
+				}
+				if ( nRes == QMessageBox::YesToAll ) {
+					m_bOverwriteFiles = true;
+				}
+			}
 		}
 	}
 
-	return false;
-}
-
-QString ExportSongDialog::findUniqueExportFilenameForInstrument( std::shared_ptr<Instrument> pInstrument )
-{
-	const auto pSong = Hydrogen::get_instance()->getSong();
-	if ( pSong == nullptr || pSong->getDrumkit() == nullptr ) {
-		return "";
+	/* arm all tracks for export */
+	for (auto i = 0; i < pInstrumentList->size(); i++) {
+		pInstrumentList->get(i)->setCurrentlyExported( true );
 	}
-	QString uniqueInstrumentName;
 
-	const auto pInstrumentList = pSong->getDrumkit()->getInstruments();
-	
-	int instrumentOccurence = 0;
-	for(int i=0; i  < pInstrumentList->size(); i++ ){
-		if( pInstrumentList->get(m_nInstrument)->getName() == pInstrument->getName()){
-			instrumentOccurence++;
-		}
-	}
-	
-	if(instrumentOccurence >= 2){
-		uniqueInstrumentName = pInstrument->getName() + QString("_") + QString::number( pInstrument->getId() );
-	} else {
-		uniqueInstrumentName = pInstrument->getName();
-	}
-	
-	return uniqueInstrumentName;
-}
-
-void ExportSongDialog::exportTracks()
-{
-	auto pHydrogen = Hydrogen::get_instance();
-	const auto pSong = pHydrogen->getSong();
-	if ( pSong == nullptr || pSong->getDrumkit() == nullptr ) {
+	if ( ! pHydrogen->startExportSession(
+			 nSampleRate, nSampleDepth, fCompressionLevel ) ) {
+		QMessageBox::critical( this, "Hydrogen",
+							   pCommonStrings->getExportSongFailure() );
 		return;
 	}
-	const auto pInstrumentList = pSong->getDrumkit()->getInstruments();
-	
-	if( m_nInstrument < pInstrumentList->size() ){
-		
-		//if a instrument contains no notes we jump to the next instrument
-		bool bInstrumentHasNotes = instrumentHasNotes( m_nInstrument );
-
-		if ( !bInstrumentHasNotes ) {
-			if ( m_nInstrument >= pInstrumentList->size() - 1 ) {
-				m_bExportTrackouts = false;
-				m_nInstrument = 0;
-				return;
-			}
-			else {
-				m_nInstrument++;
-				exportTracks();
-				return;
-			}
-		}
-
-		// Ensure we use the right extension.
-		const QString sSuffix = QString( ".%1" ).arg( m_sExtension );
-		const QString sTemplateName = exportNameTxt->text();
-		QString sBaseName = sTemplateName;
-		if ( sTemplateName.endsWith( sSuffix, Qt::CaseInsensitive ) ) {
-			sBaseName.chop( sSuffix.size() );
-		}
-
-		const QString sInstrumentName = findUniqueExportFilenameForInstrument(
-			pInstrumentList->get( m_nInstrument ) );
-		QString sExportName;
-		if ( sBaseName.isEmpty() || sBaseName.endsWith( "/" ) ||
-			 sBaseName.endsWith( "\\" ) ) {
-			// Allow to use just the instrument names when leaving the song name
-			// blank.
-			sExportName = QString( "%1%2" ).arg( sBaseName )
-				.arg( sInstrumentName );
-		}
-		else {
-			sExportName = QString( "%1-%2" ).arg( sBaseName )
-				.arg( sInstrumentName );
-		}
-
-		const QString sFileName = QString( "%1%2" ).arg( sExportName )
-			.arg( sSuffix );
-
-		if ( QFile( sFileName ).exists() == true && m_bQfileDialog == false &&
-			 ! m_bOverwriteFiles ) {
-			const int nRes = QMessageBox::information(
-				this, "Hydrogen", tr( "The file %1 exists. \nOverwrite the existing file?")
-				.arg( sFileName ),
-				QMessageBox::Yes | QMessageBox::No | QMessageBox::YesToAll );
-			if ( nRes == QMessageBox::No ) {
-				return;
-			}
-			if ( nRes == QMessageBox::YesToAll ) {
-				m_bOverwriteFiles = true;
-			}
-		}
-		
-		if( m_nInstrument > 0 ){
-			pHydrogen->stopExportSong();
-			m_bExporting = false;
-		}
-		
-		for (auto i = 0; i < pInstrumentList->size(); i++) {
-			pInstrumentList->get(i)->setCurrentlyExported( false );
-		}
-		
-		pInstrumentList->get(m_nInstrument)->setCurrentlyExported( true );
-		
-		pHydrogen->startExportSong( sFileName );
-
-		if(! (m_nInstrument == pInstrumentList->size()) ){
-			m_nInstrument++;
-		}
-	}
-    
+	pHydrogen->startExportSong( sMixFilename, stems );
 }
 
 void ExportSongDialog::closeEvent( QCloseEvent *event ) {
@@ -871,29 +736,15 @@ void ExportSongDialog::progressEvent( int nValue )
 
 		m_bExporting = false;
 
-		const auto pSong = Hydrogen::get_instance()->getSong();
 		// Check whether an error occured during export.
 		const auto pDriver = static_cast<DiskWriterDriver*>(
 			Hydrogen::get_instance()->getAudioEngine()->getAudioDriver());
 		if ( pDriver != nullptr && pDriver->m_bWritingFailed ) {
-			m_nInstrument = 0;
-			m_bExportTrackouts = false;
 			QMessageBox::critical( this, "Hydrogen",
 								   pCommonStrings->getExportSongFailure(),
 								   QMessageBox::Ok );
 			m_pProgressBar->setValue( 0 );
 		}
-		else {
-			if ( pSong == nullptr || pSong->getDrumkit() == nullptr ||
-				 m_nInstrument == pSong->getDrumkit()->getInstruments()->size() ) {
-				m_nInstrument = 0;
-				m_bExportTrackouts = false;
-			}
-
-			if ( m_bExportTrackouts ) {
-				exportTracks();
-			}
-		}
 	}
 	else if ( nValue == -1 ) {
 		m_bExporting = false;
@@ -71,19 +71,13 @@ private:
 	void		setResamplerMode(int index);
 	bool		checkUseOfRubberband();
 
-	bool		instrumentHasNotes( int nInstrumentId );
-	QString		findUniqueExportFilenameForInstrument( std::shared_ptr<H2Core::Instrument> pInstrument );
-
-	void		exportTracks();
 	bool 		validateUserInput();
 	QString		createDefaultFilename();
 
 	void		closeExport();
 	
 	bool					m_bExporting;
-	bool					m_bExportTrackouts;
 	bool					m_bOverwriteFiles;
-	uint					m_nInstrument;
 	QString					m_sExtension;
 	bool					m_bOldRubberbandBatchMode;
 	bool					m_bOldTimeLineBPMMode;
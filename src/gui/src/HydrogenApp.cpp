@@ -32,6 +32,8 @@
 #include <core/Helpers/Filesystem.h>
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
+#include <core/Sampler/Sampler.h>
+#include <core/Sampler/SampleStreamer.h>
 #include <core/Version.h>
 
 #include "AudioEngineInfoForm.h"
@@ -794,6 +796,21 @@ void HydrogenApp::XRunEvent() {
 		"HydrogenApp::XRunEvent" );
 }
 
+void HydrogenApp::streamUnderrunEvent( int nValue ) {
+	const auto pStreamer = Hydrogen::get_instance()->getAudioEngine()->
+		getSampler()->getSampleStreamer();
+	showStatusBarMessage(
+		QString( "Sample streaming underruns [%1]!!!" )
+		.arg( pStreamer->getUnderruns() ),
+		"HydrogenApp::streamUnderrunEvent" );
+}
+
+void HydrogenApp::sampleLoadingProgressEvent( int nValue ) {
+	showStatusBarMessage(
+		QString( "%1 [%2%]" ).arg( tr( "Loading samples" ) ).arg( nValue ),
+		"HydrogenApp::sampleLoadingProgressEvent" );
+}
+
 void HydrogenApp::updateWindowTitle()
 {
 	auto pSong = Hydrogen::get_instance()->getSong();
@@ -913,6 +930,15 @@ void HydrogenApp::onEventQueueTimer()
 	// use the timer to do schedule instrument slaughter;
 	EventQueue *pQueue = EventQueue::get_instance();
 
+	// Free note snapshots the audio thread is done with. Patterns only
+	// prune them themselves when being edited.
+	auto pCurrentSong = Hydrogen::get_instance()->getSong();
+	if ( pCurrentSong != nullptr ) {
+		for ( const auto& ppPattern : *pCurrentSong->getPatternList() ) {
+			ppPattern->releaseRetiredNoteSnapshots();
+		}
+	}
+
 	while ( true ) {
 		auto pEvent = pQueue->popEvent();
 		if ( pEvent == nullptr ) {
@@ -1067,6 +1093,14 @@ void HydrogenApp::onEventQueueTimer()
 				pListener->stateChangedEvent( static_cast<H2Core::AudioEngine::State>(pEvent->getValue()) );
 				break;
 
+			case Event::Type::SampleLoadingProgress:
+				pListener->sampleLoadingProgressEvent( pEvent->getValue() );
+				break;
+
+			case Event::Type::StreamUnderrun:
+				pListener->streamUnderrunEvent( pEvent->getValue() );
+				break;
+
 			case Event::Type::StackedModeActivation:
 				pListener->stackedModeActivationEvent( pEvent->getValue() );
 				break;
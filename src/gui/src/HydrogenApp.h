@@ -247,6 +247,8 @@ private slots:
 		void setupSinglePanedInterface();
 		virtual void songModifiedEvent() override;
 	virtual void XRunEvent() override;
+	virtual void streamUnderrunEvent( int nValue ) override;
+	virtual void sampleLoadingProgressEvent( int nValue ) override;
 
 		/** Handles the loading and saving of the H2Core::Preferences
 		 * from the core part of H2Core::Hydrogen.
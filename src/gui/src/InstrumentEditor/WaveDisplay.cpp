@@ -173,13 +173,15 @@ void WaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer> pLayer
 		float fGain = height() / 2.0 * pLayer->getGain();
 
 		auto pSampleData = pLayer->getSample()->getData_L();
+		// Streamed samples hold just their head in memory.
+		const int nHeadFrames = pLayer->getSample()->getHeadFrames();
 
 		int nSamplePos = 0;
 		int nVal;
 		for ( int i = 0; i < width(); ++i ){
 			nVal = 0;
 			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength ) {
+				if ( j < nSampleLength && nSamplePos < nHeadFrames ) {
 					int newVal = (int)( pSampleData[ nSamplePos ] * fGain );
 					if ( newVal > nVal ) {
 						nVal = newVal;
@@ -414,9 +414,15 @@ void LadspaFXProperties::activateBtnClicked() {
 #ifdef H2CORE_HAVE_LADSPA
 	auto pFX = Effects::get_instance()->getLadspaFX(m_nLadspaFX);
 	if ( pFX != nullptr) {
-		Hydrogen::get_instance()->getAudioEngine()->lock( RIGHT_HERE );
-		pFX->setEnabled( !pFX->isEnabled() );
-		Hydrogen::get_instance()->getAudioEngine()->unlock();
+		// The effect is resolved again by the audio thread since it
+		// might have been replaced in the meantime.
+		const int nFX = m_nLadspaFX;
+		Hydrogen::get_instance()->getAudioEngine()->pushCommand( [nFX]() {
+			auto pCurrentFX = Effects::get_instance()->getLadspaFX( nFX );
+			if ( pCurrentFX != nullptr ) {
+				pCurrentFX->setEnabled( ! pCurrentFX->isEnabled() );
+			}
+		} );
 	}
 #endif
 }
@@ -1353,19 +1353,27 @@ void PatternEditor::deselectAndOverwriteNotes( const std::vector< std::shared_pt
 	
 	// Iterate over all the notes in 'selected' and 'overwrite' by erasing any *other* notes occupying the
 	// same position.
+	//
+	// The audio engine does only play back the note snapshot of the
+	// pattern. Removing the notes does therefore not require to lock
+	// it.
 	auto pHydrogen = Hydrogen::get_instance();
-	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
-	Pattern::notes_t *pNotes = const_cast< Pattern::notes_t *>( pPattern->getNotes() );
+	const auto pNotes = pPattern->getNotes();
+	std::vector< std::shared_ptr<Note> > notesToRemove;
 	for ( auto pSelectedNote : selected ) {
 		m_selection.removeFromSelection( pSelectedNote, /* bCheck=*/false );
 		bool bFoundExact = false;
 		int nPosition = pSelectedNote->getPosition();
-		for ( auto it = pNotes->lower_bound( nPosition ); it != pNotes->end() && it->first == nPosition; ) {
+		for ( auto it = pNotes->lower_bound( nPosition ); it != pNotes->end() && it->first == nPosition; ++it ) {
 			auto pNote = it->second;
+			if ( std::find( notesToRemove.begin(), notesToRemove.end(),
+							pNote ) != notesToRemove.end() ) {
+				// Already overwritten by a previous note
+				continue;
+			}
 			if ( !bFoundExact && pSelectedNote->match( pNote ) ) {
 				// Found an exact match. We keep this.
 				bFoundExact = true;
-				++it;
 			}
 			else if ( pNote->getInstrumentId() == pSelectedNote->getInstrumentId() &&
 					  pNote->getType() == pSelectedNote->getType() &&
@@ -1373,15 +1381,15 @@ void PatternEditor::deselectAndOverwriteNotes( const std::vector< std::shared_pt
 					  pNote->getOctave() == pSelectedNote->getOctave() &&
 					  pNote->getPosition() == pSelectedNote->getPosition() ) {
 				// Something else occupying the same position (which may or may not be an exact duplicate)
-				it = pNotes->erase( it );
-			}
-			else {
-				// Any other note
-				++it;
+				notesToRemove.push_back( pNote );
 			}
 		}
 	}
-	pHydrogen->getAudioEngine()->unlock();
+	for ( const auto& ppNote : notesToRemove ) {
+		pPattern->removeNote( ppNote, false );
+	}
+	// The audio engine only plays back the notes of the snapshot.
+	pPattern->updateNoteSnapshot();
 	pHydrogen->setIsModified( true );
 }
 
@@ -1397,11 +1405,11 @@ void PatternEditor::undoDeselectAndOverwriteNotes( const std::vector< std::share
 	auto pHydrogen = Hydrogen::get_instance();
 	// Restore previously-overwritten notes, and select notes that were selected before.
 	m_selection.clearSelection( /* bCheck=*/false );
-	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
 	for ( const auto& ppNote : overwritten ) {
 		auto pNewNote = std::make_shared<Note>( ppNote );
-		pPattern->insertNote( pNewNote );
+		pPattern->insertNote( pNewNote, false );
 	}
+	pPattern->updateNoteSnapshot();
 	// Select the previously-selected notes
 	for ( auto pNote : selected ) {
 		FOREACH_NOTE_CST_IT_BOUND_END( pPattern->getNotes(), it, pNote->getPosition() ) {
@@ -1411,7 +1419,6 @@ void PatternEditor::undoDeselectAndOverwriteNotes( const std::vector< std::share
 			}
 		}
 	}
-	pHydrogen->getAudioEngine()->unlock();
 	pHydrogen->setIsModified( true );
 	m_pPatternEditorPanel->updateEditors( true );
 }
@@ -3244,8 +3251,9 @@ void PatternEditor::addOrRemoveNoteAction( int nPosition,
 	auto pPatternEditorPanel = HydrogenApp::get_instance()->getPatternEditorPanel();
 	auto pVisibleEditor = pPatternEditorPanel->getVisibleEditor();
 
-	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );	// lock the audio engine
-
+	// The audio engine only plays back the note snapshot published by
+	// the pattern. Adding and removing notes does not require to lock
+	// it.
 	if ( bIsDelete ) {
 		// Find and delete an existing (matching) note.
 
@@ -3348,7 +3356,6 @@ void PatternEditor::addOrRemoveNoteAction( int nPosition,
 				pPatternEditorPanel->findRowDB( pNote ) );
 		}
 	}
-	pHydrogen->getAudioEngine()->unlock(); // unlock the audio engine
 	pHydrogen->setIsModified( true );
 
 	pPatternEditorPanel->updateEditors( true );
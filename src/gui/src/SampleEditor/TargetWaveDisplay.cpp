@@ -217,6 +217,8 @@ void TargetWaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer>
 
 		auto pSampleDatal = pLayer->getSample()->getData_L();
 		auto pSampleDatar = pLayer->getSample()->getData_R();
+		// Streamed samples hold just their head in memory.
+		const int nHeadFrames = pLayer->getSample()->getHeadFrames();
 		int nSamplePos = 0;
 		int nVall;
 		int nValr;
@@ -224,7 +226,7 @@ void TargetWaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer>
 			nVall = 0;
 			nValr = 0;
 			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength ) {
+				if ( j < nSampleLength && nSamplePos < nHeadFrames ) {
 					if ( pSampleDatal[ nSamplePos ] < 0 ){
 						int newVal = static_cast<int>( pSampleDatal[ nSamplePos ] * -fGain );
 						nVall = newVal;
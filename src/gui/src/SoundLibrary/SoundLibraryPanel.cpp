@@ -70,6 +70,8 @@ SoundLibraryPanel::SoundLibraryPanel( QWidget *pParent, bool bInItsOwnDialog )
  , __pattern_item( nullptr )
  , __pattern_item_list( nullptr )
  , m_bInItsOwnDialog( bInItsOwnDialog )
+ , m_pFileSystemWatcher( nullptr )
+ , m_pRescanTimer( nullptr )
 {
 	setMinimumWidth( InstrumentRack::nWidth );
 	setSizePolicy( QSizePolicy( QSizePolicy::Fixed, QSizePolicy::Expanding ) );
@@ -147,8 +149,28 @@ SoundLibraryPanel::SoundLibraryPanel( QWidget *pParent, bool bInItsOwnDialog )
 	this->setLayout( pVBox );
 
 	connect( HydrogenApp::get_instance(), &HydrogenApp::preferencesChanged, this, &SoundLibraryPanel::onPreferencesChanged );
+
+	if ( ! m_bInItsOwnDialog ) {
+		m_pRescanTimer = new QTimer( this );
+		m_pRescanTimer->setSingleShot( true );
+		m_pRescanTimer->setInterval( nRescanDelayMs );
+		connect( m_pRescanTimer, &QTimer::timeout, [=]() {
+			INFOLOG( "Sound library changed on disk. Rescanning." );
+			auto pSoundLibraryDatabase =
+				Hydrogen::get_instance()->getSoundLibraryDatabase();
+			pSoundLibraryDatabase->updatePatterns( false );
+			pSoundLibraryDatabase->updateDrumkits();
+		});
+
+		m_pFileSystemWatcher = new QFileSystemWatcher( this );
+		connect( m_pFileSystemWatcher, SIGNAL( directoryChanged( QString ) ),
+				 m_pRescanTimer, SLOT( start() ) );
+		connect( m_pFileSystemWatcher, SIGNAL( fileChanged( QString ) ),
+				 m_pRescanTimer, SLOT( start() ) );
+	}
 	
 	updateTree();
+	updateWatchedPaths();
 	
 	HydrogenApp::get_instance()->addEventListener(this);
 }
@@ -190,8 +212,9 @@ void SoundLibraryPanel::updateTree()
 	// drumkit list
 	m_drumkitRegister.clear();
 	m_drumkitLabels.clear();
-	for ( const auto& [ssPath, ppDrumkit] : pSoundLibraryDatabase->getDrumkitDatabase() ) {
-		if ( ppDrumkit == nullptr ) {
+	const auto pDrumkitEntries = pSoundLibraryDatabase->getDrumkitEntries();
+	for ( const auto& [ssPath, ppEntry] : *pDrumkitEntries ) {
+		if ( ppEntry == nullptr ) {
 			continue;
 		}
 
@@ -202,7 +225,7 @@ void SoundLibraryPanel::updateTree()
 			continue;
 		}
 
-		const auto drumkitContext = ppDrumkit->getContext();
+		const auto drumkitContext = ppEntry->context;
 
 		QTreeWidgetItem* pDrumkitItem;
 		if ( drumkitContext == Drumkit::Context::System ) {
@@ -244,15 +267,12 @@ void SoundLibraryPanel::updateTree()
 		pDrumkitItem->setText( 0, sItemLabel );
 		pDrumkitItem->setToolTip( 0, ssPath );
 		if ( ! m_bInItsOwnDialog ) {
-			auto pInstrList = ppDrumkit->getInstruments();
-			for ( const auto& pInstrument : *ppDrumkit->getInstruments() ) {
-				if ( pInstrument != nullptr ) {
-					QTreeWidgetItem* pInstrumentItem = new QTreeWidgetItem( pDrumkitItem );
-					pInstrumentItem->setText( 0, QString( "[%1] %2" )
-											  .arg( pInstrument->getId() )
-											  .arg( pInstrument->getName() ) );
-					pInstrumentItem->setToolTip( 0, pInstrument->getName() );
-				}
+			for ( const auto& instrument : ppEntry->instruments ) {
+				QTreeWidgetItem* pInstrumentItem = new QTreeWidgetItem( pDrumkitItem );
+				pInstrumentItem->setText( 0, QString( "[%1] %2" )
+										  .arg( instrument.nId )
+										  .arg( instrument.sName ) );
+				pInstrumentItem->setToolTip( 0, instrument.sName );
 			}
 		}
 	}
@@ -808,9 +828,54 @@ void SoundLibraryPanel::on_patternDeleteAction()
 	H2Core::Hydrogen::get_instance()->getSoundLibraryDatabase()->updatePatterns();
 }
 
+void SoundLibraryPanel::updateWatchedPaths() {
+	if ( m_pFileSystemWatcher == nullptr ) {
+		return;
+	}
+
+	const auto pSoundLibraryDatabase =
+		Hydrogen::get_instance()->getSoundLibraryDatabase();
+
+	// Folders holding kits and patterns catch additions and removals.
+	// Kit folders themselves and their drumkit.xml files catch changes
+	// of the kits.
+	QStringList paths( pSoundLibraryDatabase->getDrumkitFolders() );
+	paths << Filesystem::patterns_dir();
+	for ( const auto& sDrumkit : Filesystem::pattern_drumkits() ) {
+		paths << Filesystem::patterns_dir( sDrumkit );
+	}
+	const auto pDrumkitEntries = pSoundLibraryDatabase->getDrumkitEntries();
+	for ( const auto& [ ssPath, _ ] : *pDrumkitEntries ) {
+		paths << ssPath << Filesystem::drumkit_file( ssPath );
+	}
+
+	QStringList newPaths;
+	for ( const auto& sPath : paths ) {
+		if ( ! sPath.isEmpty() && QFileInfo::exists( sPath ) &&
+			 ! newPaths.contains( sPath ) ) {
+			newPaths << sPath;
+		}
+	}
+
+	// Paths removed in the meantime are dropped by the watcher itself.
+	QStringList watchedPaths( m_pFileSystemWatcher->directories() );
+	watchedPaths << m_pFileSystemWatcher->files();
+	for ( const auto& sPath : watchedPaths ) {
+		if ( ! newPaths.contains( sPath ) ) {
+			m_pFileSystemWatcher->removePath( sPath );
+		}
+	}
+	for ( const auto& sPath : newPaths ) {
+		if ( ! watchedPaths.contains( sPath ) ) {
+			m_pFileSystemWatcher->addPath( sPath );
+		}
+	}
+}
+
 void SoundLibraryPanel::soundLibraryChangedEvent() {
 	test_expandedItems();
 	updateTree();
+	updateWatchedPaths();
 }
 
 void SoundLibraryPanel::test_expandedItems()
@@ -79,6 +79,9 @@ signals:
 private:
 		void editDrumkitProperties( bool bDuplicate );
 	void updateTree();
+		/** Watches the drumkit and pattern folders as well as all
+		 * drumkits currently listed. */
+		void updateWatchedPaths();
 	void test_expandedItems();
 
 	SoundLibraryTree *__sound_library_tree;
@@ -102,7 +105,7 @@ private:
 	 * Used to uniquely identify the drumkit corresponding to an item
 	 * in the tree. It maps the name used as label (key) to the
 	 * absolute path of the drumkit (value) also used as unique ID in
-	 * H2Core::Hydrogen::SoundLibraryDatabase::m_drumkitDatabase.
+	 * H2Core::Hydrogen::SoundLibraryDatabase::m_pDrumkitEntries.
 	 */
 	std::map<QString,QString> m_drumkitRegister;
 	/** List of all labels used for drumkits in the tree.
@@ -114,6 +117,15 @@ private:
 	 * or as part of the GUI.
 	 */
 	bool m_bInItsOwnDialog;
+
+		/** Triggers an incremental rescan of the sound library whenever
+		 * a drumkit or pattern is added, altered, or removed on disk.
+		 * Only used by the panel within the main window. */
+		QFileSystemWatcher* m_pFileSystemWatcher;
+		/** Bundles bursts of file system changes - e.g. while a kit is
+		 * being installed - into a single rescan. */
+		QTimer* m_pRescanTimer;
+		static constexpr int nRescanDelayMs = 500;
 };
 
 #endif
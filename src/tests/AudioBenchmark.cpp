@@ -21,7 +21,9 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <QDir>
 #include <QString>
+#include <QTemporaryDir>
 #include <QtGlobal>
 #include <core/EventQueue.h>
 #include <core/Helpers/Filesystem.h>
@@ -29,14 +31,25 @@
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/Sample.h>
 #include <core/Basics/PatternList.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/ResampleKernels.h>
+#include <core/Sampler/SampleRegistry.h>
+#include <core/Sampler/Sampler.h>
 #include "TestHelper.h"
 #include "AudioBenchmark.h"
+#include "assertions/AudioFile.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <ctime>
+#include <thread>
 
 using namespace H2Core;
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -47,7 +60,8 @@ namespace Qt {
 
 bool AudioBenchmark::bEnabled = false;
 
-static long long exportCurrentSong( const QString &fileName, int nSampleRate )
+static long long exportCurrentSong( const QString &fileName, int nSampleRate,
+									 int nSampleDepth = 16 )
 {
 	Hydrogen *pHydrogen = Hydrogen::get_instance();
 	EventQueue *pQueue = EventQueue::get_instance();
@@ -57,7 +71,7 @@ static long long exportCurrentSong( const QString &fileName, int nSampleRate )
 		return 0;
 	}
 
-	pHydrogen->startExportSession( nSampleRate, 16 );
+	pHydrogen->startExportSession( nSampleRate, nSampleDepth );
 	pHydrogen->startExportSong( fileName );
 
 	long long nStartFrame = pHydrogen->getAudioEngine()->getTransportPosition()->getFrame();
@@ -165,14 +179,21 @@ double AudioBenchmark::timeExport( int nSampleRate,
 	// Run through once to warm caches etc.
 	exportCurrentSong( outFile, 44100 );
 
+	// The CPU time reported by std::clock() sums up all threads. The
+	// throughput of the offline rendering is measured using the wall
+	// clock instead.
+	double fWallSeconds = 0;
 	for ( int i = 0; i < nIterations; i++ ) {
 
 		nFramesNew = 0;
+		const auto wallStart = std::chrono::steady_clock::now();
 		std::clock_t start = std::clock();
 		for ( int j = 0; j < 5; j++) {
 			nFramesNew += exportCurrentSong( outFile, nSampleRate );
 		}
 		std::clock_t end = std::clock();
+		fWallSeconds += std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - wallStart ).count();
 
 		CPPUNIT_ASSERT( nFramesNew == nFrames || nFrames == 0 );
 		nFrames = nFramesNew;
@@ -186,14 +207,19 @@ double AudioBenchmark::timeExport( int nSampleRate,
 	QString sTimes = showTimes( times, nFrames * 5, &fMean, &fRMS );
 	out << "Sample rate " << nSampleRate;
 	if ( nSampleRate != 44100 ) {
-		out << " (" + Interpolation::ModeToQString( interpolateMode ) + ")";
+		out << " (" + Interpolation::ModeToQString( interpolateMode ) + ", " +
+			ResampleKernels::isaToString( ResampleKernels::getIsa() ) + ")";
 	}
 	out << " times: " << sTimes;
 	if ( fReference != 0.0 ) {
 		double fDelta = 100.0 * ( fMean - fReference) / fReference;
 		out << " (" << ( ( fDelta >= 0 ) ? "+" : "" ) << fDelta << "%)";
 	}
-	out << Qt::endl;
+	const double fFramesPerSecond =
+		static_cast<double>(nFrames) * 5 * nIterations / fWallSeconds;
+	out << ", throughput: " << showNumber( fFramesPerSecond )
+		<< " frames/sec (" << QString::number( fFramesPerSecond / nSampleRate, 'f', 1 )
+		<< "x realtime)" << Qt::endl;
 
 	pHydrogen->getAudioEngine()->getSampler()->setInterpolateMode( oldInterpolateMode );
 
@@ -205,6 +231,165 @@ double AudioBenchmark::timeExport( int nSampleRate,
 	return fMean;
 }
 
+void AudioBenchmark::timeRenderThreads() {
+	Hydrogen *pHydrogen = Hydrogen::get_instance();
+	auto pSampler = pHydrogen->getAudioEngine()->getSampler();
+	const int nIterations = 8;
+	const int nOldThreads = pSampler->getRenderThreads();
+
+	std::vector<int> threads = { 1, 2, 4 };
+	const int nHardwareThreads = static_cast<int>(
+		std::thread::hardware_concurrency() );
+	if ( nHardwareThreads > 4 ) {
+		threads.push_back( std::min( nHardwareThreads,
+									 Preferences::nMaxSamplerThreads ) );
+	}
+
+	const auto sRefFile = Filesystem::tmp_file_path( "threads-ref.wav" );
+	double fReference = 0.0;
+	for ( const auto nThreads : threads ) {
+		pSampler->setRenderThreads( nThreads );
+		const auto sOutFile = Filesystem::tmp_file_path(
+			QString( "threads-%1.wav" ).arg( nThreads ) );
+
+		// Run through once to warm caches etc. and to check the output.
+		exportCurrentSong( sOutFile, 44100, 32 );
+		if ( nThreads == 1 ) {
+			Filesystem::file_copy( sOutFile, sRefFile, true, true );
+		}
+		else {
+			// Parallel rendering must not change a single bit.
+			H2TEST_ASSERT_AUDIO_FILES_EQUAL( sRefFile, sOutFile );
+		}
+
+		// The CPU time reported by std::clock() sums up all threads.
+		// We are interested in the wall clock time instead.
+		long long nFrames = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for ( int ii = 0; ii < nIterations; ++ii ) {
+			nFrames += exportCurrentSong( sOutFile, 44100, 32 );
+		}
+		const double fSeconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start ).count() / nIterations;
+
+		if ( nThreads == 1 ) {
+			fReference = fSeconds;
+		}
+
+		out << "Render threads " << nThreads << " time: "
+			<< showNumber( fSeconds ) << "s ("
+			<< showNumber( nFrames / nIterations / fSeconds )
+			<< " frames/sec), speedup: "
+			<< QString::number( fReference / fSeconds, 'f', 2 ) << Qt::endl;
+
+		Filesystem::rm( sOutFile );
+	}
+
+	Filesystem::rm( sRefFile );
+	pSampler->setRenderThreads( nOldThreads );
+}
+
+/** Copies the audio data of all samples in @a pDrumkit. */
+static std::vector< std::vector<float> > collectSampleData(
+	std::shared_ptr<Drumkit> pDrumkit ) {
+	std::vector< std::vector<float> > data;
+	for ( const auto& ppInstrument : *pDrumkit->getInstruments() ) {
+		for ( const auto& ppComponent : *ppInstrument->getComponents() ) {
+			for ( const auto& ppLayer : *ppComponent ) {
+				if ( ppLayer == nullptr || ppLayer->getSample() == nullptr ) {
+					continue;
+				}
+				auto pSample = ppLayer->getSample();
+				CPPUNIT_ASSERT( pSample->isLoaded() );
+				const int nFrames = pSample->getFrames();
+				data.emplace_back( pSample->getData_L(),
+								   pSample->getData_L() + nFrames );
+				data.emplace_back( pSample->getData_R(),
+								   pSample->getData_R() + nFrames );
+			}
+		}
+	}
+	return data;
+}
+
+void AudioBenchmark::timeSampleLoading() {
+	auto pPref = Preferences::get_instance();
+	const int nIterations = 8;
+	const int nOldThreads = pPref->m_nSampleLoadingThreads;
+	const int nOldCacheSize = pPref->m_nSampleCacheSize;
+
+	// Samples sharing a file with other Samples still alive are not
+	// decoded again but retrieved from the SampleRegistry. The same
+	// holds for the SampleCache. We use a private copy of the kit and
+	// disable the cache in order to time the decoding itself.
+	QTemporaryDir kitDir( Filesystem::tmp_dir() + "benchmarkKit-XXXXXX" );
+	CPPUNIT_ASSERT( kitDir.isValid() );
+	const QDir sourceDir( H2TEST_FILE( "drumkits/baseKit" ) );
+	for ( const auto& sFile : sourceDir.entryList( QDir::Files ) ) {
+		CPPUNIT_ASSERT( Filesystem::file_copy(
+							sourceDir.absoluteFilePath( sFile ),
+							kitDir.filePath( sFile ), true, true ) );
+	}
+	pPref->m_nSampleCacheSize = 0;
+
+	auto pDrumkit = Drumkit::load( kitDir.path() );
+	CPPUNIT_ASSERT( pDrumkit != nullptr );
+
+	auto assertUnshared = [&]() {
+		for ( const auto& info : SampleRegistry::getInfos() ) {
+			if ( info.sPath.startsWith( kitDir.path() ) ) {
+				CPPUNIT_ASSERT_EQUAL( 1L, info.nUsers );
+			}
+		}
+	};
+
+	std::vector<int> threads = { 1, 2, 4 };
+	const int nHardwareThreads = static_cast<int>(
+		std::thread::hardware_concurrency() );
+	if ( nHardwareThreads > 4 ) {
+		threads.push_back( std::min( nHardwareThreads,
+									 Preferences::nMaxSampleLoadingThreads ) );
+	}
+
+	std::vector< std::vector<float> > reference;
+	double fReference = 0.0;
+	for ( const auto nThreads : threads ) {
+		pPref->m_nSampleLoadingThreads = nThreads;
+
+		// Run through once to warm the file system cache and to check
+		// the loaded data.
+		pDrumkit->unloadSamples();
+		pDrumkit->loadSamples();
+		assertUnshared();
+		if ( nThreads == 1 ) {
+			reference = collectSampleData( pDrumkit );
+		}
+		else {
+			CPPUNIT_ASSERT( reference == collectSampleData( pDrumkit ) );
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for ( int ii = 0; ii < nIterations; ++ii ) {
+			pDrumkit->unloadSamples();
+			pDrumkit->loadSamples();
+		}
+		const double fSeconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start ).count() / nIterations;
+
+		if ( nThreads == 1 ) {
+			fReference = fSeconds;
+		}
+
+		out << "Loading threads " << nThreads << " time: "
+			<< showNumber( fSeconds ) << "s, speedup: "
+			<< QString::number( fReference / fSeconds, 'f', 2 ) << Qt::endl;
+	}
+
+	pDrumkit->unloadSamples();
+	pPref->m_nSampleLoadingThreads = nOldThreads;
+	pPref->m_nSampleCacheSize = nOldCacheSize;
+}
+
 void AudioBenchmark::audioBenchmark(void)
 {
 	if ( !bEnabled ) {
@@ -240,6 +425,24 @@ void AudioBenchmark::audioBenchmark(void)
 	timeExport( 44101, Interpolation::InterpolateMode::Cubic, fRef );
 	timeExport( 44101, Interpolation::InterpolateMode::Hermite, fRef );
 
+	// Compare against the scalar resampling path.
+	const auto supportedIsa = ResampleKernels::getSupportedIsa();
+	if ( supportedIsa != ResampleKernels::Isa::Scalar ) {
+		ResampleKernels::setIsa( ResampleKernels::Isa::Scalar );
+		timeExport( 44101, Interpolation::InterpolateMode::Linear, fRef );
+		timeExport( 44101, Interpolation::InterpolateMode::Cosine, fRef );
+		timeExport( 44101, Interpolation::InterpolateMode::Third, fRef );
+		timeExport( 44101, Interpolation::InterpolateMode::Cubic, fRef );
+		timeExport( 44101, Interpolation::InterpolateMode::Hermite, fRef );
+		ResampleKernels::setIsa( supportedIsa );
+	}
+
+	out << "Scaling of parallel note rendering" << Qt::endl;
+	timeRenderThreads();
+
+	out << "Scaling of parallel sample loading" << Qt::endl;
+	timeSampleLoading();
+
 	out << "Now with ADSR" << Qt::endl;
 	pSong = Song::load( songADSRFile );
 	ASSERT_SONG( pSong );
@@ -37,10 +37,21 @@ class AudioBenchmark : public CppUnit::TestCase {
 	QTextStream out;
 
 	void timeADSR();
+	/** Exports the current song several times and reports CPU time
+	 * as well as the throughput of the offline rendering in frames per
+	 * second of wall clock time. */
 	double timeExport( int nSampleRate,
 					   H2Core::Interpolation::InterpolateMode interpolateMode,
 					   double fReference = 0.0,
 					   double *pfRMS = nullptr );
+	/** Exports the current song using different numbers of render
+	 * threads in the #H2Core::Sampler and checks the results to be
+	 * identical. */
+	void timeRenderThreads();
+	/** Loads the samples of a drumkit using different numbers of
+	 * loading threads and checks the resulting data to be
+	 * identical. */
+	void timeSampleLoading();
 
  public:
 	void audioBenchmark(void);
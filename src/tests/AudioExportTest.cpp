@@ -26,8 +26,14 @@
 #include <QTemporaryDir>
 
 #include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Sample.h>
+#include <core/Basics/Song.h>
+#include <core/EngineContext.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Hydrogen.h>
+#include <core/IO/DiskWriterDriver.h>
 #include <core/Sampler/Interpolation.h>
 #include <core/Sampler/Sampler.h>
 
@@ -35,6 +41,7 @@
 #include "assertions/AudioFile.h"
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 using namespace H2Core;
@@ -87,6 +94,145 @@ void AudioExportTest::testExportVelocityAutomationAudio() {
 	___INFOLOG( "passed" );
 }
 
+void AudioExportTest::testExportStems() {
+	___INFOLOG( "" );
+	auto pHydrogen = Hydrogen::get_instance();
+	const auto sSongFile = H2TEST_FILE("functional/test.h2song");
+	const auto sOutFile = Filesystem::tmp_file_path("stems.wav");
+
+	auto pSong = Song::load( sSongFile );
+	CPPUNIT_ASSERT( pSong != nullptr );
+	pHydrogen->setSong( pSong );
+
+	auto pInstrumentList = pSong->getDrumkit()->getInstruments();
+	for ( auto i = 0; i < pInstrumentList->size(); i++ ) {
+		pInstrumentList->get(i)->setCurrentlyExported( true );
+	}
+
+	const auto stems = pHydrogen->getExportStems( sOutFile, false );
+	CPPUNIT_ASSERT( stems.size() > 1 );
+
+	pHydrogen->startExportSession( 44100, 32 );
+	pHydrogen->startExportSong( sOutFile, stems );
+
+	auto pDriver = dynamic_cast<DiskWriterDriver*>(pHydrogen->getAudioOutput());
+	CPPUNIT_ASSERT( pDriver != nullptr );
+
+	const int nMaxSleeps = 300;
+	int nSleeps = 0;
+	while ( ! pDriver->isDoneWriting() ) {
+		usleep(100 * 1000);
+		CPPUNIT_ASSERT( nSleeps < nMaxSleeps );
+		nSleeps++;
+	}
+	CPPUNIT_ASSERT( ! pDriver->writingFailed() );
+	pHydrogen->stopExportSession();
+
+	// All stems were rendered in the same pass and have to add up to
+	// the mix.
+	auto pMix = Sample::load( sOutFile );
+	CPPUNIT_ASSERT( pMix != nullptr );
+	std::vector<float> sum_L( pMix->getFrames(), 0 );
+	std::vector<float> sum_R( pMix->getFrames(), 0 );
+	for ( const auto& sstem : stems ) {
+		auto pStem = Sample::load( sstem.sFilename );
+		CPPUNIT_ASSERT( pStem != nullptr );
+		CPPUNIT_ASSERT_EQUAL( pMix->getFrames(), pStem->getFrames() );
+		for ( int ii = 0; ii < pStem->getFrames(); ++ii ) {
+			sum_L[ ii ] += pStem->getData_L()[ ii ];
+			sum_R[ ii ] += pStem->getData_R()[ ii ];
+		}
+		Filesystem::rm( sstem.sFilename );
+	}
+	for ( int ii = 0; ii < pMix->getFrames(); ++ii ) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pMix->getData_L()[ ii ], sum_L[ ii ], 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pMix->getData_R()[ ii ], sum_R[ ii ], 1e-5 );
+	}
+
+	Filesystem::rm( sOutFile );
+	___INFOLOG( "passed" );
+}
+
+void AudioExportTest::testExportInContexts() {
+	___INFOLOG( "" );
+	const auto sSongFile = H2TEST_FILE("functional/test_adsr.h2song");
+
+	struct Setup {
+		QString sOutFile;
+		QString sReferenceFile;
+		int nSampleRate;
+		bool bSuccess;
+	};
+
+	std::vector<Setup> setups;
+	setups.push_back( { Filesystem::tmp_file_path( "context-44100-16.wav" ),
+			H2TEST_FILE( "functional/test-44100-16.ref.flac" ), 44100, false } );
+	setups.push_back( { Filesystem::tmp_file_path( "context-48000-16.wav" ),
+			H2TEST_FILE( "functional/test-48000-16.ref.flac" ), 48000, false } );
+
+	auto pGlobalHydrogen = Hydrogen::get_instance();
+
+	// CppUnit assertions must not be used outside of the main thread.
+	auto exportInContext = [&]( Setup* pSetup ) {
+		EngineContext context;
+		EngineContext::Scope scope( &context );
+
+		auto pHydrogen = Hydrogen::get_instance();
+		if ( pHydrogen == nullptr || pHydrogen == pGlobalHydrogen ) {
+			return;
+		}
+
+		auto pSong = Song::load( sSongFile );
+		if ( pSong == nullptr ) {
+			return;
+		}
+		pHydrogen->setSong( pSong );
+
+		auto pInstrumentList = pSong->getDrumkit()->getInstruments();
+		for ( auto i = 0; i < pInstrumentList->size(); i++ ) {
+			pInstrumentList->get(i)->setCurrentlyExported( true );
+		}
+
+		if ( ! pHydrogen->startExportSession( pSetup->nSampleRate, 16 ) ) {
+			return;
+		}
+		pHydrogen->startExportSong( pSetup->sOutFile );
+
+		auto pDriver = dynamic_cast<DiskWriterDriver*>(pHydrogen->getAudioOutput());
+		if ( pDriver == nullptr ) {
+			return;
+		}
+
+		const int nMaxSleeps = 3000;
+		int nSleeps = 0;
+		while ( ! pDriver->isDoneWriting() && nSleeps < nMaxSleeps ) {
+			usleep(100 * 1000);
+			nSleeps++;
+		}
+		pSetup->bSuccess = pDriver->isDoneWriting() && ! pDriver->writingFailed();
+		pHydrogen->stopExportSession();
+	};
+
+	std::vector<std::thread> threads;
+	for ( auto& ssetup : setups ) {
+		threads.emplace_back( exportInContext, &ssetup );
+	}
+	for ( auto& tthread : threads ) {
+		tthread.join();
+	}
+
+	// The global instance must not be affected by the contexts.
+	CPPUNIT_ASSERT( Hydrogen::get_instance() == pGlobalHydrogen );
+	CPPUNIT_ASSERT( EngineContext::getCurrent() == nullptr );
+
+	for ( const auto& ssetup : setups ) {
+		CPPUNIT_ASSERT( ssetup.bSuccess );
+		H2TEST_ASSERT_AUDIO_FILES_EQUAL( ssetup.sReferenceFile, ssetup.sOutFile );
+		Filesystem::rm( ssetup.sOutFile );
+	}
+	___INFOLOG( "passed" );
+}
+
 void AudioExportTest::testFormats() {
 	___INFOLOG( "" );
 	auto pHydrogen = Hydrogen::get_instance();
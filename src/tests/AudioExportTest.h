@@ -29,6 +29,8 @@ class AudioExportTest : public CppUnit::TestCase {
 	CPPUNIT_TEST_SUITE( AudioExportTest );
 	CPPUNIT_TEST( testExportAudio );
 	CPPUNIT_TEST( testExportVelocityAutomationAudio );
+	CPPUNIT_TEST( testExportStems );
+	CPPUNIT_TEST( testExportInContexts );
 #ifdef H2CORE_HAVE_LIBARCHIVE
 	CPPUNIT_TEST( testFormats );
 #endif
@@ -37,6 +39,12 @@ class AudioExportTest : public CppUnit::TestCase {
 	public:
 		void testExportAudio();
 		void testExportVelocityAutomationAudio();
+		/** Renders a song once into the main mix as well as into one
+		 * file per instrument. */
+		void testExportStems();
+		/** Exports a song in several #H2Core::EngineContext
+		 * concurrently. */
+		void testExportInContexts();
 		/** Exports a song in all supported format, sample rate and sample depth
 		 * configurations. */
 		void testFormats();
@@ -61,6 +61,7 @@ class AutomationPathTest : public CppUnit::TestCase {
 	CPPUNIT_TEST(testFindNotFound);
 	CPPUNIT_TEST(testMovePoint);
 	CPPUNIT_TEST(testRemovePoint);
+	CPPUNIT_TEST(testCursor);
 	CPPUNIT_TEST_SUITE_END();
 
 	const double delta = 0.0001;
@@ -368,4 +369,42 @@ class AutomationPathTest : public CppUnit::TestCase {
 
 	___INFOLOG( "passed" );
 	}
+
+
+	/* Cursor has to yield the same values as a plain lookup and has
+	 * to pick up changes of the path. */
+	void testCursor()
+	{
+	___INFOLOG( "" );
+		AutomationPath p(0.0f, 1.0f, 0.5f);
+		AutomationPath::Cursor cursor;
+
+		CPPUNIT_ASSERT_EQUAL(0.5f, p.get_value(3.0f, cursor));
+
+		p.add_point(1.0f, 0.2f);
+		p.add_point(2.0f, 0.8f);
+		p.add_point(4.0f, 0.4f);
+
+		for (float x = -1.0f; x < 6.0f; x += 0.125f) {
+			CPPUNIT_ASSERT_EQUAL(p.get_value(x), p.get_value(x, cursor));
+		}
+
+		// Jumping back
+		CPPUNIT_ASSERT_EQUAL(p.get_value(1.5f), p.get_value(1.5f, cursor));
+
+		p.add_point(1.75f, 1.0f);
+		CPPUNIT_ASSERT_EQUAL(p.get_value(1.5f), p.get_value(1.5f, cursor));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+				1.0,
+				static_cast<double>(p.get_value(1.75f, cursor)),
+				delta);
+
+		p.remove_point(1.75f);
+		CPPUNIT_ASSERT_EQUAL(p.get_value(1.75f), p.get_value(1.75f, cursor));
+
+		// A different path does not use the segment of the previous one.
+		AutomationPath q(0.0f, 1.0f, 0.3f);
+		CPPUNIT_ASSERT_EQUAL(0.3f, q.get_value(1.75f, cursor));
+	___INFOLOG( "passed" );
+	}
 };
@@ -0,0 +1,156 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/CommandQueue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace H2Core;
+
+class CommandQueueTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( CommandQueueTest );
+	CPPUNIT_TEST( testOrder );
+	CPPUNIT_TEST( testOverflow );
+	CPPUNIT_TEST( testUnlockedProcessing );
+	CPPUNIT_TEST( testThreadedAccess );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void testOrder() {
+	___INFOLOG( "" );
+		CommandQueue queue;
+		std::vector<int> executed;
+
+		// Run twice to wrap around the slots.
+		for ( int nPass = 0; nPass < 2; ++nPass ) {
+			executed.clear();
+			for ( int ii = 0; ii < CommandQueue::nCapacity; ++ii ) {
+				CPPUNIT_ASSERT( queue.push( [&executed, ii]() {
+					executed.push_back( ii ); } ) );
+			}
+			CPPUNIT_ASSERT_EQUAL( CommandQueue::nCapacity, queue.size() );
+			CPPUNIT_ASSERT_EQUAL( CommandQueue::nCapacity, queue.processAll() );
+			CPPUNIT_ASSERT_EQUAL( 0, queue.size() );
+
+			CPPUNIT_ASSERT_EQUAL( CommandQueue::nCapacity,
+								  static_cast<int>(executed.size()) );
+			for ( int ii = 0; ii < executed.size(); ++ii ) {
+				CPPUNIT_ASSERT_EQUAL( ii, executed[ ii ] );
+			}
+		}
+
+		// Nothing left to do.
+		CPPUNIT_ASSERT_EQUAL( 0, queue.processAll() );
+	___INFOLOG( "passed" );
+	}
+
+	void testOverflow() {
+	___INFOLOG( "" );
+		CommandQueue queue;
+		int nExecuted = 0;
+		for ( int ii = 0; ii < CommandQueue::nCapacity; ++ii ) {
+			CPPUNIT_ASSERT( queue.push( [&nExecuted]() { ++nExecuted; } ) );
+		}
+
+		// Queue is full. The command must be rejected instead of
+		// overwriting a pending one.
+		CPPUNIT_ASSERT( ! queue.push( [&nExecuted]() { nExecuted += 1000; } ) );
+
+		CPPUNIT_ASSERT_EQUAL( CommandQueue::nCapacity, queue.processAll() );
+		CPPUNIT_ASSERT_EQUAL( CommandQueue::nCapacity, nExecuted );
+		CPPUNIT_ASSERT( queue.push( [&nExecuted]() { ++nExecuted; } ) );
+	___INFOLOG( "passed" );
+	}
+
+	void testUnlockedProcessing() {
+	___INFOLOG( "" );
+		CommandQueue queue;
+		std::vector<int> executed;
+		CPPUNIT_ASSERT( queue.push( [&executed]() {
+			executed.push_back( 0 ); }, false ) );
+		CPPUNIT_ASSERT( queue.push( [&executed]() {
+			executed.push_back( 1 ); }, true ) );
+		CPPUNIT_ASSERT( queue.push( [&executed]() {
+			executed.push_back( 2 ); }, false ) );
+
+		// Processing without the lock stops at the first command
+		// requiring it.
+		CPPUNIT_ASSERT_EQUAL( 1, queue.processAll( false ) );
+		CPPUNIT_ASSERT_EQUAL( 0, queue.processAll( false ) );
+		CPPUNIT_ASSERT_EQUAL( 2, queue.size() );
+
+		CPPUNIT_ASSERT_EQUAL( 2, queue.processAll( true ) );
+		CPPUNIT_ASSERT( executed == std::vector<int>( { 0, 1, 2 } ) );
+	___INFOLOG( "passed" );
+	}
+
+	void testThreadedAccess() {
+	___INFOLOG( "" );
+		const int nThreads = 8;
+		const int nCommandsPerThread = 20000;
+
+		CommandQueue queue;
+		std::vector<int> lastExecuted( nThreads, -1 );
+		std::atomic<int> nFinishedThreads( 0 );
+		bool bOrdered = true;
+
+		std::vector<std::thread> threads;
+		for ( int nThread = 0; nThread < nThreads; ++nThread ) {
+			threads.emplace_back( [&, nThread]() {
+				for ( int ii = 0; ii < nCommandsPerThread; ++ii ) {
+					// Commands of a single thread have to be executed in
+					// order.
+					while ( ! queue.push( [&, nThread, ii]() {
+						if ( lastExecuted[ nThread ] != ii - 1 ) {
+							bOrdered = false;
+						}
+						lastExecuted[ nThread ] = ii;
+					} ) ) {
+						std::this_thread::yield();
+					}
+				}
+				++nFinishedThreads;
+			} );
+		}
+
+		// Single consumer - like the audio thread.
+		int nTotal = 0;
+		while ( nFinishedThreads < nThreads || queue.size() > 0 ) {
+			nTotal += queue.processAll();
+		}
+		nTotal += queue.processAll();
+
+		for ( auto& tthread : threads ) {
+			tthread.join();
+		}
+
+		CPPUNIT_ASSERT( bOrdered );
+		CPPUNIT_ASSERT_EQUAL( nThreads * nCommandsPerThread, nTotal );
+		for ( const auto nLast : lastExecuted ) {
+			CPPUNIT_ASSERT_EQUAL( nCommandsPerThread - 1, nLast );
+		}
+	___INFOLOG( "passed" );
+	}
+};
@@ -21,8 +21,21 @@
  */
 
 #include "CoreActionControllerTest.h"
+#include "TestHelper.h"
+
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Sample.h>
 #include <core/CoreActionController.h>
+#include <core/DrumkitSwitcher.h>
 #include <core/Helpers/Filesystem.h>
+#include <core/Preferences/Preferences.h>
 
 #include <stdio.h>
 
@@ -160,3 +173,76 @@ void CoreActionControllerTest::testIsPathValid() {
 	
 	___INFOLOG( "passed" );
 }
+
+void CoreActionControllerTest::testDrumkitSwitching() {
+	___INFOLOG( "" );
+
+	auto pSong = Song::load( H2TEST_FILE( "song/AE_noteEnqueuing.h2song" ) );
+	CPPUNIT_ASSERT( pSong != nullptr );
+	CPPUNIT_ASSERT( CoreActionController::setSong( pSong ) );
+	const auto pPreviousDrumkit = pSong->getDrumkit();
+	CPPUNIT_ASSERT( pPreviousDrumkit != nullptr );
+
+	auto pDrumkit = Drumkit::load( H2TEST_FILE( "drumkits/baseKit" ), false, false );
+	CPPUNIT_ASSERT( pDrumkit != nullptr );
+
+	// Reference created using the plain mapping of the patterns.
+	std::vector<std::shared_ptr<Pattern>> referencePatterns;
+	for ( const auto& ppPattern : *pSong->getPatternList() ) {
+		auto pPattern = std::make_shared<Pattern>( ppPattern );
+		pPattern->mapTo( pDrumkit, pPreviousDrumkit );
+		referencePatterns.push_back( pPattern );
+	}
+
+	auto pPref = Preferences::get_instance();
+	const int nOldCrossfade = pPref->m_nDrumkitCrossfade;
+	pPref->m_nDrumkitCrossfade = 20;
+
+	CPPUNIT_ASSERT( CoreActionController::setDrumkitInBackground( pDrumkit ) );
+	m_pHydrogen->getDrumkitSwitcher()->waitForIdle();
+	CPPUNIT_ASSERT( ! m_pHydrogen->getDrumkitSwitcher()->isBusy() );
+	CPPUNIT_ASSERT( pSong->getDrumkit() == pDrumkit );
+
+	pPref->m_nDrumkitCrossfade = nOldCrossfade;
+
+	int nMappedNotes = 0;
+	CPPUNIT_ASSERT_EQUAL( static_cast<int>(referencePatterns.size()),
+						  pSong->getPatternList()->size() );
+	for ( int ii = 0; ii < pSong->getPatternList()->size(); ++ii ) {
+		const auto pNotes = pSong->getPatternList()->get( ii )->getNotes();
+		const auto pReferenceNotes = referencePatterns[ ii ]->getNotes();
+		CPPUNIT_ASSERT_EQUAL( pReferenceNotes->size(), pNotes->size() );
+		CPPUNIT_ASSERT( pSong->getPatternList()->get( ii )->getDrumkitName() ==
+						pDrumkit->getName() );
+
+		auto itReference = pReferenceNotes->begin();
+		for ( auto it = pNotes->begin(); it != pNotes->end();
+			  ++it, ++itReference ) {
+			CPPUNIT_ASSERT( it->second->getInstrument() ==
+							itReference->second->getInstrument() );
+			CPPUNIT_ASSERT_EQUAL( itReference->second->getInstrumentId(),
+								  it->second->getInstrumentId() );
+			CPPUNIT_ASSERT( it->second->getType() ==
+							itReference->second->getType() );
+			if ( it->second->getInstrument() != nullptr ) {
+				CPPUNIT_ASSERT( it->second->getAdsr() != nullptr );
+				++nMappedNotes;
+			}
+		}
+	}
+	CPPUNIT_ASSERT( nMappedNotes > 0 );
+
+	// No notes were played. All samples of the previous kit have to be
+	// freed.
+	for ( const auto& ppInstrument : *pPreviousDrumkit->getInstruments() ) {
+		for ( const auto& ppComponent : *ppInstrument->getComponents() ) {
+			for ( const auto& ppLayer : ppComponent->getLayers() ) {
+				if ( ppLayer != nullptr && ppLayer->getSample() != nullptr ) {
+					CPPUNIT_ASSERT( ! ppLayer->getSample()->isLoaded() );
+				}
+			}
+		}
+	}
+
+	___INFOLOG( "passed" );
+}
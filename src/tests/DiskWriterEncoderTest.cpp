@@ -0,0 +1,184 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/config.h>
+#include <core/IO/DiskWriterEncoder.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace H2Core;
+
+class DiskWriterEncoderTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( DiskWriterEncoderTest );
+	CPPUNIT_TEST( testClampAndInterleave );
+	CPPUNIT_TEST( testWrapAround );
+	CPPUNIT_TEST( testWriteFailure );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** In-memory file used via the virtual IO of libsndfile. Writes
+	 * past #nLimit bytes fail. */
+	struct MemoryFile {
+		std::vector<char> data;
+		sf_count_t nPos = 0;
+		sf_count_t nLimit = -1;
+	};
+
+	static sf_count_t getFileLength( void* pUserData ) {
+		return static_cast<MemoryFile*>(pUserData)->data.size();
+	}
+	static sf_count_t seek( sf_count_t nOffset, int nWhence, void* pUserData ) {
+		auto pFile = static_cast<MemoryFile*>(pUserData);
+		if ( nWhence == SEEK_CUR ) {
+			nOffset += pFile->nPos;
+		} else if ( nWhence == SEEK_END ) {
+			nOffset += pFile->data.size();
+		}
+		pFile->nPos = nOffset;
+		return pFile->nPos;
+	}
+	static sf_count_t read( void* pPtr, sf_count_t nCount, void* pUserData ) {
+		auto pFile = static_cast<MemoryFile*>(pUserData);
+		const sf_count_t nRead = std::max(
+			std::min<sf_count_t>( nCount, pFile->data.size() - pFile->nPos ),
+			static_cast<sf_count_t>(0) );
+		memcpy( pPtr, pFile->data.data() + pFile->nPos, nRead );
+		pFile->nPos += nRead;
+		return nRead;
+	}
+	static sf_count_t write( const void* pPtr, sf_count_t nCount,
+							 void* pUserData ) {
+		auto pFile = static_cast<MemoryFile*>(pUserData);
+		if ( pFile->nLimit >= 0 && pFile->nPos + nCount > pFile->nLimit ) {
+			return 0;
+		}
+		if ( pFile->nPos + nCount > pFile->data.size() ) {
+			pFile->data.resize( pFile->nPos + nCount );
+		}
+		memcpy( pFile->data.data() + pFile->nPos, pPtr, nCount );
+		pFile->nPos += nCount;
+		return nCount;
+	}
+	static sf_count_t tell( void* pUserData ) {
+		return static_cast<MemoryFile*>(pUserData)->nPos;
+	}
+
+	/** Opens a headerless stereo float file so its content can be
+	 * compared to the input directly. */
+	static SNDFILE* openFile( MemoryFile* pFile ) {
+		SF_VIRTUAL_IO io = { &getFileLength, &seek, &read, &write, &tell };
+		SF_INFO info;
+		memset( &info, 0, sizeof( info ) );
+		info.samplerate = 44100;
+		info.channels = 2;
+		info.format = SF_FORMAT_RAW | SF_FORMAT_FLOAT | SF_ENDIAN_CPU;
+		return sf_open_virtual( &io, SFM_WRITE, &info, pFile );
+	}
+
+public:
+
+	void testClampAndInterleave() {
+	___INFOLOG( "" );
+		const std::vector<float> in_L = {
+			0.5, -0.25, 1.0, -1.0, 1.5, -7.0, std::nanf( "" ),
+			1e30, -1e30 };
+		const std::vector<float> in_R = {
+			-0.5, 0.75, 0.0, 1.0001, -1.0001, std::nanf( "" ), 0.125,
+			-1e30, 1e30 };
+		const std::vector<float> expected = {
+			0.5, -0.5, -0.25, 0.75, 1.0, 0.0, -1.0, 1.0, 1.0, -1.0,
+			-1.0, 0.0, 0.0, 0.125, 1.0, -1.0, -1.0, 1.0 };
+
+		std::vector<float> out( 2 * in_L.size() );
+		DiskWriterEncoder::clampAndInterleave( in_L.data(), in_R.data(),
+											   out.data(), in_L.size() );
+		for ( int ii = 0; ii < out.size(); ++ii ) {
+			CPPUNIT_ASSERT_EQUAL( expected[ ii ], out[ ii ] );
+		}
+	___INFOLOG( "passed" );
+	}
+
+	void testWrapAround() {
+	___INFOLOG( "" );
+		MemoryFile file;
+		auto pSndfile = openFile( &file );
+		CPPUNIT_ASSERT( pSndfile != nullptr );
+
+		std::vector<float> expected;
+		{
+			DiskWriterEncoder encoder( { pSndfile } );
+
+			// Several passes through the ring using blocks of varying
+			// size.
+			const int nPushes = 3 * DiskWriterEncoder::nBlocks + 1;
+			std::vector<float> in_L( MAX_BUFFER_SIZE ), in_R( MAX_BUFFER_SIZE );
+			for ( int nn = 0; nn < nPushes; ++nn ) {
+				const int nFrames = 1 + ( nn * 37 ) % 256;
+				for ( int ii = 0; ii < nFrames; ++ii ) {
+					in_L[ ii ] = ( nn * 1000 + ii ) / 100000.0;
+					in_R[ ii ] = -in_L[ ii ];
+					expected.push_back( in_L[ ii ] );
+					expected.push_back( in_R[ ii ] );
+				}
+				CPPUNIT_ASSERT( encoder.push(
+					{ { in_L.data(), in_R.data() } }, nFrames ) );
+			}
+			CPPUNIT_ASSERT( encoder.finish() );
+		}
+		CPPUNIT_ASSERT( sf_close( pSndfile ) == 0 );
+
+		CPPUNIT_ASSERT_EQUAL( expected.size() * sizeof( float ),
+							  file.data.size() );
+		CPPUNIT_ASSERT( memcmp( expected.data(), file.data.data(),
+								file.data.size() ) == 0 );
+	___INFOLOG( "passed" );
+	}
+
+	void testWriteFailure() {
+	___INFOLOG( "" );
+		MemoryFile file;
+		auto pSndfile = openFile( &file );
+		CPPUNIT_ASSERT( pSndfile != nullptr );
+		// Writing the first block already fails.
+		file.nLimit = 0;
+
+		{
+			DiskWriterEncoder encoder( { pSndfile } );
+			std::vector<float> in_L( MAX_BUFFER_SIZE, 0.5 ),
+				in_R( MAX_BUFFER_SIZE, 0.5 );
+
+			// The producer must neither stall nor miss the failure. The
+			// ring holds at most nBlocks blocks. Pushing one more
+			// requires the failed block to be consumed.
+			bool bSuccess = true;
+			for ( int nn = 0; nn <= DiskWriterEncoder::nBlocks; ++nn ) {
+				bSuccess = encoder.push( { { in_L.data(), in_R.data() } }, 64 );
+			}
+			CPPUNIT_ASSERT( ! bSuccess );
+			CPPUNIT_ASSERT( ! encoder.finish() );
+		}
+		sf_close( pSndfile );
+		CPPUNIT_ASSERT( file.data.empty() );
+	___INFOLOG( "passed" );
+	}
+};
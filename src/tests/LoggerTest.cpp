@@ -0,0 +1,182 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Logger.h>
+#include <core/Object.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+
+using namespace H2Core;
+
+class LoggerTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( LoggerTest );
+	CPPUNIT_TEST( testRateLimiter );
+	CPPUNIT_TEST( testRealtimeLogging );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void testRateLimiter() {
+	___INFOLOG( "" );
+		Logger::RtRateLimiter rateLimiter;
+		int nSuppressed = -1;
+		const long long nStart = 100000;
+
+		// First message always passes.
+		CPPUNIT_ASSERT( rateLimiter.allow( nStart, &nSuppressed ) );
+		CPPUNIT_ASSERT_EQUAL( 0, nSuppressed );
+
+		// Repetitions within the interval are dropped and counted.
+		for ( int ii = 0; ii < 10; ++ii ) {
+			CPPUNIT_ASSERT( ! rateLimiter.allow( nStart + ii * 10, &nSuppressed ) );
+		}
+
+		CPPUNIT_ASSERT( rateLimiter.allow(
+							nStart + Logger::nRtRateLimitMs, &nSuppressed ) );
+		CPPUNIT_ASSERT_EQUAL( 10, nSuppressed );
+
+		// Counter was reset.
+		CPPUNIT_ASSERT( rateLimiter.allow(
+							nStart + 2 * Logger::nRtRateLimitMs, &nSuppressed ) );
+		CPPUNIT_ASSERT_EQUAL( 0, nSuppressed );
+	___INFOLOG( "passed" );
+	}
+
+	void testRealtimeLogging() {
+	___INFOLOG( "" );
+		auto pLogger = Logger::get_instance();
+		const unsigned nOldBitMask = Logger::bit_mask();
+		Logger::set_bit_mask( Logger::Error | Logger::Warning |
+							  Logger::Info | Logger::Debug );
+
+		// Distinguishes the messages of this run from those of earlier
+		// ones written to the same log file.
+		std::random_device randomDevice;
+		const int nRun = static_cast<int>( randomDevice() & 0x7fffffff );
+		const int nThreads = 4;
+
+		auto logMessages = [&]( int nPhase, int nMessages ) {
+			std::vector<std::thread> threads;
+			for ( int tt = 0; tt < nThreads; ++tt ) {
+				threads.emplace_back( [=]() {
+					for ( int ii = 0; ii < nMessages; ++ii ) {
+						pLogger->logRt( Logger::Debug, "LoggerTest",
+										"testRealtimeLogging", nullptr,
+										"run [%1], phase [%2], thread [%3], message [%4], value [%5]",
+										nRun, nPhase, tt, ii, 0.5 * ii );
+					}
+				} );
+			}
+			for ( auto& tthread : threads ) {
+				tthread.join();
+			}
+			pLogger->flush();
+		};
+
+		// As many messages as the ring can hold. None of them must be
+		// dropped, even if the logger thread does not keep up.
+		pLogger->flush();
+		logMessages( 1, Logger::nRtCapacity / nThreads );
+
+		// More messages than the ring can hold. Surplus ones are dropped
+		// instead of blocking the calling threads.
+		logMessages( 2, Logger::nRtCapacity );
+
+		// Rate-limited call site. Only the first message is written.
+		for ( int ii = 0; ii < 100; ++ii ) {
+			___WARNINGLOG_RT( "run [%1], rate-limited message [%2]", nRun, ii );
+		}
+		pLogger->flush();
+
+		QFile logFile( pLogger->getLogFilePath() );
+		CPPUNIT_ASSERT( logFile.open( QIODevice::ReadOnly | QIODevice::Text ) );
+		QTextStream stream( &logFile );
+
+		const QRegularExpression messageRegex(
+			QString( "run \\[%1\\], phase \\[(\\d)\\], thread \\[(\\d+)\\], message \\[(\\d+)\\]" )
+			.arg( nRun ) );
+		const QRegularExpression droppedRegex(
+			"\\[(\\d+)\\] realtime log messages dropped" );
+		const QString sRateLimited =
+			QString( "run [%1], rate-limited message" ).arg( nRun );
+
+		// Next expected message per phase and thread.
+		std::vector<std::vector<int>> nextMessages(
+			3, std::vector<int>( nThreads, 0 ) );
+		int nPhase2Written = 0;
+		int nPhase2Dropped = 0;
+		int nRateLimited = 0;
+		bool bPhase2Started = false;
+		while ( ! stream.atEnd() ) {
+			const QString sLine = stream.readLine();
+			const auto match = messageRegex.match( sLine );
+			if ( match.hasMatch() ) {
+				const int nPhase = match.captured( 1 ).toInt();
+				const int nThread = match.captured( 2 ).toInt();
+				const int nMessage = match.captured( 3 ).toInt();
+				CPPUNIT_ASSERT( nPhase == 1 || nPhase == 2 );
+				CPPUNIT_ASSERT( nThread >= 0 && nThread < nThreads );
+
+				if ( nPhase == 1 ) {
+					// All messages in the order they were logged.
+					CPPUNIT_ASSERT( ! bPhase2Started );
+					CPPUNIT_ASSERT_EQUAL( nextMessages[ 1 ][ nThread ], nMessage );
+				}
+				else {
+					// Gaps are allowed but messages of a single thread
+					// must still be in order.
+					bPhase2Started = true;
+					CPPUNIT_ASSERT( nMessage >= nextMessages[ 2 ][ nThread ] );
+					++nPhase2Written;
+				}
+				nextMessages[ nPhase ][ nThread ] = nMessage + 1;
+				continue;
+			}
+
+			const auto droppedMatch = droppedRegex.match( sLine );
+			if ( droppedMatch.hasMatch() && bPhase2Started ) {
+				nPhase2Dropped += droppedMatch.captured( 1 ).toInt();
+			}
+
+			if ( sLine.contains( sRateLimited ) ) {
+				++nRateLimited;
+			}
+		}
+
+		for ( int tt = 0; tt < nThreads; ++tt ) {
+			CPPUNIT_ASSERT_EQUAL( Logger::nRtCapacity / nThreads,
+								  nextMessages[ 1 ][ tt ] );
+		}
+		CPPUNIT_ASSERT_EQUAL( nThreads * Logger::nRtCapacity,
+							  nPhase2Written + nPhase2Dropped );
+		CPPUNIT_ASSERT_EQUAL( 1, nRateLimited );
+
+		Logger::set_bit_mask( nOldBitMask );
+	___INFOLOG( "passed" );
+	}
+};
@@ -24,8 +24,11 @@
 
 #include "TestHelper.h"
 
+#include <core/AudioEngine/NotePool.h>
+#include <core/Basics/Adsr.h>
 #include <core/Basics/Drumkit.h>
 #include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/Note.h>
 #include <core/Basics/Pattern.h>
@@ -101,6 +104,89 @@ void NoteTest::testComparison() {
 	___INFOLOG( "passed" );
 }
 
+void NoteTest::testFilter() {
+	___INFOLOG( "" );
+
+	auto pInstrument = std::make_shared<Instrument>();
+	pInstrument->setFilterActive( true );
+	pInstrument->setFilterCutoff( 0.3 );
+	pInstrument->setFilterResonance( 0.8 );
+
+	const int nFrames = 1000;
+	std::vector<float> input_L( nFrames ), input_R( nFrames );
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		input_L[ ii ] = static_cast<float>( ii * 37 % 101 ) / 101 - 0.5;
+		input_R[ ii ] = static_cast<float>( ii * 53 % 97 ) / 97 - 0.5;
+	}
+
+	// Per-frame recursion of the resonant low pass filter with
+	// coefficients changing linearly from the start to the end values.
+	float fBpfbL = 0, fBpfbR = 0, fLpfbL = 0, fLpfbR = 0;
+	auto filter = [&]( std::vector<float>& buffer_L,
+					   std::vector<float>& buffer_R, float fStartCutoff,
+					   float fStartResonance, float fEndCutoff,
+					   float fEndResonance ) {
+		const bool bRamp = fStartCutoff != fEndCutoff ||
+			fStartResonance != fEndResonance;
+		const float fCutoffStep = ( fEndCutoff - fStartCutoff ) / nFrames;
+		const float fResonanceStep =
+			( fEndResonance - fStartResonance ) / nFrames;
+		float fCutoff = fStartCutoff;
+		float fResonance = fStartResonance;
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			if ( bRamp ) {
+				fCutoff += fCutoffStep;
+				fResonance += fResonanceStep;
+			}
+			fBpfbL = fResonance * fBpfbL + fCutoff * ( buffer_L[ ii ] - fLpfbL );
+			fLpfbL += fCutoff * fBpfbL;
+			fBpfbR = fResonance * fBpfbR + fCutoff * ( buffer_R[ ii ] - fLpfbR );
+			fLpfbR += fCutoff * fBpfbR;
+			buffer_L[ ii ] = fLpfbL;
+			buffer_R[ ii ] = fLpfbR;
+		}
+	};
+
+	auto pNote = std::make_shared<Note>( pInstrument );
+
+	// Filtering has to be independent of the block size as long as the
+	// parameters are not changed.
+	std::vector<float> ref_L( input_L ), ref_R( input_R );
+	filter( ref_L, ref_R, 0.3, 0.8, 0.3, 0.8 );
+	std::vector<float> out_L( input_L ), out_R( input_R );
+	int nFrame = 0;
+	for ( const int nBlockSize : { 1, 63, 256, 680 } ) {
+		pNote->applyFilter( &out_L[ nFrame ], &out_R[ nFrame ], nBlockSize );
+		nFrame += nBlockSize;
+	}
+	CPPUNIT_ASSERT_EQUAL( nFrames, nFrame );
+	CPPUNIT_ASSERT( ref_L == out_L );
+	CPPUNIT_ASSERT( ref_R == out_R );
+
+	// Changed parameters are approached across the next block and used
+	// as they are for all following ones.
+	pInstrument->setFilterCutoff( 0.05 );
+	pInstrument->setFilterResonance( 0.5 );
+	for ( const bool bRamp : { true, false } ) {
+		ref_L = input_L;
+		ref_R = input_R;
+		if ( bRamp ) {
+			filter( ref_L, ref_R, 0.3, 0.8, 0.05, 0.5 );
+		} else {
+			filter( ref_L, ref_R, 0.05, 0.5, 0.05, 0.5 );
+		}
+		out_L = input_L;
+		out_R = input_R;
+		pNote->applyFilter( out_L.data(), out_R.data(), nFrames );
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( ref_L[ ii ], out_L[ ii ], 1e-6 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( ref_R[ ii ], out_R[ ii ], 1e-6 );
+		}
+	}
+
+	___INFOLOG( "passed" );
+}
+
 void NoteTest::testMappingLegacyDrumkit() {
 	___INFOLOG( "" );
 
@@ -387,6 +473,120 @@ void NoteTest::testMidiDefaultOffset() {
 	___INFOLOG( "passed" );
 }
 
+void NoteTest::testNotePool() {
+	___INFOLOG( "" );
+
+	auto pInstrument = std::make_shared<Instrument>( 7, "Snare", nullptr );
+	pInstrument->getAdsr()->setAttack( 123 );
+	auto pComponent = std::make_shared<InstrumentComponent>( "Main" );
+	pInstrument->addComponent( pComponent );
+
+	NotePool pool( 2 );
+	CPPUNIT_ASSERT_EQUAL( 2, pool.getCapacity() );
+	CPPUNIT_ASSERT_EQUAL( 2, pool.getAvailable() );
+
+	auto pReference = std::make_shared<Note>(
+		pInstrument, 42, 0.7f, 0.3f, 13, 2.0f );
+	pReference->setProbability( 0.5f );
+	pReference->setLeadLag( 0.2f );
+
+	// Fresh note
+	auto pNote = pool.acquire( pInstrument, 42, 0.7f, 0.3f, 13, 2.0f );
+	CPPUNIT_ASSERT( pNote->getInstrument() == pInstrument );
+	CPPUNIT_ASSERT_EQUAL( 7, pNote->getInstrumentId() );
+	CPPUNIT_ASSERT_EQUAL( 42, pNote->getPosition() );
+	CPPUNIT_ASSERT_EQUAL( 0.7f, pNote->getVelocity() );
+	CPPUNIT_ASSERT_EQUAL( pReference->getPan(), pNote->getPan() );
+	CPPUNIT_ASSERT_EQUAL( 13, pNote->getLength() );
+	CPPUNIT_ASSERT_EQUAL( 2.0f, pNote->getPitch() );
+	CPPUNIT_ASSERT_EQUAL( PROBABILITY_DEFAULT, pNote->getProbability() );
+	CPPUNIT_ASSERT( pNote->getAdsr() != nullptr );
+	CPPUNIT_ASSERT( pNote->getAdsr() != pInstrument->getAdsr() );
+	CPPUNIT_ASSERT_EQUAL( static_cast<unsigned int>(123),
+						  pNote->getAdsr()->getAttack() );
+	CPPUNIT_ASSERT_EQUAL( 1, pool.getAvailable() );
+	pNote->selectLayers( {} );
+	auto pSelectedLayerInfo = pNote->getSelecterLayerInfo( pComponent ).get();
+	CPPUNIT_ASSERT( pSelectedLayerInfo != nullptr );
+	pSelectedLayerInfo->fSamplePosition = 10;
+
+	// Copied note
+	auto pCopy = pool.acquire( pReference );
+	CPPUNIT_ASSERT( pCopy != pReference );
+	CPPUNIT_ASSERT( pCopy->getInstrument() == pInstrument );
+	CPPUNIT_ASSERT_EQUAL( pReference->getPosition(), pCopy->getPosition() );
+	CPPUNIT_ASSERT_EQUAL( pReference->getVelocity(), pCopy->getVelocity() );
+	CPPUNIT_ASSERT_EQUAL( pReference->getPan(), pCopy->getPan() );
+	CPPUNIT_ASSERT_EQUAL( pReference->getProbability(),
+						  pCopy->getProbability() );
+	CPPUNIT_ASSERT_EQUAL( pReference->getLeadLag(), pCopy->getLeadLag() );
+	CPPUNIT_ASSERT_EQUAL( 0, pool.getAvailable() );
+
+	// Pool is exhausted. We still get a valid note.
+	auto pOverflow = pool.acquire( pReference );
+	CPPUNIT_ASSERT( pOverflow != nullptr );
+	CPPUNIT_ASSERT_EQUAL( pReference->getPosition(), pOverflow->getPosition() );
+	CPPUNIT_ASSERT_EQUAL( static_cast<long>(1), pool.getMisses() );
+
+	// Released notes are recycled without leftovers of their former use.
+	auto pAdsr = pNote->getAdsr().get();
+	pNote = nullptr;
+	pCopy = nullptr;
+	CPPUNIT_ASSERT_EQUAL( 2, pool.getAvailable() );
+
+	pool.releaseIdleNotes( pInstrument );
+	auto pRecycled = pool.acquire( pInstrument, 3 );
+	CPPUNIT_ASSERT( pRecycled->getInstrument() == pInstrument );
+	CPPUNIT_ASSERT_EQUAL( 3, pRecycled->getPosition() );
+	CPPUNIT_ASSERT_EQUAL( VELOCITY_DEFAULT, pRecycled->getVelocity() );
+	CPPUNIT_ASSERT_EQUAL( LENGTH_ENTIRE_SAMPLE, pRecycled->getLength() );
+	CPPUNIT_ASSERT_EQUAL( PROBABILITY_DEFAULT, pRecycled->getProbability() );
+	// The envelope of the note is reused.
+	CPPUNIT_ASSERT( pRecycled->getAdsr().get() == pAdsr );
+	CPPUNIT_ASSERT_EQUAL( static_cast<unsigned int>(123),
+						  pRecycled->getAdsr()->getAttack() );
+	// So is the layer selection. But it starts from scratch.
+	CPPUNIT_ASSERT( pRecycled->getSelecterLayerInfo( pComponent ) == nullptr );
+	pRecycled->selectLayers( {} );
+	CPPUNIT_ASSERT( pRecycled->getSelecterLayerInfo( pComponent ).get() ==
+					pSelectedLayerInfo );
+	CPPUNIT_ASSERT_EQUAL( 0.0f, pSelectedLayerInfo->fSamplePosition );
+
+	auto pRecycled2 = pool.acquire( nullptr, 5 );
+	CPPUNIT_ASSERT( pRecycled2->getInstrument() == nullptr );
+	CPPUNIT_ASSERT_EQUAL( 5, pRecycled2->getPosition() );
+	CPPUNIT_ASSERT_EQUAL( PROBABILITY_DEFAULT, pRecycled2->getProbability() );
+	CPPUNIT_ASSERT_EQUAL( LEAD_LAG_DEFAULT, pRecycled2->getLeadLag() );
+	CPPUNIT_ASSERT_EQUAL( static_cast<long>(1), pool.getMisses() );
+
+	// Weak references keep a note from being recycled as well.
+	std::weak_ptr<Note> pWeakNote = pRecycled;
+	pRecycled = nullptr;
+	CPPUNIT_ASSERT_EQUAL( 0, pool.getAvailable() );
+	pWeakNote.reset();
+	CPPUNIT_ASSERT_EQUAL( 1, pool.getAvailable() );
+
+	// Instruments with more components than layer infos were created
+	// for by default.
+	auto pLargeInstrument = std::make_shared<Instrument>( 8, "Large", nullptr );
+	for ( int ii = 0; ii < NotePool::nLayerInfosPerNote + 2; ++ii ) {
+		pLargeInstrument->addComponent(
+			std::make_shared<InstrumentComponent>( QString::number( ii ) ) );
+	}
+	auto pDrumkit = std::make_shared<Drumkit>();
+	pDrumkit->getInstruments()->add( pLargeInstrument );
+	pool.reserveLayerInfos( pDrumkit );
+
+	auto pLargeNote = pool.acquire( pLargeInstrument );
+	pLargeNote->selectLayers( {} );
+	for ( const auto& ppComponent : *pLargeInstrument->getComponents() ) {
+		CPPUNIT_ASSERT( pLargeNote->getSelecterLayerInfo( ppComponent ) != nullptr );
+	}
+	CPPUNIT_ASSERT_EQUAL( static_cast<long>(1), pool.getMisses() );
+
+	___INFOLOG( "passed" );
+}
+
 void NoteTest::testPitchConversions() {
 	___INFOLOG( "" );
 
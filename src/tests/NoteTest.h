@@ -28,9 +28,11 @@
 class NoteTest : public CppUnit::TestCase {
 		CPPUNIT_TEST_SUITE( NoteTest );
 		CPPUNIT_TEST( testComparison );
+		CPPUNIT_TEST( testFilter );
 		CPPUNIT_TEST( testMappingLegacyDrumkit );
 		CPPUNIT_TEST( testMappingValidDrumkits );
 		CPPUNIT_TEST( testMidiDefaultOffset );
+		CPPUNIT_TEST( testNotePool );
 		CPPUNIT_TEST( testPitchConversions );
 		CPPUNIT_TEST( testProbability );
 		CPPUNIT_TEST( testSerializeProbability );
@@ -39,12 +41,18 @@ class NoteTest : public CppUnit::TestCase {
 
 	public:
 		void testComparison();
+		/** Block-wise filtering has to match the per-frame recursion and
+		 * must smoothly approach changed filter parameters. */
+		void testFilter();
 		/** Notes will be mapped back and forth between a valid/new drumkit and
 		 * one created prior to version 2.0. */
 		void testMappingLegacyDrumkit();
 		/** Notes will be mapped back and forth between two valid drumkits. */
 		void testMappingValidDrumkits();
 		void testMidiDefaultOffset();
+		/** Notes handed out by #H2Core::NotePool have to be equivalent to
+		 * freshly constructed ones and get recycled once released. */
+		void testNotePool();
 		void testPitchConversions();
 		void testProbability();
 		void testSerializeProbability();
@@ -0,0 +1,169 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <core/AudioEngine/NoteTimingWheel.h>
+#include <core/Basics/Note.h>
+#include <core/Helpers/Random.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class NoteTimingWheelTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( NoteTimingWheelTest );
+	CPPUNIT_TEST( testOrdering );
+	CPPUNIT_TEST( testPopDue );
+	CPPUNIT_TEST( testEraseIf );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Creates notes at random positions. Some of them are beyond the
+	 * horizon of the wheel and a couple start at the very same frame. */
+	std::vector<std::shared_ptr<Note>> createNotes( int nNumber ) {
+		std::vector<std::shared_ptr<Note>> notes;
+		for ( int ii = 0; ii < nNumber; ++ii ) {
+			int nPosition = static_cast<int>(
+				Random::getGaussian( 0.3 ) * 1000 ) + 1000;
+			if ( ii % 10 == 0 ) {
+				nPosition += 100000;
+			}
+			auto pNote = std::make_shared<Note>( nullptr, std::max( 0, nPosition ) );
+			pNote->setNoteOff( ii % 3 == 0 );
+			pNote->computeNoteStart();
+			notes.push_back( pNote );
+		}
+
+		return notes;
+	}
+
+	/** Checks whether the notes are ordered according to
+	 * Note::compareStart(). */
+	void checkOrder( const std::vector<std::shared_ptr<Note>>& notes ) {
+		for ( int ii = 1; ii < notes.size(); ++ii ) {
+			const auto pPrev = notes[ ii - 1 ];
+			const auto pNote = notes[ ii ];
+			CPPUNIT_ASSERT( pPrev->getNoteStart() <= pNote->getNoteStart() );
+			if ( pPrev->getNoteStart() == pNote->getNoteStart() ) {
+				CPPUNIT_ASSERT( ! pPrev->getNoteOff() || pNote->getNoteOff() );
+			}
+		}
+	}
+
+public:
+
+	void testOrdering() {
+		___INFOLOG( "" );
+
+		// Small capacity to check growing the wheel too.
+		NoteTimingWheel wheel( 8 );
+		const auto notes = createNotes( 500 );
+		for ( const auto& ppNote : notes ) {
+			wheel.push( ppNote );
+		}
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>(notes.size()), wheel.size() );
+
+		std::vector<std::shared_ptr<Note>> poppedNotes;
+		while ( ! wheel.empty() ) {
+			poppedNotes.push_back( wheel.top() );
+			wheel.pop();
+		}
+		CPPUNIT_ASSERT_EQUAL( notes.size(), poppedNotes.size() );
+		CPPUNIT_ASSERT( wheel.top() == nullptr );
+		checkOrder( poppedNotes );
+
+		___INFOLOG( "passed" );
+	}
+
+	void testPopDue() {
+		___INFOLOG( "" );
+
+		NoteTimingWheel wheel;
+		const auto notes = createNotes( 500 );
+		for ( const auto& ppNote : notes ) {
+			wheel.push( ppNote );
+		}
+
+		std::vector<std::shared_ptr<Note>> dueNotes;
+		long long nFrameEnd = 0;
+		while ( ! wheel.empty() ) {
+			nFrameEnd += 1024;
+			const int nPrevious = dueNotes.size();
+			const int nPopped = wheel.popDue( nFrameEnd, dueNotes );
+			CPPUNIT_ASSERT_EQUAL( nPrevious + nPopped,
+								  static_cast<int>(dueNotes.size()) );
+
+			for ( int ii = nPrevious; ii < dueNotes.size(); ++ii ) {
+				CPPUNIT_ASSERT( dueNotes[ ii ]->getNoteStart() < nFrameEnd );
+			}
+			if ( ! wheel.empty() ) {
+				CPPUNIT_ASSERT( wheel.top()->getNoteStart() >= nFrameEnd );
+			}
+
+			// A note arriving late has to be returned right away.
+			if ( nFrameEnd == 10 * 1024 ) {
+				auto pLateNote = std::make_shared<Note>( nullptr, 0 );
+				pLateNote->computeNoteStart();
+				wheel.push( pLateNote );
+				CPPUNIT_ASSERT( wheel.top() == pLateNote );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( notes.size() + 1, dueNotes.size() );
+
+		___INFOLOG( "passed" );
+	}
+
+	void testEraseIf() {
+		___INFOLOG( "" );
+
+		NoteTimingWheel wheel;
+		const auto notes = createNotes( 500 );
+		int nNoteOffs = 0;
+		for ( const auto& ppNote : notes ) {
+			wheel.push( ppNote );
+			if ( ppNote->getNoteOff() ) {
+				++nNoteOffs;
+			}
+		}
+
+		wheel.eraseIf( []( std::shared_ptr<Note> pNote ) {
+			return pNote->getNoteOff(); } );
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>(notes.size()) - nNoteOffs,
+							  wheel.size() );
+
+		std::vector<std::shared_ptr<Note>> poppedNotes;
+		while ( ! wheel.empty() ) {
+			CPPUNIT_ASSERT( ! wheel.top()->getNoteOff() );
+			poppedNotes.push_back( wheel.top() );
+			wheel.pop();
+		}
+		checkOrder( poppedNotes );
+
+		for ( const auto& ppNote : notes ) {
+			wheel.push( ppNote );
+		}
+		wheel.clear();
+		CPPUNIT_ASSERT( wheel.empty() );
+		CPPUNIT_ASSERT( wheel.top() == nullptr );
+
+		___INFOLOG( "passed" );
+	}
+};
@@ -57,6 +57,90 @@ void PatternTest::testCustomLegacyImport()
 	___INFOLOG( "passed" );
 }
 
+void PatternTest::testNoteSnapshot()
+{
+	___INFOLOG( "" );
+	auto pInstrument = std::make_shared<Instrument>();
+	auto pPattern = std::make_shared<Pattern>();
+
+	auto checkSnapshot = [&]() {
+		const auto pSnapshot = pPattern->getNoteSnapshot();
+		CPPUNIT_ASSERT( pSnapshot != nullptr );
+		CPPUNIT_ASSERT( pSnapshot->size() ==
+						static_cast<int>(pPattern->getNotes()->size()) );
+		int nn = 0;
+		for ( const auto& [ nnPosition, ppNote ] : *pPattern->getNotes() ) {
+			CPPUNIT_ASSERT( pSnapshot->getPosition( nn ) == nnPosition );
+			CPPUNIT_ASSERT( pSnapshot->getNote( nn ) == ppNote );
+			++nn;
+		}
+	};
+
+	checkSnapshot();
+	CPPUNIT_ASSERT( pPattern->getNoteSnapshot()->lowerBound( 0 ) == 0 );
+
+	std::vector<std::shared_ptr<Note>> notes;
+	for ( const int nnPosition : { 48, 0, 12, 12, 36 } ) {
+		auto pNote = std::make_shared<Note>( pInstrument, nnPosition );
+		notes.push_back( pNote );
+		pPattern->insertNote( pNote );
+		checkSnapshot();
+	}
+
+	const auto pOldSnapshot = pPattern->getNoteSnapshot();
+	CPPUNIT_ASSERT( pOldSnapshot->lowerBound( 12 ) == 1 );
+	CPPUNIT_ASSERT( pOldSnapshot->lowerBound( 13 ) == 3 );
+	CPPUNIT_ASSERT( pOldSnapshot->lowerBound( 49 ) == pOldSnapshot->size() );
+
+	pPattern->removeNote( notes[ 2 ] );
+	checkSnapshot();
+	CPPUNIT_ASSERT( pPattern->getNoteSnapshot() != pOldSnapshot );
+	CPPUNIT_ASSERT( pOldSnapshot->size() == 5 );
+	CPPUNIT_ASSERT( pOldSnapshot->getNote( 1 ) == notes[ 2 ] );
+
+	auto pCopy = std::make_shared<Pattern>( pPattern );
+	CPPUNIT_ASSERT( pCopy->getNoteSnapshot()->size() ==
+					pPattern->getNoteSnapshot()->size() );
+
+	pPattern->purgeInstrument( pInstrument );
+	checkSnapshot();
+	CPPUNIT_ASSERT( pPattern->getNoteSnapshot()->size() == 0 );
+	CPPUNIT_ASSERT( pCopy->getNoteSnapshot()->size() == 4 );
+
+	pCopy->clear();
+	CPPUNIT_ASSERT( pCopy->getNoteSnapshot()->size() == 0 );
+	CPPUNIT_ASSERT( pOldSnapshot->size() == 5 );
+
+	// Snapshots are only published on demand and replaced ones are
+	// released by the pattern instead of by their last reader.
+	std::weak_ptr<const Pattern::NoteSnapshot> pRetiredSnapshot;
+	{
+		const auto pSnapshot = pCopy->getNoteSnapshot();
+		pRetiredSnapshot = pSnapshot;
+		pCopy->insertNote( notes[ 0 ], false );
+		CPPUNIT_ASSERT( pCopy->getNoteSnapshot() == pSnapshot );
+		pCopy->updateNoteSnapshot();
+		CPPUNIT_ASSERT( pCopy->getNoteSnapshot()->size() == 1 );
+	}
+	CPPUNIT_ASSERT( ! pRetiredSnapshot.expired() );
+	pCopy->removeNote( notes[ 0 ] );
+	CPPUNIT_ASSERT( pRetiredSnapshot.expired() );
+
+	// Snapshots of patterns not edited anymore are released by the
+	// periodic sweep of the editing thread.
+	{
+		const auto pSnapshot = pCopy->getNoteSnapshot();
+		pRetiredSnapshot = pSnapshot;
+		pCopy->insertNote( notes[ 1 ] );
+		pCopy->releaseRetiredNoteSnapshots();
+		CPPUNIT_ASSERT( ! pRetiredSnapshot.expired() );
+	}
+	pCopy->releaseRetiredNoteSnapshots();
+	CPPUNIT_ASSERT( pRetiredSnapshot.expired() );
+
+	___INFOLOG( "passed" );
+}
+
 void PatternTest::testPurgeInstrument()
 {
 	___INFOLOG( "" );
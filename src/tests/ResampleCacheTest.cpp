@@ -0,0 +1,109 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Object.h>
+#include <core/Sampler/ResampleCache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+using namespace H2Core;
+
+class ResampleCacheTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( ResampleCacheTest );
+	CPPUNIT_TEST( testConvert );
+	CPPUNIT_TEST( testAbort );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Converts a sine and compares the result (away from the borders)
+	 * against its analytic counterpart at the target rate.
+	 *
+	 * \return Maximum amplitude of the result. */
+	static double checkSine( int nSourceRate, int nTargetRate,
+							 double fFrequency, double fTolerance ) {
+		const int nFrames = nSourceRate;
+		std::vector<float> data_L( nFrames ), data_R( nFrames );
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			data_L[ ii ] = std::sin( 2 * M_PI * fFrequency * ii / nSourceRate );
+			data_R[ ii ] = -data_L[ ii ];
+		}
+
+		auto pResampled = ResampleCache::convert(
+			data_L.data(), data_R.data(), nFrames, nSourceRate, nTargetRate );
+		CPPUNIT_ASSERT( pResampled != nullptr );
+		CPPUNIT_ASSERT_EQUAL( nTargetRate, pResampled->nSampleRate );
+		CPPUNIT_ASSERT_EQUAL( nTargetRate, pResampled->nFrames );
+
+		double fMaxAmplitude = 0;
+		for ( int ii = 256; ii < pResampled->nFrames - 256; ++ii ) {
+			const double fExpected =
+				std::sin( 2 * M_PI * fFrequency * ii / nTargetRate );
+			if ( fTolerance > 0 ) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(
+					fExpected, pResampled->data_L[ ii ], fTolerance );
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(
+					-fExpected, pResampled->data_R[ ii ], fTolerance );
+			}
+			fMaxAmplitude = std::max(
+				fMaxAmplitude,
+				static_cast<double>( std::abs( pResampled->data_L[ ii ] ) ) );
+		}
+		return fMaxAmplitude;
+	}
+
+public:
+
+	void testConvert() {
+	___INFOLOG( "" );
+		checkSine( 44100, 48000, 1000, 1e-4 );
+		checkSine( 44100, 48000, 15000, 1e-4 );
+		checkSine( 48000, 44100, 1000, 1e-4 );
+		checkSine( 22050, 48000, 5000, 1e-4 );
+
+		// Content above the Nyquist frequency of the target rate has
+		// to be removed instead of being aliased.
+		CPPUNIT_ASSERT( checkSine( 96000, 44100, 30000, 0 ) < 1e-3 );
+	___INFOLOG( "passed" );
+	}
+
+	void testAbort() {
+	___INFOLOG( "" );
+		std::vector<float> data( 1000, 0.5 );
+		std::atomic<bool> bAbort( true );
+		CPPUNIT_ASSERT( ResampleCache::convert(
+							data.data(), data.data(), 1000, 44100, 48000,
+							&bAbort ) == nullptr );
+
+		bAbort = false;
+		CPPUNIT_ASSERT( ResampleCache::convert(
+							data.data(), data.data(), 1000, 44100, 48000,
+							&bAbort ) != nullptr );
+
+		CPPUNIT_ASSERT( ResampleCache::convert(
+							data.data(), data.data(), 0, 44100, 48000 ) == nullptr );
+		CPPUNIT_ASSERT( ResampleCache::convert(
+							nullptr, data.data(), 1000, 44100, 48000 ) == nullptr );
+	___INFOLOG( "passed" );
+	}
+};
@@ -0,0 +1,227 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Object.h>
+#include <core/Sampler/Interpolation.h>
+#include <core/Sampler/ResampleKernels.h>
+
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace H2Core;
+
+class ResampleKernelsTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( ResampleKernelsTest );
+	CPPUNIT_TEST( testParity );
+	CPPUNIT_TEST( testPackedParity );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Scalar reference as used within Sampler.cpp. */
+	template < Interpolation::InterpolateMode mode, typename T >
+	static void reference( float* pBuffer, const T* pData, int nFrames,
+						   double fSamplePos, float fStep ) {
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			const int nPos = static_cast<int>(fSamplePos);
+			pBuffer[ ii ] = Interpolation::interpolate<mode>(
+				ResampleKernels::toFloat( pData[ nPos - 1 ] ),
+				ResampleKernels::toFloat( pData[ nPos ] ),
+				ResampleKernels::toFloat( pData[ nPos + 1 ] ),
+				ResampleKernels::toFloat( pData[ nPos + 2 ] ),
+				fSamplePos - nPos );
+			fSamplePos += fStep;
+		}
+	}
+
+	template < typename T >
+	static void reference( Interpolation::InterpolateMode mode, float* pBuffer,
+						   const T* pData, int nFrames, double fSamplePos,
+						   float fStep ) {
+		switch ( mode ) {
+		case Interpolation::InterpolateMode::Linear:
+			reference<Interpolation::InterpolateMode::Linear, T>(
+				pBuffer, pData, nFrames, fSamplePos, fStep );
+			break;
+		case Interpolation::InterpolateMode::Cosine:
+			reference<Interpolation::InterpolateMode::Cosine, T>(
+				pBuffer, pData, nFrames, fSamplePos, fStep );
+			break;
+		case Interpolation::InterpolateMode::Third:
+			reference<Interpolation::InterpolateMode::Third, T>(
+				pBuffer, pData, nFrames, fSamplePos, fStep );
+			break;
+		case Interpolation::InterpolateMode::Cubic:
+			reference<Interpolation::InterpolateMode::Cubic, T>(
+				pBuffer, pData, nFrames, fSamplePos, fStep );
+			break;
+		case Interpolation::InterpolateMode::Hermite:
+			reference<Interpolation::InterpolateMode::Hermite, T>(
+				pBuffer, pData, nFrames, fSamplePos, fStep );
+			break;
+		}
+	}
+
+public:
+
+	void testParity() {
+	___INFOLOG( "" );
+		const int nSampleFrames = 1 << 17;
+		const int nFrames = 4099; // not a multiple of any vector width
+
+		std::mt19937 generator( 1234 );
+		std::uniform_real_distribution<float> distribution( -1.0, 1.0 );
+		std::vector<float> data_L( nSampleFrames ), data_R( nSampleFrames );
+		for ( int ii = 0; ii < nSampleFrames; ++ii ) {
+			data_L[ ii ] = distribution( generator );
+			data_R[ ii ] = distribution( generator );
+		}
+
+		std::vector<float> ref_L( nFrames ), ref_R( nFrames );
+		std::vector<float> out_L( nFrames ), out_R( nFrames );
+
+		const std::vector<Interpolation::InterpolateMode> modes = {
+			Interpolation::InterpolateMode::Linear,
+			Interpolation::InterpolateMode::Cosine,
+			Interpolation::InterpolateMode::Third,
+			Interpolation::InterpolateMode::Cubic,
+			Interpolation::InterpolateMode::Hermite };
+		const std::vector<ResampleKernels::Isa> isas = {
+			ResampleKernels::Isa::SSE2,
+			ResampleKernels::Isa::AVX2,
+			ResampleKernels::Isa::AVX512 };
+
+		for ( const auto mode : modes ) {
+			for ( const float fStep : { 0.5f, 0.918707f, 1.0884354f, 1.9999f } ) {
+				for ( const double fSamplePos : { 1.0, 1.37, 76543.21 } ) {
+					reference( mode, ref_L.data(), data_L.data(), nFrames,
+							   fSamplePos, fStep );
+					reference( mode, ref_R.data(), data_R.data(), nFrames,
+							   fSamplePos, fStep );
+
+					for ( const auto isa : isas ) {
+						auto kernel = ResampleKernels::getKernel(
+							isa, static_cast<int>(mode) );
+						if ( kernel == nullptr ) {
+							// Not supported by the CPU.
+							continue;
+						}
+
+						kernel( out_L.data(), out_R.data(), data_L.data(),
+								data_R.data(), nFrames, fSamplePos, fStep );
+
+						for ( int ii = 0; ii < nFrames; ++ii ) {
+							CPPUNIT_ASSERT_DOUBLES_EQUAL(
+								ref_L[ ii ], out_L[ ii ],
+								ResampleKernels::fTolerance );
+							CPPUNIT_ASSERT_DOUBLES_EQUAL(
+								ref_R[ ii ], out_R[ ii ],
+								ResampleKernels::fTolerance );
+						}
+
+						// Mono samples use the same data for both channels.
+						kernel( out_L.data(), out_R.data(), data_L.data(),
+								data_L.data(), nFrames, fSamplePos, fStep );
+						for ( int ii = 0; ii < nFrames; ++ii ) {
+							CPPUNIT_ASSERT_DOUBLES_EQUAL(
+								ref_L[ ii ], out_L[ ii ],
+								ResampleKernels::fTolerance );
+							CPPUNIT_ASSERT( out_L[ ii ] == out_R[ ii ] );
+						}
+					}
+				}
+			}
+		}
+	___INFOLOG( "passed" );
+	}
+
+	/** The kernels for packed integer data have to match the scalar
+	 * path widening each frame before interpolating. */
+	template < typename T >
+	void checkPackedParity( T (*convert)( float ) ) {
+		const int nSampleFrames = 1 << 17;
+		const int nFrames = 4099;
+
+		std::mt19937 generator( 4321 );
+		std::uniform_real_distribution<float> distribution( -1.0, 1.0 );
+		// The vectorized gathers read a few bytes past the last frame.
+		std::vector<T> data_L( nSampleFrames + 2 ), data_R( nSampleFrames + 2 );
+		for ( int ii = 0; ii < nSampleFrames; ++ii ) {
+			data_L[ ii ] = convert( distribution( generator ) );
+			data_R[ ii ] = convert( distribution( generator ) );
+		}
+
+		std::vector<float> ref_L( nFrames ), ref_R( nFrames );
+		std::vector<float> out_L( nFrames ), out_R( nFrames );
+
+		for ( const auto mode : { Interpolation::InterpolateMode::Linear,
+								  Interpolation::InterpolateMode::Hermite } ) {
+			for ( const float fStep : { 0.5f, 1.0884354f, 1.9999f } ) {
+				for ( const double fSamplePos : { 1.0, 1.37, 76543.21 } ) {
+					reference( mode, ref_L.data(), data_L.data(), nFrames,
+							   fSamplePos, fStep );
+					reference( mode, ref_R.data(), data_R.data(), nFrames,
+							   fSamplePos, fStep );
+
+					for ( const auto isa : { ResampleKernels::Isa::SSE2,
+											 ResampleKernels::Isa::AVX2,
+											 ResampleKernels::Isa::AVX512 } ) {
+						auto kernel = ResampleKernels::getKernelFor<T>(
+							isa, static_cast<int>(mode) );
+						if ( kernel == nullptr ) {
+							continue;
+						}
+
+						kernel( out_L.data(), out_R.data(), data_L.data(),
+								data_R.data(), nFrames, fSamplePos, fStep );
+						for ( int ii = 0; ii < nFrames; ++ii ) {
+							CPPUNIT_ASSERT_DOUBLES_EQUAL(
+								ref_L[ ii ], out_L[ ii ],
+								ResampleKernels::fTolerance );
+							CPPUNIT_ASSERT_DOUBLES_EQUAL(
+								ref_R[ ii ], out_R[ ii ],
+								ResampleKernels::fTolerance );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void testPackedParity() {
+	___INFOLOG( "" );
+		checkPackedParity<int16_t>( &ResampleKernels::toInt16 );
+		checkPackedParity<ResampleKernels::Int24>( &ResampleKernels::toInt24 );
+
+		// Conversion clips and maps NaN to silence.
+		CPPUNIT_ASSERT( ResampleKernels::toInt16( 2.0 ) == 32767 );
+		CPPUNIT_ASSERT( ResampleKernels::toInt16( -2.0 ) == -32768 );
+		CPPUNIT_ASSERT( ResampleKernels::toInt16( std::nanf( "" ) ) == 0 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			0.5, ResampleKernels::toFloat( ResampleKernels::toInt24( 0.5 ) ),
+			ResampleKernels::fInt24Scale );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			-1.0, ResampleKernels::toFloat( ResampleKernels::toInt24( -3.0 ) ),
+			ResampleKernels::fInt24Scale );
+	___INFOLOG( "passed" );
+	}
+};
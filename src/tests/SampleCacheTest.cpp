@@ -0,0 +1,138 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Sample.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/SampleCache.h>
+#include <core/Sampler/SampleRegistry.h>
+
+#include <QFile>
+
+#include "TestHelper.h"
+
+using namespace H2Core;
+
+class SampleCacheTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SampleCacheTest );
+	CPPUNIT_TEST( testStoreAndMap );
+	CPPUNIT_TEST( testInvalidEntry );
+	CPPUNIT_TEST_SUITE_END();
+
+	int m_nPreviousSize;
+
+public:
+
+	void setUp() override {
+		// The cache resides in the user data folder. The limit is
+		// chosen large enough for no foreign entries to be evicted.
+		auto pPref = Preferences::get_instance();
+		m_nPreviousSize = pPref->m_nSampleCacheSize;
+		pPref->m_nSampleCacheSize = 1 << 20;
+	}
+
+	void tearDown() override {
+		Preferences::get_instance()->m_nSampleCacheSize = m_nPreviousSize;
+	}
+
+	void testStoreAndMap() {
+	___INFOLOG( "" );
+		// Samples of the test kit might be shared with other tests
+		// via the SampleRegistry. We use a private copy instead.
+		const QString sPath = Filesystem::tmp_file_path( "cached-snare.wav" );
+		CPPUNIT_ASSERT( Filesystem::file_copy(
+							H2TEST_FILE( "drumkits/baseKit/snare.wav" ),
+							sPath, true, true ) );
+		const QString sEntryPath = SampleCache::getEntryPath( sPath );
+		CPPUNIT_ASSERT( ! sEntryPath.isEmpty() );
+		QFile::remove( sEntryPath );
+		CPPUNIT_ASSERT( SampleCache::lookup( sPath ) == nullptr );
+
+		// Decoded and added to the cache.
+		auto pDecoded = std::make_shared<Sample>( sPath );
+		CPPUNIT_ASSERT( pDecoded->load( 120, 0, true ) );
+		CPPUNIT_ASSERT( QFile::exists( sEntryPath ) );
+
+		// Mapped from the cache once no other sample shares the
+		// decoded data anymore.
+		const std::vector<float> data_L(
+			pDecoded->getData_L(),
+			pDecoded->getData_L() + pDecoded->getFrames() );
+		const int nSampleRate = pDecoded->getSampleRate();
+		pDecoded->unload();
+		auto pMapped = std::make_shared<Sample>( sPath );
+		CPPUNIT_ASSERT( pMapped->load( 120, 0, true ) );
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>(data_L.size()),
+							  pMapped->getFrames() );
+		CPPUNIT_ASSERT_EQUAL( nSampleRate, pMapped->getSampleRate() );
+		for ( int ii = 0; ii < pMapped->getFrames(); ++ii ) {
+			CPPUNIT_ASSERT( data_L[ ii ] == pMapped->getData_L()[ ii ] );
+		}
+		bool bMapped = false;
+		for ( const auto& info : SampleRegistry::getInfos() ) {
+			if ( info.sPath == sPath ) {
+				bMapped = info.bMapped;
+			}
+		}
+		CPPUNIT_ASSERT( bMapped );
+
+		// Copies share the mapping.
+		auto pCopy = std::make_shared<Sample>( pMapped );
+		pMapped->unload();
+		CPPUNIT_ASSERT( pCopy->getData_L()[ 0 ] == data_L[ 0 ] );
+		pCopy = nullptr;
+
+		// Samples loaded without the cache do not add entries.
+		QFile::remove( sEntryPath );
+		auto pUncached = Sample::load( sPath );
+		CPPUNIT_ASSERT( pUncached != nullptr );
+		CPPUNIT_ASSERT( ! QFile::exists( sEntryPath ) );
+
+		Filesystem::rm( sPath );
+	___INFOLOG( "passed" );
+	}
+
+	void testInvalidEntry() {
+	___INFOLOG( "" );
+		const QString sPath = H2TEST_FILE( "drumkits/baseKit/kick.wav" );
+		const QString sEntryPath = SampleCache::getEntryPath( sPath );
+		CPPUNIT_ASSERT( SampleCache::store(
+							sPath, 44100, 4, 1,
+							std::vector<float>( 4, 0.5 ).data(),
+							std::vector<float>( 4, 0.5 ).data() ) );
+		auto pEntry = SampleCache::lookup( sPath );
+		CPPUNIT_ASSERT( pEntry != nullptr );
+		CPPUNIT_ASSERT_EQUAL( 1, pEntry->getChannels() );
+		CPPUNIT_ASSERT( pEntry->getData_L() == pEntry->getData_R() );
+		pEntry = nullptr;
+
+		// Truncated entries are removed.
+		QFile file( sEntryPath );
+		CPPUNIT_ASSERT( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+		file.write( "H2SCACHE" );
+		file.close();
+		CPPUNIT_ASSERT( SampleCache::lookup( sPath ) == nullptr );
+		CPPUNIT_ASSERT( ! QFile::exists( sEntryPath ) );
+	___INFOLOG( "passed" );
+	}
+};
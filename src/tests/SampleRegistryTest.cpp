@@ -0,0 +1,102 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Sample.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Sampler/SampleRegistry.h>
+
+#include "TestHelper.h"
+
+using namespace H2Core;
+
+class SampleRegistryTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SampleRegistryTest );
+	CPPUNIT_TEST( testSharing );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** \return Number of Samples sharing the buffer of @a sPath
+	 * holding @a nFrames frames or -1 if none is registered.
+	 *
+	 * Buffers of the same file but with different modifiers are
+	 * registered separately. They are told apart by their length. */
+	long getUsers( const QString& sPath, int nFrames ) {
+		long nUsers = -1;
+		for ( const auto& info : SampleRegistry::getInfos() ) {
+			if ( info.sPath == sPath && info.nFrames == nFrames ) {
+				CPPUNIT_ASSERT( nUsers == -1 );
+				nUsers = info.nUsers;
+			}
+		}
+		return nUsers;
+	}
+
+public:
+
+	void testSharing() {
+	___INFOLOG( "" );
+		// Samples of the test kit might be shared with other tests.
+		// We use a private copy instead.
+		const QString sPath = Filesystem::tmp_file_path( "shared-snare.wav" );
+		CPPUNIT_ASSERT( Filesystem::file_copy(
+							H2TEST_FILE( "drumkits/baseKit/snare.wav" ),
+							sPath, true, true ) );
+
+		auto pFirst = Sample::load( sPath );
+		auto pSecond = Sample::load( sPath );
+		CPPUNIT_ASSERT( pFirst != nullptr && pSecond != nullptr );
+		CPPUNIT_ASSERT( pFirst->getData_L() == pSecond->getData_L() );
+		CPPUNIT_ASSERT( pFirst->getData_R() == pSecond->getData_R() );
+		const int nFrames = pFirst->getFrames();
+		CPPUNIT_ASSERT_EQUAL( 2L, getUsers( sPath, nFrames ) );
+
+		// Modifiers result in a buffer of its own.
+		auto pLooped = std::make_shared<Sample>( sPath );
+		Sample::Loops loops;
+		loops.end_frame = pFirst->getFrames() / 2;
+		pLooped->setLoops( loops );
+		CPPUNIT_ASSERT( pLooped->load() );
+		CPPUNIT_ASSERT( pLooped->getData_L() != pFirst->getData_L() );
+		CPPUNIT_ASSERT_EQUAL( pFirst->getFrames() / 2, pLooped->getFrames() );
+		CPPUNIT_ASSERT_EQUAL( 1L, getUsers( sPath, pLooped->getFrames() ) );
+
+		// Copies share the data as well.
+		auto pCopy = std::make_shared<Sample>( pFirst );
+		CPPUNIT_ASSERT( pCopy->getData_L() == pFirst->getData_L() );
+		CPPUNIT_ASSERT_EQUAL( 3L, getUsers( sPath, nFrames ) );
+
+		// Buffers are freed along with their last user.
+		const std::vector<float> data_L(
+			pFirst->getData_L(), pFirst->getData_L() + pFirst->getFrames() );
+		pFirst->unload();
+		pSecond = nullptr;
+		CPPUNIT_ASSERT( pCopy->getData_L()[ 0 ] == data_L[ 0 ] );
+		pCopy->unload();
+		CPPUNIT_ASSERT_EQUAL( -1L, getUsers( sPath, nFrames ) );
+		pLooped->unload();
+		CPPUNIT_ASSERT_EQUAL( -1L, getUsers( sPath, nFrames / 2 ) );
+
+		Filesystem::rm( sPath );
+	___INFOLOG( "passed" );
+	}
+};
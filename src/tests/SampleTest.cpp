@@ -24,10 +24,19 @@
 #include "TestHelper.h"
 
 #include <core/Basics/Sample.h>
+#include <core/Sampler/Sampler.h>
+#include <core/Sampler/SampleStreamer.h>
+
+#include <chrono>
+#include <thread>
 
 class SampleTest : public CppUnit::TestCase {
 	CPPUNIT_TEST_SUITE( SampleTest );
 	CPPUNIT_TEST( testLoadInvalidSample );
+	CPPUNIT_TEST( testStreaming );
+	CPPUNIT_TEST( testStreamingOffline );
+	CPPUNIT_TEST( testMono );
+	CPPUNIT_TEST( testPacked );
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -47,4 +56,187 @@ class SampleTest : public CppUnit::TestCase {
 		CPPUNIT_ASSERT(pSample == nullptr);
 	___INFOLOG( "passed" );
 	}
+
+	void testStreaming()
+	{
+	___INFOLOG( "" );
+		const QString sPath = H2TEST_FILE( "drumkits/baseKit/crash.wav" );
+		auto pSample = H2Core::Sample::load( sPath );
+		CPPUNIT_ASSERT( pSample != nullptr );
+		CPPUNIT_ASSERT( ! pSample->isStreamed() );
+		const int nFrames = pSample->getFrames();
+
+		const int nHeadFrames = 1000;
+		auto pStreamed = std::make_shared<H2Core::Sample>( sPath );
+		CPPUNIT_ASSERT( pStreamed->load( 120, nHeadFrames ) );
+		CPPUNIT_ASSERT( pStreamed->isStreamed() );
+		CPPUNIT_ASSERT( pStreamed->getHeadFrames() == nHeadFrames );
+		CPPUNIT_ASSERT( pStreamed->getFrames() == nFrames );
+
+		// Read the whole sample in chunks of a typical buffer size.
+		// Chunks not prefetched yet are requested again.
+		H2Core::SampleStreamer streamer( 1 );
+		const int nStream = streamer.acquire( pStreamed );
+		CPPUNIT_ASSERT( nStream == 0 );
+		CPPUNIT_ASSERT( streamer.acquire( pStreamed ) == -1 );
+
+		const int nChunk = 512;
+		std::vector<float> data_L( nFrames + nChunk ), data_R( nFrames + nChunk );
+		for ( int nPos = 0; nPos < nFrames; nPos += nChunk ) {
+			int nTries = 0;
+			while ( ! streamer.read( nStream, pStreamed.get(), nPos, nChunk,
+									 &data_L[ nPos ], &data_R[ nPos ] ) ) {
+				CPPUNIT_ASSERT( ++nTries < 1000 );
+				std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+			}
+		}
+		streamer.release( nStream );
+
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			CPPUNIT_ASSERT( data_L[ ii ] == pSample->getData_L()[ ii ] );
+			CPPUNIT_ASSERT( data_R[ ii ] == pSample->getData_R()[ ii ] );
+		}
+		for ( int ii = nFrames; ii < data_L.size(); ++ii ) {
+			CPPUNIT_ASSERT( data_L[ ii ] == 0 );
+			CPPUNIT_ASSERT( data_R[ ii ] == 0 );
+		}
+	___INFOLOG( "passed" );
+	}
+
+	void testStreamingOffline()
+	{
+	___INFOLOG( "" );
+		const QString sPath = H2TEST_FILE( "drumkits/baseKit/crash.wav" );
+		auto pSample = H2Core::Sample::load( sPath );
+		CPPUNIT_ASSERT( pSample != nullptr );
+		const int nFrames = pSample->getFrames();
+
+		auto pStreamed = std::make_shared<H2Core::Sample>( sPath );
+		CPPUNIT_ASSERT( pStreamed->load( 120, 1000 ) );
+		CPPUNIT_ASSERT( pStreamed->isStreamed() );
+
+		// Pitched rendering of the whole sample at once. Reads do
+		// outpace the prefetch thread but have to wait for it instead
+		// of rendering silence.
+		H2Core::SampleStreamer streamer( 1 );
+		streamer.setOffline( true );
+		const int nStream = streamer.acquire( pStreamed );
+		CPPUNIT_ASSERT( nStream == 0 );
+
+		const float fStep = 1.5;
+		const int nOutFrames = static_cast<int>( nFrames / fStep ) + 4;
+		std::vector<float> streamed_L( nOutFrames ), streamed_R( nOutFrames );
+		H2Core::renderStreamed( H2Core::Interpolation::InterpolateMode::Linear,
+								&streamer, nStream, pStreamed.get(),
+								streamed_L.data(), streamed_R.data(),
+								nOutFrames, 0, fStep, true );
+		streamer.release( nStream );
+		CPPUNIT_ASSERT( streamer.getUnderruns() == 0 );
+		CPPUNIT_ASSERT( streamer.getMissingFrames() == 0 );
+
+		std::vector<float> expected_L( nOutFrames ), expected_R( nOutFrames );
+		double fSamplePos = 0;
+		H2Core::resample( H2Core::Interpolation::InterpolateMode::Linear,
+						  expected_L.data(), expected_R.data(),
+						  pSample->getData_L(), pSample->getData_R(),
+						  nOutFrames, fSamplePos, fStep, nFrames );
+
+		for ( int ii = 0; ii < nOutFrames; ++ii ) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( expected_L[ ii ], streamed_L[ ii ], 1e-5 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( expected_R[ ii ], streamed_R[ ii ], 1e-5 );
+		}
+	___INFOLOG( "passed" );
+	}
+
+	void testMono()
+	{
+	___INFOLOG( "" );
+		const QString sPath = H2TEST_FILE( "drumkits/baseKit/kick.wav" );
+		auto pSample = H2Core::Sample::load( sPath );
+		CPPUNIT_ASSERT( pSample != nullptr );
+		CPPUNIT_ASSERT( pSample->isMono() );
+		CPPUNIT_ASSERT( pSample->getData_L() == pSample->getData_R() );
+		const int nFrames = pSample->getFrames();
+
+		// Envelopes must be applied just once.
+		const float fGain = ( 91 - 13 ) / 91.0F;
+		auto pVelocity = std::make_shared<H2Core::Sample>( sPath );
+		pVelocity->setVelocityEnvelope( { H2Core::EnvelopePoint( 0, 13 ),
+										  H2Core::EnvelopePoint( 841, 13 ) } );
+		CPPUNIT_ASSERT( pVelocity->load() );
+		CPPUNIT_ASSERT( pVelocity->isMono() );
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			CPPUNIT_ASSERT( pVelocity->getData_L()[ ii ] ==
+							pSample->getData_L()[ ii ] * fGain );
+		}
+
+		// Panning results in distinct channels.
+		auto pPan = std::make_shared<H2Core::Sample>( sPath );
+		pPan->setPanEnvelope( { H2Core::EnvelopePoint( 0, 0 ),
+								H2Core::EnvelopePoint( 841, 0 ) } );
+		CPPUNIT_ASSERT( pPan->load() );
+		CPPUNIT_ASSERT( ! pPan->isMono() );
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			CPPUNIT_ASSERT( pPan->getData_L()[ ii ] ==
+							pSample->getData_L()[ ii ] );
+			CPPUNIT_ASSERT( pPan->getData_R()[ ii ] == 0 );
+		}
+
+		// Copies stay mono.
+		pSample->unload();
+		auto pCopy = std::make_shared<H2Core::Sample>( pVelocity );
+		CPPUNIT_ASSERT( pCopy->isMono() );
+	___INFOLOG( "passed" );
+	}
+
+	void testPacked()
+	{
+	___INFOLOG( "" );
+		for ( const QString& sFile : { QString( "crash.wav" ),
+									   QString( "kick.wav" ) } ) {
+			const QString sPath = H2TEST_FILE( "drumkits/baseKit/" + sFile );
+			auto pSample = H2Core::Sample::load( sPath );
+			CPPUNIT_ASSERT( pSample != nullptr );
+			CPPUNIT_ASSERT( pSample->getFormat() ==
+							H2Core::ResampleKernels::Format::Float );
+			CPPUNIT_ASSERT( pSample->getPackedData_L() == nullptr );
+			const int nFrames = pSample->getFrames();
+
+			for ( const auto format : { H2Core::ResampleKernels::Format::Int16,
+										H2Core::ResampleKernels::Format::Int24 } ) {
+				const float fScale = format == H2Core::ResampleKernels::Format::Int16 ?
+					H2Core::ResampleKernels::fInt16Scale :
+					H2Core::ResampleKernels::fInt24Scale;
+
+				auto pPacked = std::make_shared<H2Core::Sample>( sPath );
+				CPPUNIT_ASSERT( pPacked->load( 120, 0, false, format ) );
+				CPPUNIT_ASSERT( pPacked->getFormat() == format );
+				CPPUNIT_ASSERT( pPacked->getFrames() == nFrames );
+				CPPUNIT_ASSERT( pPacked->isMono() == pSample->isMono() );
+				CPPUNIT_ASSERT( pPacked->getPackedData_L() != nullptr );
+				CPPUNIT_ASSERT( ( pPacked->getPackedData_L() ==
+								  pPacked->getPackedData_R() ) ==
+								pSample->isMono() );
+
+				// Float data is created on demand for all other
+				// consumers.
+				CPPUNIT_ASSERT( pPacked->getData_L() != nullptr );
+				for ( int ii = 0; ii < nFrames; ++ii ) {
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( pSample->getData_L()[ ii ],
+												  pPacked->getData_L()[ ii ],
+												  fScale );
+					CPPUNIT_ASSERT_DOUBLES_EQUAL( pSample->getData_R()[ ii ],
+												  pPacked->getData_R()[ ii ],
+												  fScale );
+				}
+
+				// Copies share the packed data.
+				auto pCopy = std::make_shared<H2Core::Sample>( pPacked );
+				CPPUNIT_ASSERT( pCopy->getFormat() == format );
+				CPPUNIT_ASSERT( pCopy->getPackedData_L() ==
+								pPacked->getPackedData_L() );
+			}
+		}
+	___INFOLOG( "passed" );
+	}
 };
@@ -25,6 +25,7 @@
 #include <core/Basics/Drumkit.h>
 #include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
+#include <core/Helpers/Filesystem.h>
 #include <core/Hydrogen.h>
 #include <core/SoundLibrary/SoundLibraryDatabase.h>
 
@@ -32,9 +33,10 @@ void SoundLibraryTest::testContextValidity() {
 	___INFOLOG( "" );
 
 	auto pDB = H2Core::Hydrogen::get_instance()->getSoundLibraryDatabase();
-	for ( const auto& [ _, ppDrumkit ]: pDB->getDrumkitDatabase() ) {
-		CPPUNIT_ASSERT( ppDrumkit != nullptr );
-		CPPUNIT_ASSERT( ppDrumkit->getContext() != H2Core::Drumkit::Context::Song );
+	const auto pDrumkitEntries = pDB->getDrumkitEntries();
+	for ( const auto& [ _, ppEntry ]: *pDrumkitEntries ) {
+		CPPUNIT_ASSERT( ppEntry != nullptr );
+		CPPUNIT_ASSERT( ppEntry->context != H2Core::Drumkit::Context::Song );
 	}
 
 	___INFOLOG( "passed" );
@@ -84,3 +86,51 @@ void SoundLibraryTest::testKitRetrievalDirect() {
 
 	___INFOLOG( "passed" );
 }
+
+void SoundLibraryTest::testIndex() {
+	___INFOLOG( "" );
+
+	auto pDB = H2Core::Hydrogen::get_instance()->getSoundLibraryDatabase();
+
+	// The first update indexes kits which might have been added or
+	// upgraded since startup. The second one must not parse any kit.
+	pDB->updateDrumkits( false );
+	pDB->updateDrumkits( false );
+	CPPUNIT_ASSERT( H2Core::Filesystem::file_exists(
+						H2Core::SoundLibraryDatabase::getIndexPath(), true ) );
+	const auto pDrumkitEntries = pDB->getDrumkitEntries();
+	CPPUNIT_ASSERT( pDrumkitEntries->size() > 0 );
+
+	for ( const auto& [ ssPath, _ ] : *pDrumkitEntries ) {
+		CPPUNIT_ASSERT( ! pDB->isDrumkitLoaded( ssPath ) );
+	}
+
+	const QString sDrumkitPath = H2Core::Filesystem::absolute_path(
+		H2Core::Filesystem::drumkit_path_search( "GMRockKit" ) );
+	const auto search = pDrumkitEntries->find( sDrumkitPath );
+	CPPUNIT_ASSERT( search != pDrumkitEntries->end() );
+	const auto pEntry = search->second;
+
+	auto pKit = pDB->getDrumkit( sDrumkitPath );
+	CPPUNIT_ASSERT( pKit != nullptr );
+	CPPUNIT_ASSERT( pDB->isDrumkitLoaded( sDrumkitPath ) );
+	CPPUNIT_ASSERT( pDB->getDrumkit( sDrumkitPath ) == pKit );
+
+	CPPUNIT_ASSERT( pEntry->sName == pKit->getName() );
+	CPPUNIT_ASSERT( pEntry->context == pKit->getContext() );
+	CPPUNIT_ASSERT( pEntry->instruments.size() == pKit->getInstruments()->size() );
+	for ( int ii = 0; ii < pEntry->instruments.size(); ++ii ) {
+		const auto pInstrument = pKit->getInstruments()->get( ii );
+		CPPUNIT_ASSERT( pEntry->instruments[ ii ].nId == pInstrument->getId() );
+		CPPUNIT_ASSERT( pEntry->instruments[ ii ].sName == pInstrument->getName() );
+		CPPUNIT_ASSERT( pEntry->instruments[ ii ].sType == pInstrument->getType() );
+	}
+	CPPUNIT_ASSERT( pEntry->getAllTypes() == pKit->getAllTypes() );
+
+	const auto allTypes = pDB->getAllTypes();
+	for ( const auto& sType : pKit->getAllTypes() ) {
+		CPPUNIT_ASSERT( allTypes.find( sType ) != allTypes.end() );
+	}
+
+	___INFOLOG( "passed" );
+}
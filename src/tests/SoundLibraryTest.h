@@ -30,6 +30,7 @@ class SoundLibraryTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( testContextValidity );
 	CPPUNIT_TEST( testKitRetrievalCopy );
 	CPPUNIT_TEST( testKitRetrievalDirect );
+	CPPUNIT_TEST( testIndex );
 	CPPUNIT_TEST_SUITE_END();
 	
 public:
@@ -37,4 +38,7 @@ public:
 		void testContextValidity();
 		void testKitRetrievalCopy();
 		void testKitRetrievalDirect();
+		/** Kits found in the on-disk index must not be loaded before
+		 * being requested and have to match their index entry. */
+		void testIndex();
 };
@@ -20,13 +20,18 @@
  *
  */
 
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/AudioEngine/AudioEngineTests.h>
+#include <core/AudioEngine/TransportPosition.h>
 #include <core/Basics/Drumkit.h>
 #include <core/CoreActionController.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 #include "TransportTest.h"
@@ -270,6 +275,20 @@ void TransportTest::testNoteEnqueuingTimeline() {
 	___INFOLOG( "passed" );
 }
 
+void TransportTest::testQueuingTickSkipping() {
+	___INFOLOG( "" );
+	auto pSong = Song::load( QString( H2TEST_FILE( "song/AE_noteEnqueuing.h2song" ) ) );
+	ASSERT_SONG( pSong );
+
+	H2Core::CoreActionController::setSong( pSong );
+
+	for ( auto ii : { 1, 9 } ) {
+		TestHelper::varyAudioDriverConfig( ii );
+		perform( &AudioEngineTests::testQueuingTickSkipping );
+	}
+	___INFOLOG( "passed" );
+}
+
 void TransportTest::testHumanization() {
 	___INFOLOG( "" );
 	auto pHydrogen = Hydrogen::get_instance();
@@ -322,6 +341,21 @@ void TransportTest::testNoteOff() {
 	___INFOLOG( "passed" );
 }
 
+void TransportTest::testMidiIngressJitter() {
+	___INFOLOG( "" );
+	auto pSongDemo = Song::load( QString( "%1/GM_kit_demo3.h2song" )
+								   .arg( Filesystem::demos_dir() ) );
+	ASSERT_SONG( pSongDemo );
+	H2Core::CoreActionController::setSong( pSongDemo );
+
+	const std::vector<int> indices{ 0, 3, 9, 12 };
+	for ( const int ii : indices ) {
+		TestHelper::varyAudioDriverConfig( ii );
+		perform( &AudioEngineTests::testMidiIngressJitter );
+	}
+	___INFOLOG( "passed" );
+}
+
 void TransportTest::testUpdateTransportPosition() {
 	___INFOLOG( "" );
 
@@ -330,6 +364,101 @@ void TransportTest::testUpdateTransportPosition() {
 	___INFOLOG( "passed" );
 }
 
+void TransportTest::testTempoMapBenchmark() {
+	___INFOLOG( "" );
+	auto pSongDemo = Song::load( QString( "%1/GM_kit_demo3.h2song" )
+								   .arg( Filesystem::demos_dir() ) );
+	ASSERT_SONG( pSongDemo );
+	H2Core::CoreActionController::setSong( pSongDemo );
+	TestHelper::varyAudioDriverConfig( 0 );
+
+	// A ritardando drawn marker by marker.
+	const int nColumns = 4000;
+	CoreActionController::toggleGridCell( nColumns - 1, 0 );
+	CPPUNIT_ASSERT( pSongDemo->getPatternGroupVector()->size() == nColumns );
+	CoreActionController::activateTimeline( true );
+	for ( int ii = 0; ii < nColumns; ++ii ) {
+		CoreActionController::addTempoMarker(
+			ii, 200 - 150 * static_cast<float>(ii) / nColumns );
+	}
+
+	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	const double fSongSizeInTicks = pAudioEngine->getSongSizeInTicks();
+	const int nConversions = 200000;
+
+	double fTickMismatch;
+	double fMaxDeviation = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for ( int ii = 0; ii < nConversions; ++ii ) {
+		// Spread across the song and its first repetition.
+		const double fTick = 2 * fSongSizeInTicks * ii / nConversions + 0.3;
+		const long long nFrame =
+			TransportPosition::computeFrameFromTick( fTick, &fTickMismatch );
+		const double fTickCheck =
+			TransportPosition::computeTickFromFrame( nFrame ) + fTickMismatch;
+		fMaxDeviation = std::max( fMaxDeviation, std::abs( fTickCheck - fTick ) );
+	}
+	const double fSeconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start ).count();
+
+	___INFOLOG( QString( "[%1] tempo markers: [%2] tick/frame round trips in [%3]s ([%4] us each), max deviation: [%5]" )
+				.arg( nColumns ).arg( nConversions ).arg( fSeconds )
+				.arg( fSeconds / nConversions * 1e6 ).arg( fMaxDeviation ) );
+	CPPUNIT_ASSERT( fMaxDeviation < 1e-6 );
+
+	___INFOLOG( "passed" );
+}
+
+void TransportTest::testColumnMap() {
+	___INFOLOG( "" );
+	auto pSongDemo = Song::load( QString( "%1/GM_kit_demo3.h2song" )
+								   .arg( Filesystem::demos_dir() ) );
+	ASSERT_SONG( pSongDemo );
+	H2Core::CoreActionController::setSong( pSongDemo );
+	auto pHydrogen = Hydrogen::get_instance();
+
+	auto checkColumns = [&]() {
+		const auto pColumns = pSongDemo->getPatternGroupVector();
+		long nStartTick = 0;
+		long nPatternStartTick;
+		for ( int ii = 0; ii < pColumns->size(); ++ii ) {
+			const long nLength = ( *pColumns )[ ii ]->size() != 0 ?
+				( *pColumns )[ ii ]->longestPatternLength() :
+				4 * H2Core::nTicksPerQuarter;
+
+			CPPUNIT_ASSERT( pHydrogen->getTickForColumn( ii ) == nStartTick );
+			for ( const long nnTick : { nStartTick, nStartTick + nLength - 1 } ) {
+				CPPUNIT_ASSERT( pHydrogen->getColumnForTick(
+									nnTick, false, &nPatternStartTick ) == ii );
+				CPPUNIT_ASSERT( nPatternStartTick == nStartTick );
+				CPPUNIT_ASSERT( pHydrogen->getColumnForTick(
+									nnTick + pSongDemo->lengthInTicks(), true,
+									&nPatternStartTick ) == ii );
+				CPPUNIT_ASSERT( nPatternStartTick == nStartTick );
+			}
+			nStartTick += nLength;
+		}
+		CPPUNIT_ASSERT( nStartTick == pSongDemo->lengthInTicks() );
+		CPPUNIT_ASSERT( pHydrogen->getColumnForTick(
+							nStartTick, false, &nPatternStartTick ) == -1 );
+		CPPUNIT_ASSERT( pHydrogen->getColumnForTick(
+							-1, true, &nPatternStartTick ) == -1 );
+	};
+
+	checkColumns();
+
+	// Appending a column has to be picked up by the column map.
+	const int nColumns = pSongDemo->getPatternGroupVector()->size();
+	CoreActionController::toggleGridCell( nColumns + 2, 0 );
+	CPPUNIT_ASSERT( pSongDemo->getPatternGroupVector()->size() == nColumns + 3 );
+	checkColumns();
+
+	CoreActionController::toggleGridCell( nColumns + 2, 0 );
+	checkColumns();
+
+	___INFOLOG( "passed" );
+}
+
 void TransportTest::perform( std::function<void()> func ) {
 	try {
 		func();
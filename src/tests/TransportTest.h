@@ -42,10 +42,14 @@ class TransportTest : public CppUnit::TestFixture {
 #endif
 	CPPUNIT_TEST( testNoteEnqueuing );
 	CPPUNIT_TEST( testNoteEnqueuingTimeline );
+	CPPUNIT_TEST( testQueuingTickSkipping );
 	CPPUNIT_TEST( testMuteGroups );
 	CPPUNIT_TEST( testNoteOff );
+	CPPUNIT_TEST( testMidiIngressJitter );
 	CPPUNIT_TEST( testHumanization );
 	CPPUNIT_TEST( testUpdateTransportPosition );
+	CPPUNIT_TEST( testTempoMapBenchmark );
+	CPPUNIT_TEST( testColumnMap );
 	CPPUNIT_TEST_SUITE_END();
 private:
 	void perform( std::function<void()> func );
@@ -74,8 +78,20 @@ public:
 	 * Sampler is consistent on tempo change.
 	 */
 	void testNoteEnqueuingTimeline();
+	/** Compares the notes enqueued in song mode with and without
+	 * skipping ticks holding no events. */
+	void testQueuingTickSkipping();
 	void testHumanization();
 	void testMuteGroups();
 	void testNoteOff();
+	/** Drives the #H2Core::FakeDriver with time stamped MIDI notes and
+	 * checks the frame they are started at. */
+	void testMidiIngressJitter();
 		void testUpdateTransportPosition();
+	/** Converts ticks and frames in a song with thousands of tempo
+	 * markers and reports the time required. */
+	void testTempoMapBenchmark();
+	/** Compares column lookups against the column lengths of the song
+	 * before and after changing its size. */
+	void testColumnMap();
 };
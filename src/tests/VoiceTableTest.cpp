@@ -0,0 +1,190 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2025 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
+#include <core/Sampler/VoiceTable.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace H2Core;
+
+class VoiceTableTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( VoiceTableTest );
+	CPPUNIT_TEST( testAddRemove );
+	CPPUNIT_TEST( testRandomized );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Collects the notes of all voices in the order given by the
+	 * table. */
+	static std::vector<std::shared_ptr<Note>> allNotes( const VoiceTable& table ) {
+		std::vector<std::shared_ptr<Note>> notes;
+		for ( int nVoice = table.getFirst(); nVoice != VoiceTable::nInvalid;
+			  nVoice = table.getNext( nVoice ) ) {
+			notes.push_back( table[ nVoice ].pNote );
+		}
+		return notes;
+	}
+
+	static std::vector<std::shared_ptr<Note>> notesOfInstrument(
+		const VoiceTable& table, const Instrument* pInstrument ) {
+		std::vector<std::shared_ptr<Note>> notes;
+		for ( int nVoice = table.getFirstOfInstrument( pInstrument );
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = table.getNextOfInstrument( nVoice ) ) {
+			notes.push_back( table[ nVoice ].pNote );
+		}
+		return notes;
+	}
+
+	static std::vector<std::shared_ptr<Note>> notesOfMuteGroup(
+		const VoiceTable& table, int nMuteGroup ) {
+		std::vector<std::shared_ptr<Note>> notes;
+		for ( int nVoice = table.getFirstOfMuteGroup( nMuteGroup );
+			  nVoice != VoiceTable::nInvalid;
+			  nVoice = table.getNextOfMuteGroup( nVoice ) ) {
+			notes.push_back( table[ nVoice ].pNote );
+		}
+		return notes;
+	}
+
+	public:
+
+	void testAddRemove() {
+		___INFOLOG( "" );
+
+		auto pInstrA = std::make_shared<Instrument>( 0 );
+		auto pInstrB = std::make_shared<Instrument>( 1 );
+		pInstrB->setMuteGroup( 3 );
+
+		VoiceTable table( 3 );
+		CPPUNIT_ASSERT_EQUAL( 0, table.size() );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid, table.getFirst() );
+
+		auto pNote1 = std::make_shared<Note>( pInstrA );
+		auto pNote2 = std::make_shared<Note>( pInstrB );
+		auto pNote3 = std::make_shared<Note>( pInstrA );
+		const int nVoice1 = table.add( pNote1 );
+		const int nVoice2 = table.add( pNote2 );
+		const int nVoice3 = table.add( pNote3 );
+		CPPUNIT_ASSERT( nVoice1 != VoiceTable::nInvalid );
+		CPPUNIT_ASSERT( nVoice2 != VoiceTable::nInvalid );
+		CPPUNIT_ASSERT( nVoice3 != VoiceTable::nInvalid );
+		CPPUNIT_ASSERT( table.isFull() );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid,
+							  table.add( std::make_shared<Note>( pInstrB ) ) );
+
+		// Notes without instrument can not be rendered.
+		table.remove( nVoice3 );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid,
+							  table.add( std::make_shared<Note>( nullptr, 0 ) ) );
+		table.add( pNote3 );
+
+		CPPUNIT_ASSERT( allNotes( table ) ==
+						std::vector<std::shared_ptr<Note>>( { pNote1, pNote2, pNote3 } ) );
+		CPPUNIT_ASSERT( notesOfInstrument( table, pInstrA.get() ) ==
+						std::vector<std::shared_ptr<Note>>( { pNote1, pNote3 } ) );
+		CPPUNIT_ASSERT( notesOfMuteGroup( table, 3 ) ==
+						std::vector<std::shared_ptr<Note>>( { pNote2 } ) );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid, table.getFirstOfMuteGroup( -1 ) );
+
+		table.remove( nVoice1 );
+		table.remove( table.getFirstOfMuteGroup( 3 ) );
+		CPPUNIT_ASSERT_EQUAL( 1, table.size() );
+		CPPUNIT_ASSERT( allNotes( table ) ==
+						std::vector<std::shared_ptr<Note>>( { pNote3 } ) );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid,
+							  table.getFirstOfInstrument( pInstrB.get() ) );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid, table.getFirstOfMuteGroup( 3 ) );
+
+		table.clear();
+		CPPUNIT_ASSERT_EQUAL( 0, table.size() );
+		CPPUNIT_ASSERT_EQUAL( VoiceTable::nInvalid,
+							  table.getFirstOfInstrument( pInstrA.get() ) );
+
+		___INFOLOG( "passed" );
+	}
+
+	/** Compares the table against a plain vector for a random sequence
+	 * of insertions and removals. */
+	void testRandomized() {
+		___INFOLOG( "" );
+
+		const int nCapacity = 64;
+		std::vector<std::shared_ptr<Instrument>> instruments;
+		for ( int ii = 0; ii < 10; ++ii ) {
+			auto pInstrument = std::make_shared<Instrument>( ii );
+			pInstrument->setMuteGroup( ii % 4 - 1 );
+			instruments.push_back( pInstrument );
+		}
+
+		std::mt19937 randomEngine( 1234 );
+		VoiceTable table( nCapacity );
+		std::vector<std::shared_ptr<Note>> reference;
+
+		for ( int nn = 0; nn < 5000; ++nn ) {
+			if ( reference.size() < nCapacity &&
+				 ( reference.empty() || randomEngine() % 2 == 0 ) ) {
+				auto pNote = std::make_shared<Note>(
+					instruments[ randomEngine() % instruments.size() ] );
+				CPPUNIT_ASSERT( table.add( pNote ) != VoiceTable::nInvalid );
+				reference.push_back( pNote );
+			}
+			else {
+				// Remove a random voice.
+				int nVoice = table.getFirst();
+				for ( int ii = randomEngine() % reference.size(); ii > 0; --ii ) {
+					nVoice = table.getNext( nVoice );
+				}
+				reference.erase( std::find( reference.begin(), reference.end(),
+											table[ nVoice ].pNote ) );
+				table.remove( nVoice );
+			}
+
+			CPPUNIT_ASSERT_EQUAL( static_cast<int>(reference.size()), table.size() );
+			CPPUNIT_ASSERT( allNotes( table ) == reference );
+			for ( const auto& pInstrument : instruments ) {
+				std::vector<std::shared_ptr<Note>> expected;
+				for ( const auto& pNote : reference ) {
+					if ( pNote->getInstrument() == pInstrument ) {
+						expected.push_back( pNote );
+					}
+				}
+				CPPUNIT_ASSERT( notesOfInstrument( table, pInstrument.get() ) ==
+								expected );
+			}
+			for ( int nMuteGroup = 0; nMuteGroup < 3; ++nMuteGroup ) {
+				std::vector<std::shared_ptr<Note>> expected;
+				for ( const auto& pNote : reference ) {
+					if ( pNote->getInstrument()->getMuteGroup() == nMuteGroup ) {
+						expected.push_back( pNote );
+					}
+				}
+				CPPUNIT_ASSERT( notesOfMuteGroup( table, nMuteGroup ) == expected );
+			}
+		}
+
+		___INFOLOG( "passed" );
+	}
+};
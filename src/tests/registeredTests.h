@@ -30,7 +30,10 @@
 #include "AutomationPathSerializerTest.cpp"
 #include "AutomationPathTest.cpp"
 #include "CliTest.h"
+#include "CommandQueueTest.cpp"
+#include "LoggerTest.cpp"
 #include "CoreActionControllerTest.h"
+#include "DiskWriterEncoderTest.cpp"
 #include "EventQueueTest.cpp"
 #include "DrumkitExportTest.h"
 #include "FilesystemTest.h"
@@ -42,13 +45,19 @@
 #include "MimeTest.h"
 #include "NetworkTest.h"
 #include "NoteTest.h"
+#include "NoteTimingWheelTest.cpp"
 #include "OscServerTest.h"
 #include "PatternTest.h"
+#include "ResampleCacheTest.cpp"
+#include "ResampleKernelsTest.cpp"
+#include "SampleCacheTest.cpp"
+#include "SampleRegistryTest.cpp"
 #include "SampleTest.cpp"
 #include "SoundLibraryTest.h"
 #include "TimeTest.h"
 #include "Translations.cpp"
 #include "TransportTest.h"
+#include "VoiceTableTest.cpp"
 #include "XmlTest.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ADSRTest );
@@ -62,7 +71,10 @@ CPPUNIT_TEST_SUITE_REGISTRATION( AutomationPathTest );
   // For now h2cli is just part of our Linux package.
   CPPUNIT_TEST_SUITE_REGISTRATION( CliTest );
 #endif
+CPPUNIT_TEST_SUITE_REGISTRATION( CommandQueueTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( LoggerTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( CoreActionControllerTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( DiskWriterEncoderTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( EventQueueTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( DrumkitExportTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( FilesystemTest );
@@ -74,13 +86,19 @@ CPPUNIT_TEST_SUITE_REGISTRATION( MidiExportTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( MidiNoteTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( NetworkTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( NoteTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( NoteTimingWheelTest );
 #ifdef H2CORE_HAVE_OSC
 CPPUNIT_TEST_SUITE_REGISTRATION( OscServerTest );
 #endif
 CPPUNIT_TEST_SUITE_REGISTRATION( PatternTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( ResampleCacheTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( ResampleKernelsTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( SampleCacheTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( SampleRegistryTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( SampleTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( SoundLibraryTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( TimeTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( TransportTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( UITranslationTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( VoiceTableTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( XmlTest );